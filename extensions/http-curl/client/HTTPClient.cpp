@@ -247,8 +247,15 @@ void HTTPClient::setUseChunkedEncoding() {
 }
 
 bool HTTPClient::submit() {
-  if (IsNullOrEmpty(url_))
+  CURL* const handle = prepareSubmit();
+  if (handle == nullptr)
     return false;
+  return finishSubmit(curl_easy_perform(handle));
+}
+
+CURL* HTTPClient::prepareSubmit() {
+  if (IsNullOrEmpty(url_))
+    return nullptr;
 
   int absoluteTimeout = std::max(0, 3 * static_cast<int>(read_timeout_ms_.count()));
 
@@ -292,7 +299,11 @@ bool HTTPClient::submit() {
     logger_->log_debug("Not using keep alive");
     curl_easy_setopt(http_session_, CURLOPT_TCP_KEEPALIVE, 0L);
   }
-  res = curl_easy_perform(http_session_);
+  return http_session_;
+}
+
+bool HTTPClient::finishSubmit(CURLcode result) {
+  res = result;
   if (callback == nullptr) {
     read_callback_.close();
   }
@@ -301,6 +312,7 @@ bool HTTPClient::submit() {
   http_code_ = http_code;
   curl_easy_getinfo(http_session_, CURLINFO_CONTENT_TYPE, &content_type_str_);
   if (res == CURLE_OPERATION_TIMEDOUT) {
+    const int absoluteTimeout = std::max(0, 3 * static_cast<int>(read_timeout_ms_.count()));
     logger_->log_error("HTTP operation timed out, with absolute timeout %dms\n", absoluteTimeout);
   }
   if (res != CURLE_OK) {
@@ -126,6 +126,19 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   bool submit() override;
 
+  /**
+   * Sets up the transfer of submit() without performing it, so that it can be added to a curl multi handle, see HTTPEventLoop.
+   * @return the easy handle of the transfer, or nullptr if there is no URL to submit to
+   */
+  CURL* prepareSubmit();
+
+  /**
+   * Collects the response of the transfer set up by prepareSubmit() once it has finished.
+   * @param result the result of the transfer
+   * @return whether the transfer succeeded, as in submit()
+   */
+  bool finishSubmit(CURLcode result);
+
   CURLcode getResponseResult();
 
   int64_t getResponseCode() const override;
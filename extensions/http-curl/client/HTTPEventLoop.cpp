@@ -0,0 +1,177 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPEventLoop.h"
+
+#include <chrono>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+constexpr int HTTPEventLoop::MAX_WAIT_MS;
+constexpr int HTTPEventLoop::MAX_POLL_MS;
+
+HTTPEventLoop::HTTPEventLoop()
+    : multi_handle_(curl_multi_init()) {
+  thread_ = std::thread(&HTTPEventLoop::run, this);
+}
+
+HTTPEventLoop::~HTTPEventLoop() {
+  {
+    std::lock_guard<std::mutex> lock(submitted_mutex_);
+    running_ = false;
+  }
+  submitted_condition_.notify_all();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  curl_multi_wakeup(multi_handle_);
+#endif
+  thread_.join();
+  curl_multi_cleanup(multi_handle_);
+}
+
+void HTTPEventLoop::submit(CURL* handle, Callback callback) {
+  bool accepted = false;
+  {
+    std::lock_guard<std::mutex> lock(submitted_mutex_);
+    if (running_) {
+      ++transfer_count_;
+      submitted_.emplace_back(handle, std::move(callback));
+      accepted = true;
+    }
+  }
+  if (!accepted) {
+    // the event loop is shutting down
+    callback(CURLE_ABORTED_BY_CALLBACK);
+    return;
+  }
+  submitted_condition_.notify_one();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  curl_multi_wakeup(multi_handle_);
+#endif
+}
+
+void HTTPEventLoop::abortTransfers() {
+  {
+    std::lock_guard<std::mutex> lock(submitted_mutex_);
+    abort_requested_ = true;
+  }
+  submitted_condition_.notify_one();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  curl_multi_wakeup(multi_handle_);
+#endif
+}
+
+void HTTPEventLoop::run() {
+  while (running_) {
+    startSubmittedTransfers();
+    abortStartedTransfers();
+
+    int running_transfers = 0;
+    curl_multi_perform(multi_handle_, &running_transfers);
+
+    int messages_left = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi_handle_, &messages_left)) {
+      if (message->msg == CURLMSG_DONE) {
+        finishTransfer(message->easy_handle, message->data.result);
+      }
+    }
+
+    waitForActivity();
+  }
+
+  startSubmittedTransfers();
+  while (!transfers_.empty()) {
+    finishTransfer(transfers_.begin()->first, CURLE_ABORTED_BY_CALLBACK);
+  }
+}
+
+void HTTPEventLoop::abortStartedTransfers() {
+  {
+    std::lock_guard<std::mutex> lock(submitted_mutex_);
+    if (!abort_requested_) {
+      return;
+    }
+    abort_requested_ = false;
+  }
+  while (!transfers_.empty()) {
+    finishTransfer(transfers_.begin()->first, CURLE_ABORTED_BY_CALLBACK);
+  }
+}
+
+void HTTPEventLoop::startSubmittedTransfers() {
+  std::vector<std::pair<CURL*, Callback>> submitted;
+  {
+    std::lock_guard<std::mutex> lock(submitted_mutex_);
+    submitted.swap(submitted_);
+  }
+  for (auto& transfer : submitted) {
+    const CURLMcode result = curl_multi_add_handle(multi_handle_, transfer.first);
+    if (result != CURLM_OK) {
+      logger_->log_error("Could not start HTTP transfer: %s", curl_multi_strerror(result));
+      --transfer_count_;
+      transfer.second(CURLE_FAILED_INIT);
+      continue;
+    }
+    transfers_.emplace(transfer.first, std::move(transfer.second));
+  }
+}
+
+void HTTPEventLoop::finishTransfer(CURL* handle, CURLcode result) {
+  curl_multi_remove_handle(multi_handle_, handle);
+  const auto it = transfers_.find(handle);
+  if (it == transfers_.end()) {
+    return;
+  }
+  const Callback callback = std::move(it->second);
+  transfers_.erase(it);
+  --transfer_count_;
+  try {
+    callback(result);
+  } catch (const std::exception& exception) {
+    logger_->log_error("Caught \"%s\" in the completion callback of an HTTP transfer", exception.what());
+  } catch (...) {
+    logger_->log_error("Caught unknown exception in the completion callback of an HTTP transfer");
+  }
+}
+
+void HTTPEventLoop::waitForActivity() {
+  if (transfers_.empty()) {
+    std::unique_lock<std::mutex> lock(submitted_mutex_);
+    submitted_condition_.wait(lock, [this] { return !running_ || abort_requested_ || !submitted_.empty(); });
+    return;
+  }
+  int descriptors = 0;
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  // interrupted by curl_multi_wakeup on submission
+  curl_multi_poll(multi_handle_, nullptr, 0, MAX_POLL_MS, &descriptors);
+#else
+  curl_multi_wait(multi_handle_, nullptr, 0, MAX_WAIT_MS, &descriptors);
+  if (descriptors == 0) {
+    // curl had no sockets to wait for (e.g. during name resolution) and returned immediately
+    std::unique_lock<std::mutex> lock(submitted_mutex_);
+    submitted_condition_.wait_for(lock, std::chrono::milliseconds(MAX_WAIT_MS), [this] { return !running_ || abort_requested_ || !submitted_.empty(); });
+  }
+#endif
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
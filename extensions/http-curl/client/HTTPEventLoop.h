@@ -0,0 +1,105 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/logging/Logger.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Performs the transfers of many HTTPClients concurrently on a single thread, using a curl multi handle.
+ * The transfers are set up with HTTPClient::prepareSubmit() and their results are collected with
+ * HTTPClient::finishSubmit() in the completion callback.
+ */
+class HTTPEventLoop {
+ public:
+  using Callback = std::function<void(CURLcode)>;
+
+  HTTPEventLoop();
+  // aborts the transfers in progress, calling their callbacks with CURLE_ABORTED_BY_CALLBACK
+  ~HTTPEventLoop();
+
+  HTTPEventLoop(const HTTPEventLoop&) = delete;
+  HTTPEventLoop& operator=(const HTTPEventLoop&) = delete;
+
+  /**
+   * Starts the transfer of handle. Thread-safe.
+   * @param handle easy handle which must stay valid until the callback is called
+   * @param callback called with the result of the transfer on the thread of the event loop,
+   * it should hand the result over instead of processing it
+   */
+  void submit(CURL* handle, Callback callback);
+
+  // aborts the transfers in progress, calling their callbacks with CURLE_ABORTED_BY_CALLBACK on the thread of the event loop
+  void abortTransfers();
+
+  // number of the transfers submitted and not yet completed
+  size_t getTransferCount() const {
+    return transfer_count_;
+  }
+
+ private:
+  void run();
+  void startSubmittedTransfers();
+  void finishTransfer(CURL* handle, CURLcode result);
+  void abortStartedTransfers();
+  void waitForActivity();
+
+  // upper bound of a wait for socket activity when submissions can interrupt it (curl 7.68+)
+  static constexpr int MAX_POLL_MS = 1000;
+  // upper bound of a wait for socket activity on older curl versions, where submissions cannot interrupt it
+  static constexpr int MAX_WAIT_MS = 10;
+
+  CURLM* multi_handle_;
+  std::atomic<bool> running_{true};
+  std::atomic<size_t> transfer_count_{0};
+
+  std::mutex submitted_mutex_;
+  std::condition_variable submitted_condition_;
+  std::vector<std::pair<CURL*, Callback>> submitted_;
+  bool abort_requested_{false};
+
+  // transfers added to multi_handle_, accessed only by thread_
+  std::unordered_map<CURL*, Callback> transfers_;
+
+  std::thread thread_;
+
+  std::shared_ptr<logging::Logger> logger_{logging::LoggerFactory<HTTPEventLoop>::getLogger()};
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
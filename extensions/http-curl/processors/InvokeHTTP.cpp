@@ -45,6 +45,7 @@
 #include "io/BufferStream.h"
 #include "io/StreamFactory.h"
 #include "ResourceClaim.h"
+#include "utils/GeneralUtils.h"
 #include "utils/gsl.h"
 #include "utils/StringUtils.h"
 
@@ -122,6 +123,11 @@ core::Property InvokeHTTP::AlwaysOutputResponse("Always Output Response", "Will
                                                 "false");
 core::Property InvokeHTTP::PenalizeOnNoRetry("Penalize on \"No Retry\"", "Enabling this property will penalize FlowFiles that are routed to the \"No Retry\" relationship.", "false");
 
+core::Property InvokeHTTP::MaxConcurrentRequests(
+    core::PropertyBuilder::createProperty("Max Concurrent Requests")->withDescription("Maximum number of requests in flight at once. The requests are performed on a single thread "
+        "without blocking the tasks of the processor, so a single task can keep many requests in flight. At least as many requests are allowed as the number of concurrent tasks.")
+        ->isRequired(false)->withDefaultValue<uint64_t>(1)->build());
+
 core::Property InvokeHTTP::DisablePeerVerification("Disable Peer Verification", "Disables peer verification for the SSL session", "false");
 const char* InvokeHTTP::STATUS_CODE = "invokehttp.status.code";
 const char* InvokeHTTP::STATUS_MESSAGE = "invokehttp.status.message";
@@ -168,6 +174,7 @@ void InvokeHTTP::initialize() {
   properties.insert(DisablePeerVerification);
   properties.insert(AlwaysOutputResponse);
   properties.insert(FollowRedirects);
+  properties.insert(MaxConcurrentRequests);
 
   setSupportedProperties(properties);
   // Set the supported relationships
@@ -182,6 +189,14 @@ bool getTimeMSFromString(const std::string& propertyName, uint64_t& valInt) {
 }
 
 void InvokeHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory>& /*sessionFactory*/) {
+  if (!event_loop_) {
+    event_loop_ = utils::make_unique<utils::HTTPEventLoop>();
+  }
+
+  uint64_t max_concurrent_requests = 1;
+  context->getProperty(MaxConcurrentRequests.getName(), max_concurrent_requests);
+  setMaxSessionsInFlight((std::max)(gsl::narrow<size_t>(max_concurrent_requests), static_cast<size_t>(getMaxConcurrentTasks())));
+
   if (!context->getProperty(Method.getName(), method_)) {
     logger_->log_debug("%s attribute is missing, so default value of %s will be used", Method.getName(), Method.getValue());
     return;
@@ -278,6 +293,31 @@ void InvokeHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context
 
 InvokeHTTP::~InvokeHTTP() = default;
 
+void InvokeHTTP::notifyStop() {
+  // the responses received so far are processed, the flow files of the rest are rolled back
+  closeSessionsInFlight();
+  if (event_loop_) {
+    event_loop_->abortTransfers();
+  }
+}
+
+struct InvokeHTTP::Request {
+  Request(const std::string &url, const std::shared_ptr<minifi::controllers::SSLContextService> &ssl_context_service)
+      : client(url, ssl_context_service) {
+  }
+
+  // Note: callback must be declared before callbackObj so that they are destructed in the correct order
+  std::unique_ptr<utils::ByteInputCallBack> callback;
+  std::unique_ptr<utils::HTTPUploadCallback> callbackObj;
+
+  // Client declared after the callbacks to make sure the callbacks are still available when the client is destructed
+  utils::HTTPClient client;
+
+  std::shared_ptr<core::FlowFile> flow_file;
+  std::string url;
+  std::string tx_id;
+};
+
 std::string InvokeHTTP::generateId() {
   return utils::IdGenerator::getIdGenerator()->generate().to_string();
 }
@@ -286,7 +326,7 @@ bool InvokeHTTP::emitFlowFile(const std::string &method) {
   return ("POST" == method || "PUT" == method || "PATCH" == method);
 }
 
-void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+void InvokeHTTP::onTriggerAsync(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
   auto flowFile = session->get();
 
   std::string url = url_;
@@ -306,15 +346,14 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
 
   logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, url_);
 
+  // the request is shared by the completion handlers, as it is performed by event_loop_ after returning
+  const auto request = std::make_shared<Request>(url_, ssl_context_service_);
+  request->flow_file = flowFile;
+  request->url = url;
   // create a transaction id
-  std::string tx_id = generateId();
-
-  // Note: callback must be declared before callbackObj so that they are destructed in the correct order
-  std::unique_ptr<utils::ByteInputCallBack> callback = nullptr;
-  std::unique_ptr<utils::HTTPUploadCallback> callbackObj = nullptr;
+  request->tx_id = generateId();
 
-  // Client declared after the callbacks to make sure the callbacks are still available when the client is destructed
-  utils::HTTPClient client(url_, ssl_context_service_);
+  utils::HTTPClient& client = request->client;
 
   client.initialize(method_);
   client.setConnectionTimeout(connect_timeout_ms_);
@@ -340,6 +379,8 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     logger_->log_trace("InvokeHTTP -- reading flowfile");
     std::shared_ptr<ResourceClaim> claim = flowFile->getResourceClaim();
     if (claim) {
+      auto& callback = request->callback;
+      auto& callbackObj = request->callbackObj;
       callback = std::unique_ptr<utils::ByteInputCallBack>(new utils::ByteInputCallBack());
       if (send_body_) {
         session->read(flowFile, callback.get());
@@ -366,8 +407,29 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
   // append all headers
   client.build_header_list(attribute_to_send_regex_, flowFile->getAttributes());
 
+  CURL* const handle = client.prepareSubmit();
+  if (handle == nullptr) {
+    session->penalize(flowFile);
+    session->transfer(flowFile, RelFailure);
+    return;
+  }
+
+  const Operation operation = startOperation(session);
+  event_loop_->submit(handle, [this, operation, request, context, session](CURLcode result) {
+    operation.complete([this, request, context, session, result] {
+      onResponse(*request, context, session, result);
+    });
+  });
+}
+
+void InvokeHTTP::onResponse(Request &request, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, CURLcode result) {
+  utils::HTTPClient& client = request.client;
+  const std::shared_ptr<core::FlowFile>& flowFile = request.flow_file;
+  const std::string& url = request.url;
+  const std::string& tx_id = request.tx_id;
+
   logger_->log_trace("InvokeHTTP -- curl performed");
-  if (client.submit()) {
+  if (client.finishSubmit(result)) {
     logger_->log_trace("InvokeHTTP -- curl successful");
 
     bool putToAttribute = !IsNullOrEmpty(put_attribute_name_);
@@ -25,7 +25,7 @@
 #include <curl/curl.h>
 #include "utils/ByteArrayCallback.h"
 #include "FlowFileRecord.h"
-#include "core/Processor.h"
+#include "core/AsyncProcessor.h"
 #include "core/ProcessSession.h"
 #include "core/Core.h"
 #include "core/Property.h"
@@ -34,6 +34,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/Id.h"
 #include "../client/HTTPClient.h"
+#include "../client/HTTPEventLoop.h"
 
 namespace org {
 namespace apache {
@@ -42,7 +43,7 @@ namespace minifi {
 namespace processors {
 
 // InvokeHTTP Class
-class InvokeHTTP : public core::Processor {
+class InvokeHTTP : public core::AsyncProcessor {
  public:
 
   // Constructor
@@ -50,7 +51,7 @@ class InvokeHTTP : public core::Processor {
    * Create a new processor
    */
   InvokeHTTP(std::string name, utils::Identifier uuid = utils::Identifier())
-      : Processor(name, uuid) {
+      : AsyncProcessor(name, uuid) {
   }
   // Destructor
   virtual ~InvokeHTTP();
@@ -81,6 +82,8 @@ class InvokeHTTP : public core::Processor {
 
   static core::Property PenalizeOnNoRetry;
 
+  static core::Property MaxConcurrentRequests;
+
   static const char* STATUS_CODE;
   static const char* STATUS_MESSAGE;
   static const char* RESPONSE_BODY;
@@ -96,7 +99,6 @@ class InvokeHTTP : public core::Processor {
   static core::Relationship RelNoRetry;
   static core::Relationship RelFailure;
 
-  void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
   void initialize() override;
   void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
   /**
@@ -107,6 +109,10 @@ class InvokeHTTP : public core::Processor {
   }
 
  protected:
+  void onTriggerAsync(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
+
+  // returns the flow files of the requests in flight to the incoming queue
+  void notifyStop() override;
 
   /**
    * Generate a transaction ID
@@ -163,6 +169,14 @@ class InvokeHTTP : public core::Processor {
   bool send_body_{true};
 
  private:
+  struct Request;
+
+  // processes the response of the request once it has finished with result, on a scheduler thread
+  void onResponse(Request &request, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, CURLcode result);
+
+  // performs the requests of all the tasks of the processor
+  std::unique_ptr<utils::HTTPEventLoop> event_loop_;
+
   std::shared_ptr<logging::Logger> logger_{logging::LoggerFactory<InvokeHTTP>::getLogger()};
 };
 
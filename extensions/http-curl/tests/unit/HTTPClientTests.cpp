@@ -16,19 +16,27 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <set>
+#include <thread>
+#include <vector>
 #include "FlowController.h"
 #include "io/BaseStream.h"
 #include "TestBase.h"
 #include "processors/GetFile.h"
 #include "core/Core.h"
 #include "client/HTTPClient.h"
+#include "client/HTTPEventLoop.h"
 #include "CivetServer.h"
+#include "utils/IntegrationTestUtils.h"
 
 TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
   LogTestController::getInstance().setDebug<utils::HTTPClient>();
@@ -93,3 +101,96 @@ TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
 
   LogTestController::getInstance().reset();
 }
+
+TEST_CASE("HTTPEventLoop performs the transfers of many clients concurrently", "[HTTPEventLoop]") {
+  // every response takes half a second
+  class SlowResponder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer* /*server*/, struct mg_connection *conn) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK");
+      return true;
+    }
+  };
+
+  const std::vector<std::string> options{"listening_ports", "0", "num_threads", "16"};
+  CivetServer server(options);
+  SlowResponder responder;
+  server.addHandler("**", responder);
+  const std::string url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/slow";
+
+  std::vector<std::unique_ptr<utils::HTTPClient>> clients;
+  std::mutex results_mutex;
+  std::vector<bool> results;
+  utils::HTTPEventLoop event_loop;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; ++i) {
+    clients.push_back(utils::make_unique<utils::HTTPClient>());
+    utils::HTTPClient* client = clients.back().get();
+    client->initialize("GET", url);
+    event_loop.submit(client->prepareSubmit(), [client, &results_mutex, &results](CURLcode result) {
+      const bool success = client->finishSubmit(result);
+      std::lock_guard<std::mutex> lock(results_mutex);
+      results.push_back(success);
+    });
+  }
+
+  const auto all_finished = [&results_mutex, &results] {
+    std::lock_guard<std::mutex> lock(results_mutex);
+    return results.size() == 10;
+  };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(10), all_finished));
+  // one after the other they would take 5 seconds
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(4));
+  const auto all_succeeded = std::all_of(results.begin(), results.end(), [](bool success) { return success; });
+  REQUIRE(all_succeeded);
+  for (const auto& client : clients) {
+    REQUIRE(client->getResponseCode() == 200);
+    const std::vector<char>& response = client->getResponseBody();
+    REQUIRE("OK" == std::string(response.begin(), response.end()));
+  }
+  REQUIRE(event_loop.getTransferCount() == 0);
+}
+
+TEST_CASE("HTTPEventLoop aborts the transfers in progress", "[HTTPEventLoop]") {
+  class SlowResponder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer* /*server*/, struct mg_connection *conn) {
+      std::this_thread::sleep_for(std::chrono::seconds(2));
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK");
+      return true;
+    }
+  };
+
+  const std::vector<std::string> options{"listening_ports", "0", "num_threads", "4"};
+  CivetServer server(options);
+  SlowResponder responder;
+  server.addHandler("**", responder);
+  const std::string url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/slow";
+
+  utils::HTTPClient client;
+  client.initialize("GET", url);
+  std::atomic<int> aborted{0};
+  const auto on_finished = [&aborted](CURLcode result) {
+    if (result == CURLE_ABORTED_BY_CALLBACK) {
+      ++aborted;
+    }
+  };
+
+  SECTION("Aborted on request") {
+    utils::HTTPEventLoop event_loop;
+    event_loop.submit(client.prepareSubmit(), on_finished);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    event_loop.abortTransfers();
+    const auto was_aborted = [&aborted] { return aborted == 1; };
+    REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(1), was_aborted));
+  }
+  SECTION("Aborted by the destructor") {
+    {
+      utils::HTTPEventLoop event_loop;
+      event_loop.submit(client.prepareSubmit(), on_finished);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    REQUIRE(aborted == 1);
+  }
+}
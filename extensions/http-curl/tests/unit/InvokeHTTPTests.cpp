@@ -16,15 +16,21 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <set>
+#include <thread>
+#include <vector>
 #include "FlowController.h"
 #include "io/BaseStream.h"
 #include "TestBase.h"
+#include "CivetServer.h"
 #include "processors/GetFile.h"
 #include "core/Core.h"
 #include "HTTPClient.h"
@@ -310,3 +316,71 @@ TEST_CASE("HTTPTestsPostNoResourceClaim", "[httptest1]") {
   REQUIRE(true == LogTestController::getInstance().contains("exiting because method is POST"));
   LogTestController::getInstance().reset();
 }
+
+namespace {
+
+// requests per second of an InvokeHTTP triggered by a single thread, against a server responding in 10 ms
+double measureRequestsPerSecond(uint64_t max_concurrent_requests) {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer* /*server*/, struct mg_connection *conn) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK");
+      return true;
+    }
+  };
+  const std::vector<std::string> options{"listening_ports", "0", "num_threads", "256", "enable_keep_alive", "yes"};
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+
+  TestController testController;
+  LogTestController::getInstance().setOff<org::apache::nifi::minifi::processors::InvokeHTTP>();
+  std::shared_ptr<TestPlan> plan = testController.createPlan();
+  const auto invokehttp = std::make_shared<org::apache::nifi::minifi::processors::InvokeHTTP>("invokehttp");
+  plan->addProcessor(invokehttp, "invokehttp");
+  invokehttp->setAutoTerminatedRelationships({org::apache::nifi::minifi::processors::InvokeHTTP::Success, org::apache::nifi::minifi::processors::InvokeHTTP::RelResponse,
+      org::apache::nifi::minifi::processors::InvokeHTTP::RelRetry, org::apache::nifi::minifi::processors::InvokeHTTP::RelNoRetry,
+      org::apache::nifi::minifi::processors::InvokeHTTP::RelFailure});
+  plan->setProperty(invokehttp, org::apache::nifi::minifi::processors::InvokeHTTP::Method.getName(), "GET");
+  plan->setProperty(invokehttp, org::apache::nifi::minifi::processors::InvokeHTTP::URL.getName(),
+      "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/benchmark");
+  plan->setProperty(invokehttp, org::apache::nifi::minifi::processors::InvokeHTTP::MaxConcurrentRequests.getName(), std::to_string(max_concurrent_requests));
+  plan->scheduleProcessor(invokehttp);
+  const auto context = plan->getProcessContextForProcessor(invokehttp);
+  const auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+
+  // the scheduler thread sleeps while all the requests are in flight, until a response arrives
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool notified = false;
+  invokehttp->setWorkNotificationCallback([&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    notified = true;
+    condition.notify_one();
+  });
+
+  const auto duration = std::chrono::seconds(3);
+  const auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < duration) {
+    invokehttp->onTrigger(context, factory);
+    if (!invokehttp->isWorkAvailable()) {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait_for(lock, std::chrono::milliseconds(100), [&] { return notified; });
+      notified = false;
+    }
+  }
+  invokehttp->setWorkNotificationCallback({});
+  invokehttp->setScheduledState(core::ScheduledState::STOPPED);
+
+  const uint64_t requests = invokehttp->getStatistics().getSnapshot().commits;
+  return static_cast<double>(requests) / std::chrono::duration<double>(duration).count();
+}
+
+}  // namespace
+
+TEST_CASE("InvokeHTTP requests per second on a single thread", "[.][benchmark]") {
+  for (const uint64_t max_concurrent_requests : {1, 16, 64, 200}) {
+    WARN("Max Concurrent Requests " << max_concurrent_requests << ": " << measureRequestsPerSecond(max_concurrent_requests) << " requests/s");
+  }
+}
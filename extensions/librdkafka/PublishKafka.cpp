@@ -21,7 +21,9 @@
 
 #include <cstdio>
 #include <algorithm>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <map>
 #include <set>
@@ -877,19 +879,10 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
   logger_->log_debug("PublishKafka onTrigger");
 
   // Collect FlowFiles to process
-  uint64_t actual_bytes = 0U;
-  std::vector<std::shared_ptr<core::FlowFile>> flowFiles;
-  for (uint32_t i = 0; i < batch_size_; i++) {
-    std::shared_ptr<core::FlowFile> flowFile = session->get();
-    if (flowFile == nullptr) {
-      break;
-    }
-    actual_bytes += flowFile->getSize();
-    flowFiles.emplace_back(std::move(flowFile));
-    if (target_batch_payload_size_ != 0U && actual_bytes >= target_batch_payload_size_) {
-      break;
-    }
-  }
+  const uint64_t max_batch_bytes = target_batch_payload_size_ != 0U ? target_batch_payload_size_ : std::numeric_limits<uint64_t>::max();
+  std::vector<std::shared_ptr<core::FlowFile>> flowFiles = session->get(batch_size_, max_batch_bytes);
+  const uint64_t actual_bytes = std::accumulate(flowFiles.begin(), flowFiles.end(), uint64_t{0},
+      [](uint64_t sum, const std::shared_ptr<core::FlowFile>& flowFile) { return sum + flowFile->getSize(); });
   if (flowFiles.empty()) {
     context->yield();
     return;
@@ -18,12 +18,20 @@
 
 #include "DatabaseContentRepository.h"
 
+#include <cstdio>
+#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "RocksDbEnvironment.h"
 #include "RocksDbStream.h"
+#include "core/TypedValues.h"
 #include "rocksdb/merge_operator.h"
 #include "utils/GeneralUtils.h"
+#include "utils/file/FileUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/gsl.h"
 #include "Exception.h"
 
@@ -34,6 +42,84 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+namespace {
+
+template<typename T>
+void setFromDataSize(const minifi::Configure& configuration, const char* key, T& target, logging::Logger& logger) {
+  std::string value;
+  uint64_t size = 0;
+  if (!configuration.get(key, value)) {
+    return;
+  }
+  if (core::DataSizeValue::StringToInt(value, size) && size > 0) {
+    target = gsl::narrow<T>(size);
+  } else {
+    logger.log_error("Invalid value for %s: %s", key, value);
+  }
+}
+
+// counts are plain positive integers, a data size like "4 KB" is rejected
+void setFromCount(const minifi::Configure& configuration, const char* key, int& target, logging::Logger& logger) {
+  std::string value;
+  if (!configuration.get(key, value)) {
+    return;
+  }
+  const std::string trimmed = utils::StringUtils::trim(value);
+  try {
+    size_t pos = 0;
+    const long long count = std::stoll(trimmed, &pos);  // NOLINT
+    if (pos == trimmed.size() && count > 0 && count <= (std::numeric_limits<int>::max)()) {
+      target = static_cast<int>(count);
+      return;
+    }
+  } catch (const std::exception&) {
+  }
+  logger.log_error("Invalid value for %s: %s", key, value);
+}
+
+// the writes of a resource being published are written to the database whenever they reach this size
+constexpr size_t MAX_PUBLISH_BATCH_SIZE = 4 * 1024 * 1024;
+
+bool isEnabled(const minifi::Configure& configuration, const char* key) {
+  std::string value;
+  return configuration.get(key, value) && utils::StringUtils::toBool(value).value_or(false);
+}
+
+}  // namespace
+
+std::vector<state::response::SerializedResponseNode> DatabaseContentRepositoryMetrics::serialize() {
+  std::vector<state::response::SerializedResponseNode> resp;
+  const uint64_t user_bytes = statistics_->getTickerCount(rocksdb::BYTES_WRITTEN);
+  const uint64_t flush_bytes = statistics_->getTickerCount(rocksdb::FLUSH_WRITE_BYTES);
+  const uint64_t compaction_bytes = statistics_->getTickerCount(rocksdb::COMPACT_WRITE_BYTES);
+
+  state::response::SerializedResponseNode user_bytes_node;
+  user_bytes_node.name = "UserBytesWritten";
+  user_bytes_node.value = user_bytes;
+  resp.push_back(user_bytes_node);
+
+  state::response::SerializedResponseNode flush_bytes_node;
+  flush_bytes_node.name = "FlushBytesWritten";
+  flush_bytes_node.value = flush_bytes;
+  resp.push_back(flush_bytes_node);
+
+  state::response::SerializedResponseNode compaction_bytes_node;
+  compaction_bytes_node.name = "CompactionBytesWritten";
+  compaction_bytes_node.value = compaction_bytes;
+  resp.push_back(compaction_bytes_node);
+
+  // bytes written to the disk by the database for every byte written by the repository
+  char write_amplification[32];
+  std::snprintf(write_amplification, sizeof(write_amplification), "%.2f",
+      user_bytes > 0 ? static_cast<double>(flush_bytes + compaction_bytes) / static_cast<double>(user_bytes) : 0.0);
+  state::response::SerializedResponseNode write_amplification_node;
+  write_amplification_node.name = "WriteAmplification";
+  write_amplification_node.value = std::string(write_amplification);
+  resp.push_back(write_amplification_node);
+
+  return resp;
+}
+
 bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
   std::string value;
   if (configuration->get(Configure::nifi_dbcontent_repository_directory_default, value)) {
@@ -41,13 +127,36 @@ bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configu
   } else {
     directory_ = configuration->getHome() + "/dbcontentrepository";
   }
+  if (configuration->get(Configure::nifi_dbcontent_repository_chunk_size, value)
+      && (!core::DataSizeValue::StringToInt(value, chunk_size_) || chunk_size_ == 0)) {
+    logger_->log_error("Invalid value for %s: %s", Configure::nifi_dbcontent_repository_chunk_size, value);
+    chunk_size_ = io::RocksDbStream::DEFAULT_CHUNK_SIZE;
+  }
+  if (configuration->get(Configure::nifi_content_repository_streaming_session, value)) {
+    utils::StringUtils::StringToBool(value, streaming_session_);
+  }
+  if (streaming_session_) {
+    // staging files are kept out of the database directory
+    staging_directory_ = directory_ + "_staging";
+    utils::file::FileUtils::create_dir(staging_directory_);
+    StreamingContentSession::removeStaleStagingFiles(staging_directory_);
+  }
+  minifi::internal::RocksDbEnvironment::getInstance().configure(*configuration);
   rocksdb::Options options;
   options.create_if_missing = true;
   options.use_direct_io_for_flush_and_compaction = true;
   options.use_direct_reads = true;
+  // content is no longer appended with merges, the operator is kept to read the merge operands written by earlier versions
   options.merge_operator = std::make_shared<StringAppender>();
   options.error_if_exists = false;
   options.max_successive_merges = 0;
+  configureDatabase(*configuration, options);
+  minifi::internal::RocksDbEnvironment::getInstance().apply(options);
+  // collecting the statistics costs CPU on every operation of the database, so they are only collected on request
+  if (isEnabled(*configuration, Configure::nifi_dbcontent_repository_statistics_enabled)) {
+    options.statistics = rocksdb::CreateDBStatistics();
+    metrics_ = std::make_shared<DatabaseContentRepositoryMetrics>(options.statistics);
+  }
   db_ = utils::make_unique<minifi::internal::RocksDatabase>(options, directory_);
   if (db_->open()) {
     logger_->log_debug("NiFi Content DB Repository database open %s success", directory_);
@@ -59,6 +168,21 @@ bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configu
   return is_valid_;
 }
 
+void DatabaseContentRepository::configureDatabase(const minifi::Configure& configuration, rocksdb::Options& options) {
+  setFromDataSize(configuration, Configure::nifi_dbcontent_repository_write_buffer_size, options.write_buffer_size, *logger_);
+  setFromCount(configuration, Configure::nifi_dbcontent_repository_max_write_buffer_number, options.max_write_buffer_number, *logger_);
+  setFromDataSize(configuration, Configure::nifi_dbcontent_repository_target_file_size_base, options.target_file_size_base, *logger_);
+  setFromDataSize(configuration, Configure::nifi_dbcontent_repository_max_bytes_for_level_base, options.max_bytes_for_level_base, *logger_);
+  setFromCount(configuration, Configure::nifi_dbcontent_repository_max_background_jobs, options.max_background_jobs, *logger_);
+}
+
+int16_t DatabaseContentRepository::getMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> &metric_vector) {
+  if (metrics_) {
+    metric_vector.push_back(metrics_);
+  }
+  return 0;
+}
+
 void DatabaseContentRepository::stop() {
   if (db_) {
     auto opendb = db_->open();
@@ -72,9 +196,75 @@ void DatabaseContentRepository::stop() {
 DatabaseContentRepository::Session::Session(std::shared_ptr<ContentRepository> repository) : ContentSession(std::move(repository)) {}
 
 std::shared_ptr<ContentSession> DatabaseContentRepository::createSession() {
+  if (streaming_session_) {
+    return std::make_shared<StreamingSession>(sharedFromThis(), staging_directory_);
+  }
   return std::make_shared<Session>(sharedFromThis());
 }
 
+DatabaseContentRepository::StreamingSession::StreamingSession(std::shared_ptr<ContentRepository> repository, std::string staging_directory)
+    : StreamingContentSession(std::move(repository), std::move(staging_directory)) {}
+
+void DatabaseContentRepository::StreamingSession::commit() {
+  auto dbContentRepository = std::static_pointer_cast<DatabaseContentRepository>(repository_);
+  auto opendb = dbContentRepository->db_->open();
+  if (!opendb) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open rocksdb database to commit content changes");
+  }
+  // the resources are published in unsynced batches of bounded size, so the staged content is never held in memory as a whole
+  StreamingContentSession::commit();
+  rocksdb::Status status = opendb->FlushWAL(true);
+  if (!status.ok()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to sync content changes: " + status.ToString());
+  }
+}
+
+void DatabaseContentRepository::StreamingSession::publish(const minifi::ResourceClaim& claim, const std::string& staging_path, bool append) {
+  auto dbContentRepository = std::static_pointer_cast<DatabaseContentRepository>(repository_);
+  auto opendb = dbContentRepository->db_->open();
+  if (!opendb) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open rocksdb database to publish " + claim.getContentFullPath());
+  }
+  rocksdb::WriteBatch batch;
+  const auto write_batch = [&]() {
+    rocksdb::Status status = opendb->Write(rocksdb::WriteOptions(), &batch);
+    if (!status.ok()) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to write resource " + claim.getContentFullPath() + ": " + status.ToString());
+    }
+    batch.Clear();
+  };
+  {
+    // only the resources created by the session are published without appending
+    auto output = dbContentRepository->write(claim, append, &batch, !append);
+    if (output == nullptr) {
+      throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + claim.getContentFullPath());
+    }
+    copyStagingFile(claim, staging_path, *output, [&]() {
+      if (batch.GetDataSize() >= MAX_PUBLISH_BATCH_SIZE) {
+        write_batch();
+      }
+    });
+  }
+  write_batch();
+}
+
+bool DatabaseContentRepository::StreamingSession::revertAppend(const minifi::ResourceClaim& claim, uint64_t original_size) {
+  auto dbContentRepository = std::static_pointer_cast<DatabaseContentRepository>(repository_);
+  auto opendb = dbContentRepository->db_->open();
+  if (!opendb) {
+    return false;
+  }
+  rocksdb::WriteBatch batch;
+  if (original_size == 0) {
+    io::RocksDbStream::remove(batch, claim.getContentFullPath());
+  } else if (!io::RocksDbStream::truncate(*opendb, batch, claim.getContentFullPath(), original_size)) {
+    return false;
+  }
+  rocksdb::WriteOptions options;
+  options.sync = true;
+  return opendb->Write(options, &batch).ok();
+}
+
 void DatabaseContentRepository::Session::commit() {
   auto dbContentRepository = std::static_pointer_cast<DatabaseContentRepository>(repository_);
   auto opendb = dbContentRepository->db_->open();
@@ -83,7 +273,8 @@ void DatabaseContentRepository::Session::commit() {
   }
   rocksdb::WriteBatch batch;
   for (const auto& resource : managedResources_) {
-    auto outStream = dbContentRepository->write(*resource.first, false, &batch);
+    // the managed resources are created by the session, so they have no previous content
+    auto outStream = dbContentRepository->write(*resource.first, false, &batch, true);
     if (outStream == nullptr) {
       throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + resource.first->getContentFullPath());
     }
@@ -131,10 +322,7 @@ bool DatabaseContentRepository::exists(const minifi::ResourceClaim &streamId) {
   if (!opendb) {
     return false;
   }
-  std::string value;
-  rocksdb::Status status;
-  status = opendb->Get(rocksdb::ReadOptions(), streamId.getContentFullPath(), &value);
-  if (status.ok()) {
+  if (io::RocksDbStream::exists(*opendb, streamId.getContentFullPath())) {
     logger_->log_debug("%s exists", streamId.getContentFullPath());
     return true;
   } else {
@@ -150,8 +338,9 @@ bool DatabaseContentRepository::remove(const minifi::ResourceClaim &claim) {
   if (!opendb) {
     return false;
   }
-  rocksdb::Status status;
-  status = opendb->Delete(rocksdb::WriteOptions(), claim.getContentFullPath());
+  rocksdb::WriteBatch batch;
+  io::RocksDbStream::remove(batch, claim.getContentFullPath());
+  rocksdb::Status status = opendb->Write(rocksdb::WriteOptions(), &batch);
   if (status.ok()) {
     logger_->log_debug("Deleting resource %s", claim.getContentFullPath());
     return true;
@@ -161,13 +350,13 @@ bool DatabaseContentRepository::remove(const minifi::ResourceClaim &claim) {
   }
 }
 
-std::shared_ptr<io::BaseStream> DatabaseContentRepository::write(const minifi::ResourceClaim& claim, bool /*append*/, rocksdb::WriteBatch* batch) {
+std::shared_ptr<io::BaseStream> DatabaseContentRepository::write(const minifi::ResourceClaim& claim, bool append, rocksdb::WriteBatch* batch, bool new_claim) {
   // the traditional approach with these has been to return -1 from the stream; however, since we have the ability here
   // we can simply return a nullptr, which is also valid from the API when this stream is not valid.
   if (!is_valid_ || !db_)
     return nullptr;
-  // append is already supported in all modes
-  return std::make_shared<io::RocksDbStream>(claim.getContentFullPath(), gsl::make_not_null<minifi::internal::RocksDatabase*>(db_.get()), true, batch);
+  return std::make_shared<io::RocksDbStream>(claim.getContentFullPath(), gsl::make_not_null<minifi::internal::RocksDatabase*>(db_.get()), true, batch, append, chunk_size_,
+      new_claim);
 }
 
 } /* namespace repository */
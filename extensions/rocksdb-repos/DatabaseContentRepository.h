@@ -18,15 +18,24 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_DatabaseContentRepository_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_DatabaseContentRepository_H_
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/statistics.h"
 #include "core/Core.h"
 #include "core/Connectable.h"
 #include "core/ContentRepository.h"
 #include "properties/Configure.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "RocksDatabase.h"
+#include "RocksDbStream.h"
 #include "core/ContentSession.h"
+#include "core/StreamingContentSession.h"
+#include "core/state/nodes/MetricsBase.h"
 
 namespace org {
 namespace apache {
@@ -67,21 +76,56 @@ class StringAppender : public rocksdb::AssociativeMergeOperator {
 
 };
 
+/**
+ * Write statistics of the content database, the write amplification is the number of bytes flushed and compacted
+ * for every byte written by the repository.
+ */
+class DatabaseContentRepositoryMetrics : public state::response::ResponseNode {
+ public:
+  explicit DatabaseContentRepositoryMetrics(std::shared_ptr<rocksdb::Statistics> statistics)
+      : state::response::ResponseNode("DatabaseContentRepositoryMetrics"),
+        statistics_(std::move(statistics)) {
+  }
+
+  std::string getName() const override {
+    return "DatabaseContentRepositoryMetrics";
+  }
+
+  std::vector<state::response::SerializedResponseNode> serialize() override;
+
+ private:
+  std::shared_ptr<rocksdb::Statistics> statistics_;
+};
+
 /**
  * DatabaseContentRepository is a content repository that stores data onto the local file system.
  */
-class DatabaseContentRepository : public core::ContentRepository, public core::Connectable {
+class DatabaseContentRepository : public core::ContentRepository, public core::Connectable, public state::response::MetricsNodeSource {
   class Session : public ContentSession {
    public:
     explicit Session(std::shared_ptr<ContentRepository> repository);
 
     void commit() override;
   };
+
+  class StreamingSession : public StreamingContentSession {
+   public:
+    StreamingSession(std::shared_ptr<ContentRepository> repository, std::string staging_directory);
+
+    void commit() override;
+
+   protected:
+    void publish(const minifi::ResourceClaim& claim, const std::string& staging_path, bool append) override;
+
+    bool revertAppend(const minifi::ResourceClaim& claim, uint64_t original_size) override;
+  };
  public:
 
   DatabaseContentRepository(std::string name = getClassName<DatabaseContentRepository>(), utils::Identifier uuid = utils::Identifier())
       : core::Connectable(name, uuid),
         is_valid_(false),
+        streaming_session_(false),
+        chunk_size_(io::RocksDbStream::DEFAULT_CHUNK_SIZE),
         db_(nullptr),
         logger_(logging::LoggerFactory<DatabaseContentRepository>::getLogger()) {
   }
@@ -126,11 +170,21 @@ class DatabaseContentRepository : public core::ContentRepository, public core::C
     return true;
   }
 
+  int16_t getMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> &metric_vector) override;
+
  private:
-  std::shared_ptr<io::BaseStream> write(const minifi::ResourceClaim &claim, bool append, rocksdb::WriteBatch* batch);
+  // new claims have no previous content to remove, so writing them only adds keys to the batch
+  std::shared_ptr<io::BaseStream> write(const minifi::ResourceClaim &claim, bool append, rocksdb::WriteBatch* batch, bool new_claim = false);
+
+  // applies the write buffer and compaction settings of the configuration
+  void configureDatabase(const minifi::Configure& configuration, rocksdb::Options& options);
 
   bool is_valid_;
+  bool streaming_session_;
+  size_t chunk_size_;
+  std::string staging_directory_;
   std::unique_ptr<minifi::internal::RocksDatabase> db_;
+  std::shared_ptr<DatabaseContentRepositoryMetrics> metrics_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -17,12 +17,13 @@
  */
 #include "FlowFileRepository.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
-#include <list>
 
 #include "rocksdb/options.h"
 #include "rocksdb/write_batch.h"
@@ -37,63 +38,153 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+std::vector<state::response::SerializedResponseNode> FlowFileRepositoryMetrics::serialize() {
+  std::vector<state::response::SerializedResponseNode> serialized;
+
+  state::response::SerializedResponseNode recovering;
+  recovering.name = "recovering";
+  recovering.value = recovering_.load();
+  serialized.push_back(recovering);
+
+  state::response::SerializedResponseNode threads;
+  threads.name = "recoveryThreads";
+  threads.value = recovery_threads_.load();
+  serialized.push_back(threads);
+
+  state::response::SerializedResponseNode recovered;
+  recovered.name = "recoveredFlowFiles";
+  recovered.value = recovered_.load();
+  serialized.push_back(recovered);
+
+  state::response::SerializedResponseNode discarded;
+  discarded.name = "discardedFlowFiles";
+  discarded.value = discarded_.load();
+  serialized.push_back(discarded);
+
+  state::response::SerializedResponseNode duration;
+  duration.name = "recoveryDurationMillis";
+  duration.value = recovery_duration_ms_.load();
+  serialized.push_back(duration);
+
+  return serialized;
+}
+
 void FlowFileRepository::flush() {
   auto opendb = db_->open();
   if (!opendb) {
     return;
   }
   rocksdb::WriteBatch batch;
-  rocksdb::ReadOptions options;
 
-  std::vector<std::shared_ptr<FlowFile>> purgeList;
+  std::vector<ExpiredFlowFile> purgeList;
+  ExpiredFlowFile expired;
+  while (keys_to_delete.try_dequeue(expired)) {
+    purgeList.push_back(std::move(expired));
+  }
+  if (purgeList.empty()) {
+    return;
+  }
 
+  // the claims are usually carried along with the keys, only the records deleted without one are read
   std::vector<rocksdb::Slice> keys;
-  std::list<std::string> keystrings;
-  std::vector<std::string> values;
-
-  while (keys_to_delete.size_approx() > 0) {
-    std::string key;
-    if (keys_to_delete.try_dequeue(key)) {
-      keystrings.push_back(std::move(key));  // rocksdb::Slice doesn't copy the string, only grabs ptrs. Hacky, but have to ensure the required lifetime of the strings.
-      keys.push_back(keystrings.back());
+  std::vector<size_t> unknown_claims;
+  for (size_t i = 0; i < purgeList.size(); ++i) {
+    if (!purgeList[i].claim) {
+      keys.emplace_back(purgeList[i].key);
+      unknown_claims.push_back(i);
     }
   }
-
-  auto multistatus = opendb->MultiGet(options, keys, &values);
-
-  for(size_t i=0; i<keys.size() && i<values.size() && i<multistatus.size(); ++i) {
-    if(!multistatus[i].ok()) {
-      logger_->log_error("Failed to read key from rocksdb: %s! DB is most probably in an inconsistent state!", keys[i].data());
-      keystrings.remove(keys[i].data());
-      continue;
+  if (!keys.empty()) {
+    std::vector<std::string> values;
+    auto multistatus = opendb->MultiGet(rocksdb::ReadOptions(), keys, &values);
+    for (size_t i = 0; i < unknown_claims.size() && i < values.size() && i < multistatus.size(); ++i) {
+      auto& item = purgeList[unknown_claims[i]];
+      if (!multistatus[i].ok()) {
+        logger_->log_error("Failed to read key from rocksdb: %s! DB is most probably in an inconsistent state!", item.key);
+        item.claim = std::shared_ptr<ResourceClaim>();
+        continue;
+      }
+      utils::Identifier containerId;
+      auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(values[i].data()), gsl::narrow<int>(values[i].size()), content_repo_, containerId);
+      item.claim = eventRead ? eventRead->getResourceClaim() : nullptr;
     }
+  }
 
-    utils::Identifier containerId;
-    auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(values[i].data()), gsl::narrow<int>(values[i].size()), content_repo_, containerId);
-    if (eventRead) {
-      purgeList.push_back(eventRead);
-    }
-    logger_->log_debug("Issuing batch delete, including %s, Content path %s", eventRead->getUUIDStr(), eventRead->getContentFullPath());
-    batch.Delete(keys[i]);
+  for (const auto& item : purgeList) {
+    logger_->log_debug("Issuing batch delete, including %s", item.key);
+    batch.Delete(item.key);
   }
 
   auto operation = [&batch, &opendb]() { return opendb->Write(rocksdb::WriteOptions(), &batch); };
 
   if (!ExecuteWithRetry(operation)) {
-    for (const auto& key: keystrings) {
-      keys_to_delete.enqueue(key);  // Push back the values that we could get but couldn't delete
+    for (auto& item : purgeList) {
+      keys_to_delete.enqueue(std::move(item));  // Push back the values that we couldn't delete
     }
     return;  // Stop here - don't delete from content repo while we have records in FF repo
   }
 
   if (content_repo_) {
-    for (const auto &ffr : purgeList) {
-      auto claim = ffr->getResourceClaim();
-      if (claim) claim->decreaseFlowFileRecordOwnedCount();
+    for (const auto &item : purgeList) {
+      if (item.claim && *item.claim) (*item.claim)->decreaseFlowFileRecordOwnedCount();
     }
   }
 }
 
+bool FlowFileRepository::MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) {
+  PendingWrite write(data);
+  std::unique_lock<std::mutex> lock(group_commit_mutex_);
+  pending_writes_.push_back(&write);
+  // a leader waiting for its group to fill up is interested in every new arrival
+  group_commit_condition_.notify_all();
+  group_commit_condition_.wait(lock, [&] { return write.done || pending_writes_.front() == &write; });
+  if (write.done) {
+    return write.success;
+  }
+
+  // we are the leader of the next group commit
+  if (group_commit_window_.count() > 0) {
+    group_commit_condition_.wait_for(lock, group_commit_window_, [this] { return pending_writes_.size() >= static_cast<size_t>(FLOWFILE_REPOSITORY_MAX_GROUP_COMMIT_SIZE); });
+  }
+  const size_t group_size = (std::min)(pending_writes_.size(), static_cast<size_t>(FLOWFILE_REPOSITORY_MAX_GROUP_COMMIT_SIZE));
+  const std::vector<PendingWrite*> group(pending_writes_.begin(), pending_writes_.begin() + group_size);
+  lock.unlock();
+
+  // later arrivals queue up behind the group and are written by the next leader
+  const bool success = writeGroup(group);
+
+  lock.lock();
+  for (PendingWrite* member : group) {
+    member->success = success;
+    member->done = true;
+  }
+  pending_writes_.erase(pending_writes_.begin(), pending_writes_.begin() + group_size);
+  group_commit_condition_.notify_all();
+  return success;
+}
+
+bool FlowFileRepository::writeGroup(const std::vector<PendingWrite*>& group) {
+  auto opendb = db_->open();
+  if (!opendb) {
+    return false;
+  }
+  rocksdb::WriteBatch batch;
+  for (const PendingWrite* member : group) {
+    for (const auto& item : member->data) {
+      rocksdb::Slice value(reinterpret_cast<const char*>(item.second->getBuffer()), item.second->size());
+      if (!batch.Put(item.first, value).ok()) {
+        logger_->log_error("Failed to add item to batch operation");
+        return false;
+      }
+    }
+  }
+  logger_->log_trace("Writing group commit of %zu sessions, %zu bytes", group.size(), batch.GetDataSize());
+  rocksdb::WriteOptions options;
+  options.sync = group_commit_sync_;
+  auto operation = [&batch, &opendb, &options]() { return opendb->Write(options, &batch); };
+  return ExecuteWithRetry(operation);
+}
+
 void FlowFileRepository::printStats() {
   auto opendb = db_->open();
   if (!opendb) {
@@ -130,28 +221,113 @@ void FlowFileRepository::run() {
 }
 
 void FlowFileRepository::prune_stored_flowfiles() {
-  rocksdb::Options options;
-  options.create_if_missing = true;
-  options.use_direct_io_for_flush_and_compaction = true;
-  options.use_direct_reads = true;
-  minifi::internal::RocksDatabase checkpointDB(options, checkpoint_dir_, minifi::internal::RocksDatabase::Mode::ReadOnly);
-  utils::optional<minifi::internal::OpenRocksDB> opendb;
-  if (nullptr != checkpoint_) {
-    opendb = checkpointDB.open();
-    if (!opendb) {
-      opendb = db_->open();
-    }
-    if (!opendb) {
-      logger_->log_trace("Could not open neither the checkpoint nor the live database.");
-      return;
+  if (!recovery_db_) {
+    logger_->log_trace("There is no snapshot to recover FlowFiles from.");
+    if (content_repo_) {
+      content_repo_->clearOrphans();
     }
-  } else {
-    logger_->log_trace("Could not open checkpoint as object doesn't exist. Likely not needed or file system error.");
     return;
   }
+  const auto recovery_start = std::chrono::steady_clock::now();
+  rocksdb::ReadOptions options;
+  options.snapshot = recovery_snapshot_;
+  const auto ranges = getRecoveryRanges(options);
+  metrics_->recoveryStarted(ranges.size());
+  logger_->log_info("Recovering FlowFiles on %zu threads", ranges.size());
 
-  auto it = opendb->NewIterator(rocksdb::ReadOptions());
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    utils::optional<std::string> upper_bound;
+    if (i + 1 < ranges.size()) {
+      upper_bound = ranges[i + 1];
+    }
+    workers.emplace_back(&FlowFileRepository::recoverRange, this, ranges[i], upper_bound);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  releaseRecoverySnapshot();
+  // every claim still in use has been referenced by a restored FlowFile, unless the recovery was interrupted
+  if (running_ && content_repo_) {
+    content_repo_->clearOrphans();
+  }
+
+  const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - recovery_start);
+  metrics_->recoveryFinished(duration);
+  logger_->log_info("Recovered FlowFiles in %" PRId64 " ms", static_cast<int64_t>(duration.count()));
+}
+
+std::vector<std::string> FlowFileRepository::getRecoveryRanges(const rocksdb::ReadOptions& options) {
+  if (recovery_threads_ <= 1) {
+    return {std::string()};
+  }
+  auto it = recovery_db_->NewIterator(options);
+  // adds the distinct one byte longer prefixes of the keys starting with prefix, found by seeking past each of them
+  const auto extend = [&it](const std::string& prefix, std::vector<std::string>& extended) {
+    it->Seek(prefix);
+    while (it->Valid() && it->key().starts_with(prefix)) {
+      if (it->key().size() == prefix.size()) {
+        // the key is the prefix itself, it cannot be extended
+        extended.push_back(prefix);
+        it->Next();
+        continue;
+      }
+      const auto next_byte = static_cast<unsigned char>(it->key()[prefix.size()]);
+      extended.push_back(prefix + static_cast<char>(next_byte));
+      if (next_byte == 0xFF) {
+        break;
+      }
+      it->Seek(prefix + static_cast<char>(next_byte + 1));
+    }
+  };
+
+  // the prefixes are extended byte by byte until there are enough of them to split the keys evenly, so keys sharing
+  // their leading bytes, e.g. time based UUIDs, are split on the bytes that differ
+  const size_t target_prefix_count = recovery_threads_ * FLOWFILE_REPOSITORY_RECOVERY_PREFIXES_PER_THREAD;
+  std::vector<std::string> prefixes{std::string()};
+  for (size_t length = 1; prefixes.size() < target_prefix_count; ++length) {
+    std::vector<std::string> extended;
+    bool any_extended = false;
+    for (const auto& prefix : prefixes) {
+      if (prefix.size() + 1 < length) {
+        extended.push_back(prefix);
+      } else {
+        extend(prefix, extended);
+        any_extended = true;
+      }
+    }
+    prefixes = std::move(extended);
+    if (!any_extended || prefixes.empty()) {
+      break;
+    }
+  }
+  if (prefixes.empty()) {
+    return {};
+  }
+
+  std::vector<std::string> ranges;
+  const size_t range_count = (std::min)(recovery_threads_, prefixes.size());
+  for (size_t i = 0; i < range_count; ++i) {
+    // the first range also covers the keys before the first prefix
+    ranges.push_back(i == 0 ? std::string() : prefixes[i * prefixes.size() / range_count]);
+  }
+  return ranges;
+}
+
+void FlowFileRepository::recoverRange(const std::string& lower_bound, const utils::optional<std::string>& upper_bound) {
+  rocksdb::ReadOptions options;
+  options.snapshot = recovery_snapshot_;
+  rocksdb::Slice upper_bound_slice;
+  if (upper_bound) {
+    upper_bound_slice = *upper_bound;
+    options.iterate_upper_bound = &upper_bound_slice;
+  }
+
+  std::unordered_map<std::shared_ptr<core::Connectable>, std::vector<std::shared_ptr<core::FlowFile>>> batches;
+  uint64_t recovered = 0;
+  uint64_t discarded = 0;
+  auto it = recovery_db_->NewIterator(options);
+  for (it->Seek(lower_bound); it->Valid() && running_; it->Next()) {
     utils::Identifier containerId;
     auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), gsl::narrow<int>(it->value().size()), content_repo_, containerId);
     std::string key = it->key().ToString();
@@ -172,16 +348,38 @@ void FlowFileRepository::prune_stored_flowfiles() {
         eventRead->setStoredToRepository(true);
         // we found the connection for the persistent flowFile
         // even if a processor immediately marks it for deletion, flush only happens after prune_stored_flowfiles
-        search->second->restore(eventRead);
+        auto& batch = batches[search->second];
+        batch.push_back(eventRead);
+        if (batch.size() >= FLOWFILE_REPOSITORY_RECOVERY_BATCH_SIZE) {
+          search->second->restoreBatch(batch);
+          batch.clear();
+        }
+        ++recovered;
       } else {
         logger_->log_warn("Could not find connection for %s, path %s ", containerId.to_string(), eventRead->getContentFullPath());
-        keys_to_delete.enqueue(key);
+        keys_to_delete.enqueue(ExpiredFlowFile{key, claim});
+        ++discarded;
       }
     } else {
       // failed to deserialize FlowFile, cannot clear claim
-      keys_to_delete.enqueue(key);
+      keys_to_delete.enqueue(ExpiredFlowFile{key, std::shared_ptr<ResourceClaim>()});
+      ++discarded;
     }
   }
+  for (const auto& batch : batches) {
+    if (!batch.second.empty()) {
+      batch.first->restoreBatch(batch.second);
+    }
+  }
+  metrics_->addRecovered(recovered, discarded);
+}
+
+void FlowFileRepository::releaseRecoverySnapshot() {
+  if (recovery_db_ && recovery_snapshot_) {
+    recovery_db_->ReleaseSnapshot(recovery_snapshot_);
+  }
+  recovery_snapshot_ = nullptr;
+  recovery_db_ = utils::nullopt;
 }
 
 bool FlowFileRepository::ExecuteWithRetry(std::function<rocksdb::Status()> operation) {
@@ -203,33 +401,29 @@ bool FlowFileRepository::ExecuteWithRetry(std::function<rocksdb::Status()> opera
  * Returns True if there is data to interrogate.
  * @return true if our db has data stored.
  */
-bool FlowFileRepository::need_checkpoint(minifi::internal::OpenRocksDB& opendb){
+bool FlowFileRepository::need_recovery(minifi::internal::OpenRocksDB& opendb) {
   auto it = opendb.NewIterator(rocksdb::ReadOptions());
   it->SeekToFirst();
   return it->Valid();
 }
+
 void FlowFileRepository::initialize_repository() {
+  releaseRecoverySnapshot();
+  // recovery used to read from a checkpoint copy of the database, which is no longer needed
+  utils::file::FileUtils::delete_dir(checkpoint_dir_);
   auto opendb = db_->open();
   if (!opendb) {
-    logger_->log_trace("Couldn't open database, no way to checkpoint");
+    logger_->log_trace("Couldn't open database, no way to recover FlowFiles");
     return;
   }
-  // first we need to establish a checkpoint iff it is needed.
-  if (!need_checkpoint(*opendb)){
-    logger_->log_trace("Do not need checkpoint");
+  if (!need_recovery(*opendb)) {
+    logger_->log_trace("Do not need recovery");
     return;
   }
-  rocksdb::Checkpoint *checkpoint;
-  // delete any previous copy
-  if (utils::file::FileUtils::delete_dir(checkpoint_dir_) >= 0 && opendb->NewCheckpoint(&checkpoint).ok()) {
-    if (checkpoint->CreateCheckpoint(checkpoint_dir_).ok()) {
-      checkpoint_ = std::unique_ptr<rocksdb::Checkpoint>(checkpoint);
-      logger_->log_trace("Created checkpoint directory");
-    } else {
-      logger_->log_trace("Could not create checkpoint. Corrupt?");
-    }
-  } else
-    logger_->log_trace("Could not create checkpoint directory. Not properly deleted?");
+  // the FlowFiles persisted from now on are not to be recovered, as they are already in their connections
+  recovery_snapshot_ = opendb->GetSnapshot();
+  recovery_db_ = std::move(opendb);
+  logger_->log_trace("Created recovery snapshot");
 }
 
 void FlowFileRepository::loadComponent(const std::shared_ptr<core::ContentRepository> &content_repo) {
@@ -239,6 +433,17 @@ void FlowFileRepository::loadComponent(const std::shared_ptr<core::ContentReposi
   initialize_repository();
 }
 
+utils::optional<uint64_t> FlowFileRepository::getMemoryUsage() {
+  if (!db_) {
+    return utils::nullopt;
+  }
+  auto opendb = db_->open();
+  if (!opendb) {
+    return utils::nullopt;
+  }
+  return minifi::internal::RocksDbEnvironment::getMemoryUsage(*opendb->get());
+}
+
 } /* namespace repository */
 } /* namespace core */
 } /* namespace minifi */
@@ -18,17 +18,35 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "utils/file/FileUtils.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
-#include "rocksdb/utilities/checkpoint.h"
 #include "core/Repository.h"
 #include "core/Core.h"
+#include "core/TypedValues.h"
+#include "core/state/nodes/MetricsBase.h"
 #include "Connection.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "concurrentqueue.h"
 #include "RocksDatabase.h"
+#include "RocksDbEnvironment.h"
+#include "utils/gsl.h"
+#include "utils/OptionalUtils.h"
+#include "utils/StringUtils.h"
 
 namespace org {
 namespace apache {
@@ -48,12 +66,56 @@ namespace repository {
 #define MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME (600000)  // 10 minute
 #define FLOWFILE_REPOSITORY_PURGE_PERIOD (2000)  // 2000 msec
 #define FLOWFILE_REPOSITORY_RETRY_INTERVAL_INCREMENTS (500)  // msec
+#define FLOWFILE_REPOSITORY_MAX_GROUP_COMMIT_SIZE (1000)  // number of MultiPut calls written together
+#define FLOWFILE_REPOSITORY_MAX_DEFAULT_RECOVERY_THREADS (4)
+#define FLOWFILE_REPOSITORY_RECOVERY_BATCH_SIZE (10000)  // number of FlowFiles restored into a connection at once
+#define FLOWFILE_REPOSITORY_RECOVERY_PREFIXES_PER_THREAD (4)  // distinct key prefixes looked for per recovery thread
+
+/**
+ * Startup recovery of the FlowFiles persisted before the agent was (re)started.
+ */
+class FlowFileRepositoryMetrics : public state::response::ResponseNode {
+ public:
+  FlowFileRepositoryMetrics()
+      : state::response::ResponseNode("FlowFileRepositoryMetrics") {
+  }
+
+  std::string getName() const override {
+    return "FlowFileRepositoryMetrics";
+  }
+
+  void recoveryStarted(size_t threads) {
+    recovering_ = true;
+    recovery_threads_ = threads;
+  }
+
+  void addRecovered(uint64_t recovered, uint64_t discarded) {
+    recovered_ += recovered;
+    discarded_ += discarded;
+  }
+
+  void recoveryFinished(std::chrono::milliseconds duration) {
+    recovery_duration_ms_ = duration.count();
+    recovering_ = false;
+  }
+
+  std::vector<state::response::SerializedResponseNode> serialize() override;
+
+ private:
+  std::atomic<bool> recovering_{false};
+  std::atomic<uint64_t> recovery_threads_{0};
+  // restored into their connections
+  std::atomic<uint64_t> recovered_{0};
+  // without a connection in the current flow, or unreadable
+  std::atomic<uint64_t> discarded_{0};
+  std::atomic<uint64_t> recovery_duration_ms_{0};
+};
 
 /**
  * Flow File repository
  * Design: Extends Repository and implements the run function, using rocksdb as the primary substrate.
  */
-class FlowFileRepository : public core::Repository, public std::enable_shared_from_this<FlowFileRepository> {
+class FlowFileRepository : public core::Repository, public state::response::MetricsNodeSource, public std::enable_shared_from_this<FlowFileRepository> {
  public:
   // Constructor
 
@@ -67,11 +129,18 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<FlowFileRepository>(), directory, maxPartitionMillis, maxPartitionBytes, purgePeriod),
         checkpoint_dir_(checkpoint_dir),
         content_repo_(nullptr),
-        checkpoint_(nullptr),
+        recovery_threads_((std::max)(1u, (std::min)(std::thread::hardware_concurrency(), static_cast<unsigned>(FLOWFILE_REPOSITORY_MAX_DEFAULT_RECOVERY_THREADS)))),
+        metrics_(std::make_shared<FlowFileRepositoryMetrics>()),
         logger_(logging::LoggerFactory<FlowFileRepository>::getLogger()) {
     db_ = NULL;
   }
 
+  ~FlowFileRepository() override {
+    // the monitor thread may still be recovering from the snapshot
+    stop();
+    releaseRecoverySnapshot();
+  }
+
   virtual bool isNoop() {
     return false;
   }
@@ -98,6 +167,28 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
       }
     }
     logger_->log_debug("NiFi FlowFile Max Storage Time: [%d] ms", max_partition_millis_);
+    if (configure->get(Configure::nifi_flowfile_repository_group_commit_window, value)) {
+      if (auto window = TimePeriodValue::fromString(value)) {
+        group_commit_window_ = std::chrono::milliseconds(window->getMilliseconds());
+      } else {
+        logger_->log_error("Invalid value for %s: %s", Configure::nifi_flowfile_repository_group_commit_window, value);
+      }
+    }
+    logger_->log_debug("NiFi FlowFile Group Commit Window: [%" PRId64 "] ms", static_cast<int64_t>(group_commit_window_.count()));
+    if (configure->get(Configure::nifi_flowfile_repository_group_commit_sync, value)) {
+      group_commit_sync_ = utils::StringUtils::toBool(value).value_or(false);
+    }
+    logger_->log_debug("NiFi FlowFile Group Commit Sync: [%s]", group_commit_sync_ ? "true" : "false");
+    if (configure->get(Configure::nifi_flowfile_repository_recovery_threads, value)) {
+      int64_t threads = 0;
+      if (Property::StringToInt(value, threads) && threads > 0) {
+        recovery_threads_ = gsl::narrow<size_t>(threads);
+      } else {
+        logger_->log_error("Invalid value for %s: %s", Configure::nifi_flowfile_repository_recovery_threads, value);
+      }
+    }
+    logger_->log_debug("NiFi FlowFile Recovery Threads: [%zu]", recovery_threads_);
+    minifi::internal::RocksDbEnvironment::getInstance().configure(*configure);
     rocksdb::Options options;
     options.create_if_missing = true;
     options.use_direct_io_for_flush_and_compaction = true;
@@ -112,6 +203,8 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     options.write_buffer_size = 8 << 20;
     options.max_write_buffer_number = 20;
     options.min_write_buffer_number_to_merge = 1;
+    // with a shared memory limit the write buffers of every database are flushed once they reach it together
+    minifi::internal::RocksDbEnvironment::getInstance().apply(options);
     db_ = utils::make_unique<minifi::internal::RocksDatabase>(options, directory_);
     if (db_->open()) {
       logger_->log_debug("NiFi FlowFile Repository database open %s success", directory_);
@@ -135,31 +228,31 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     return ExecuteWithRetry(operation);
   }
 
-  virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) {
-    auto opendb = db_->open();
-    if (!opendb) {
-      return false;
-    }
-    rocksdb::WriteBatch batch;
-    for (const auto &item: data) {
-      rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->size());
-      if (!batch.Put(item.first, value).ok()) {
-        logger_->log_error("Failed to add item to batch operation");
-        return false;
-      }
-    }
-    auto operation = [&batch, &opendb]() { return opendb->Write(rocksdb::WriteOptions(), &batch); };
-    return ExecuteWithRetry(operation);
-  }
-
+  /**
+   * Persists the serialized FlowFiles in a single atomic write.
+   * Concurrent calls are coalesced into group commits: the first caller becomes the leader, waits at most
+   * the configured group commit window for other sessions to join, then writes every queued batch in one
+   * WriteBatch and wakes the waiting callers once it has been written.
+   * @return false if the write failed, in which case none of the FlowFiles of the group have been persisted
+   */
+  virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data);
 
   /**
    *
-   * Deletes the key
+   * Deletes the key, the record is read before the deletion to release its claim
    * @return status of the delete operation
    */
   virtual bool Delete(std::string key) {
-    keys_to_delete.enqueue(key);
+    keys_to_delete.enqueue(ExpiredFlowFile{std::move(key), utils::nullopt});
+    return true;
+  }
+
+  /**
+   * Deletes the key without reading the record, the claim is released once the deletion is written
+   * @return status of the delete operation
+   */
+  bool Delete(const std::string& key, const std::shared_ptr<ResourceClaim>& claim) override {
+    keys_to_delete.enqueue(ExpiredFlowFile{key, claim});
     return true;
   }
   /**
@@ -174,8 +267,19 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     return opendb->Get(rocksdb::ReadOptions(), key, &value).ok();
   }
 
+  /**
+   * Takes a snapshot of the persisted FlowFiles, which are restored into their connections by the
+   * monitor thread once the repository is started.
+   */
   virtual void loadComponent(const std::shared_ptr<core::ContentRepository> &content_repo);
 
+  int16_t getMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> &metric_vector) override {
+    metric_vector.push_back(metrics_);
+    return 0;
+  }
+
+  utils::optional<uint64_t> getMemoryUsage() override;
+
   void start() {
     if (this->purge_period_ <= 0) {
       return;
@@ -189,6 +293,31 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   }
 
  private:
+  /**
+   * A FlowFile to delete, with the claim referenced by its record if it is known.
+   */
+  struct ExpiredFlowFile {
+    std::string key;
+    utils::optional<std::shared_ptr<ResourceClaim>> claim;
+  };
+
+  /**
+   * A MultiPut call waiting to be written as part of a group commit.
+   */
+  struct PendingWrite {
+    explicit PendingWrite(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data)
+        : data(data) {
+    }
+
+    const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data;
+    bool done = false;
+    bool success = false;
+  };
+
+  /**
+   * Writes the batches of the group in a single WriteBatch.
+   */
+  bool writeGroup(const std::vector<PendingWrite*>& group);
 
   bool ExecuteWithRetry(std::function<rocksdb::Status()> operation);
 
@@ -198,21 +327,50 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   void initialize_repository();
 
   /**
-   * Returns true if a checkpoint is needed at startup
-   * @return true if a checkpoint is needed.
+   * Returns true if there are FlowFiles to recover at startup
    */
-  bool need_checkpoint(minifi::internal::OpenRocksDB& opendb);
+  bool need_recovery(minifi::internal::OpenRocksDB& opendb);
 
   /**
-   * Prunes stored flow files.
+   * Restores the FlowFiles of the recovery snapshot into their connections, splitting the key space
+   * between the recovery threads, and deletes the ones without a connection.
    */
   void prune_stored_flowfiles();
 
+  /**
+   * Splits the keys of the recovery snapshot into at most recovery_threads_ ranges at distinct key prefixes,
+   * which are made longer until there are a few of them for every thread.
+   * @return the lower bounds of the ranges, each range ends at the lower bound of the next one
+   */
+  std::vector<std::string> getRecoveryRanges(const rocksdb::ReadOptions& options);
+
+  /**
+   * Restores the FlowFiles of the recovery snapshot between the bounds, in batches per connection.
+   */
+  void recoverRange(const std::string& lower_bound, const utils::optional<std::string>& upper_bound);
+
+  void releaseRecoverySnapshot();
+
+  // the data of the legacy startup checkpoint, which is only deleted now
   std::string checkpoint_dir_;
-  moodycamel::ConcurrentQueue<std::string> keys_to_delete;
+  moodycamel::ConcurrentQueue<ExpiredFlowFile> keys_to_delete;
   std::shared_ptr<core::ContentRepository> content_repo_;
   std::unique_ptr<minifi::internal::RocksDatabase> db_;
-  std::unique_ptr<rocksdb::Checkpoint> checkpoint_;
+
+  // the FlowFiles persisted before the start, read without copying them like a checkpoint would
+  utils::optional<minifi::internal::OpenRocksDB> recovery_db_;
+  const rocksdb::Snapshot* recovery_snapshot_ = nullptr;
+  size_t recovery_threads_;
+  std::shared_ptr<FlowFileRepositoryMetrics> metrics_;
+
+  // pending MultiPut calls in arrival order, the first one is the leader of the next group commit
+  std::mutex group_commit_mutex_;
+  std::condition_variable group_commit_condition_;
+  std::deque<PendingWrite*> pending_writes_;
+  std::chrono::milliseconds group_commit_window_{0};
+  // whether every group commit waits for the write ahead log to be synced to the storage device
+  bool group_commit_sync_ = false;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -17,13 +17,181 @@
  */
 
 #include "ProvenanceRepository.h"
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
 namespace provenance {
 
+namespace {
+
+const std::vector<std::string> INDEX_COLUMN_FAMILIES{"flowfile_uuid_index", "component_id_index", "event_type_index", "event_time_index"};
+
+// big endian, so that the index entries are ordered by time
+void appendTime(std::string& key, uint64_t time) {
+  for (int i = 7; i >= 0; --i) {
+    key.push_back(static_cast<char>((time >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t readTime(const rocksdb::Slice& key, size_t position) {
+  uint64_t time = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    time = (time << 8) | static_cast<uint8_t>(key[position + i]);
+  }
+  return time;
+}
+
+// the index entries are <prefix><event time><event id>, where the prefix is the indexed value followed by a separator
+std::string indexPrefix(const std::string& value) {
+  return value + '\0';
+}
+
+std::string indexKey(const std::string& prefix, uint64_t time, const std::string& event_id) {
+  std::string key = prefix;
+  appendTime(key, time);
+  key += event_id;
+  return key;
+}
+
+}  // namespace
+
+bool ProvenanceRepository::openDatabase(const rocksdb::Options& options) {
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  descriptors.emplace_back(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(options));
+  // every index gets a quarter of the storage and write buffers of the events, index entries are much smaller than the events
+  rocksdb::ColumnFamilyOptions index_options(options);
+  index_options.write_buffer_size = (std::max<size_t>)(options.write_buffer_size / 4, 1);
+  index_options.compaction_options_fifo = rocksdb::CompactionOptionsFIFO(max_partition_bytes_ / 4, false);
+  for (const auto& name : INDEX_COLUMN_FAMILIES) {
+    descriptors.emplace_back(name, index_options);
+  }
+  // the indexes are always opened, a database has to be opened with all of its column families
+  rocksdb::DBOptions db_options(options);
+  db_options.create_missing_column_families = true;
+
+  rocksdb::DB* db;
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  rocksdb::Status status = rocksdb::DB::Open(db_options, directory_, descriptors, &handles, &db);
+  if (!status.ok()) {
+    logger_->log_error("MiNiFi Provenance Repository database open %s failed: %s", directory_, status.ToString());
+    return false;
+  }
+  logger_->log_debug("MiNiFi Provenance Repository database open %s success", directory_);
+  column_families_.clear();
+  db_.reset(db);
+  for (auto handle : handles) {
+    column_families_.emplace_back(handle);
+  }
+  return true;
+}
+
+bool ProvenanceRepository::addEvent(rocksdb::WriteBatch& batch, const std::string& key, const uint8_t* buffer, size_t buffer_size, ProvenanceEventRecord* event) {
+  if (!batch.Put(key, rocksdb::Slice(reinterpret_cast<const char*>(buffer), buffer_size)).ok()) {
+    return false;
+  }
+  if (!indexing_enabled_) {
+    return true;
+  }
+  ProvenanceEventRecord parsed_event;
+  if (event == nullptr) {
+    bool deserialized = false;
+    try {
+      deserialized = parsed_event.DeSerialize(buffer, buffer_size);
+    } catch (const std::exception&) {
+    }
+    if (!deserialized) {
+      logger_->log_warn("Could not read provenance event %s, it is not indexed", key);
+      return true;
+    }
+    event = &parsed_event;
+  }
+  const uint64_t time = event->getEventTime();
+  return batch.Put(getIndex(Index::FLOW_FILE_UUID), indexKey(indexPrefix(event->getFlowFileUuid().to_string()), time, key), rocksdb::Slice()).ok()
+      && batch.Put(getIndex(Index::COMPONENT_ID), indexKey(indexPrefix(event->getComponentId()), time, key), rocksdb::Slice()).ok()
+      && batch.Put(getIndex(Index::EVENT_TYPE), indexKey(indexPrefix(ProvenanceEventRecord::ProvenanceEventTypeStr[event->getEventType()]), time, key), rocksdb::Slice()).ok()
+      && batch.Put(getIndex(Index::EVENT_TIME), indexKey("", time, key), rocksdb::Slice()).ok();
+}
+
+std::vector<std::shared_ptr<ProvenanceEventRecord>> ProvenanceRepository::query(const ProvenanceQuery& query) {
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> results;
+  if (query.max_results == 0 || query.start_time > query.end_time) {
+    return results;
+  }
+  if (!indexing_enabled_) {
+    // without indexes every event has to be read, only the most recent max_results of them are kept in a heap,
+    // whose front is the oldest event kept
+    const auto more_recent = [](const std::shared_ptr<ProvenanceEventRecord>& lhs, const std::shared_ptr<ProvenanceEventRecord>& rhs) {
+      return lhs->getEventTime() > rhs->getEventTime();
+    };
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions()));
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+      auto event = std::make_shared<ProvenanceEventRecord>();
+      if (!event->DeSerialize(reinterpret_cast<const uint8_t*>(it->value().data()), it->value().size()) || !query.matches(*event)) {
+        continue;
+      }
+      if (results.size() == query.max_results) {
+        if (!more_recent(event, results.front())) {
+          continue;
+        }
+        std::pop_heap(results.begin(), results.end(), more_recent);
+        results.back() = std::move(event);
+      } else {
+        results.push_back(std::move(event));
+      }
+      std::push_heap(results.begin(), results.end(), more_recent);
+    }
+    std::sort_heap(results.begin(), results.end(), more_recent);
+    return results;
+  }
+
+  // the most selective condition picks the index, the others are checked on the events
+  Index index = Index::EVENT_TIME;
+  std::string prefix;
+  if (query.flow_file_uuid) {
+    index = Index::FLOW_FILE_UUID;
+    prefix = indexPrefix(query.flow_file_uuid->to_string());
+  } else if (query.component_id) {
+    index = Index::COMPONENT_ID;
+    prefix = indexPrefix(*query.component_id);
+  } else if (query.event_type) {
+    index = Index::EVENT_TYPE;
+    prefix = indexPrefix(ProvenanceEventRecord::ProvenanceEventTypeStr[*query.event_type]);
+  }
+
+  // event ids are printable, so every entry of the end time sorts before this key
+  std::string last_key = prefix;
+  appendTime(last_key, query.end_time);
+  last_key.push_back('\xFF');
+
+  std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), getIndex(index)));
+  for (it->SeekForPrev(last_key); it->Valid() && results.size() < query.max_results; it->Prev()) {
+    const rocksdb::Slice key = it->key();
+    if (!key.starts_with(prefix) || key.size() < prefix.size() + 8) {
+      break;
+    }
+    if (readTime(key, prefix.size()) < query.start_time) {
+      break;
+    }
+    const std::string event_id(key.data() + prefix.size() + 8, key.size() - prefix.size() - 8);
+    std::string value;
+    if (!db_->Get(rocksdb::ReadOptions(), event_id, &value).ok()) {
+      // the event has already expired
+      continue;
+    }
+    auto event = std::make_shared<ProvenanceEventRecord>();
+    if (event->DeSerialize(reinterpret_cast<const uint8_t*>(value.data()), value.size()) && query.matches(*event)) {
+      results.push_back(event);
+    }
+  }
+  return results;
+}
+
 void ProvenanceRepository::printStats() {
   std::string key_count;
   db_->GetProperty("rocksdb.estimate-num-keys", &key_count);
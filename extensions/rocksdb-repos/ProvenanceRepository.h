@@ -17,13 +17,21 @@
 #ifndef LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEREPOSITORY_H_
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/write_batch.h"
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "provenance/Provenance.h"
+#include "provenance/ProvenanceQuery.h"
+#include "utils/StringUtils.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "RocksDbEnvironment.h"
 namespace org {
 namespace apache {
 namespace nifi {
@@ -35,7 +43,15 @@ namespace provenance {
 #define MAX_PROVENANCE_ENTRY_LIFE_TIME (60000)  // 1 minute
 #define PROVENANCE_PURGE_PERIOD (2500)  // 2500 msec
 
-class ProvenanceRepository : public core::Repository, public std::enable_shared_from_this<ProvenanceRepository> {
+/**
+ * Provenance repository storing the events in RocksDB keyed by their event id.
+ *
+ * Unless indexing is disabled, every event is also added to the FlowFile UUID, component id, event type and event time
+ * indexes, each kept in a column family of its own, so that queries only read the matching events. The indexes expire
+ * like the events; index entries of expired events are skipped by the queries. Without indexes a query reads every
+ * event, but keeps at most max_results of them in memory.
+ */
+class ProvenanceRepository : public core::Repository, public ProvenanceQueryable, public std::enable_shared_from_this<ProvenanceRepository> {
  public:
   ProvenanceRepository(std::string name, utils::Identifier /*uuid*/)
       : ProvenanceRepository(name){
@@ -50,6 +66,7 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
                        uint64_t purgePeriod = PROVENANCE_PURGE_PERIOD)
       : core::SerializableComponent(repo_name),
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<ProvenanceRepository>(), directory, maxPartitionMillis, maxPartitionBytes, purgePeriod),
+        indexing_enabled_(true),
         logger_(logging::LoggerFactory<ProvenanceRepository>::getLogger()) {
     db_ = NULL;
   }
@@ -85,6 +102,10 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
       }
     }
     logger_->log_debug("MiNiFi Provenance Max Storage Time: [%d] ms", max_partition_millis_);
+    if (config->get(Configure::nifi_provenance_repository_indexing_enabled, value)) {
+      indexing_enabled_ = utils::StringUtils::toBool(value).value_or(true);
+    }
+    minifi::internal::RocksDbEnvironment::getInstance().configure(*config);
     rocksdb::Options options;
     options.create_if_missing = true;
     options.use_direct_io_for_flush_and_compaction = true;
@@ -102,40 +123,46 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
       options.ttl = max_partition_millis_ / 1000;
     }
 
+    minifi::internal::RocksDbEnvironment::getInstance().apply(options);
+
     logger_->log_info("Write buffer: %llu", options.write_buffer_size);
     logger_->log_info("Max partition bytes: %llu", max_partition_bytes_);
     logger_->log_info("Ttl: %llu", options.ttl);
 
-    rocksdb::DB* db;
-    rocksdb::Status status = rocksdb::DB::Open(options, directory_, &db);
-    if (status.ok()) {
-      logger_->log_debug("MiNiFi Provenance Repository database open %s success", directory_);
-      db_.reset(db);
-    } else {
-      logger_->log_error("MiNiFi Provenance Repository database open %s failed: %s", directory_, status.ToString());
-      return false;
-    }
-
-    return true;
+    return openDatabase(options);
   }
   // Put
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
     // persist to the DB
-    rocksdb::Slice value((const char *) buf, bufLen);
-    return db_->Put(rocksdb::WriteOptions(), key, value).ok();
+    rocksdb::WriteBatch batch;
+    if (!addEvent(batch, key, buf, bufLen)) {
+      return false;
+    }
+    return db_->Write(rocksdb::WriteOptions(), &batch).ok();
   }
 
   virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) {
     rocksdb::WriteBatch batch;
     for (const auto &item: data) {
-      rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->size());
-      if (!batch.Put(item.first, value).ok()) {
+      if (!addEvent(batch, item.first, item.second->getBuffer(), item.second->size())) {
         return false;
       }
     }
     return db_->Write(rocksdb::WriteOptions(), &batch).ok();
   }
 
+  bool storeEvents(const std::vector<std::pair<std::shared_ptr<ProvenanceEventRecord>, std::unique_ptr<minifi::io::BufferStream>>>& events) override {
+    rocksdb::WriteBatch batch;
+    for (const auto& item : events) {
+      if (!addEvent(batch, item.first->getUUIDStr(), item.second->getBuffer(), item.second->size(), item.first.get())) {
+        return false;
+      }
+    }
+    return db_->Write(rocksdb::WriteOptions(), &batch).ok();
+  }
+
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> query(const ProvenanceQuery& query) override;
+
   // Delete
   virtual bool Delete(std::string /*key*/) {
     // The repo is cleaned up by itself, there is no need to delete items.
@@ -214,6 +241,7 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
 
   // destroy
   void destroy() {
+    column_families_.clear();
     db_.reset();
   }
   // Run function for the thread
@@ -226,13 +254,38 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     return std::stoull(key_count);
   }
 
+  utils::optional<uint64_t> getMemoryUsage() override {
+    if (!db_) {
+      return utils::nullopt;
+    }
+    return minifi::internal::RocksDbEnvironment::getMemoryUsage(*db_);
+  }
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   ProvenanceRepository(const ProvenanceRepository &parent) = delete;
   ProvenanceRepository &operator=(const ProvenanceRepository &parent) = delete;
 
  private:
+  // column families of the indexes, in the order of column_families_ after the default column family
+  enum class Index {
+    FLOW_FILE_UUID = 1,
+    COMPONENT_ID,
+    EVENT_TYPE,
+    EVENT_TIME
+  };
+
+  bool openDatabase(const rocksdb::Options& options);
+  // adds the event and, when indexing is enabled, its index entries to the batch; without the event record the indexed fields are parsed from the buffer
+  bool addEvent(rocksdb::WriteBatch& batch, const std::string& key, const uint8_t* buffer, size_t buffer_size, ProvenanceEventRecord* event = nullptr);
+  rocksdb::ColumnFamilyHandle* getIndex(Index index) const {
+    return column_families_.at(static_cast<size_t>(index)).get();
+  }
+
   std::unique_ptr<rocksdb::DB> db_;
+  // destroyed before db_
+  std::vector<std::unique_ptr<rocksdb::ColumnFamilyHandle>> column_families_;
+  bool indexing_enabled_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -90,6 +90,14 @@ rocksdb::Status OpenRocksDB::NewCheckpoint(rocksdb::Checkpoint **checkpoint) {
   return rocksdb::Checkpoint::Create(impl_.get(), checkpoint);
 }
 
+const rocksdb::Snapshot* OpenRocksDB::GetSnapshot() {
+  return impl_->GetSnapshot();
+}
+
+void OpenRocksDB::ReleaseSnapshot(const rocksdb::Snapshot* snapshot) {
+  impl_->ReleaseSnapshot(snapshot);
+}
+
 rocksdb::Status OpenRocksDB::FlushWAL(bool sync) {
   rocksdb::Status result = impl_->FlushWAL(sync);
   if (result == rocksdb::Status::NoSpace()) {
@@ -65,6 +65,10 @@ class OpenRocksDB {
 
   rocksdb::Status NewCheckpoint(rocksdb::Checkpoint** checkpoint);
 
+  const rocksdb::Snapshot* GetSnapshot();
+
+  void ReleaseSnapshot(const rocksdb::Snapshot* snapshot);
+
   rocksdb::Status FlushWAL(bool sync);
 
   rocksdb::DB* get();
@@ -0,0 +1,157 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RocksDbEnvironment.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <string>
+
+#include "rocksdb/table.h"
+#include "core/Property.h"
+#include "core/TypedValues.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace internal {
+
+constexpr double RocksDbEnvironment::WRITE_BUFFER_RATIO;
+
+namespace {
+
+// the name of the default table factory of RocksDB
+constexpr const char* BLOCK_BASED_TABLE_FACTORY_NAME = "BlockBasedTable";
+
+}  // namespace
+
+RocksDbEnvironment& RocksDbEnvironment::getInstance() {
+  static RocksDbEnvironment instance;
+  return instance;
+}
+
+RocksDbEnvironment::RocksDbEnvironment()
+    : memory_limit_(0),
+      background_threads_(0),
+      default_low_priority_threads_(0),
+      default_high_priority_threads_(0),
+      logger_(core::logging::LoggerFactory<RocksDbEnvironment>::getLogger()) {
+}
+
+void RocksDbEnvironment::configure(const Configure& configuration) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string value;
+  if (configuration.get(Configure::nifi_rocksdb_memory_limit, value)) {
+    uint64_t limit = 0;
+    if (!core::DataSizeValue::StringToInt(value, limit)) {
+      logger_->log_error("Invalid value for %s: %s", Configure::nifi_rocksdb_memory_limit, value);
+    } else if (limit != memory_limit_) {
+      memory_limit_ = limit;
+      if (memory_limit_ > 0) {
+        // the write buffers are charged to the block cache, so the cache bounds the memory of both
+        cache_ = rocksdb::NewLRUCache(gsl::narrow<size_t>(memory_limit_));
+        write_buffer_manager_ = std::make_shared<rocksdb::WriteBufferManager>(gsl::narrow<size_t>(memory_limit_ * WRITE_BUFFER_RATIO), cache_);
+        logger_->log_info("RocksDB databases share a memory limit of %" PRIu64 " bytes", memory_limit_);
+      } else {
+        cache_.reset();
+        write_buffer_manager_.reset();
+      }
+    }
+  }
+  if (configuration.get(Configure::nifi_rocksdb_background_threads, value)) {
+    int64_t threads = 0;
+    rocksdb::Env* env = rocksdb::Env::Default();
+    if (core::Property::StringToInt(value, threads) && threads > 0) {
+      if (background_threads_ == 0) {
+        // the pool sizes of the default environment are process-wide, they are restored when the setting is reset
+        default_low_priority_threads_ = env->GetBackgroundThreads(rocksdb::Env::Priority::LOW);
+        default_high_priority_threads_ = env->GetBackgroundThreads(rocksdb::Env::Priority::HIGH);
+      }
+      background_threads_ = gsl::narrow<int>(threads);
+      // RocksDB gives a quarter of the background jobs of a database to flushes, the rest to compactions
+      env->SetBackgroundThreads(background_threads_, rocksdb::Env::Priority::LOW);
+      env->SetBackgroundThreads((std::max)(background_threads_ / 4, 1), rocksdb::Env::Priority::HIGH);
+      logger_->log_info("RocksDB databases share %d background threads", background_threads_);
+    } else if (core::Property::StringToInt(value, threads) && threads == 0) {
+      if (background_threads_ > 0) {
+        env->SetBackgroundThreads(default_low_priority_threads_, rocksdb::Env::Priority::LOW);
+        env->SetBackgroundThreads(default_high_priority_threads_, rocksdb::Env::Priority::HIGH);
+        background_threads_ = 0;
+      }
+    } else {
+      logger_->log_error("Invalid value for %s: %s", Configure::nifi_rocksdb_background_threads, value);
+    }
+  }
+}
+
+void RocksDbEnvironment::apply(rocksdb::Options& options, rocksdb::BlockBasedTableOptions table_options) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  options.env = rocksdb::Env::Default();
+  if (background_threads_ > 0) {
+    // opening a database grows the thread pools up to its own background jobs
+    options.max_background_jobs = (std::min)(options.max_background_jobs, background_threads_);
+  }
+  if (memory_limit_ == 0) {
+    return;
+  }
+  options.write_buffer_manager = write_buffer_manager_;
+  if (options.table_factory && std::string(options.table_factory->Name()) != BLOCK_BASED_TABLE_FACTORY_NAME) {
+    logger_->log_warn("The blocks of the %s table format are not kept in the shared block cache", options.table_factory->Name());
+    return;
+  }
+  // only the caching of the table options of the database is changed
+  table_options.block_cache = cache_;
+  // the index and filter blocks are kept in the cache as well instead of being held by the table readers outside of the limit
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+  options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+}
+
+uint64_t RocksDbEnvironment::getMemoryLimit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_limit_;
+}
+
+int RocksDbEnvironment::getBackgroundThreads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return background_threads_;
+}
+
+uint64_t RocksDbEnvironment::getSharedCacheUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_ ? gsl::narrow<uint64_t>(cache_->GetUsage()) : 0;
+}
+
+uint64_t RocksDbEnvironment::getMemoryUsage(rocksdb::DB& db) {
+  uint64_t usage = 0;
+  for (const auto& property : {rocksdb::DB::Properties::kCurSizeAllMemTables, rocksdb::DB::Properties::kEstimateTableReadersMem}) {
+    uint64_t value = 0;
+    if (db.GetAggregatedIntProperty(property, &value)) {
+      usage += value;
+    }
+  }
+  return usage;
+}
+
+}  // namespace internal
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
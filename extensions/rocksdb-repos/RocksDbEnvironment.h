@@ -0,0 +1,106 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/table.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "core/logging/Logger.h"
+#include "properties/Configure.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace internal {
+
+/**
+ * The RocksDB resources shared by every database of the agent: the repositories and the state stores.
+ *
+ * With a memory limit configured, the databases share a single block cache of that size, and their write buffers
+ * are charged to the same cache through a shared write buffer manager, so the memory of all databases together is
+ * bounded by the limit. The background flushes and compactions of every database run on the thread pools of the
+ * default environment, which can be sized as a whole.
+ */
+class RocksDbEnvironment {
+ public:
+  // the write buffers of all databases together may use at most this share of the memory limit
+  static constexpr double WRITE_BUFFER_RATIO = 0.5;
+
+  static RocksDbEnvironment& getInstance();
+
+  RocksDbEnvironment(const RocksDbEnvironment&) = delete;
+  RocksDbEnvironment& operator=(const RocksDbEnvironment&) = delete;
+
+  /**
+   * Reads the memory limit and the background threads from the configuration. The resources are shared by the
+   * databases opened afterwards; a setting missing from the configuration is left unchanged. Setting the background
+   * threads to 0 restores the thread pools of the default environment to their sizes before they were first changed.
+   */
+  void configure(const Configure& configuration);
+
+  /**
+   * Makes the options of a database use the shared resources. Without a memory limit the cache and the write
+   * buffers of the database are left as they are. A database with block based table options of its own passes them
+   * in table_options, only their caching is changed; a table factory of another format is left as it is.
+   */
+  void apply(rocksdb::Options& options, rocksdb::BlockBasedTableOptions table_options = rocksdb::BlockBasedTableOptions()) const;
+
+  uint64_t getMemoryLimit() const;
+
+  /**
+   * @return the number of background threads shared by the databases, 0 if it is left to RocksDB
+   */
+  int getBackgroundThreads() const;
+
+  /**
+   * @return the bytes held by the shared block cache, including the write buffers charged to it, 0 without a memory limit
+   */
+  uint64_t getSharedCacheUsage() const;
+
+  /**
+   * @return the bytes used by the write buffers and the table readers of every column family of the database
+   */
+  static uint64_t getMemoryUsage(rocksdb::DB& db);
+
+ private:
+  RocksDbEnvironment();
+
+  mutable std::mutex mutex_;
+  uint64_t memory_limit_;
+  int background_threads_;
+  int default_low_priority_threads_;
+  int default_high_priority_threads_;
+  std::shared_ptr<rocksdb::Cache> cache_;
+  std::shared_ptr<rocksdb::WriteBufferManager> write_buffer_manager_;
+
+  std::shared_ptr<core::logging::Logger> logger_;
+};
+
+}  // namespace internal
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -18,6 +18,10 @@
 
 #include "RocksDbStream.h"
 #include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <fstream>
 #include <utility>
 #include <vector>
@@ -31,24 +35,85 @@ namespace nifi {
 namespace minifi {
 namespace io {
 
-RocksDbStream::RocksDbStream(std::string path, gsl::not_null<minifi::internal::RocksDatabase*> db, bool write_enable, rocksdb::WriteBatch* batch)
+namespace {
+
+constexpr size_t HEADER_SIZE = 16;
+
+void encodeUInt64(std::string& buffer, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t decodeUInt64(const std::string& buffer, size_t position) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | static_cast<uint8_t>(buffer[position + i]);
+  }
+  return value;
+}
+
+}  // namespace
+
+constexpr size_t RocksDbStream::DEFAULT_CHUNK_SIZE;
+
+RocksDbStream::RocksDbStream(std::string path, gsl::not_null<minifi::internal::RocksDatabase*> db, bool write_enable, rocksdb::WriteBatch* batch, bool append, size_t chunk_size,
+    bool new_claim)
     : BaseStream(),
       path_(std::move(path)),
       write_enable_(write_enable),
+      exists_(false),
+      offset_(0),
+      single_value_(false),
       db_(db),
       batch_(batch),
+      size_(0),
+      chunk_size_(chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE),
+      chunk_index_(std::numeric_limits<uint64_t>::max()),
+      chunk_pending_(false),
+      replace_content_(write_enable && !append && !new_claim),
       logger_(logging::LoggerFactory<RocksDbStream>::getLogger()) {
+  if (write_enable_ && !append) {
+    return;
+  }
   auto opendb = db_->open();
-  exists_ = opendb && opendb->Get(rocksdb::ReadOptions(), path_, &value_).ok();
-  offset_ = 0;
-  size_ = value_.size();
+  if (!opendb) {
+    return;
+  }
+  exists_ = load(*opendb);
+  if (!write_enable_ || !exists_) {
+    return;
+  }
+  if (single_value_) {
+    // the single value is converted to chunks by the first write
+    replace_content_ = true;
+    size_ = 0;
+    chunk_size_ = chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE;
+  } else if (size_ % chunk_size_ != 0 && !opendb->Get(rocksdb::ReadOptions(), chunkKey(path_, size_ / chunk_size_), &chunk_).ok()) {
+    logger_->log_error("Failed to read the last chunk of %s, it cannot be appended to", path_);
+    write_enable_ = false;
+  }
 }
 
 void RocksDbStream::close() {
+  if (!write_enable_ || !chunk_pending_) {
+    return;
+  }
+  rocksdb::WriteBatch local_batch;
+  rocksdb::WriteBatch& batch = batch_ != nullptr ? *batch_ : local_batch;
+  putChunk(batch);
+  putHeader(batch, size_);
+  if (batch_ == nullptr && !writeBatch(local_batch)) {
+    logger_->log_error("Failed to write the last chunk of %s", path_);
+  }
 }
 
-void RocksDbStream::seek(uint64_t /*offset*/) {
-  // noop
+void RocksDbStream::seek(uint64_t offset) {
+  if (write_enable_) {
+    // writes always go to the end of the content
+    return;
+  }
+  offset_ = gsl::narrow<size_t>((std::min)(offset, static_cast<uint64_t>(size_)));
 }
 
 int RocksDbStream::write(const uint8_t *value, int size) {
@@ -60,25 +125,19 @@ int RocksDbStream::write(const uint8_t *value, int size) {
     return 0;
   }
   if (!IsNullOrEmpty(value)) {
-    auto opendb = db_->open();
-    if (!opendb) {
-      return -1;
-    }
-    rocksdb::Slice slice_value((const char *) value, size);
-    rocksdb::Status status;
-    size_ += size;
-    if (batch_ != nullptr) {
-      status = batch_->Merge(path_, slice_value);
-    } else {
-      rocksdb::WriteOptions opts;
-      opts.sync = true;
-      status = opendb->Merge(opts, path_, slice_value);
+    rocksdb::WriteBatch local_batch;
+    rocksdb::WriteBatch& batch = batch_ != nullptr ? *batch_ : local_batch;
+    if (single_value_) {
+      single_value_ = false;
+      appendChunks(batch, value_.data(), value_.size());
+      value_.clear();
     }
-    if (status.ok()) {
-      return size;
-    } else {
+    appendChunks(batch, reinterpret_cast<const char*>(value), gsl::narrow<size_t>(size));
+    // only completed chunks are written, the last one is kept in chunk_ until it fills or the stream is closed
+    if (batch_ == nullptr && local_batch.Count() > 0 && !writeBatch(local_batch)) {
       return -1;
     }
+    return size;
   } else {
     return -1;
   }
@@ -93,21 +152,167 @@ int RocksDbStream::read(uint8_t *buf, int buflen) {
     return 0;
   }
   if (!IsNullOrEmpty(buf)) {
-    size_t amtToRead = gsl::narrow<size_t>(buflen);
-    if (offset_ >= value_.size()) {
+    if (offset_ >= size_) {
       return 0;
     }
-    if (amtToRead > value_.size() - offset_) {
-      amtToRead = value_.size() - offset_;
+    const size_t amtToRead = (std::min)(gsl::narrow<size_t>(buflen), size_ - offset_);
+    if (single_value_) {
+      std::memcpy(buf, value_.data() + offset_, amtToRead);
+      offset_ += amtToRead;
+      return gsl::narrow<int>(amtToRead);
     }
-    std::memcpy(buf, value_.data() + offset_, amtToRead);
-    offset_ += amtToRead;
-    return gsl::narrow<int>(amtToRead);
+    size_t read_size = 0;
+    while (read_size < amtToRead) {
+      if (!loadChunk()) {
+        break;
+      }
+      const size_t chunk_offset = offset_ % chunk_size_;
+      if (chunk_offset >= chunk_.size()) {
+        logger_->log_error("Chunk %" PRIu64 " of %s is shorter than expected", chunk_index_, path_);
+        break;
+      }
+      const size_t length = (std::min)(amtToRead - read_size, chunk_.size() - chunk_offset);
+      std::memcpy(buf + read_size, chunk_.data() + chunk_offset, length);
+      read_size += length;
+      offset_ += length;
+    }
+    return read_size > 0 ? gsl::narrow<int>(read_size) : -1;
   } else {
     return -1;
   }
 }
 
+bool RocksDbStream::exists(minifi::internal::OpenRocksDB& db, const std::string& path) {
+  std::string value;
+  return db.Get(rocksdb::ReadOptions(), headerKey(path), &value).ok() || db.Get(rocksdb::ReadOptions(), path, &value).ok();
+}
+
+void RocksDbStream::remove(rocksdb::WriteBatch& batch, const std::string& path) {
+  // every key of the claim starts with <path># and '$' follows '#'
+  batch.DeleteRange(path + "#", path + "$");
+  batch.Delete(path);
+}
+
+bool RocksDbStream::truncate(minifi::internal::OpenRocksDB& db, rocksdb::WriteBatch& batch, const std::string& path, uint64_t size) {
+  std::string header;
+  if (!db.Get(rocksdb::ReadOptions(), headerKey(path), &header).ok() || header.size() != HEADER_SIZE || decodeUInt64(header, 8) == 0) {
+    return false;
+  }
+  const uint64_t chunk_size = decodeUInt64(header, 8);
+  if (size >= decodeUInt64(header, 0)) {
+    return true;
+  }
+  uint64_t first_removed_chunk = size / chunk_size;
+  if (size % chunk_size != 0) {
+    std::string chunk;
+    if (!db.Get(rocksdb::ReadOptions(), chunkKey(path, first_removed_chunk), &chunk).ok()) {
+      return false;
+    }
+    chunk.resize(gsl::narrow<size_t>(size % chunk_size));
+    batch.Put(chunkKey(path, first_removed_chunk), chunk);
+    ++first_removed_chunk;
+  }
+  // the chunk numbers are digits, ':' follows them and precedes the header key
+  batch.DeleteRange(chunkKey(path, first_removed_chunk), path + "#:");
+  header.clear();
+  encodeUInt64(header, size);
+  encodeUInt64(header, chunk_size);
+  batch.Put(headerKey(path), header);
+  return true;
+}
+
+std::string RocksDbStream::headerKey(const std::string& path) {
+  return path + "#size";
+}
+
+std::string RocksDbStream::chunkKey(const std::string& path, uint64_t chunk) {
+  // fixed width, so that the chunks are ordered by their number
+  char number[21];
+  std::snprintf(number, sizeof(number), "%010" PRIu64, chunk);
+  return path + "#" + number;
+}
+
+bool RocksDbStream::load(minifi::internal::OpenRocksDB& db) {
+  std::string header;
+  if (db.Get(rocksdb::ReadOptions(), headerKey(path_), &header).ok()) {
+    if (header.size() != HEADER_SIZE || decodeUInt64(header, 8) == 0) {
+      logger_->log_error("Invalid header of %s", path_);
+      return false;
+    }
+    size_ = gsl::narrow<size_t>(decodeUInt64(header, 0));
+    chunk_size_ = gsl::narrow<size_t>(decodeUInt64(header, 8));
+    return true;
+  }
+  if (db.Get(rocksdb::ReadOptions(), path_, &value_).ok()) {
+    single_value_ = true;
+    size_ = value_.size();
+    return true;
+  }
+  return false;
+}
+
+bool RocksDbStream::loadChunk() {
+  const uint64_t index = offset_ / chunk_size_;
+  if (index == chunk_index_) {
+    return true;
+  }
+  auto opendb = db_->open();
+  if (!opendb || !opendb->Get(rocksdb::ReadOptions(), chunkKey(path_, index), &chunk_).ok()) {
+    logger_->log_error("Failed to read chunk %" PRIu64 " of %s", index, path_);
+    chunk_index_ = std::numeric_limits<uint64_t>::max();
+    return false;
+  }
+  chunk_index_ = index;
+  return true;
+}
+
+void RocksDbStream::appendChunks(rocksdb::WriteBatch& batch, const char* value, size_t size) {
+  bool chunk_completed = false;
+  while (size > 0) {
+    const size_t length = (std::min)(size, chunk_size_ - chunk_.size());
+    chunk_.append(value, length);
+    chunk_pending_ = true;
+    value += length;
+    size -= length;
+    size_ += length;
+    if (chunk_.size() == chunk_size_) {
+      putChunk(batch);
+      chunk_.clear();
+      chunk_completed = true;
+    }
+  }
+  if (chunk_completed) {
+    putHeader(batch, chunk_pending_ ? size_ - chunk_.size() : size_);
+  }
+}
+
+void RocksDbStream::putChunk(rocksdb::WriteBatch& batch) {
+  // the previous content is removed together with the first chunk replacing it
+  if (replace_content_) {
+    remove(batch, path_);
+    replace_content_ = false;
+  }
+  batch.Put(chunkKey(path_, (size_ - chunk_.size()) / chunk_size_), chunk_);
+  chunk_pending_ = false;
+}
+
+void RocksDbStream::putHeader(rocksdb::WriteBatch& batch, uint64_t size) {
+  std::string header;
+  encodeUInt64(header, size);
+  encodeUInt64(header, chunk_size_);
+  batch.Put(headerKey(path_), header);
+}
+
+bool RocksDbStream::writeBatch(rocksdb::WriteBatch& batch) {
+  auto opendb = db_->open();
+  if (!opendb) {
+    return false;
+  }
+  rocksdb::WriteOptions opts;
+  opts.sync = true;
+  return opendb->Write(opts, &batch).ok();
+}
+
 } /* namespace io */
 } /* namespace minifi */
 } /* namespace nifi */
@@ -22,6 +22,8 @@
 #include <iostream>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include "rocksdb/write_batch.h"
 #include "io/EndianCheck.h"
 #include "io/BaseStream.h"
 #include "core/logging/LoggerConfiguration.h"
@@ -33,19 +35,30 @@ namespace minifi {
 namespace io {
 
 /**
- * Purpose: File Stream Base stream extension. This is intended to be a thread safe access to
- * read/write to the local file system.
+ * Stream of the content of a claim in the RocksDB content repository.
  *
- * Design: Simply extends BaseStream and overrides readData/writeData to allow a sink to the
- * fstream object.
+ * The content is stored in chunks of a fixed size under the keys <path>#<chunk number>, along with a header under
+ * <path>#size holding the size of the content and the chunk size it was written with. Reads load one chunk at a time
+ * and can seek anywhere in the content. Writes fill the last chunk in memory and store it, along with the header, only
+ * when it is complete or when the stream is closed, so readers see the content once the stream is closed.
+ * Content stored by earlier versions as a single value under <path> is still readable, and it is converted to chunks
+ * when appended to.
  */
 class RocksDbStream : public io::BaseStream {
  public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
   /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
+   * @param path path of the claim
+   * @param db content database
+   * @param write_enable whether the stream writes the content instead of reading it
+   * @param batch if set, the writes are added to this batch instead of being written to the database
+   * @param append whether writes extend the existing content instead of replacing it
+   * @param chunk_size size of the chunks of newly written content
+   * @param new_claim whether the claim is known to have no content yet, so writing it does not remove any previous content
    */
-  explicit RocksDbStream(std::string path, gsl::not_null<minifi::internal::RocksDatabase*> db, bool write_enable = false, rocksdb::WriteBatch* batch = nullptr);
+  explicit RocksDbStream(std::string path, gsl::not_null<minifi::internal::RocksDatabase*> db, bool write_enable = false, rocksdb::WriteBatch* batch = nullptr,
+      bool append = false, size_t chunk_size = DEFAULT_CHUNK_SIZE, bool new_claim = false);
 
   ~RocksDbStream() override {
     close();
@@ -79,7 +92,38 @@ class RocksDbStream : public io::BaseStream {
    */
   int write(const uint8_t *value, int size) override;
 
+  /**
+   * Whether the content of the claim exists in the database
+   */
+  static bool exists(minifi::internal::OpenRocksDB& db, const std::string& path);
+
+  /**
+   * Adds the deletion of every chunk and the header of the claim to the batch
+   */
+  static void remove(rocksdb::WriteBatch& batch, const std::string& path);
+
+  /**
+   * Adds the writes cutting the content of the claim to the given size to the batch
+   * @return false if the claim has no chunked content or its last remaining chunk cannot be read
+   */
+  static bool truncate(minifi::internal::OpenRocksDB& db, rocksdb::WriteBatch& batch, const std::string& path, uint64_t size);
+
  protected:
+  static std::string headerKey(const std::string& path);
+  static std::string chunkKey(const std::string& path, uint64_t chunk);
+
+  // reads the header or the content stored as a single value, returns false if the claim has no content
+  bool load(minifi::internal::OpenRocksDB& db);
+  // loads the chunk containing offset_ into chunk_
+  bool loadChunk();
+  // adds the completed chunks of value to the batch, the chunk being filled is kept in chunk_
+  void appendChunks(rocksdb::WriteBatch& batch, const char* value, size_t size);
+  // adds chunk_ as the last chunk of the content to the batch
+  void putChunk(rocksdb::WriteBatch& batch);
+  void putHeader(rocksdb::WriteBatch& batch, uint64_t size);
+  // writes a batch of a stream without an external batch
+  bool writeBatch(rocksdb::WriteBatch& batch);
+
   std::string path_;
 
   bool write_enable_;
@@ -88,6 +132,9 @@ class RocksDbStream : public io::BaseStream {
 
   size_t offset_;
 
+  // content stored as a single value by earlier versions
+  bool single_value_;
+
   std::string value_;
 
   gsl::not_null<minifi::internal::RocksDatabase*> db_;
@@ -96,10 +143,22 @@ class RocksDbStream : public io::BaseStream {
 
   size_t size_;
 
- private:
+  size_t chunk_size_;
 
-  std::shared_ptr<logging::Logger> logger_;
+  // when reading, the chunk containing the offset; when writing, the content of the last, incomplete chunk
+  std::string chunk_;
+
+  // index of the chunk in chunk_ when reading
+  uint64_t chunk_index_;
 
+  // whether chunk_ holds written content that is not in the database or the batch yet
+  bool chunk_pending_;
+
+  // whether the next write replaces the previous content of the claim
+  bool replace_content_;
+
+ private:
+  std::shared_ptr<logging::Logger> logger_;
 };
 
 } /* namespace io */
@@ -18,6 +18,7 @@
 #include "RocksDbPersistableKeyValueStoreService.h"
 
 #include "utils/StringUtils.h"
+#include "../RocksDbEnvironment.h"
 
 #include <fstream>
 
@@ -69,6 +70,8 @@ void RocksDbPersistableKeyValueStoreService::onEnable() {
   if (!always_persist_) {
     options.manual_wal_flush = true;
   }
+  minifi::internal::RocksDbEnvironment::getInstance().configure(*configuration_);
+  minifi::internal::RocksDbEnvironment::getInstance().apply(options);
   db_ = utils::make_unique<minifi::internal::RocksDatabase>(options, directory_);
   if (db_->open()) {
     logger_->log_trace("Successfully opened RocksDB database at %s", directory_.c_str());
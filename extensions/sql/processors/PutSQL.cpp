@@ -31,6 +31,7 @@
 #include "core/ProcessContext.h"
 #include "core/ProcessSession.h"
 #include "Exception.h"
+#include "utils/gsl.h"
 #include "data/DatabaseConnectors.h"
 #include "data/JSONSQLWriter.h"
 
@@ -51,6 +52,14 @@ const core::Property PutSQL::SQLStatement(
       "the incoming flow file is expected to contain a valid SQL statement, to be issued by the processor to the database.")
   ->supportsExpressionLanguage(true)->build());
 
+const core::Property PutSQL::BatchSize(
+  core::PropertyBuilder::createProperty("Batch Size")
+  ->isRequired(true)
+  ->withDefaultValue<uint64_t>(1)
+  ->withDescription(
+      "The maximum number of flow files to put to the database in a single transaction. "
+      "If any of the statements fails, the whole batch is rolled back.")->build());
+
 const core::Relationship PutSQL::Success("success", "Database is successfully updated.");
 
 PutSQL::PutSQL(const std::string& name, utils::Identifier uuid)
@@ -59,22 +68,41 @@ PutSQL::PutSQL(const std::string& name, utils::Identifier uuid)
 
 void PutSQL::initialize() {
   //! Set the supported properties
-  setSupportedProperties({ DBControllerService, SQLStatement });
+  setSupportedProperties({ DBControllerService, SQLStatement, BatchSize });
 
   //! Set the supported relationships
   setSupportedRelationships({ Success });
 }
 
-void PutSQL::processOnSchedule(core::ProcessContext& /*context*/) {}
+void PutSQL::processOnSchedule(core::ProcessContext& context) {
+  context.getProperty(BatchSize.getName(), batch_size_);
+  if (batch_size_ == 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "'" + BatchSize.getName() + "' must be a positive number");
+  }
+}
 
 void PutSQL::processOnTrigger(core::ProcessContext& context, core::ProcessSession& session) {
-  auto flow_file = session.get();
-  if (!flow_file) {
+  const auto flow_files = session.get(gsl::narrow<size_t>(batch_size_));
+  if (flow_files.empty()) {
     context.yield();
     return;
   }
-  session.transfer(flow_file, Success);
 
+  auto sql_session = connection_->getSession();
+  sql_session->begin();
+  try {
+    for (const auto& flow_file : flow_files) {
+      session.transfer(flow_file, Success);
+      putFlowFile(context, session, flow_file);
+    }
+    sql_session->commit();
+  } catch (...) {
+    sql_session->rollback();
+    throw;
+  }
+}
+
+void PutSQL::putFlowFile(core::ProcessContext& context, core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow_file) {
   std::string sql_statement;
   if (!context.getProperty(SQLStatement, sql_statement, flow_file)) {
     logger_->log_debug("Using the contents of the flow file as the SQL statement");
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "core/Resource.h"
@@ -46,8 +47,14 @@ class PutSQL: public SQLProcessor {
   void initialize() override;
 
   static const core::Property SQLStatement;
+  static const core::Property BatchSize;
 
   static const core::Relationship Success;
+
+ private:
+  void putFlowFile(core::ProcessContext& context, core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow_file);
+
+  uint64_t batch_size_ = 1;
 };
 
 REGISTER_RESOURCE(PutSQL, "PutSQL to execute SQL command via ODBC.");
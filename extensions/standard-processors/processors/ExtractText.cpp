@@ -41,7 +41,6 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
-constexpr size_t MAX_BUFFER_SIZE = 4096;
 constexpr int MAX_CAPTURE_GROUP_SIZE = 1024;
 
 core::Property ExtractText::Attribute(core::PropertyBuilder::createProperty("Attribute")->withDescription("Attribute to set from content")->build());
@@ -107,72 +106,50 @@ void ExtractText::onTrigger(core::ProcessContext *context, core::ProcessSession
     return;
   }
 
-  ReadCallback cb(flowFile, context, logger_);
-  session->read(flowFile, &cb);
+  extract(context, session, flowFile);
   session->transfer(flowFile, Success);
 }
 
-int64_t ExtractText::ReadCallback::process(const std::shared_ptr<io::BaseStream>& stream) {
-  int64_t ret = 0;
-  uint64_t read_size = 0;
+void ExtractText::extract(core::ProcessContext *context, core::ProcessSession *session, const std::shared_ptr<core::FlowFile>& flowFile) {
   bool regex_mode;
-  uint64_t size_limit = flowFile_->getSize();
+  uint64_t size_limit = flowFile->getSize();
 
   std::string attrKey, sizeLimitStr;
-  ctx_->getProperty(Attribute.getName(), attrKey);
-  ctx_->getProperty(SizeLimit.getName(), sizeLimitStr);
-  ctx_->getProperty(RegexMode.getName(), regex_mode);
+  context->getProperty(Attribute.getName(), attrKey);
+  context->getProperty(SizeLimit.getName(), sizeLimitStr);
+  context->getProperty(RegexMode.getName(), regex_mode);
 
   if (sizeLimitStr.empty())
     size_limit = DEFAULT_SIZE_LIMIT;
   else if (sizeLimitStr != "0")
     size_limit = std::stoi(sizeLimitStr);
 
-  std::ostringstream contentStream;
-
-  while (read_size < size_limit) {
-    // Don't read more than config limit or the size of the buffer
-    int length = gsl::narrow<int>(std::min<uint64_t>(size_limit - read_size, buffer_.size()));
-    ret = stream->read(buffer_, length);
-
-    if (ret < 0) {
-      return -1;  // Stream error
-    } else if (ret == 0) {
-      break;  // End of stream, no more data
-    }
-
-    contentStream.write(reinterpret_cast<const char*>(buffer_.data()), ret);
-    read_size += ret;
-    if (contentStream.fail()) {
-      return -1;
-    }
-  }
+  // Don't extract more than config limit
+  const std::string contentStr = session->readView(flowFile, size_limit)->toString();
 
   if (regex_mode) {
     std::vector<utils::Regex::Mode> rgx_mode;
 
     bool insensitive;
-    if (ctx_->getProperty(InsensitiveMatch.getName(), insensitive) && insensitive) {
+    if (context->getProperty(InsensitiveMatch.getName(), insensitive) && insensitive) {
       rgx_mode.push_back(utils::Regex::Mode::ICASE);
     }
 
     bool ignoregroupzero;
-    ctx_->getProperty(IgnoreCaptureGroupZero.getName(), ignoregroupzero);
+    context->getProperty(IgnoreCaptureGroupZero.getName(), ignoregroupzero);
 
     bool repeatingcapture;
-    ctx_->getProperty(EnableRepeatingCaptureGroup.getName(), repeatingcapture);
+    context->getProperty(EnableRepeatingCaptureGroup.getName(), repeatingcapture);
 
     int maxCaptureSizeProperty;
-    ctx_->getProperty(MaxCaptureGroupLen.getName(), maxCaptureSizeProperty);
+    context->getProperty(MaxCaptureGroupLen.getName(), maxCaptureSizeProperty);
     size_t maxCaptureSize = gsl::narrow<size_t>(maxCaptureSizeProperty);
 
-    std::string contentStr = contentStream.str();
-
     std::map<std::string, std::string> regexAttributes;
 
-    for (const auto& k : ctx_->getDynamicPropertyKeys()) {
+    for (const auto& k : context->getDynamicPropertyKeys()) {
       std::string value;
-      ctx_->getDynamicProperty(k, value);
+      context->getDynamicProperty(k, value);
 
       std::string workStr = contentStr;
 
@@ -207,19 +184,11 @@ int64_t ExtractText::ReadCallback::process(const std::shared_ptr<io::BaseStream>
     }
 
     for (const auto& kv : regexAttributes) {
-      flowFile_->setAttribute(kv.first, kv.second);
+      flowFile->setAttribute(kv.first, kv.second);
     }
   } else {
-    flowFile_->setAttribute(attrKey, contentStream.str());
+    flowFile->setAttribute(attrKey, contentStr);
   }
-  return read_size;
-}
-
-ExtractText::ReadCallback::ReadCallback(std::shared_ptr<core::FlowFile> flowFile, core::ProcessContext *ctx,  std::shared_ptr<logging::Logger> lgr)
-    : flowFile_(std::move(flowFile)),
-      ctx_(ctx),
-      logger_(std::move(lgr)) {
-  buffer_.resize(std::min(gsl::narrow<size_t>(flowFile_->getSize()), MAX_BUFFER_SIZE));
 }
 
 }  // namespace processors
@@ -72,20 +72,17 @@ class ExtractText : public core::Processor {
       return true;
     }
 
-    class ReadCallback : public InputStreamCallback {
-     public:
-        ReadCallback(std::shared_ptr<core::FlowFile> flowFile, core::ProcessContext *ct, std::shared_ptr<logging::Logger> lgr);
-        ~ReadCallback() = default;
-        int64_t process(const std::shared_ptr<io::BaseStream>& stream);
-
-     private:
-        std::shared_ptr<core::FlowFile> flowFile_;
-        core::ProcessContext *ctx_;
-        std::vector<uint8_t> buffer_;
-        std::shared_ptr<logging::Logger> logger_;
-    };
+    virtual bool supportsBatching() const {
+      return true;
+    }
 
  private:
+    /**
+     * Extracts the text, or the matches of the regular expressions, from the content into attributes.
+     * The content is scanned in place, through a memory mapped view of it where possible.
+     */
+    void extract(core::ProcessContext *context, core::ProcessSession *session, const std::shared_ptr<core::FlowFile>& flowFile);
+
     //! Logger
     std::shared_ptr<logging::Logger> logger_;
 };
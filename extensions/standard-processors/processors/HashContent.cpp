@@ -37,6 +37,12 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
+namespace {
+
+constexpr int HASH_BUFFER_SIZE = 16384;
+
+}  // namespace
+
 core::Property HashContent::HashAttribute("Hash Attribute", "Attribute to store checksum to", "Checksum");
 core::Property HashContent::HashAlgorithm("Hash Algorithm", "Name of the algorithm used to generate checksum", "SHA256");
 core::Property HashContent::FailOnEmpty("Fail on empty", "Route to failure relationship in case of empty content", "false");
@@ -88,17 +94,36 @@ void HashContent::onTrigger(core::ProcessContext *, core::ProcessSession *sessio
   }
 
   logger_->log_trace("attempting read");
-  ReadCallback cb(flowFile, *this);
-  session->read(flowFile, &cb);
+  // This throws in case algo is not found, but that's fine
+  logger_->log_trace("Searching for %s", algoName_);
+  const auto& algo = HashAlgos.at(algoName_);
+  if (const auto content = session->mapView(flowFile)) {
+    const auto ret_val = algo([&content](const HashUpdate& update) {
+      update(content->data(), content->size());
+      return gsl::narrow<int64_t>(content->size());
+    });
+    flowFile->setAttribute(attrKey_, ret_val.first);
+  } else {
+    // content that cannot be mapped is hashed while it is read, so it is never held in memory as a whole
+    ReadCallback cb(flowFile, *this);
+    session->read(flowFile, &cb);
+  }
   session->transfer(flowFile, Success);
 }
 
 int64_t HashContent::ReadCallback::process(const std::shared_ptr<io::BaseStream>& stream) {
-  // This throws in case algo is not found, but that's fine
-  parent_.logger_->log_trace("Searching for %s", parent_.algoName_);
-  auto algo = HashAlgos.at(parent_.algoName_);
-
-  const auto& ret_val = algo(stream);
+  const auto& algo = HashAlgos.at(parent_.algoName_);
+
+  const auto ret_val = algo([&stream](const HashUpdate& update) {
+    uint8_t buffer[HASH_BUFFER_SIZE];
+    int64_t size = 0;
+    int ret;
+    while ((ret = stream->read(buffer, HASH_BUFFER_SIZE)) > 0) {
+      update(buffer, gsl::narrow<size_t>(ret));
+      size += ret;
+    }
+    return size;
+  });
 
   flowFile_->setAttribute(parent_.attrKey_, ret_val.first);
 
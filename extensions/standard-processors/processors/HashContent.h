@@ -39,29 +39,22 @@
 #include "core/ProcessSession.h"
 #include "core/Resource.h"
 #include "io/BaseStream.h"
+#include "utils/gsl.h"
 #include "utils/StringUtils.h"
 
 using HashReturnType = std::pair<std::string, int64_t>;
+using HashUpdate = std::function<void(const uint8_t*, size_t)>;
+// passes the content to the hash update in one or more pieces, returns the size of the content
+using HashInput = std::function<int64_t(const HashUpdate&)>;
 
 // Without puttng this into its own namespace, the code would export already defined symbols.
 namespace { // NOLINT
-#define HASH_BUFFER_SIZE 16384
 
-  HashReturnType MD5Hash(const std::shared_ptr<org::apache::nifi::minifi::io::BaseStream>& stream) {
+  HashReturnType MD5Hash(const HashInput& input) {
     HashReturnType ret_val;
-    ret_val.second = 0;
-    uint8_t buffer[HASH_BUFFER_SIZE];
     MD5_CTX context;
     MD5_Init(&context);
-
-    size_t ret = 0;
-    do {
-      ret = stream->read(buffer, HASH_BUFFER_SIZE);
-      if (ret > 0) {
-        MD5_Update(&context, buffer, ret);
-        ret_val.second += ret;
-      }
-    } while (ret > 0);
+    ret_val.second = input([&context](const uint8_t* data, size_t size) { MD5_Update(&context, data, size); });
 
     if (ret_val.second > 0) {
       unsigned char digest[MD5_DIGEST_LENGTH];
@@ -71,21 +64,11 @@ namespace { // NOLINT
     return ret_val;
   }
 
-  HashReturnType SHA1Hash(const std::shared_ptr<org::apache::nifi::minifi::io::BaseStream>& stream) {
+  HashReturnType SHA1Hash(const HashInput& input) {
     HashReturnType ret_val;
-    ret_val.second = 0;
-    uint8_t buffer[HASH_BUFFER_SIZE];
     SHA_CTX context;
     SHA1_Init(&context);
-
-    size_t ret = 0;
-    do {
-      ret = stream->read(buffer, HASH_BUFFER_SIZE);
-      if (ret > 0) {
-        SHA1_Update(&context, buffer, ret);
-        ret_val.second += ret;
-      }
-    } while (ret > 0);
+    ret_val.second = input([&context](const uint8_t* data, size_t size) { SHA1_Update(&context, data, size); });
 
     if (ret_val.second > 0) {
       unsigned char digest[SHA_DIGEST_LENGTH];
@@ -95,21 +78,11 @@ namespace { // NOLINT
     return ret_val;
   }
 
-  HashReturnType SHA256Hash(const std::shared_ptr<org::apache::nifi::minifi::io::BaseStream>& stream) {
+  HashReturnType SHA256Hash(const HashInput& input) {
     HashReturnType ret_val;
-    ret_val.second = 0;
-    uint8_t buffer[HASH_BUFFER_SIZE];
     SHA256_CTX context;
     SHA256_Init(&context);
-
-    size_t ret;
-    do {
-      ret = stream->read(buffer, HASH_BUFFER_SIZE);
-      if (ret > 0) {
-        SHA256_Update(&context, buffer, ret);
-        ret_val.second += ret;
-      }
-    } while (ret > 0);
+    ret_val.second = input([&context](const uint8_t* data, size_t size) { SHA256_Update(&context, data, size); });
 
     if (ret_val.second > 0) {
       unsigned char digest[SHA256_DIGEST_LENGTH];
@@ -127,7 +100,8 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
-static const std::map<std::string, const std::function<HashReturnType(const std::shared_ptr<io::BaseStream>&)>> HashAlgos =
+// the content is hashed in place through a memory mapped view of it where possible, otherwise while it is read
+static const std::map<std::string, const std::function<HashReturnType(const HashInput&)>> HashAlgos =
   { {"MD5",  MD5Hash}, {"SHA1", SHA1Hash}, {"SHA256", SHA256Hash} };
 
 //! HashContent Class
@@ -158,6 +132,10 @@ class HashContent : public core::Processor {
   //! Initialize, over write by NiFi HashContent
   void initialize(void);  // override
 
+  bool supportsBatching() const {  // override
+    return true;
+  }
+
   class ReadCallback : public InputStreamCallback {
    public:
     ReadCallback(std::shared_ptr<core::FlowFile> flowFile, const HashContent& parent);
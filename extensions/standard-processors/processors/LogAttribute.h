@@ -125,6 +125,10 @@ class LogAttribute : public core::Processor {
   // Initialize, over write by NiFi LogAttribute
   void initialize(void) override;
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
  private:
   uint64_t flowfiles_to_log_;
   bool hexencode_;
@@ -80,6 +80,10 @@ class PutFile : public core::Processor {
   void onTrigger(core::ProcessContext *context, core::ProcessSession *session) override;
   void initialize() override;
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   class ReadCallback : public InputStreamCallback {
    public:
     ReadCallback(const std::string &tmp_file, const std::string &dest_file);
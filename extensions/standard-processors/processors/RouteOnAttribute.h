@@ -59,6 +59,10 @@ class RouteOnAttribute : public core::Processor {
     return true;
   }
 
+  virtual bool supportsBatching() const {
+    return true;
+  }
+
   virtual bool supportsDynamicRelationships() {
     return true;
   }
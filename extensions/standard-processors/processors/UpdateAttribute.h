@@ -59,6 +59,10 @@ class UpdateAttribute : public core::Processor {
     return true;
   }
 
+  virtual bool supportsBatching() const {
+    return true;
+  }
+
   virtual void onSchedule(core::ProcessContext *context,
                           core::ProcessSessionFactory *sessionFactory);
   virtual void onTrigger(core::ProcessContext *context,
@@ -158,12 +158,14 @@ TEST_CASE("Test Scheduling Defaults", "[schedDef]") {
       proc_0 = node;
     }
   }
-  REQUIRE(proc_0.children.size() == 6);
+  REQUIRE(proc_0.children.size() == 7);
   for (const auto &child : proc_0.children) {
     if ("defaultMaxConcurrentTasks" == child.name) {
       REQUIRE("1" == child.value.to_string());
     } else if ("defaultRunDurationNanos" == child.name) {
       REQUIRE("0" == child.value.to_string());
+    } else if ("defaultMaxBatchSize" == child.name) {
+      REQUIRE("0" == child.value.to_string());
     } else if ("defaultSchedulingPeriodMillis" == child.name) {
       REQUIRE("1000" == child.value.to_string());
     } else if ("defaultSchedulingStrategy" == child.name) {
@@ -178,6 +180,33 @@ TEST_CASE("Test Scheduling Defaults", "[schedDef]") {
   }
 }
 
+TEST_CASE("Test Supports Batching", "[batching]") {
+  minifi::state::response::ComponentManifest manifest("minifi-system");
+  auto serialized = manifest.serialize();
+  REQUIRE(serialized.size() > 0);
+  const auto &resp = serialized[0];
+  const auto processors = std::find_if(resp.children.begin(), resp.children.end(), [](const minifi::state::response::SerializedResponseNode &node) {
+    return node.name == "processors";
+  });
+  REQUIRE(processors != resp.children.end());
+
+  const auto supportsBatching = [&](const std::string &class_name) {
+    for (const auto &processor : processors->children) {
+      if (processor.name != class_name) {
+        continue;
+      }
+      for (const auto &child : processor.children) {
+        if (child.name == "supportsBatching") {
+          return child.value.to_string();
+        }
+      }
+    }
+    return std::string{};
+  };
+  REQUIRE("true" == supportsBatching("org.apache.nifi.minifi.processors.HashContent"));
+  REQUIRE("false" == supportsBatching("org.apache.nifi.minifi.processors.GetFile"));
+}
+
 TEST_CASE("Test operatingSystem Defaults", "[opsys]") {
   minifi::state::response::DeviceInfoNode manifest("minifi-system");
   auto serialized = manifest.serialize();
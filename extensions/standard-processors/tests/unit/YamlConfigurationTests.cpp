@@ -505,6 +505,50 @@ Processors:
                                                     "Dynamic Property with value Bad"));
 }
 
+TEST_CASE("Test Run Duration", "[YamlConfigurationRunDuration]") {
+  TestController test_controller;
+
+  LogTestController &logTestController = LogTestController::getInstance();
+  logTestController.setDebug<TestPlan>();
+  logTestController.setDebug<core::YamlConfiguration>();
+
+  std::shared_ptr<core::Repository> testProvRepo = core::createRepository("provenancerepository", true);
+  std::shared_ptr<core::Repository> testFlowFileRepo = core::createRepository("flowfilerepository", true);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<minifi::io::StreamFactory> streamFactory = minifi::io::StreamFactory::getInstance(configuration);
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  core::YamlConfiguration yamlConfig(testProvRepo, testFlowFileRepo, content_repo, streamFactory, configuration);
+
+  static const std::string TEST_CONFIG_YAML = R"(
+Flow Controller:
+  name: Simple
+Processors:
+- name: PutFile
+  class: PutFile
+  run duration nanos: 25 ms
+  max batch size: 100
+- name: LogAttribute
+  class: LogAttribute
+  run duration nanos: 5000
+- name: GetFile
+  class: GetFile
+  run duration nanos: 25 ms
+      )";
+  std::istringstream configYamlStream(TEST_CONFIG_YAML);
+  std::unique_ptr<core::ProcessGroup> rootFlowConfig = yamlConfig.getYamlRoot(configYamlStream);
+
+  REQUIRE(rootFlowConfig);
+  const auto put_file = rootFlowConfig->findProcessorByName("PutFile");
+  REQUIRE(put_file->supportsBatching());
+  REQUIRE(25000000 == put_file->getRunDurationNano());
+  REQUIRE(100 == put_file->getMaxBatchSize());
+  const auto log_attribute = rootFlowConfig->findProcessorByName("LogAttribute");
+  REQUIRE(5000 == log_attribute->getRunDurationNano());
+  REQUIRE(0 == log_attribute->getMaxBatchSize());
+  REQUIRE_FALSE(rootFlowConfig->findProcessorByName("GetFile")->supportsBatching());
+  REQUIRE(LogTestController::getInstance().contains("[warning] Processor GetFile does not support batching, its run duration is ignored"));
+}
+
 TEST_CASE("Test Required Property", "[YamlConfigurationRequiredProperty]") {
   TestController test_controller;
 
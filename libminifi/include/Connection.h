@@ -25,9 +25,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <deque>
 #include <mutex>
 #include <atomic>
 #include <algorithm>
+#include <utility>
 #include "core/Core.h"
 #include "core/Connectable.h"
 #include "core/logging/Logger.h"
@@ -35,6 +37,8 @@
 #include "core/FlowFile.h"
 #include "core/Repository.h"
 #include "utils/FlowFileQueue.h"
+#include "utils/ConcurrentFlowFileQueue.h"
+#include "FlowFileSwapManager.h"
 
 namespace org {
 namespace apache {
@@ -140,17 +144,62 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
     return drop_empty_;
   }
 
+  /**
+   * Selects the lock-free queue implementation instead of the default mutex-guarded priority queue.
+   * Must be set before any flow file is queued into the connection.
+   */
+  void setLockFreeQueue(bool lock_free) {
+    lock_free_queue_ = lock_free;
+  }
+
+  bool getLockFreeQueue() const {
+    return lock_free_queue_;
+  }
+
+  /**
+   * Once the number of flow files held in memory reaches the swap threshold, further flow files are
+   * collected and written to swap files in batches, then swapped back in as the queue drains.
+   * 0 disables swapping. Swapping is not supported with the lock-free queue.
+   */
+  void setSwapThreshold(uint64_t threshold) {
+    swap_threshold_ = threshold;
+  }
+
+  uint64_t getSwapThreshold() const {
+    return swap_threshold_;
+  }
+
+  void setSwapManager(std::shared_ptr<FlowFileSwapManager> swap_manager) {
+    swap_manager_ = std::move(swap_manager);
+  }
+
+  // Get the number of flow files currently swapped out to disk
+  uint64_t getSwappedCount() const {
+    return swapped_count_;
+  }
+
+  // Get the data size of flow files currently swapped out to disk
+  uint64_t getSwappedDataSize() const {
+    return swapped_data_size_;
+  }
+
   // Check whether the queue is empty
   bool isEmpty() const;
   // Check whether the queue is full to apply back pressure
   bool isFull();
   // Get queue size
   uint64_t getQueueSize() {
+    if (lock_free_queue_) {
+      return concurrent_queue_.size();
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return queuedCount();
   }
   // Get queue data size
   uint64_t getQueueDataSize() {
+    if (lock_free_queue_) {
+      return concurrent_queue_.dataSize();
+    }
     return queued_data_size_;
   }
 
@@ -158,17 +207,28 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   void put(const std::shared_ptr<core::FlowFile>& flow) override;
 
   // Put multiple flowfiles into the queue
-  void multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows);
+  void multiPut(const std::vector<std::shared_ptr<core::FlowFile>>& flows);
+
+  void restoreBatch(const std::vector<std::shared_ptr<core::FlowFile>>& flows) override {
+    multiPut(flows);
+  }
   // Poll the flow file from queue, the expired flow file record also being returned
   std::shared_ptr<core::FlowFile> poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
+  // Poll at most max_count flow files from the queue at once, the expired flow file records also being returned
+  std::vector<std::shared_ptr<core::FlowFile>> pollBatch(size_t max_count, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
+  // Poll flow files from the queue until either max_count flow files are polled or their total size reaches max_bytes
+  std::vector<std::shared_ptr<core::FlowFile>> pollBatch(size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Drain the flow records
   void drain(bool delete_permanently);
 
   void yield() override {}
 
   bool isWorkAvailable() override {
+    if (lock_free_queue_) {
+      return concurrent_queue_.isWorkAvailable();
+    }
     const std::lock_guard<std::mutex> lock{mutex_};
-    return queue_.isWorkAvailable();
+    return queue_.isWorkAvailable() || shouldSwapIn();
   }
 
   bool isRunning() override {
@@ -198,13 +258,36 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   std::shared_ptr<core::ContentRepository> content_repo_;
 
  private:
+  bool isExpired(const std::shared_ptr<core::FlowFile>& flow_file) const;
+  void enqueue(const std::shared_ptr<core::FlowFile>& flow_file);
+  // the following functions must be called with mutex_ held
+  uint64_t queuedCount() const;
+  bool isSwapEnabled() const;
+  uint64_t swapBatchSize() const;
+  bool shouldSwapIn() const;
+  void swapOut();
+  void swapIn();
+
   bool drop_empty_;
+  bool lock_free_queue_;
   // Mutex for protection
   mutable std::mutex mutex_;
   // Queued data size
   std::atomic<uint64_t> queued_data_size_;
   // Queue for the Flow File
   utils::FlowFileQueue queue_;
+  // Queue for the Flow File if the lock-free implementation is selected
+  utils::ConcurrentFlowFileQueue concurrent_queue_;
+  std::atomic<uint64_t> swap_threshold_;
+  std::shared_ptr<FlowFileSwapManager> swap_manager_;
+  // Flow files queued behind the swapped out ones, which are not yet written to a swap file
+  std::vector<std::shared_ptr<core::FlowFile>> swap_buffer_;
+  // Swap files in the order they were written
+  std::deque<SwapLocation> swap_locations_;
+  std::atomic<uint64_t> swapped_count_;
+  std::atomic<uint64_t> swapped_data_size_;
+  // size the swap buffer has to reach before the next swap out, doubled after every failed swap out
+  uint64_t next_swap_out_size_;
   // flow repository
   // Logger
   std::shared_ptr<logging::Logger> logger_;
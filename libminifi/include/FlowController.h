@@ -123,6 +123,8 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
 
   int16_t clearConnection(const std::string &connection) override;
 
+  int16_t setThreadPoolSize(uint16_t threads) override;
+
   int16_t applyUpdate(const std::string& /*source*/, const std::shared_ptr<state::Update>&) override { return -1; }
   // Asynchronous function trigger unloading and wait for a period of time
   virtual void waitUnload(uint64_t timeToWaitMs);
@@ -210,7 +212,7 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
   template <typename T, typename = typename std::enable_if<std::is_base_of<SchedulingAgent, T>::value>::type>
   void conditionalReloadScheduler(std::shared_ptr<T>& scheduler, const bool condition) {
     if (condition) {
-      scheduler = std::make_shared<T>(gsl::not_null<core::controller::ControllerServiceProvider*>(this), provenance_repo_, flow_file_repo_, content_repo_, configuration_, thread_pool_);
+      scheduler = std::make_shared<T>(gsl::not_null<core::controller::ControllerServiceProvider*>(this), provenance_repo_, flow_file_repo_, content_repo_, configuration_, *thread_pool_);
     }
   }
 
@@ -225,7 +227,7 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
   // Whether it has already been initialized (load the flow XML already)
   std::atomic<bool> initialized_;
   // Thread pool for schedulers
-  utils::ThreadPool<utils::TaskRescheduleInfo> thread_pool_;
+  std::unique_ptr<utils::ThreadPool<utils::TaskRescheduleInfo>> thread_pool_;
   // Flow Timer Scheduler
   std::shared_ptr<TimerDrivenSchedulingAgent> timer_scheduler_;
   // Flow Event Scheduler
@@ -58,6 +58,11 @@ class FlowFileRecord : public core::FlowFile {
  public:
   FlowFileRecord();
 
+  /**
+   * Serializes the record in the compact format: integers are varint encoded, well-known attribute keys are
+   * replaced by their dictionary code and the content is referenced by its claim id relative to the storage
+   * path of the content repository when possible.
+   */
   bool Serialize(io::OutputStream &outStream);
 
   //! Serialize and Persistent to the repository
@@ -67,7 +72,7 @@ class FlowFileRecord : public core::FlowFile {
     io::BufferStream inStream{buffer, gsl::narrow<unsigned int>(bufferSize)};
     return DeSerialize(inStream, content_repo, container);
   }
-  //! DeSerialize
+  //! DeSerialize, accepts both the compact and the original record format
   static std::shared_ptr<FlowFileRecord> DeSerialize(io::InputStream &stream, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier& container);
   //! DeSerialize
   static std::shared_ptr<FlowFileRecord> DeSerialize(const std::string& key, const std::shared_ptr<core::Repository>& flowRepository,
@@ -82,6 +87,10 @@ class FlowFileRecord : public core::FlowFile {
   static std::atomic<uint64_t> local_flow_seq_number_;
 
  private:
+  static std::shared_ptr<FlowFileRecord> DeSerializeCompact(io::InputStream &stream, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier& container);
+  static std::shared_ptr<FlowFileRecord> DeSerializeOriginal(uint8_t first_byte, io::InputStream &stream, const std::shared_ptr<core::ContentRepository> &content_repo,
+      utils::Identifier& container);
+
   static std::shared_ptr<logging::Logger> logger_;
 };
 
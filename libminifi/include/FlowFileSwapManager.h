@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ContentRepository.h"
+#include "core/FlowFile.h"
+#include "core/logging/Logger.h"
+#include "utils/OptionalUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+/**
+ * Location and summary of a batch of FlowFiles that were swapped out to disk.
+ */
+struct SwapLocation {
+  std::string path;
+  size_t count = 0;
+  uint64_t data_size = 0;
+};
+
+/**
+ * Serializes batches of queued FlowFiles into swap files, so that they do not have to be kept in memory,
+ * and restores them when the queue drains. The swap file holds a reference to the resource claims of
+ * the swapped out FlowFiles, so their content is kept alive while they are on disk.
+ *
+ * Swap files do not survive restarts: the FlowFiles are recovered from the FlowFile repository instead.
+ */
+class FlowFileSwapManager {
+ public:
+  FlowFileSwapManager(std::string swap_directory, std::shared_ptr<core::ContentRepository> content_repo);
+
+  /**
+   * Writes the FlowFiles into a new swap file.
+   * @return the location of the swap file, or nullopt if it could not be written, in which case the caller still owns the FlowFiles
+   */
+  utils::optional<SwapLocation> swapOut(const std::string& queue_id, const std::vector<std::shared_ptr<core::FlowFile>>& flow_files);
+
+  /**
+   * Reads back the FlowFiles of the swap file and deletes it.
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> swapIn(const SwapLocation& location);
+
+  /**
+   * Removes the swap files left behind by a previous run.
+   */
+  void removeStaleSwapFiles();
+
+ private:
+  static constexpr uint32_t SWAP_FILE_VERSION = 1;
+
+  std::string swap_directory_;
+  std::shared_ptr<core::ContentRepository> content_repo_;
+  std::atomic<uint64_t> swap_file_counter_;
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -78,6 +78,13 @@ class ResourceClaim {
     return _contentFullPath;
   }
 
+  /**
+   * @return the storage path of the repository managing this claim, or an empty string if it has none
+   */
+  std::string getStoragePath() const {
+    return claim_manager_ ? claim_manager_->getStoragePath() : "";
+  }
+
   bool exists() {
     if (claim_manager_ == nullptr) {
       return false;
@@ -46,6 +46,7 @@
 
 #define SCHEDULING_WATCHDOG_CHECK_PERIOD_MS 1000  // msec
 #define SCHEDULING_WATCHDOG_DEFAULT_ALERT_PERIOD_MS 5000  // msec
+#define SCHEDULING_DEFAULT_MAX_WAIT_FOR_WORK_MS 1000  // msec
 
 namespace org {
 namespace apache {
@@ -63,6 +64,7 @@ class SchedulingAgent {
                   std::shared_ptr<core::ContentRepository> content_repo, std::shared_ptr<Configure> configuration, utils::ThreadPool<utils::TaskRescheduleInfo> &thread_pool)
       : admin_yield_duration_(),
         bored_yield_duration_(0),
+        max_wait_for_work_(SCHEDULING_DEFAULT_MAX_WAIT_FOR_WORK_MS),
         configure_(configuration),
         content_repo_(content_repo),
         thread_pool_(thread_pool),
@@ -111,11 +113,24 @@ class SchedulingAgent {
   virtual void schedule(std::shared_ptr<core::Processor> processor) = 0;
   // unschedule, overwritten by different DrivenSchedulingAgent
   virtual void unschedule(std::shared_ptr<core::Processor> processor) = 0;
+  // changes the number of concurrent tasks of the processor, while it is running too
+  virtual void setMaxConcurrentTasks(const std::shared_ptr<core::Processor> &processor, uint8_t tasks) {
+    processor->setMaxConcurrentTasks(tasks);
+  }
 
   SchedulingAgent(const SchedulingAgent &parent) = delete;
   SchedulingAgent &operator=(const SchedulingAgent &parent) = delete;
 
  protected:
+  /**
+   * Reschedules the task once new work is queued for its processor, or after max_wait_for_work_ at the latest.
+   * The scheduling agent registers the work notification callback of the processors with incoming connections
+   * and of those that notify work of their own, see Processor::notifiesOwnWork().
+   */
+  utils::TaskRescheduleInfo waitForWork() const {
+    return utils::TaskRescheduleInfo::RetryOnWork(std::chrono::milliseconds(max_wait_for_work_.load()));
+  }
+
   // Mutex for protection
   std::mutex mutex_;
   // Whether it is running
@@ -124,6 +139,8 @@ class SchedulingAgent {
   int64_t admin_yield_duration_;
   // BoredYieldDuration
   int64_t bored_yield_duration_;
+  // longest time a task waiting for work is parked without being notified, in milliseconds
+  std::atomic<int64_t> max_wait_for_work_;
 
   std::shared_ptr<Configure> configure_;
 
@@ -20,10 +20,12 @@
 #ifndef LIBMINIFI_INCLUDE_THREADEDSCHEDULINGAGENT_H_
 #define LIBMINIFI_INCLUDE_THREADEDSCHEDULINGAGENT_H_
 
+#include <atomic>
+#include <map>
 #include <memory>
-#include <set>
 #include <string>
 #include <chrono>
+#include <vector>
 #include "properties/Configure.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Processor.h"
@@ -65,6 +67,8 @@ class ThreadedSchedulingAgent : public SchedulingAgent {
   virtual void schedule(std::shared_ptr<core::Processor> processor);
   // unschedule, overwritten by different DrivenTimerDrivenSchedulingAgent
   virtual void unschedule(std::shared_ptr<core::Processor> processor);
+  // submits or retires tasks of a running processor, the others keep running
+  void setMaxConcurrentTasks(const std::shared_ptr<core::Processor> &processor, uint8_t tasks) override;
 
   virtual void stop();
 
@@ -73,9 +77,19 @@ class ThreadedSchedulingAgent : public SchedulingAgent {
   // Only support pass by reference or pointer
   ThreadedSchedulingAgent(const ThreadedSchedulingAgent &parent);
   ThreadedSchedulingAgent &operator=(const ThreadedSchedulingAgent &parent);
+  struct RunningProcessor {
+    std::shared_ptr<core::ProcessContext> process_context;
+    std::shared_ptr<core::ProcessSessionFactory> session_factory;
+    // one flag per task submitted to the thread pool, a task finishes once its flag is cleared
+    std::vector<std::shared_ptr<std::atomic<bool>>> task_slots;
+  };
+
+  // submits one more task of the processor to the thread pool
+  void submitTask(const std::shared_ptr<core::Processor> &processor, RunningProcessor &running_processor);
+
   std::shared_ptr<logging::Logger> logger_;
 
-  std::set<utils::Identifier> processors_running_;  // Set just for easy usage
+  std::map<utils::Identifier, RunningProcessor> processors_running_;
 };
 
 }  // namespace minifi
@@ -35,6 +35,7 @@ class ClassDescription {
       : class_name_(name),
         dynamic_properties_(false),
         dynamic_relationships_(false),
+        supports_batching_(false),
         is_controller_service_(false) {
   }
   explicit ClassDescription(std::string name, std::map<std::string, core::Property> props, bool dyn_prop)
@@ -42,6 +43,7 @@ class ClassDescription {
         class_properties_(props),
         dynamic_properties_(dyn_prop),
         dynamic_relationships_(false),
+        supports_batching_(false),
         is_controller_service_(false) {
   }
   explicit ClassDescription(std::string name, std::map<std::string, core::Property> props, std::vector<core::Relationship> class_relationships, bool dyn_prop, bool dyn_rel)
@@ -50,6 +52,7 @@ class ClassDescription {
         class_relationships_(class_relationships),
         dynamic_properties_(dyn_prop),
         dynamic_relationships_(dyn_rel),
+        supports_batching_(false),
         is_controller_service_(false) {
   }
   std::string class_name_;
@@ -57,6 +60,8 @@ class ClassDescription {
   std::vector<core::Relationship> class_relationships_;
   bool dynamic_properties_;
   bool dynamic_relationships_;
+  // whether the processor may run several triggers in a session over its run duration
+  bool supports_batching_;
 
   bool is_controller_service_;
 };
@@ -148,6 +153,7 @@ class BuildDescription {
           description.dynamic_relationships_ = component->supportsDynamicRelationships();
           if (is_processor) {
             description.class_relationships_ = processor->getSupportedRelationships();
+            description.supports_batching_ = processor->supportsBatching();
             class_mappings[group].processors_.emplace_back(description);
           } else if (is_controller_service) {
             class_mappings[group].controller_services_.emplace_back(description);
@@ -153,11 +153,21 @@ class C2Agent : public state::UpdateController {
    */
   bool update_property(const std::string &property_name, const std::string &property_value,  bool persist);
 
+  /**
+   * Changes the number of concurrent tasks of the processors with the given name while they are running
+   */
+  bool update_concurrency(const std::string &processor_name, const std::string &tasks);
+
   /**
    * Creates configuration options C2 payload for response
    */
   C2Payload prepareConfigurationOptions(const C2ContentResponse &resp) const;
 
+  /**
+   * Runs the provenance query described by the arguments of the request and creates the C2 payload of the events found
+   */
+  C2Payload prepareProvenanceEvents(const C2ContentResponse &resp, const state::response::NodeReporter &reporter) const;
+
  private:
   utils::TaskRescheduleInfo produce();
   utils::TaskRescheduleInfo consume();
@@ -54,6 +54,8 @@ class C2Client : public core::Flow, public state::response::NodeReporter {
 
   std::vector<std::shared_ptr<state::response::ResponseNode>> getHeartbeatNodes(bool include_manifest) const override;
 
+  utils::optional<std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>>> queryProvenance(const provenance::ProvenanceQuery& query) const override;
+
   void stopC2();
 
  protected:
@@ -0,0 +1,156 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Processor.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Base of the processors which wait for I/O (e.g. network requests) without blocking a scheduler thread.
+ *
+ * onTriggerAsync() starts operations with startOperation() and returns, the session stays open until all of its operations
+ * have completed. The I/O completes each operation from any thread (e.g. an event loop) with a continuation, which runs on a
+ * scheduler thread the next time the processor is triggered; completing an operation notifies the scheduling agent of the work.
+ * This way a single thread can keep many operations in flight. The session is committed once the last continuation of it has
+ * run, or rolled back if onTriggerAsync or any of its continuations threw.
+ *
+ * onTriggerAsync and the continuations of the same session never run concurrently, continuations may start further operations.
+ */
+class AsyncProcessor : public Processor {
+ private:
+  struct SessionState;
+  struct OperationState;
+  class CompletionQueue;
+
+ public:
+  /**
+   * Handle of an operation started by startOperation(), to be copied into the completion handler of the I/O.
+   * If every copy of it is destroyed without completing it, the operation fails its session.
+   */
+  class Operation {
+   public:
+    /**
+     * Completes the operation, thread-safe. Only the first call has effect.
+     * @param continuation processes the result of the operation with exclusive access to its session, on a scheduler thread
+     */
+    void complete(std::function<void()> continuation) const;
+
+   private:
+    friend class AsyncProcessor;
+    explicit Operation(std::shared_ptr<OperationState> state);
+
+    std::shared_ptr<OperationState> state_;
+  };
+
+  AsyncProcessor(const std::string& name, const utils::Identifier& uuid);
+  explicit AsyncProcessor(const std::string& name);
+  ~AsyncProcessor() override;
+
+  using Processor::onTrigger;
+
+  /**
+   * Runs the continuations of the completed operations, then calls onTriggerAsync with a new session
+   * unless the maximum number of sessions in flight is reached.
+   */
+  void onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSessionFactory> &sessionFactory) override;
+
+  /**
+   * Synchronous trigger on a session committed by the caller: runs onTriggerAsync, then waits for the operations
+   * started on the session, running their continuations on the calling thread. Rethrows the first exception
+   * of onTriggerAsync or the continuations.
+   */
+  void onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSession> &session) override;
+
+  // whether there are continuations to run, or a session can be started and there is input for it
+  bool isWorkAvailable() override;
+
+  bool notifiesOwnWork() const override {
+    return true;
+  }
+
+  size_t getSessionsInFlight() const;
+
+  size_t getMaxSessionsInFlight() const {
+    return max_sessions_in_flight_;
+  }
+
+  void setMaxSessionsInFlight(size_t max_sessions) {
+    max_sessions_in_flight_ = (std::max)(max_sessions, size_t{1});
+  }
+
+ protected:
+  // Starts the operations of a trigger, implemented by the asynchronous processors instead of onTrigger
+  virtual void onTriggerAsync(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSession> &session) = 0;
+
+  /**
+   * Starts an operation on session, which stays open until the operation is completed.
+   * Must be called from onTriggerAsync or from a continuation of session.
+   */
+  Operation startOperation(const std::shared_ptr<ProcessSession> &session);
+
+  /**
+   * Runs the continuations of the completed operations, then rolls back the sessions which still have operations in flight,
+   * the later completions of those are discarded. Called from notifyStop() by the processors after cancelling their I/O.
+   */
+  void closeSessionsInFlight();
+
+ private:
+  struct Completion {
+    std::shared_ptr<SessionState> session;
+    std::function<void()> continuation;  // empty if the operation was abandoned
+  };
+
+  void registerSession(const std::shared_ptr<SessionState> &state);
+  void runCompletions();
+  // runs the continuation of completion, returns whether it was the last operation of its session
+  bool runContinuation(const Completion &completion);
+  // commits the session, or rolls it back if it failed
+  void finishSession(const std::shared_ptr<SessionState> &state);
+  void rollbackSessionsInFlight();
+
+  std::atomic<size_t> max_sessions_in_flight_{1};
+
+  // the completions of the sessions created by onTrigger(context, sessionFactory)
+  std::shared_ptr<CompletionQueue> completions_;
+
+  mutable std::mutex sessions_mutex_;
+  std::unordered_map<const ProcessSession*, std::shared_ptr<SessionState>> sessions_in_flight_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
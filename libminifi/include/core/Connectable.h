@@ -19,6 +19,7 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_CONNECTABLE_H_
 #define LIBMINIFI_INCLUDE_CORE_CONNECTABLE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -91,6 +92,13 @@ class Connectable : public CoreComponent {
     put(file);
   }
 
+  // restores the FlowFiles recovered from the repository at once
+  virtual void restoreBatch(const std::vector<std::shared_ptr<FlowFile>>& files) {
+    for (const auto& file : files) {
+      restore(file);
+    }
+  }
+
   /**
    * Gets and sets next incoming connection
    * @return next incoming connection
@@ -136,6 +144,12 @@ class Connectable : public CoreComponent {
 
   void notifyWork();
 
+  /**
+   * Sets the function called by notifyWork, used by the scheduling agent to wake up the tasks of this
+   * connectable that wait for work. An empty function removes the callback.
+   */
+  void setWorkNotificationCallback(std::function<void()> callback);
+
   /**
    * Determines if work is available by this connectable
    * @return boolean if work is available.
@@ -190,6 +204,8 @@ class Connectable : public CoreComponent {
   std::atomic<SchedulingStrategy> strategy_;
   // Concurrent condition variable for whether there is incoming work to do
   std::condition_variable work_condition_;
+  // called by notifyWork, replaced atomically as it is called from the threads of the upstream connectables
+  std::shared_ptr<const std::function<void()>> work_notification_callback_;
   // version under which this connectable was created.
   std::shared_ptr<state::FlowIdentifier> connectable_version_;
 
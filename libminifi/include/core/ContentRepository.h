@@ -58,6 +58,13 @@ class ContentRepository : public StreamManager<minifi::ResourceClaim>, public ut
    */
   virtual void stop() = 0;
 
+  /**
+   * Called once the FlowFiles persisted by the previous run have been restored, so that the content
+   * left behind by that run which is not referenced by any of them can be deleted.
+   */
+  virtual void clearOrphans() {
+  }
+
   void reset();
 
   virtual uint32_t getStreamCount(const minifi::ResourceClaim &streamId);
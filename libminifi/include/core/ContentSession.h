@@ -40,15 +40,31 @@ class ContentSession {
 
   explicit ContentSession(std::shared_ptr<ContentRepository> repository);
 
-  std::shared_ptr<ResourceClaim> create();
+  virtual std::shared_ptr<ResourceClaim> create();
 
-  std::shared_ptr<io::BaseStream> write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode = WriteMode::OVERWRITE);
+  virtual std::shared_ptr<io::BaseStream> write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode = WriteMode::OVERWRITE);
 
-  std::shared_ptr<io::BaseStream> read(const std::shared_ptr<ResourceClaim>& resourceId);
+  virtual std::shared_ptr<io::BaseStream> read(const std::shared_ptr<ResourceClaim>& resourceId);
+
+  /**
+   * Offset of the content written to an owned resource within the stream of the claim.
+   * Repositories storing every resource in a stream of its own always write from offset 0.
+   */
+  virtual uint64_t getWriteOffset(const std::shared_ptr<ResourceClaim>& /*resourceId*/) const {
+    return 0;
+  }
+
+  /**
+   * Whether the content of the resource can be extended in place using WriteMode::APPEND.
+   * If not, the content has to be copied to a new resource to append to it.
+   */
+  virtual bool canAppend(const std::shared_ptr<ResourceClaim>& /*resourceId*/) const {
+    return true;
+  }
 
   virtual void commit();
 
-  void rollback();
+  virtual void rollback();
 
   virtual ~ContentSession() = default;
 
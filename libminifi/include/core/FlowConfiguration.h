@@ -25,6 +25,7 @@
 
 #include "core/Core.h"
 #include "Connection.h"
+#include "FlowFileSwapManager.h"
 #include "RemoteProcessorGroupPort.h"
 #include "core/controller/ControllerServiceNode.h"
 #include "core/controller/StandardControllerServiceProvider.h"
@@ -125,6 +126,11 @@ class FlowConfiguration : public CoreComponent {
     return configuration_;
   }
 
+  // Get the swap manager shared by the connections of the flow, creating it on first use
+  std::shared_ptr<FlowFileSwapManager> getSwapManager();
+  // Get the default swap threshold of connections, 0 if swapping is disabled
+  uint64_t getDefaultSwapThreshold();
+
   bool persist(const std::string& configuration);
 
   /**
@@ -189,6 +195,8 @@ class FlowConfiguration : public CoreComponent {
   std::shared_ptr<utils::file::FileSystem> filesystem_;
 
  private:
+  std::shared_ptr<FlowFileSwapManager> swap_manager_;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -241,12 +241,21 @@ class FlowFile : public CoreComponent, public ReferenceContainer {
 
   void setStoredToRepository(bool storedInRepository) {
     stored = storedInRepository;
+    stored_claim_ = storedInRepository ? claim_ : nullptr;
   }
 
   bool isStored() const {
     return stored;
   }
 
+  /**
+   * Returns the claim referenced by the record of this flow file in the repository, which
+   * the repository releases once the record is deleted.
+   */
+  std::shared_ptr<ResourceClaim> getStoredResourceClaim() const {
+    return stored_claim_;
+  }
+
  protected:
   bool stored;
   // Mark for deletion
@@ -272,6 +281,8 @@ class FlowFile : public CoreComponent, public ReferenceContainer {
   AttributeMap attributes_;
   // Pointer to the associated content resource claim
   std::shared_ptr<ResourceClaim> claim_;
+  // the claim of the record persisted in the repository, which can differ from claim_ while the content is being modified
+  std::shared_ptr<ResourceClaim> stored_claim_;
   // Pointers to stashed content resource claims
   utils::FlatMap<std::string, std::shared_ptr<ResourceClaim>> stashedContent_;
   // UUID string
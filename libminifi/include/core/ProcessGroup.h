@@ -187,6 +187,11 @@ class ProcessGroup : public CoreComponent {
   void addProcessGroup(std::unique_ptr<ProcessGroup> child);
   // ! Add connections
   void addConnection(const std::shared_ptr<Connection>& connection);
+  /**
+   * Sets the provenance sampler of the processors of this group and of the child groups without a sampler of their own.
+   * A null sampler keeps every provenance event, also overriding a sampler inherited from the parent group.
+   */
+  void setProvenanceSampler(std::shared_ptr<provenance::ProvenanceSampler> sampler);
   // Generic find
   template <typename Fun>
   std::shared_ptr<Processor> findProcessor(Fun condition, Traverse traverse) const {
@@ -275,6 +280,12 @@ class ProcessGroup : public CoreComponent {
   core::controller::ControllerServiceMap controller_service_map_;
 
  private:
+  // passes the sampler to the processors and to the child groups inheriting it, must hold mutex_
+  void applyProvenanceSampler(const std::shared_ptr<provenance::ProvenanceSampler>& sampler);
+
+  // whether the provenance mode was configured on this group rather than inherited
+  bool has_own_provenance_sampler_ = false;
+  std::shared_ptr<provenance::ProvenanceSampler> provenance_sampler_;
   // Mutex for protection
   mutable std::recursive_mutex mutex_;
   // Logger
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <algorithm>
 #include <set>
+#include <limits>
 
 #include "ProcessContext.h"
 #include "FlowFileRecord.h"
@@ -35,6 +36,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Deprecated.h"
 #include "FlowFile.h"
+#include "io/ContentView.h"
 #include "WeakReference.h"
 #include "provenance/Provenance.h"
 
@@ -47,18 +49,19 @@ namespace core {
 // ProcessSession Class
 class ProcessSession : public ReferenceContainer {
  public:
+  // FlowFiles consumed from the incoming connections and transferred to the outgoing ones by the committed transactions
+  struct TransferStatistics {
+    uint64_t flow_files_in = 0;
+    uint64_t bytes_in = 0;
+    uint64_t flow_files_out = 0;
+    uint64_t bytes_out = 0;
+  };
+
   // Constructor
   /*!
    * Create a new process session
    */
-  ProcessSession(std::shared_ptr<ProcessContext> processContext = nullptr) // NOLINT
-      : process_context_(std::move(processContext)),
-        logger_(logging::LoggerFactory<ProcessSession>::getLogger()) {
-    logger_->log_trace("ProcessSession created for %s", process_context_->getProcessorNode()->getName());
-    auto repo = process_context_->getProvenanceRepository();
-    provenance_report_ = std::make_shared<provenance::ProvenanceReporter>(repo, process_context_->getProcessorNode()->getName(), process_context_->getProcessorNode()->getName());
-    content_session_ = process_context_->getContentRepository()->createSession();
-  }
+  ProcessSession(std::shared_ptr<ProcessContext> processContext = nullptr); // NOLINT
 
   // Destructor
   virtual ~ProcessSession();
@@ -74,8 +77,26 @@ class ProcessSession : public ReferenceContainer {
   // writes the created contents to the underlying repository
   void flushContent();
 
+  const TransferStatistics& getTransferStatistics() const {
+    return transfer_statistics_;
+  }
+
+  // Number of FlowFiles taken from the incoming connections or created since the last commit or rollback
+  size_t getFlowFileCount() const {
+    return _updatedFlowFiles.size() + _addedFlowFiles.size();
+  }
+
   // Get the FlowFile from the highest priority queue
   virtual std::shared_ptr<core::FlowFile> get();
+  /**
+   * Gets a batch of FlowFiles, visiting each incoming connection at most once.
+   * Polling stops when max_count FlowFiles have been collected or their total size reaches max_bytes,
+   * so the FlowFile crossing the byte budget is still included in the batch.
+   * @param max_count maximum number of FlowFiles to get
+   * @param max_bytes target total content size of the batch
+   * @return the FlowFiles, possibly empty
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> get(size_t max_count, uint64_t max_bytes = std::numeric_limits<uint64_t>::max());
   // Create a new UUID FlowFile with no content resource claim and inherit all attributes from parent
   std::shared_ptr<core::FlowFile> create(const std::shared_ptr<core::FlowFile> &parent = {});
   // Add a FlowFile to the session
@@ -94,6 +115,12 @@ class ProcessSession : public ReferenceContainer {
   void remove(const std::shared_ptr<core::FlowFile> &flow);
   // Execute the given read callback against the content
   int read(const std::shared_ptr<core::FlowFile> &flow, InputStreamCallback *callback);
+  // Returns at most max_size bytes of the content as a read-only view: file backed content is memory mapped, other content is read into a buffer
+  std::shared_ptr<io::ContentView> readView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size = std::numeric_limits<uint64_t>::max());
+  // Returns at most max_size bytes of the content memory mapped, or nullptr if the content cannot be mapped, e.g. it is not in a file
+  std::shared_ptr<io::ContentView> mapView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size = std::numeric_limits<uint64_t>::max());
+  // Reads the whole content into a buffer
+  std::vector<uint8_t> readBuffer(const std::shared_ptr<core::FlowFile> &flow);
   // Execute the given write callback against the content
   void write(const std::shared_ptr<core::FlowFile> &flow, OutputStreamCallback *callback);
   // Execute the given write/append callback against the content
@@ -167,6 +194,13 @@ class ProcessSession : public ReferenceContainer {
 
   RouteResult routeFlowFile(const std::shared_ptr<FlowFile>& record);
 
+  // Report and remove the FlowFiles that expired while they were queued
+  void removeExpired(const std::set<std::shared_ptr<core::FlowFile>>& expired);
+  // Add a polled FlowFile to the session, taking a snapshot for rollback
+  void addPolled(const std::shared_ptr<core::FlowFile>& flow_file);
+  // Maps the content, or reads it into a buffer if it cannot be mapped and copy_unmapped is set
+  std::shared_ptr<io::ContentView> readView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size, bool copy_unmapped);
+
   void persistFlowFilesBeforeTransfer(
       std::map<std::shared_ptr<Connectable>, std::vector<std::shared_ptr<core::FlowFile>>>& transactionMap,
       const std::map<utils::Identifier, FlowFileUpdate>& modifiedFlowFiles);
@@ -185,6 +219,8 @@ class ProcessSession : public ReferenceContainer {
 
   std::shared_ptr<ContentSession> content_session_;
 
+  TransferStatistics transfer_statistics_;
+
   static std::shared_ptr<utils::IdGenerator> id_generator_;
 };
 
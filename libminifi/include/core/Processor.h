@@ -32,6 +32,7 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <utility>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -44,6 +45,7 @@
 #include "ProcessContext.h"
 #include "ProcessSession.h"
 #include "ProcessSessionFactory.h"
+#include "ProcessorStatistics.h"
 #include "Property.h"
 #include "Relationship.h"
 #include "Scheduling.h"
@@ -53,6 +55,9 @@ namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
+namespace provenance {
+class ProvenanceSampler;
+}  // namespace provenance
 namespace core {
 
 // Minimum scheduling period in Nano Second
@@ -129,6 +134,14 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   uint64_t getRunDurationNano() const {
     return (run_duration_nano_);
   }
+  // Set the maximum number of FlowFiles in a session batched over the run duration, 0 for no limit
+  void setMaxBatchSize(uint64_t size) {
+    max_batch_size_ = size;
+  }
+  // Get the maximum number of FlowFiles in a session batched over the run duration
+  uint64_t getMaxBatchSize() const {
+    return max_batch_size_;
+  }
   // Set Processor yield period in MilliSecond
   void setYieldPeriodMsec(uint64_t period) {
     yield_period_msec_ = period;
@@ -204,6 +217,23 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   // Whether flow file queue full in any of the outgoin connection
   bool flowFilesOutGoingFull() const;
 
+  // Performance statistics of the triggers and sessions of this processor
+  ProcessorStatistics& getStatistics() {
+    return statistics_;
+  }
+  const ProcessorStatistics& getStatistics() const {
+    return statistics_;
+  }
+
+  // the sampler deciding which provenance events of the sessions are kept, null if every event is kept
+  void setProvenanceSampler(std::shared_ptr<provenance::ProvenanceSampler> sampler) {
+    std::atomic_store(&provenance_sampler_, std::move(sampler));
+  }
+
+  std::shared_ptr<provenance::ProvenanceSampler> getProvenanceSampler() const {
+    return std::atomic_load(&provenance_sampler_);
+  }
+
   bool addConnection(std::shared_ptr<Connectable> connection);
   void removeConnection(std::shared_ptr<Connectable> connection);
 
@@ -239,6 +269,22 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   // Check all incoming connections for work
   bool isWorkAvailable() override;
 
+  /**
+   * Whether isWorkAvailable() and notifyWork() also account for work of the processor itself, e.g. completed
+   * asynchronous operations, so that the scheduling agent relies on them even without incoming connections
+   */
+  virtual bool notifiesOwnWork() const {
+    return false;
+  }
+
+  /**
+   * Whether onTrigger may be called repeatedly on the same session for up to the run duration before it is committed.
+   * Only processors that neither commit nor keep references to their session between calls may opt in.
+   */
+  virtual bool supportsBatching() const {
+    return false;
+  }
+
   void setStreamFactory(std::shared_ptr<minifi::io::StreamFactory> stream_factory) {
     stream_factory_ = stream_factory;
   }
@@ -266,6 +312,8 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   std::atomic<uint64_t> scheduling_period_nano_;
   // Run Duration in Nano Seconds
   std::atomic<uint64_t> run_duration_nano_;
+  // Maximum number of FlowFiles batched in a session over the run duration, 0 for no limit
+  std::atomic<uint64_t> max_batch_size_;
   // Yield Period in Milliseconds
   std::atomic<uint64_t> yield_period_msec_;
 
@@ -276,12 +324,22 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
 
   std::string cron_period_;
 
+  // commits the session of onTrigger, recording its duration and transfers in statistics_
+  void commitAndRecordStatistics(ProcessSession& session);
+
  private:
+  // whether onTrigger should be called again on the session of a batch started at batch_start
+  bool continueBatch(const ProcessSession& session, std::chrono::steady_clock::time_point batch_start, size_t flow_files_before_trigger);
+
   // Mutex for protection
   mutable std::mutex mutex_;
   // Yield Expiration
   std::atomic<uint64_t> yield_expiration_;
 
+  ProcessorStatistics statistics_;
+
+  std::shared_ptr<provenance::ProvenanceSampler> provenance_sampler_;
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   Processor(const Processor &parent);
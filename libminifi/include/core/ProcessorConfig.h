@@ -34,6 +34,7 @@ namespace core {
 #define DEFAULT_SCHEDULING_PERIOD_STR "1 sec"
 #define DEFAULT_SCHEDULING_PERIOD_MILLIS 1000
 #define DEFAULT_RUN_DURATION 0
+#define DEFAULT_MAX_BATCH_SIZE 0
 #define DEFAULT_MAX_CONCURRENT_TASKS 1
 #define DEFAULT_YIELD_PERIOD_SECONDS 1
 constexpr std::chrono::seconds DEFAULT_PENALIZATION_PERIOD{30};
@@ -48,6 +49,7 @@ struct ProcessorConfig {
   std::string penalizationPeriod;
   std::string yieldPeriod;
   std::string runDurationNanos;
+  std::string maxBatchSize;
   std::vector<std::string> autoTerminatedRelationships;
   std::vector<core::Property> properties;
 };
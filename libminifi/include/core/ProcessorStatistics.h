@@ -0,0 +1,95 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "utils/LogLinearHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Performance statistics of a processor: the distribution of its onTrigger and session commit durations,
+ * the CPU time of its triggers and the FlowFiles it consumed and produced.
+ *
+ * Samples are recorded into one of a few slots chosen by the recording thread, using relaxed atomic
+ * operations only, so concurrent tasks of the processor neither lock nor keep writing the same counters.
+ * The slots are summed when a snapshot is taken.
+ */
+class ProcessorStatistics {
+ public:
+  struct Snapshot {
+    uint64_t triggers = 0;
+    uint64_t commits = 0;
+    std::chrono::nanoseconds cpu_time{0};
+    uint64_t flow_files_in = 0;
+    uint64_t bytes_in = 0;
+    uint64_t flow_files_out = 0;
+    uint64_t bytes_out = 0;
+    // in microseconds
+    utils::LogLinearHistogram::Snapshot trigger_duration;
+    // in microseconds
+    utils::LogLinearHistogram::Snapshot commit_duration;
+  };
+
+  ProcessorStatistics() = default;
+  ProcessorStatistics(const ProcessorStatistics&) = delete;
+  ProcessorStatistics& operator=(const ProcessorStatistics&) = delete;
+
+  /**
+   * Records a call of onTrigger, measured by the scheduling agent.
+   * @param cpu_time CPU time used by the thread during the call
+   */
+  void recordTrigger(std::chrono::nanoseconds duration, std::chrono::nanoseconds cpu_time);
+
+  /**
+   * Records a committed session.
+   */
+  void recordCommit(std::chrono::nanoseconds duration, uint64_t flow_files_in, uint64_t bytes_in, uint64_t flow_files_out, uint64_t bytes_out);
+
+  Snapshot getSnapshot() const;
+
+ private:
+  static constexpr size_t SLOT_COUNT = 4;
+
+  struct Slot {
+    utils::LogLinearHistogram trigger_duration;
+    utils::LogLinearHistogram commit_duration;
+    std::atomic<uint64_t> cpu_time_ns{0};
+    std::atomic<uint64_t> flow_files_in{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> flow_files_out{0};
+    std::atomic<uint64_t> bytes_out{0};
+  };
+
+  static size_t currentThreadSlot();
+
+  std::array<Slot, SLOT_COUNT> slots_;
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
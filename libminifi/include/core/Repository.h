@@ -43,6 +43,7 @@
 #include "core/Connectable.h"
 #include "core/TraceableResource.h"
 #include "utils/BackTrace.h"
+#include "utils/OptionalUtils.h"
 
 #ifndef WIN32
 #include <sys/stat.h>
@@ -108,6 +109,14 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
     return true;
   }
 
+  /**
+   * Deletes the record of a flow file, releasing its reference to the claim once the record is deleted,
+   * so that repositories do not need to read the record back to find its claim.
+   */
+  virtual bool Delete(const std::string& key, const std::shared_ptr<ResourceClaim>& /*claim*/) {
+    return Delete(key);
+  }
+
   virtual bool Delete(std::vector<std::shared_ptr<core::SerializableComponent>> &storedValues) {
     bool found = true;
     for (auto storedValue : storedValues) {
@@ -229,6 +238,13 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
 
   virtual uint64_t getRepoSize();
 
+  /**
+   * @return the bytes of memory held by the repository's database, nothing if the repository doesn't track it
+   */
+  virtual utils::optional<uint64_t> getMemoryUsage() {
+    return utils::nullopt;
+  }
+
   std::string getDirectory() const {
     return directory_;
   }
@@ -0,0 +1,105 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/ContentSession.h"
+#include "io/BaseStream.h"
+#include "io/FileStreamFactory.h"
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * ContentSession that writes the content into staging files on disk instead of buffering it in memory,
+ * so the memory used by a session does not depend on the size of the content it writes.
+ * On commit the staging files are published into the repository, on rollback they are deleted.
+ * The staging files are opened through the file stream factory, so they use the configured stream implementation and durability.
+ * The session keeps the streams it hands out until commit, where they are flushed, so that content the streams failed
+ * to store fails the commit instead of being published truncated.
+ */
+class StreamingContentSession : public ContentSession {
+ public:
+  StreamingContentSession(std::shared_ptr<ContentRepository> repository, std::string staging_directory, io::FileStreamFactory file_streams = io::FileStreamFactory());
+
+  ~StreamingContentSession() override;
+
+  std::shared_ptr<ResourceClaim> create() override;
+
+  std::shared_ptr<io::BaseStream> write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode = WriteMode::OVERWRITE) override;
+
+  std::shared_ptr<io::BaseStream> read(const std::shared_ptr<ResourceClaim>& resourceId) override;
+
+  void commit() override;
+
+  void rollback() override;
+
+  static constexpr const char* STAGING_FILE_EXTENSION = ".staging";
+
+  /**
+   * Removes the staging files left behind by sessions that were interrupted by a shutdown.
+   */
+  static void removeStaleStagingFiles(const std::string& staging_directory);
+
+ protected:
+  /**
+   * Moves the content of the staging file into the resource. The staging file is deleted by the caller afterwards, if it still exists.
+   * The default implementation copies the staging file in fixed size chunks through ContentRepository::write.
+   */
+  virtual void publish(const ResourceClaim& claim, const std::string& staging_path, bool append);
+
+  /**
+   * Reverts a resource appended to by a failed commit to the size it had before the commit.
+   * The default implementation cannot revert the append and returns false.
+   */
+  virtual bool revertAppend(const ResourceClaim& claim, uint64_t original_size);
+
+  // copies the staging file into the stream in fixed size chunks, calling on_chunk after every chunk written
+  void copyStagingFile(const ResourceClaim& claim, const std::string& staging_path, io::BaseStream& output, const std::function<void()>& on_chunk = nullptr) const;
+
+  std::string createStagingFile();
+  // opens the staging file for writing and keeps the stream until the session is committed or rolled back
+  std::shared_ptr<io::BaseStream> openStagingFile(const std::string& path, bool append);
+  void removeStagingFiles();
+  uint64_t getContentSize(const ResourceClaim& claim) const;
+
+  std::string staging_directory_;
+  io::FileStreamFactory file_streams_;
+  std::map<std::shared_ptr<ResourceClaim>, std::string> stagedResources_;
+  std::map<std::shared_ptr<ResourceClaim>, std::string> stagedExtensions_;
+  std::vector<std::pair<std::string, std::shared_ptr<io::BaseStream>>> stagingStreams_;
+
+ private:
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -23,6 +23,8 @@
 
 #include "core/Core.h"
 #include "../ContentRepository.h"
+#include "core/StreamingContentSession.h"
+#include "io/FileStreamFactory.h"
 #include "properties/Configure.h"
 #include "core/logging/LoggerConfiguration.h"
 namespace org {
@@ -36,9 +38,40 @@ namespace repository {
  * FileSystemRepository is a content repository that stores data onto the local file system.
  */
 class FileSystemRepository : public core::ContentRepository, public core::CoreComponent {
+  class Session : public StreamingContentSession {
+   public:
+    Session(std::shared_ptr<ContentRepository> repository, std::string staging_directory, const io::FileStreamFactory& file_streams);
+
+   protected:
+    void publish(const minifi::ResourceClaim& claim, const std::string& staging_path, bool append) override;
+
+    bool revertAppend(const minifi::ResourceClaim& claim, uint64_t original_size) override;
+
+   private:
+    // the content files written by the session are synced when they are published, with the directory they are published to
+    bool isSyncOnPublish() const {
+      return file_streams_.getDurability() == io::FileStreamFactory::Durability::SYNC_ON_COMMIT;
+    }
+
+    bool isDurable() const {
+      return file_streams_.getDurability() != io::FileStreamFactory::Durability::NONE;
+    }
+  };
+
+  /**
+   * Buffering session that flushes the content files it wrote to the storage device on commit.
+   */
+  class SyncingSession : public ContentSession {
+   public:
+    using ContentSession::ContentSession;
+
+    void commit() override;
+  };
+
  public:
   FileSystemRepository(std::string name = getClassName<FileSystemRepository>()) // NOLINT
       : core::CoreComponent(name),
+        streaming_session_(false),
         logger_(logging::LoggerFactory<FileSystemRepository>::getLogger()) {
   }
   virtual ~FileSystemRepository() = default;
@@ -47,6 +80,8 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual void stop();
 
+  std::shared_ptr<ContentSession> createSession() override;
+
   bool exists(const minifi::ResourceClaim &streamId);
 
   virtual std::shared_ptr<io::BaseStream> write(const minifi::ResourceClaim &claim, bool append = false);
@@ -59,7 +94,13 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual bool remove(const minifi::ResourceClaim &claim);
 
+  io::FileStreamFactory::Durability getDurability() const {
+    return file_streams_.getDurability();
+  }
+
  private:
+  bool streaming_session_;
+  io::FileStreamFactory file_streams_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/ContentRepository.h"
+#include "core/ContentSession.h"
+#include "core/repository/FileSystemRepository.h"
+#include "io/BufferStream.h"
+#include "properties/Configure.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+/**
+ * Content repository keeping small claims in memory and the rest in a FileSystemRepository.
+ *
+ * When a session commits, the content of each claim up to the memory threshold is kept in memory as long as the
+ * memory budget allows it, anything larger or over budget is written to the file system. A claim has the same path in
+ * both tiers, so its content can migrate to the file system without changing the FlowFiles referring to it: this
+ * happens when appending makes the content too large for memory, when the content is opened for writing outside of a
+ * session, and when the repository is stopped. Content still in memory is lost if the agent terminates without stopping.
+ */
+class HybridContentRepository : public core::ContentRepository, public core::CoreComponent {
+  class Session : public ContentSession {
+   public:
+    explicit Session(std::shared_ptr<HybridContentRepository> repository);
+
+    void commit() override;
+
+   private:
+    std::shared_ptr<HybridContentRepository> hybrid_repository_;
+  };
+
+ public:
+  explicit HybridContentRepository(std::string name = getClassName<HybridContentRepository>());
+
+  ~HybridContentRepository() override;
+
+  bool initialize(const std::shared_ptr<minifi::Configure> &configuration) override;
+
+  /**
+   * Writes the content still in memory to the file system.
+   */
+  void stop() override;
+
+  std::shared_ptr<ContentSession> createSession() override;
+
+  bool exists(const minifi::ResourceClaim &streamId) override;
+
+  /**
+   * Writes outside of a session always go to the file system, the content in memory is moved there first when appending.
+   */
+  std::shared_ptr<io::BaseStream> write(const minifi::ResourceClaim &claim, bool append = false) override;
+
+  std::shared_ptr<io::BaseStream> read(const minifi::ResourceClaim &claim) override;
+
+  bool close(const minifi::ResourceClaim &claim) override {
+    return remove(claim);
+  }
+
+  bool remove(const minifi::ResourceClaim &claim) override;
+
+  bool isInMemory(const minifi::ResourceClaim &claim);
+
+  uint64_t getMemoryUsage();
+
+ private:
+  // keeps the content in memory if it is small enough and fits in the budget, replacing any previous content of the claim
+  bool storeInMemory(const minifi::ResourceClaim &claim, const std::shared_ptr<io::BufferStream> &content);
+  // appends to the content of the claim, moving it to the file system if it no longer fits in memory
+  // @return the path written on the file system, or an empty string if the content stayed in memory
+  std::string append(const minifi::ResourceClaim &claim, const io::BufferStream &extension);
+  void writeToDisk(const minifi::ResourceClaim &claim, const std::vector<const io::BufferStream*> &contents, bool append);
+  // writes the content of the claim to the file system and drops it from memory
+  void moveToDisk(const minifi::ResourceClaim &claim);
+  void eraseFromMemory(const std::string &path);
+  bool syncOnCommit() const;
+
+  uint64_t memory_threshold_;
+  uint64_t max_memory_size_;
+  std::shared_ptr<FileSystemRepository> disk_repository_;
+
+  std::mutex memory_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<io::BufferStream>> memory_content_;
+  uint64_t memory_size_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,175 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/ContentRepository.h"
+#include "core/ContentSession.h"
+#include "io/FileStreamFactory.h"
+#include "properties/Configure.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+/**
+ * Content repository that packs the content of many resource claims into large, append-only slab files.
+ *
+ * The claims of a slab share its path, the content of a FlowFile is located by the offset and size of the FlowFile.
+ * Each session writes into slabs it holds exclusively until it commits or rolls back; slabs with room left are then
+ * reused by later sessions, full ones are sealed. Slabs are reference counted through the claims pointing into them:
+ * once nothing refers to a sealed slab, a background thread deletes it, so removing a FlowFile does not touch the file system.
+ * Rolled back or overwritten content is not reused, it is reclaimed along with the rest of the slab.
+ * The slabs of the previous run are reclaimed once the FlowFiles referring to them have been restored.
+ */
+class SlabFileSystemRepository : public core::ContentRepository, public core::CoreComponent {
+  struct Slab {
+    explicit Slab(std::string slab_path);
+
+    const std::string path;
+    std::ofstream stream;
+    uint64_t size;
+  };
+
+  struct Region {
+    std::shared_ptr<Slab> slab;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  class RegionStream;
+
+  class Session : public ContentSession {
+   public:
+    explicit Session(std::shared_ptr<SlabFileSystemRepository> repository);
+
+    ~Session() override;
+
+    std::shared_ptr<ResourceClaim> create() override;
+
+    std::shared_ptr<io::BaseStream> write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode = WriteMode::OVERWRITE) override;
+
+    std::shared_ptr<io::BaseStream> read(const std::shared_ptr<ResourceClaim>& resourceId) override;
+
+    uint64_t getWriteOffset(const std::shared_ptr<ResourceClaim>& resourceId) const override;
+
+    bool canAppend(const std::shared_ptr<ResourceClaim>& resourceId) const override;
+
+    void commit() override;
+
+    void rollback() override;
+
+   private:
+    void releaseSlabs();
+
+    std::shared_ptr<SlabFileSystemRepository> slab_repository_;
+    std::vector<std::shared_ptr<Slab>> slabs_;
+    std::map<std::shared_ptr<ResourceClaim>, std::shared_ptr<Region>> regions_;
+  };
+
+ public:
+  static constexpr const char* SLAB_FILE_EXTENSION = ".slab";
+
+  explicit SlabFileSystemRepository(std::string name = getClassName<SlabFileSystemRepository>());
+
+  ~SlabFileSystemRepository() override;
+
+  bool initialize(const std::shared_ptr<minifi::Configure> &configuration) override;
+
+  void stop() override;
+
+  std::shared_ptr<ContentSession> createSession() override;
+
+  bool exists(const minifi::ResourceClaim &streamId) override;
+
+  /**
+   * Slabs can only be written through a session, this is only supported for claims of stand-alone files.
+   */
+  std::shared_ptr<io::BaseStream> write(const minifi::ResourceClaim &claim, bool append = false) override;
+
+  std::shared_ptr<io::BaseStream> read(const minifi::ResourceClaim &claim) override;
+
+  bool close(const minifi::ResourceClaim &claim) override {
+    return remove(claim);
+  }
+
+  bool remove(const minifi::ResourceClaim &claim) override;
+
+  /**
+   * Deletes the slabs that are no longer referenced. Called periodically by the reclaimer thread.
+   */
+  void reclaim();
+
+  /**
+   * Makes the slabs found at startup candidates for reclaiming, the ones not referenced by a restored FlowFile are deleted.
+   */
+  void clearOrphans() override;
+
+ private:
+  static bool isSlab(const std::string& path);
+
+  std::shared_ptr<Slab> acquireSlab();
+  void releaseSlab(const std::shared_ptr<Slab>& slab);
+  bool isReferenced(const std::string& path);
+  void deleteSlab(const std::string& path);
+  void runReclaimer();
+
+  uint64_t max_slab_size_;
+  std::chrono::milliseconds reclaim_period_;
+  io::FileStreamFactory file_streams_;
+
+  std::mutex slab_mutex_;
+  // slabs with room left that are not held by any session
+  std::deque<std::shared_ptr<Slab>> available_slabs_;
+  // paths of the slabs that are available or held by a session
+  std::set<std::string> writable_slabs_;
+
+  std::mutex reclaim_mutex_;
+  std::condition_variable reclaim_condition_;
+  std::set<std::string> reclaim_candidates_;
+  // slabs written by the previous run, only referenced through the FlowFiles restored from the FlowFile repository
+  std::set<std::string> startup_slabs_;
+  bool running_;
+  std::thread reclaim_thread_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
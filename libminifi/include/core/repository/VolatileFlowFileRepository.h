@@ -77,6 +77,10 @@ class VolatileFlowFileRepository : public VolatileRepository<std::string>, publi
 
   void loadComponent(const std::shared_ptr<core::ContentRepository> &content_repo) {
     content_repo_ = content_repo;
+    // no FlowFile survives a restart, so none of the content of the previous run is referenced
+    if (content_repo_) {
+      content_repo_->clearOrphans();
+    }
   }
 
  protected:
@@ -18,15 +18,19 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_VOLATILEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_VOLATILEREPOSITORY_H_
 
+#include <array>
 #include <chrono>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "AtomicRepoEntries.h"
+#include "concurrentqueue.h"
 #include "Connection.h"
 #include "core/Core.h"
 #include "core/Repository.h"
@@ -65,7 +69,7 @@ class VolatileRepository : public core::Repository, public utils::EnableSharedFr
       : core::SerializableComponent(repo_name),
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<VolatileRepository>(), "", maxPartitionMillis, maxPartitionBytes, purgePeriod),
         current_size_(0),
-        current_index_(0),
+        eviction_index_(0),
         max_count_(10000),
         max_size_(static_cast<size_t>(maxPartitionBytes * 0.75)),
         logger_(logging::LoggerFactory<VolatileRepository>::getLogger()) {
@@ -162,15 +166,50 @@ class VolatileRepository : public core::Repository, public utils::EnableSharedFr
       return false;
   }
 
+  // number of independently locked parts of the key index
+  static constexpr size_t INDEX_STRIPES = 64;
+
+  struct IndexStripe {
+    std::mutex mutex;
+    // slot in value_vector_ of the keys of the stripe
+    std::unordered_map<T, size_t> slots;
+  };
+
+  IndexStripe &getStripe(const T &key) {
+    return index_[std::hash<T>{}(key) % INDEX_STRIPES];
+  }
+
+  // Stores the value in a slot owned by the caller
+  void storeValue(size_t slot, RepoValue<T> &value);
+
+  // Takes whatever value the entry at the given slot holds, releasing the slot
+  bool takeAnyValue(size_t slot, RepoValue<T> &value);
+
+  /**
+   * Returns a slot owned by the caller: a free slot if there is any, otherwise the next slot in round robin order,
+   * after taking its value into evicted. Must not hold the lock of any stripe.
+   */
+  size_t evictSlot(RepoValue<T> &evicted, bool &has_evicted);
+
   std::map<std::string, std::shared_ptr<minifi::Connection>> connectionMap;
   // current size of the volatile repo.
   std::atomic<size_t> current_size_;
-  // current index.
-  std::atomic<uint16_t> current_index_;
   // value vector that exists for non blocking iteration over
   // objects that store data for this repo instance.
   std::vector<AtomicEntry<T>*> value_vector_;
 
+  /**
+   * The index only points to the slots, the entries themselves tell which key they hold. The thread that takes the
+   * value out of an entry, or takes a free slot, owns the slot until it stores a value in it or releases it to
+   * free_slots_; only the owner of a slot writes to its entry. So a slot of the index is only trusted once the value
+   * of the key is taken from the entry, and the stripe of a key is only locked while its index is updated.
+   */
+  std::array<IndexStripe, INDEX_STRIPES> index_;
+  // slots in value_vector_ without a value and without an owner
+  moodycamel::ConcurrentQueue<size_t> free_slots_;
+  // next slot to evict once every slot holds a value
+  std::atomic<size_t> eviction_index_;
+
   // max count we are allowed to store.
   uint32_t max_count_;
   // maximum estimated size
@@ -190,6 +229,8 @@ template<typename T>
 const char *VolatileRepository<T>::volatile_repo_max_count = "max.count";
 template<typename T>
 const char *VolatileRepository<T>::volatile_repo_max_bytes = "max.bytes";
+template<typename T>
+constexpr size_t VolatileRepository<T>::INDEX_STRIPES;
 
 template<typename T>
 void VolatileRepository<T>::loadComponent(const std::shared_ptr<core::ContentRepository>& /*content_repo*/) {
@@ -241,6 +282,16 @@ bool VolatileRepository<T>::initialize(const std::shared_ptr<Configure> &configu
   for (uint32_t i = 0; i < max_count_; i++) {
     value_vector_.emplace_back(new AtomicEntry<T>(&current_size_, &max_size_));
   }
+  for (auto& stripe : index_) {
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.slots.reserve(max_count_ / INDEX_STRIPES + 1);
+  }
+  // hand out the lowest slots first
+  std::vector<size_t> slots(max_count_);
+  for (uint32_t i = 0; i < max_count_; i++) {
+    slots[i] = i;
+  }
+  free_slots_.enqueue_bulk(slots.begin(), slots.size());
   return true;
 }
 
@@ -251,45 +302,77 @@ bool VolatileRepository<T>::initialize(const std::shared_ptr<Configure> &configu
  **/
 template<typename T>
 bool VolatileRepository<T>::Put(T key, const uint8_t *buf, size_t bufLen) {
+  if (value_vector_.empty()) {
+    return false;
+  }
   RepoValue<T> new_value(key, buf, bufLen);
 
   const size_t size = new_value.size();
-  bool updated = false;
   size_t reclaimed_size = 0;
-  RepoValue<T> old_value;
-  do {
-    uint16_t private_index = current_index_.fetch_add(1);
-    // round robin through the beginning
-    if (private_index >= max_count_) {
-      uint16_t new_index = 0;
-      if (current_index_.compare_exchange_weak(new_index, 0)) {
-        private_index = 0;
+  auto& stripe = getStripe(key);
+  bool stored = false;
+  {
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    size_t slot = 0;
+    auto indexed = stripe.slots.find(key);
+    if (indexed != stripe.slots.end()) {
+      RepoValue<T> old_value;
+      if (value_vector_[indexed->second]->getValue(key, old_value)) {
+        // a new version of the key replaces the previous one in place
+        slot = indexed->second;
+        reclaimed_size += old_value.size();
+        stored = true;
       } else {
-        continue;
+        // it has been evicted
+        stripe.slots.erase(indexed);
       }
     }
-
-    updated = value_vector_.at(private_index)->setRepoValue(new_value, old_value, reclaimed_size);
-    logger_->log_debug("Set repo value at %u out of %u updated %u current_size %u, adding %u to  %u", private_index, max_count_, updated == true, reclaimed_size, size, current_size_.load());
-    if (updated && reclaimed_size > 0) {
+    if (stored || free_slots_.try_dequeue(slot)) {
+      storeValue(slot, new_value);
+      stripe.slots[key] = slot;
+      stored = true;
+      logger_->log_debug("Set repo value at %u out of %u", slot, max_count_);
+    }
+  }
+  if (!stored) {
+    // evicting locks the stripe of the evicted key, so it cannot be done while holding the lock of this stripe
+    RepoValue<T> evicted;
+    bool has_evicted = false;
+    const size_t slot = evictSlot(evicted, has_evicted);
+    if (has_evicted) {
+      logger_->log_debug("%s is full, evicted a value", getName());
+      reclaimed_size += evicted.size();
       std::lock_guard<std::mutex> lock(mutex_);
-      emplace(old_value);
+      emplace(evicted);
     }
-    if (reclaimed_size > 0) {
-      /**
-       * this is okay since current_size_ is really an estimate.
-       * we don't need precise counts.
-       */
-      if (current_size_ < reclaimed_size) {
-        current_size_ = 0;
-      } else {
-        current_size_ -= reclaimed_size;
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto indexed = stripe.slots.find(key);
+    if (indexed != stripe.slots.end()) {
+      // the key has been put by another thread in the meantime, the value put last wins
+      RepoValue<T> old_value;
+      if (value_vector_[indexed->second]->getValue(key, old_value)) {
+        reclaimed_size += old_value.size();
+        free_slots_.enqueue(indexed->second);
       }
     }
-  } while (!updated);
+    storeValue(slot, new_value);
+    stripe.slots[key] = slot;
+    logger_->log_debug("Set repo value at %u out of %u", slot, max_count_);
+  }
+  if (reclaimed_size > 0) {
+    /**
+     * this is okay since current_size_ is really an estimate.
+     * we don't need precise counts.
+     */
+    if (current_size_ < reclaimed_size) {
+      current_size_ = 0;
+    } else {
+      current_size_ -= reclaimed_size;
+    }
+  }
   current_size_ += size;
 
-  logger_->log_debug("VolatileRepository -- put %u %u", current_size_.load(), current_index_.load());
+  logger_->log_debug("VolatileRepository -- put %u", current_size_.load());
   return true;
 }
 
@@ -303,6 +386,56 @@ bool VolatileRepository<T>::MultiPut(const std::vector<std::pair<T, std::unique_
   return true;
 }
 
+template<typename T>
+void VolatileRepository<T>::storeValue(size_t slot, RepoValue<T> &value) {
+  RepoValue<T> previous_value;
+  size_t previous_size = 0;
+  // setRepoValue fails spuriously or while a reader holds the lock of the entry, retry until it is set
+  while (!value_vector_[slot]->setRepoValue(value, previous_value, previous_size)) {
+  }
+}
+
+template<typename T>
+bool VolatileRepository<T>::takeAnyValue(size_t slot, RepoValue<T> &value) {
+  if (!value_vector_[slot]->getValue(value)) {
+    return false;
+  }
+  {
+    // the slot is ours, so the key cannot be stored in it again until it is released
+    auto& stripe = getStripe(value.getKey());
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto indexed = stripe.slots.find(value.getKey());
+    if (indexed != stripe.slots.end() && indexed->second == slot) {
+      stripe.slots.erase(indexed);
+    }
+  }
+  free_slots_.enqueue(slot);
+  return true;
+}
+
+template<typename T>
+size_t VolatileRepository<T>::evictSlot(RepoValue<T> &evicted, bool &has_evicted) {
+  has_evicted = false;
+  while (true) {
+    size_t slot;
+    if (free_slots_.try_dequeue(slot)) {
+      return slot;
+    }
+    slot = eviction_index_++ % value_vector_.size();
+    // an empty entry is either free or owned by another thread
+    if (value_vector_[slot]->getValue(evicted)) {
+      has_evicted = true;
+      auto& stripe = getStripe(evicted.getKey());
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      auto indexed = stripe.slots.find(evicted.getKey());
+      if (indexed != stripe.slots.end() && indexed->second == slot) {
+        stripe.slots.erase(indexed);
+      }
+      return slot;
+    }
+  }
+}
+
 /**
  * Deletes the key
  * @return status of the delete operation
@@ -310,17 +443,26 @@ bool VolatileRepository<T>::MultiPut(const std::vector<std::pair<T, std::unique_
 template<typename T>
 bool VolatileRepository<T>::Delete(T key) {
   logger_->log_debug("Delete from volatile");
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> value;
-    if (ent->getValue(key, value)) {
-      current_size_ -= value.size();
-      logger_->log_debug("Delete and pushed into purge_list from volatile");
-      emplace(value);
-      return true;
+  RepoValue<T> value;
+  {
+    auto& stripe = getStripe(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto indexed = stripe.slots.find(key);
+    if (indexed == stripe.slots.end()) {
+      return false;
+    }
+    const size_t slot = indexed->second;
+    // the key is either taken now or it has been evicted
+    stripe.slots.erase(indexed);
+    if (!value_vector_[slot]->getValue(key, value)) {
+      return false;
     }
+    free_slots_.enqueue(slot);
   }
-  return false;
+  current_size_ -= value.size();
+  logger_->log_debug("Delete and pushed into purge_list from volatile");
+  emplace(value);
+  return true;
 }
 /**
  * Sets the value from the provided key. Once the item is retrieved
@@ -329,27 +471,36 @@ bool VolatileRepository<T>::Delete(T key) {
  */
 template<typename T>
 bool VolatileRepository<T>::Get(const T &key, std::string &value) {
-  for (auto ent : value_vector_) {
-    // let the destructor do the cleanup
-    RepoValue<T> repo_value;
-    if (ent->getValue(key, repo_value)) {
-      current_size_ -= value.size();
-      repo_value.emplace(value);
-      return true;
+  RepoValue<T> repo_value;
+  {
+    auto& stripe = getStripe(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto indexed = stripe.slots.find(key);
+    if (indexed == stripe.slots.end()) {
+      return false;
+    }
+    const size_t slot = indexed->second;
+    // the key is either taken now or it has been evicted
+    stripe.slots.erase(indexed);
+    if (!value_vector_[slot]->getValue(key, repo_value)) {
+      return false;
     }
+    free_slots_.enqueue(slot);
   }
-  return false;
+  current_size_ -= repo_value.size();
+  repo_value.emplace(value);
+  return true;
 }
 
 template<typename T>
 bool VolatileRepository<T>::DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &store, size_t &max_size, std::function<std::shared_ptr<core::SerializableComponent>()> lambda) {
   size_t requested_batch = max_size;
   max_size = 0;
-  for (auto ent : value_vector_) {
+  for (size_t slot = 0; slot < value_vector_.size(); slot++) {
     // let the destructor do the cleanup
     RepoValue<T> repo_value;
 
-    if (ent->getValue(repo_value)) {
+    if (takeAnyValue(slot, repo_value)) {
       std::shared_ptr<core::SerializableComponent> newComponent = lambda();
       // we've taken ownership of this repo value
       newComponent->DeSerialize(repo_value.getBuffer(), repo_value.getBufferSize());
@@ -374,11 +525,11 @@ template<typename T>
 bool VolatileRepository<T>::DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &store, size_t &max_size) {
   logger_->log_debug("VolatileRepository -- DeSerialize %u", current_size_.load());
   max_size = 0;
-  for (auto ent : value_vector_) {
+  for (size_t slot = 0; slot < value_vector_.size(); slot++) {
     // let the destructor do the cleanup
     RepoValue<T> repo_value;
 
-    if (ent->getValue(repo_value)) {
+    if (takeAnyValue(slot, repo_value)) {
       // we've taken ownership of this repo value
       store.at(max_size)->DeSerialize(repo_value.getBuffer(), repo_value.getBufferSize());
       current_size_ -= repo_value.getBufferSize();
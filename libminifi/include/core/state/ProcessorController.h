@@ -68,6 +68,11 @@ class ProcessorController : public StateController {
 
   int16_t resume() override;
 
+  /**
+   * Changes the number of concurrent tasks of the processor without restarting it
+   */
+  int16_t setMaxConcurrentTasks(uint8_t tasks);
+
  protected:
   std::shared_ptr<core::Processor> processor_;
   std::shared_ptr<SchedulingAgent> scheduler_;
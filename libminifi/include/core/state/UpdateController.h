@@ -203,6 +203,11 @@ class StateMonitor : public StateController {
    */
   virtual int16_t clearConnection(const std::string &connection) = 0;
 
+  /**
+   * Resizes the thread pool of the agent without restarting the flow.
+   */
+  virtual int16_t setThreadPoolSize(uint16_t threads) = 0;
+
   /**
    * Apply an update with the provided string.
    *
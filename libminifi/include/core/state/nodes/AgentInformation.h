@@ -296,6 +296,12 @@ class ComponentManifest : public DeviceInformation {
 
         desc.children.push_back(dyn_relat);
         desc.children.push_back(dyn_prop);
+        if (name == "processors") {
+          SerializedResponseNode batching;
+          batching.name = "supportsBatching";
+          batching.value = group.supports_batching_;
+          desc.children.push_back(batching);
+        }
         desc.children.push_back(className);
 
         type.children.push_back(desc);
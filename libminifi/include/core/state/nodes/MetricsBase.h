@@ -26,11 +26,16 @@
 #include "../Value.h"
 #include "core/Core.h"
 #include "core/Connectable.h"
+#include "utils/OptionalUtils.h"
 
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
+namespace provenance {
+class ProvenanceEventRecord;
+struct ProvenanceQuery;
+}  // namespace provenance
 namespace state {
 namespace response {
 
@@ -208,6 +213,12 @@ class NodeReporter {
    * @return the agent manifest response node
    */
   virtual std::shared_ptr<state::response::ResponseNode> getAgentManifest() const = 0;
+
+  /**
+   * Runs a query on the provenance repository
+   * @return the matching events, or nothing if the provenance repository cannot be queried
+   */
+  virtual utils::optional<std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>>> queryProvenance(const provenance::ProvenanceQuery& query) const = 0;
 };
 
 /**
@@ -0,0 +1,116 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../nodes/MetricsBase.h"
+#include "core/Processor.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+namespace response {
+
+/**
+ * Justification and Purpose: Provides the onTrigger and session commit latency percentiles, the CPU time
+ * and the FlowFile throughput of each processor, so that the processors using up the CPU budget of an
+ * agent can be found from the C2 server.
+ */
+class ProcessorPerformanceMetrics : public ResponseNode {
+ public:
+  ProcessorPerformanceMetrics(const std::string &name, const utils::Identifier &uuid)
+      : ResponseNode(name, uuid) {
+  }
+
+  ProcessorPerformanceMetrics(const std::string &name) // NOLINT
+      : ResponseNode(name) {
+  }
+
+  ProcessorPerformanceMetrics()
+      : ResponseNode("ProcessorPerformanceMetrics") {
+  }
+
+  std::string getName() const override {
+    return "ProcessorPerformanceMetrics";
+  }
+
+  void addProcessor(const std::shared_ptr<core::Processor> &processor) {
+    if (nullptr != processor) {
+      processors_.insert(std::make_pair(processor->getUUIDStr(), processor));
+    }
+  }
+
+  std::vector<SerializedResponseNode> serialize() override {
+    std::vector<SerializedResponseNode> serialized;
+    for (const auto& uuid_and_processor : processors_) {
+      const auto& processor = uuid_and_processor.second;
+      const auto statistics = processor->getStatistics().getSnapshot();
+
+      SerializedResponseNode parent;
+      parent.name = processor->getName();
+      parent.children.push_back(createNode("uuid", uuid_and_processor.first));
+      parent.children.push_back(createNode("triggers", statistics.triggers));
+      parent.children.push_back(createNode("cputimens", static_cast<uint64_t>(statistics.cpu_time.count())));
+      parent.children.push_back(createNode("flowfilesin", statistics.flow_files_in));
+      parent.children.push_back(createNode("bytesin", statistics.bytes_in));
+      parent.children.push_back(createNode("flowfilesout", statistics.flow_files_out));
+      parent.children.push_back(createNode("bytesout", statistics.bytes_out));
+      parent.children.push_back(serializeLatency("ontriggerus", statistics.trigger_duration));
+      parent.children.push_back(serializeLatency("commitus", statistics.commit_duration));
+
+      serialized.push_back(parent);
+    }
+    return serialized;
+  }
+
+ protected:
+  template<typename T>
+  static SerializedResponseNode createNode(const std::string& name, const T& value) {
+    SerializedResponseNode node;
+    node.name = name;
+    node.value = value;
+    return node;
+  }
+
+  static SerializedResponseNode serializeLatency(const std::string& name, const utils::LogLinearHistogram::Snapshot& histogram) {
+    SerializedResponseNode node;
+    node.name = name;
+    node.children.push_back(createNode("count", histogram.count()));
+    node.children.push_back(createNode("mean", histogram.mean()));
+    node.children.push_back(createNode("p50", histogram.percentile(0.5)));
+    node.children.push_back(createNode("p90", histogram.percentile(0.9)));
+    node.children.push_back(createNode("p99", histogram.percentile(0.99)));
+    node.children.push_back(createNode("max", histogram.max()));
+    return node;
+  }
+
+  std::map<std::string, std::shared_ptr<core::Processor>> processors_;
+};
+
+}  // namespace response
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
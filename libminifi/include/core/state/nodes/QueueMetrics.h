@@ -85,10 +85,20 @@ class QueueMetrics : public ResponseNode {
       queuesizemax.name = "queuedmax";
       queuesizemax.value = std::to_string(connection->getMaxQueueSize());
 
+      SerializedResponseNode swapped;
+      swapped.name = "swapped";
+      swapped.value = std::to_string(connection->getSwappedCount());
+
+      SerializedResponseNode swappeddatasize;
+      swappeddatasize.name = "swappeddatasize";
+      swappeddatasize.value = std::to_string(connection->getSwappedDataSize());
+
       parent.children.push_back(datasize);
       parent.children.push_back(datasizemax);
       parent.children.push_back(queuesize);
       parent.children.push_back(queuesizemax);
+      parent.children.push_back(swapped);
+      parent.children.push_back(swappeddatasize);
 
       serialized.push_back(parent);
     }
@@ -85,6 +85,13 @@ class RepositoryMetrics : public ResponseNode {
       parent.children.push_back(datasizemax);
       parent.children.push_back(queuesize);
 
+      if (auto memory_usage = repo->getMemoryUsage()) {
+        SerializedResponseNode memoryusage;
+        memoryusage.name = "memoryUsage";
+        memoryusage.value = std::to_string(*memory_usage);
+        parent.children.push_back(memoryusage);
+      }
+
       serialized.push_back(parent);
     }
     return serialized;
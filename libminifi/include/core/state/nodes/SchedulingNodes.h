@@ -71,6 +71,12 @@ class SchedulingDefaults : public DeviceInformation {
 
     schedulingDefaults.children.push_back(defaultRunDuration);
 
+    SerializedResponseNode defaultMaxBatchSize;
+    defaultMaxBatchSize.name = "defaultMaxBatchSize";
+    defaultMaxBatchSize.value = DEFAULT_MAX_BATCH_SIZE;
+
+    schedulingDefaults.children.push_back(defaultMaxBatchSize);
+
     SerializedResponseNode defaultMaxConcurrentTasks;
     defaultMaxConcurrentTasks.name = "defaultMaxConcurrentTasks";
     defaultMaxConcurrentTasks.value = DEFAULT_MAX_CONCURRENT_TASKS;
@@ -48,6 +48,7 @@ namespace core {
 #define CONFIG_YAML_REMOTE_PROCESS_GROUP_KEY "Remote Processing Groups"
 #define CONFIG_YAML_REMOTE_PROCESS_GROUP_KEY_V3 "Remote Process Groups"
 #define CONFIG_YAML_PROVENANCE_REPORT_KEY "Provenance Reporting"
+#define CONFIG_YAML_PROVENANCE_MODE_KEY "Provenance"
 
 #define YAML_CONFIGURATION_USE_REGEX
 
@@ -240,6 +241,17 @@ class YamlConfiguration : public FlowConfiguration {
    */
   void parseProvenanceReportingYaml(const YAML::Node& reportNode, core::ProcessGroup* parentGroup);
 
+  /**
+   * Parses the provenance mode of a process group. In the sampled mode
+   * only a sample of the provenance events and the events of the listed
+   * types are stored, the rest is only counted in per-window aggregates.
+   *
+   * @param provenanceNode the YAML::Node containing the provenance mode
+   * @param group the process group the mode applies to, including its
+   *                child groups without a mode of their own
+   */
+  void parseProvenanceModeYaml(const YAML::Node& provenanceNode, core::ProcessGroup* group);
+
   /**
    * A helper function to parse the Properties Node YAML for a processor.
    *
@@ -51,6 +51,8 @@ class YamlConnectionParser {
   utils::Identifier getDestinationUUIDFromYaml() const;
   uint64_t getFlowFileExpirationFromYaml() const;
   bool getDropEmptyFromYaml() const;
+  bool getLockFreeQueueFromYaml() const;
+  uint64_t getSwapThresholdFromYaml(uint64_t default_threshold) const;
  private:
   const YAML::Node& connectionNode_;
   const std::string& name_;
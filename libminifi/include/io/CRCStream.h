@@ -43,6 +43,11 @@ namespace minifi {
 namespace io {
 namespace internal {
 
+/**
+ * Updates the checksum with the content of the file region, mapping the file instead of reading it into a buffer.
+ */
+bool updateCRC(uLong& crc, const FileRegion& region);
+
 template<typename StreamType>
 class CRCStreamBase : public virtual Stream {
  public:
@@ -111,6 +116,18 @@ class OutputCRCStream : public virtual CRCStreamBase<StreamType>, public OutputS
     }
     return ret;
   }
+
+  bool canWriteFileRegion() const override {
+    return child_stream_->canWriteFileRegion();
+  }
+
+  int64_t writeFileRegion(const FileRegion& region) override {
+    const int64_t ret = child_stream_->writeFileRegion(region);
+    if (ret > 0 && !updateCRC(crc_, FileRegion{region.fd, region.offset, gsl::narrow<uint64_t>(ret)})) {
+      return -1;
+    }
+    return ret;
+  }
 };
 
 struct empty_class {};
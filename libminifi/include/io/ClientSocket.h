@@ -153,6 +153,13 @@ class Socket : public BaseStream {
 
   int write(const uint8_t *value, int size) override;
 
+  bool canWriteFileRegion() const override;
+
+  /**
+   * Sends the file region with sendfile, so the content does not have to be copied through user space.
+   */
+  int64_t writeFileRegion(const FileRegion& region) override;
+
   /**
    * Reads data and places it into buf
    * @param buf buffer in which we extract data
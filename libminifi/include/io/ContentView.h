@@ -0,0 +1,88 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Read-only contiguous view of content, so that it can be hashed, scanned or matched in place.
+ * The view either maps the file holding the content into memory, or owns a copy of the content
+ * if it is not stored in a file that can be mapped.
+ */
+class ContentView {
+ public:
+  explicit ContentView(std::vector<uint8_t> buffer);
+
+  /**
+   * Maps size bytes of the file starting at offset. The descriptor can be closed once the view is created.
+   * @return nullptr if the file cannot be mapped
+   */
+  static std::shared_ptr<ContentView> map(int fd, uint64_t offset, uint64_t size);
+
+  ContentView(const ContentView&) = delete;
+  ContentView& operator=(const ContentView&) = delete;
+
+  ~ContentView();
+
+  const uint8_t* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  const uint8_t* begin() const {
+    return data_;
+  }
+
+  const uint8_t* end() const {
+    return data_ + size_;
+  }
+
+  bool isMapped() const {
+    return mapping_ != nullptr;
+  }
+
+  std::string toString() const {
+    return std::string(reinterpret_cast<const char*>(data_), size_);
+  }
+
+ private:
+  ContentView(void* mapping, size_t mapping_size, const uint8_t* data, size_t size);
+
+  std::vector<uint8_t> buffer_;
+  void* mapping_;
+  size_t mapping_size_;
+  const uint8_t* data_;
+  size_t size_;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
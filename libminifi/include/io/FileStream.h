@@ -86,6 +86,11 @@ class FileStream : public io::BaseStream {
    */
   int write(const uint8_t *value, int size) override;
 
+  /**
+   * Maps the remaining content of the file, opening it by its path.
+   */
+  std::shared_ptr<ContentView> map(uint64_t max_size) override;
+
  private:
   void seekToEndOfFile(const char* caller_error_msg);
 
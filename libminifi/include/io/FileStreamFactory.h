@@ -0,0 +1,99 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "BaseStream.h"
+#include "properties/Configure.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Opens the file streams of the file based content repositories, using the stream implementation and
+ * durability policy configured in minifi.properties.
+ */
+class FileStreamFactory {
+ public:
+  enum class Implementation {
+    // io::FileStream, based on std::fstream
+    FSTREAM,
+    // io::PosixFileStream, buffered pread/pwrite on a file descriptor
+    POSIX
+  };
+
+  enum class Durability {
+    // the data is flushed to the storage device by the operating system
+    NONE,
+    // every content file is flushed to the storage device when the stream writing it is closed
+    SYNC_ON_CLOSE,
+    // the content files written by a content session are flushed to the storage device when the session is committed
+    SYNC_ON_COMMIT
+  };
+
+  FileStreamFactory();
+
+  /**
+   * Reads nifi.content.repository.file.stream and nifi.content.repository.durability.
+   * @return false if either of them has an invalid value
+   */
+  bool initialize(const std::shared_ptr<minifi::Configure>& configuration);
+
+  std::shared_ptr<io::BaseStream> openForRead(const std::string& path) const;
+
+  std::shared_ptr<io::BaseStream> openForWrite(const std::string& path, bool append) const;
+
+  Implementation getImplementation() const {
+    return implementation_;
+  }
+
+  Durability getDurability() const {
+    return durability_;
+  }
+
+  /**
+   * Flushes the content of the file to the storage device.
+   */
+  static bool sync(const std::string& path);
+
+  /**
+   * Flushes the entries of the directory to the storage device, so that the files created or renamed in it persist.
+   */
+  static bool syncDirectory(const std::string& path);
+
+  /**
+   * Cuts the file to the given size.
+   */
+  static bool truncate(const std::string& path, uint64_t size);
+
+ private:
+  Implementation implementation_;
+  Durability durability_;
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -18,11 +18,14 @@
 
 #pragma once
 
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <string>
 #include "Stream.h"
+#include "OutputStream.h"
 #include "utils/Id.h"
+#include "utils/OptionalUtils.h"
 
 namespace org {
 namespace apache {
@@ -30,6 +33,8 @@ namespace nifi {
 namespace minifi {
 namespace io {
 
+class ContentView;
+
 class InputStream : public virtual Stream {
  public:
   virtual size_t size() const {
@@ -43,6 +48,24 @@ class InputStream : public virtual Stream {
    **/
   virtual int read(uint8_t *value, int len) = 0;
 
+  /**
+   * Writes at most max_size bytes of the remaining data to the output without copying them through user space buffers,
+   * and advances the stream past the transferred data. Only streams reading from a file descriptor support this,
+   * and only towards outputs supporting OutputStream::writeFileRegion.
+   * @return the number of bytes transferred, -1 on error, or nullopt if the data has to be copied with read and write
+   */
+  virtual utils::optional<int64_t> transferTo(OutputStream& /*output*/, uint64_t /*max_size*/) {
+    return utils::nullopt;
+  }
+
+  /**
+   * Maps at most max_size bytes of the remaining data into memory, without advancing the stream.
+   * @return nullptr if the stream is not backed by a file that can be mapped
+   */
+  virtual std::shared_ptr<ContentView> map(uint64_t /*max_size*/) {
+    return nullptr;
+  }
+
   int read(std::vector<uint8_t>& buffer, int len);
 
   /**
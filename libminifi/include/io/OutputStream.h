@@ -32,6 +32,15 @@ namespace nifi {
 namespace minifi {
 namespace io {
 
+/**
+ * Range of an open file, for transferring its content without copying it through user space buffers.
+ */
+struct FileRegion {
+  int fd;
+  uint64_t offset;
+  uint64_t size;
+};
+
 /**
  * Serializable instances provide base functionality to
  * write certain objects/primitives to a data stream.
@@ -47,6 +56,30 @@ class OutputStream : public virtual Stream {
    **/
   virtual int write(const uint8_t *value, int len) = 0;
 
+  /**
+   * Whether writeFileRegion is supported, e.g. by sending the file to a socket with sendfile.
+   */
+  virtual bool canWriteFileRegion() const {
+    return false;
+  }
+
+  /**
+   * Writes the content of the file region directly from the file.
+   * @return the number of bytes written, or -1 on error
+   */
+  virtual int64_t writeFileRegion(const FileRegion& /*region*/) {
+    return -1;
+  }
+
+  /**
+   * Stores the data buffered by the stream, syncing it if the stream syncs its data on close.
+   * Unlike close, it reports whether all the data written so far has been stored.
+   * @return false if some of the data written to the stream could not be stored
+   */
+  virtual bool flush() {
+    return true;
+  }
+
   int write(const std::vector<uint8_t>& buffer, int len);
 
   /**
@@ -0,0 +1,117 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BaseStream.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * File stream working directly on a POSIX file descriptor.
+ *
+ * Writes are collected in an internal buffer and written with pwrite when it fills up, the stream is seeked, read or closed.
+ * Reads use pread, so the stream keeps its position without seeking the descriptor, and sequential access is
+ * advised to the kernel. Unlike FileStream, the stream does not lock: it must not be shared between threads.
+ *
+ * If sync_on_close is set, the data is flushed to the storage device with fdatasync when the stream is flushed or closed.
+ * A failure to store the buffered data is remembered, so flush reports it even after the stream has been closed.
+ */
+class PosixFileStream : public io::BaseStream {
+ public:
+  static constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+  enum class WriteMode {
+    TRUNCATE,
+    APPEND
+  };
+
+  /**
+   * Opens an existing file for reading, and optionally writing, starting from offset.
+   */
+  PosixFileStream(const std::string& path, uint64_t offset, bool write_enable = false);
+
+  /**
+   * Opens a file for writing, creating it if it does not exist.
+   */
+  PosixFileStream(const std::string& path, WriteMode mode, bool sync_on_close = false);
+
+  ~PosixFileStream() override;
+
+  void close() override;
+
+  void seek(uint64_t offset) override;
+
+  size_t size() const override {
+    return length_;
+  }
+
+  using BaseStream::read;
+  using BaseStream::write;
+
+  int read(uint8_t *buf, int buflen) override;
+
+  int write(const uint8_t *value, int size) override;
+
+  utils::optional<int64_t> transferTo(OutputStream& output, uint64_t max_size) override;
+
+  std::shared_ptr<ContentView> map(uint64_t max_size) override;
+
+  /**
+   * Writes the buffered data to the file, and flushes it to the storage device if sync_on_close is set.
+   * @return false if any data written to the stream has not been stored
+   */
+  bool flush() override;
+
+  /**
+   * Writes the buffered data to the file and flushes it to the storage device.
+   */
+  bool sync();
+
+ private:
+  // writes the buffered data to the file
+  bool flushBuffer();
+  bool writeAt(const uint8_t* data, size_t size, uint64_t offset);
+
+  std::string path_;
+  int fd_;
+  bool sync_on_close_;
+  uint64_t offset_;
+  size_t length_;
+  // data written at offset_ - write_buffer_.size(), that is not in the file yet
+  std::vector<uint8_t> write_buffer_;
+  // whether data has been written since the file was last synced
+  bool sync_pending_;
+  // whether storing some of the data written to the stream failed
+  bool failed_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
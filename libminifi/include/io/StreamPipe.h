@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <utility>
 #include "BaseStream.h"
@@ -46,6 +47,11 @@ class OutputStreamCallback {
 namespace internal {
 
 inline int64_t pipe(const std::shared_ptr<io::InputStream>& src, const std::shared_ptr<io::OutputStream>& dst) {
+  // file backed content can be sent to e.g. a socket without copying it through user space
+  const auto zero_copy_transferred = src->transferTo(*dst, std::numeric_limits<uint64_t>::max());
+  if (zero_copy_transferred) {
+    return *zero_copy_transferred;
+  }
   uint8_t buffer[4096U];
   int64_t totalTransferred = 0;
   while (true) {
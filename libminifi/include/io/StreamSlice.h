@@ -0,0 +1,71 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include "BaseStream.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Read-only view of the [offset, offset + size) range of another stream.
+ * Seeking is relative to the start of the range and reads stop at its end,
+ * so the content of a FlowFile can be handed out even if its resource holds other data as well.
+ */
+class StreamSlice : public BaseStream {
+ public:
+  StreamSlice(std::shared_ptr<BaseStream> stream, uint64_t offset, uint64_t size);
+
+  size_t size() const override {
+    return size_;
+  }
+
+  void seek(uint64_t offset) override;
+
+  using BaseStream::read;
+  using BaseStream::write;
+
+  int read(uint8_t *value, int len) override;
+
+  utils::optional<int64_t> transferTo(OutputStream& output, uint64_t max_size) override;
+
+  std::shared_ptr<ContentView> map(uint64_t max_size) override;
+
+  int write(const uint8_t* /*value*/, int /*len*/) override {
+    return -1;
+  }
+
+  void close() override;
+
+ private:
+  std::shared_ptr<BaseStream> stream_;
+  uint64_t offset_;
+  size_t size_;
+  size_t position_;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -153,6 +153,11 @@ class TLSSocket : public Socket {
    */
   int write(const uint8_t *value, int size) override;
 
+  // the content has to be encrypted in user space
+  bool canWriteFileRegion() const override {
+    return false;
+  }
+
   void close() override;
 
  protected:
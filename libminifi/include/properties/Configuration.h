@@ -39,8 +39,13 @@ class Configuration : public Properties {
   static constexpr const char *nifi_flow_configuration_file_exit_failure = "nifi.flow.configuration.file.exit.onfailure";
   static constexpr const char *nifi_flow_configuration_file_backup_update = "nifi.flow.configuration.backup.on.update";
   static constexpr const char *nifi_flow_engine_threads = "nifi.flow.engine.threads";
+  static constexpr const char *nifi_flow_engine_thread_pool = "nifi.flow.engine.thread.pool";
+  static constexpr const char *nifi_flow_engine_threads_adaptive = "nifi.flow.engine.threads.adaptive";
+  static constexpr const char *nifi_flow_engine_threads_min = "nifi.flow.engine.threads.min";
+  static constexpr const char *nifi_flow_engine_threads_max = "nifi.flow.engine.threads.max";
   static constexpr const char *nifi_flow_engine_alert_period = "nifi.flow.engine.alert.period";
   static constexpr const char *nifi_flow_engine_event_driven_time_slice = "nifi.flow.engine.event.driven.time.slice";
+  static constexpr const char *nifi_flow_engine_max_wait_for_work = "nifi.flow.engine.max.wait.for.work";
   static constexpr const char *nifi_administrative_yield_duration = "nifi.administrative.yield.duration";
   static constexpr const char *nifi_bored_yield_duration = "nifi.bored.yield.duration";
   static constexpr const char *nifi_graceful_shutdown_seconds = "nifi.flowcontroller.graceful.shutdown.period";
@@ -50,6 +55,13 @@ class Configuration : public Properties {
   static constexpr const char *nifi_configuration_class_name = "nifi.flow.configuration.class.name";
   static constexpr const char *nifi_flow_repository_class_name = "nifi.flowfile.repository.class.name";
   static constexpr const char *nifi_content_repository_class_name = "nifi.content.repository.class.name";
+  static constexpr const char *nifi_content_repository_streaming_session = "nifi.content.repository.streaming.session";
+  static constexpr const char *nifi_content_repository_slab_max_size = "nifi.content.repository.slab.max.size";
+  static constexpr const char *nifi_content_repository_slab_reclaim_period = "nifi.content.repository.slab.reclaim.period";
+  static constexpr const char *nifi_content_repository_file_stream = "nifi.content.repository.file.stream";
+  static constexpr const char *nifi_content_repository_durability = "nifi.content.repository.durability";
+  static constexpr const char *nifi_content_repository_memory_threshold = "nifi.content.repository.memory.threshold";
+  static constexpr const char *nifi_content_repository_memory_max_size = "nifi.content.repository.memory.max.size";
   static constexpr const char *nifi_volatile_repository_options = "nifi.volatile.repository.options.";
   static constexpr const char *nifi_provenance_repository_class_name = "nifi.provenance.repository.class.name";
   static constexpr const char *nifi_server_port = "nifi.server.port";
@@ -57,10 +69,25 @@ class Configuration : public Properties {
   static constexpr const char *nifi_provenance_repository_max_storage_size = "nifi.provenance.repository.max.storage.size";
   static constexpr const char *nifi_provenance_repository_max_storage_time = "nifi.provenance.repository.max.storage.time";
   static constexpr const char *nifi_provenance_repository_directory_default = "nifi.provenance.repository.directory.default";
+  static constexpr const char *nifi_provenance_repository_indexing_enabled = "nifi.provenance.repository.indexing.enabled";
   static constexpr const char *nifi_flowfile_repository_max_storage_size = "nifi.flowfile.repository.max.storage.size";
   static constexpr const char *nifi_flowfile_repository_max_storage_time = "nifi.flowfile.repository.max.storage.time";
+  static constexpr const char *nifi_flowfile_repository_group_commit_window = "nifi.flowfile.repository.group.commit.window";
+  static constexpr const char *nifi_flowfile_repository_group_commit_sync = "nifi.flowfile.repository.group.commit.sync";
+  static constexpr const char *nifi_flowfile_repository_recovery_threads = "nifi.flowfile.repository.recovery.threads";
   static constexpr const char *nifi_flowfile_repository_directory_default = "nifi.flowfile.repository.directory.default";
   static constexpr const char *nifi_dbcontent_repository_directory_default = "nifi.database.content.repository.directory.default";
+  static constexpr const char *nifi_dbcontent_repository_chunk_size = "nifi.database.content.repository.chunk.size";
+  static constexpr const char *nifi_dbcontent_repository_write_buffer_size = "nifi.database.content.repository.write.buffer.size";
+  static constexpr const char *nifi_dbcontent_repository_max_write_buffer_number = "nifi.database.content.repository.max.write.buffer.number";
+  static constexpr const char *nifi_dbcontent_repository_target_file_size_base = "nifi.database.content.repository.target.file.size.base";
+  static constexpr const char *nifi_dbcontent_repository_max_bytes_for_level_base = "nifi.database.content.repository.max.bytes.for.level.base";
+  static constexpr const char *nifi_dbcontent_repository_max_background_jobs = "nifi.database.content.repository.max.background.jobs";
+  static constexpr const char *nifi_dbcontent_repository_statistics_enabled = "nifi.database.content.repository.statistics.enabled";
+  static constexpr const char *nifi_rocksdb_memory_limit = "nifi.rocksdb.memory.limit";
+  static constexpr const char *nifi_rocksdb_background_threads = "nifi.rocksdb.background.threads";
+  static constexpr const char *nifi_flowfile_swap_directory = "nifi.flowfile.swap.directory";
+  static constexpr const char *nifi_queue_swap_threshold = "nifi.queue.swap.threshold";
   static constexpr const char *nifi_remote_input_secure = "nifi.remote.input.secure";
   static constexpr const char *nifi_remote_input_http = "nifi.remote.input.http.enabled";
   static constexpr const char *nifi_security_need_ClientAuth = "nifi.security.need.ClientAuth";
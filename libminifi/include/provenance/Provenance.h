@@ -28,6 +28,7 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #include "core/Core.h"
 #include "core/SerializableComponent.h"
@@ -331,7 +332,7 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     _sourceQueueIdentifier = identifier;
   }
   // fromFlowFile
-  void fromFlowFile(std::shared_ptr<core::FlowFile> &flow) {
+  void fromFlowFile(const std::shared_ptr<core::FlowFile> &flow) {
     _entryDate = flow->getEntryDate();
     _lineageStartDate = flow->getlineageStartDate();
     _lineageIdentifiers = flow->getlineageIdentifiers();
@@ -442,6 +443,8 @@ class ProvenanceEventRecord : public core::SerializableComponent {
 };
 
 // Provenance Reporter
+class ProvenanceSampler;
+
 class ProvenanceReporter {
  public:
   // Constructor
@@ -480,14 +483,49 @@ class ProvenanceReporter {
   }
   // commit
   void commit();
+  // keeps only the events chosen by the sampler, or every event if it is null
+  void setSampler(std::shared_ptr<ProvenanceSampler> sampler) {
+    sampler_ = std::move(sampler);
+  }
   // create
   void create(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // create, the details are only formatted if the event is kept
+  template<typename DetailFormatter, typename = decltype(std::declval<DetailFormatter&>()())>
+  void create(const std::shared_ptr<core::FlowFile>& flow, DetailFormatter format_details) {
+    auto event = allocate(ProvenanceEventRecord::CREATE, flow);
+
+    if (event) {
+      event->setDetails(format_details());
+      add(event);
+    }
+  }
   // route
   void route(std::shared_ptr<core::FlowFile> flow, core::Relationship relation, std::string detail, uint64_t processingDuration);
   // modifyAttributes
   void modifyAttributes(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // modifyAttributes, the details are only formatted if the event is kept
+  template<typename DetailFormatter, typename = decltype(std::declval<DetailFormatter&>()())>
+  void modifyAttributes(const std::shared_ptr<core::FlowFile>& flow, DetailFormatter format_details) {
+    auto event = allocate(ProvenanceEventRecord::ATTRIBUTES_MODIFIED, flow);
+
+    if (event) {
+      event->setDetails(format_details());
+      add(event);
+    }
+  }
   // modifyContent
   void modifyContent(std::shared_ptr<core::FlowFile> flow, std::string detail, uint64_t processingDuration);
+  // modifyContent, the details are only formatted if the event is kept
+  template<typename DetailFormatter, typename = decltype(std::declval<DetailFormatter&>()())>
+  void modifyContent(const std::shared_ptr<core::FlowFile>& flow, DetailFormatter format_details, uint64_t processingDuration) {
+    auto event = allocate(ProvenanceEventRecord::CONTENT_MODIFIED, flow, processingDuration);
+
+    if (event) {
+      event->setDetails(format_details());
+      event->setEventDuration(processingDuration);
+      add(event);
+    }
+  }
   // clone
   void clone(std::shared_ptr<core::FlowFile> parent, std::shared_ptr<core::FlowFile> child);
   // join
@@ -496,6 +534,8 @@ class ProvenanceReporter {
   void fork(std::vector<std::shared_ptr<core::FlowFile> > child, std::shared_ptr<core::FlowFile> parent, std::string detail, uint64_t processingDuration);
   // expire
   void expire(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // expire multiple flow files, the details of each event are the detail prefix followed by the flow file's UUID
+  void expire(const std::set<std::shared_ptr<core::FlowFile>>& flows, const std::string& detail_prefix);
   // drop
   void drop(std::shared_ptr<core::FlowFile> flow, std::string reason);
   // send
@@ -506,18 +546,8 @@ class ProvenanceReporter {
   void receive(std::shared_ptr<core::FlowFile> flow, std::string transitUri, std::string sourceSystemFlowFileIdentifier, std::string detail, uint64_t processingDuration);
 
  protected:
-  // allocate
-  std::shared_ptr<ProvenanceEventRecord> allocate(ProvenanceEventRecord::ProvenanceEventType eventType, std::shared_ptr<core::FlowFile> flow) {
-    if (repo_->isNoop()) {
-      return nullptr;
-    }
-
-    auto event = std::make_shared<ProvenanceEventRecord>(eventType, _componentId, _componentType);
-    if (event)
-      event->fromFlowFile(flow);
-
-    return event;
-  }
+  // allocate, returns null if the event is not kept
+  std::shared_ptr<ProvenanceEventRecord> allocate(ProvenanceEventRecord::ProvenanceEventType eventType, const std::shared_ptr<core::FlowFile>& flow, uint64_t processingDuration = 0);
 
   // Component ID
   std::string _componentId;
@@ -530,6 +560,7 @@ class ProvenanceReporter {
   std::set<std::shared_ptr<ProvenanceEventRecord>> _events;
   // provenance repository.
   std::shared_ptr<core::Repository> repo_;
+  std::shared_ptr<ProvenanceSampler> sampler_;
 
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
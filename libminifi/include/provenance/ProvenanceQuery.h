@@ -0,0 +1,79 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "io/BufferStream.h"
+#include "provenance/Provenance.h"
+#include "utils/Id.h"
+#include "utils/OptionalUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+/**
+ * Conditions of a provenance query, the events returned match every condition that is set.
+ */
+struct ProvenanceQuery {
+  utils::optional<utils::Identifier> flow_file_uuid;
+  utils::optional<std::string> component_id;
+  utils::optional<ProvenanceEventRecord::ProvenanceEventType> event_type;
+  // inclusive range of the event time, in milliseconds since the epoch
+  uint64_t start_time = 0;
+  uint64_t end_time = std::numeric_limits<uint64_t>::max();
+  size_t max_results = 100;
+
+  bool matches(ProvenanceEventRecord& event) const {
+    return (!flow_file_uuid || event.getFlowFileUuid() == *flow_file_uuid)
+        && (!component_id || event.getComponentId() == *component_id)
+        && (!event_type || event.getEventType() == *event_type)
+        && event.getEventTime() >= start_time && event.getEventTime() <= end_time;
+  }
+};
+
+/**
+ * Provenance repository that can look up events without reading every stored event.
+ */
+class ProvenanceQueryable {
+ public:
+  virtual ~ProvenanceQueryable() = default;
+
+  /**
+   * Stores the serialized events, indexing them by the fields of the events instead of parsing the serialized form again.
+   */
+  virtual bool storeEvents(const std::vector<std::pair<std::shared_ptr<ProvenanceEventRecord>, std::unique_ptr<io::BufferStream>>>& events) = 0;
+
+  /**
+   * Returns at most query.max_results events matching the query, the most recent first.
+   */
+  virtual std::vector<std::shared_ptr<ProvenanceEventRecord>> query(const ProvenanceQuery& query) = 0;
+};
+
+}  // namespace provenance
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,127 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/state/nodes/MetricsBase.h"
+#include "provenance/Provenance.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+/**
+ * Number, total size and total duration of the provenance events of one type emitted by one component.
+ */
+struct ProvenanceAggregate {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  uint64_t duration = 0;
+};
+
+/**
+ * Provenance aggregates of the components of a process group in fixed time windows, reported as metrics.
+ * Only the most recent windows are kept.
+ *
+ * Every event of the group is added, so the aggregates are split into shards chosen by the adding thread, and each shard
+ * has its own lock. The shards are merged when the windows are read.
+ */
+class ProvenanceAggregateMetrics : public state::response::ResponseNode {
+ public:
+  // orders the aggregate keys, it also accepts keys referring to the component id, so that looking up a key does not copy it
+  struct KeyLess {
+    using is_transparent = void;
+
+    template<typename Lhs, typename Rhs>
+    bool operator()(const Lhs& lhs, const Rhs& rhs) const {
+      return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    }
+  };
+
+  // aggregates of the events of a window by component id and event type
+  using Window = std::map<std::pair<std::string, ProvenanceEventRecord::ProvenanceEventType>, ProvenanceAggregate, KeyLess>;
+
+  ProvenanceAggregateMetrics(const std::string& group_name, std::chrono::milliseconds window_length, size_t max_windows);
+
+  void add(const std::string& component_id, ProvenanceEventRecord::ProvenanceEventType type, uint64_t bytes, uint64_t duration, uint64_t event_time);
+
+  // the kept windows by their start time, in milliseconds since the epoch
+  std::map<uint64_t, Window> getWindows() const;
+
+  std::vector<state::response::SerializedResponseNode> serialize() override;
+
+ private:
+  static constexpr size_t SHARD_COUNT = 16;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::map<uint64_t, Window> windows;
+  };
+
+  const uint64_t window_length_;
+  const size_t max_windows_;
+  std::array<Shard, SHARD_COUNT> shards_;
+};
+
+/**
+ * Sampled provenance of a process group: every event is added to the aggregates, but only the events of the always kept
+ * types and a fraction of the other events, given by the sample rate, are stored in the provenance repository.
+ * The n-th of the other events is kept when floor(n * rate) increases, so any rate is followed exactly, not only 1/N.
+ */
+class ProvenanceSampler {
+ public:
+  static constexpr size_t MAX_AGGREGATE_WINDOWS = 60;
+
+  ProvenanceSampler(const std::string& group_name, double sample_rate, std::set<ProvenanceEventRecord::ProvenanceEventType> kept_event_types,
+      std::chrono::milliseconds aggregation_window);
+
+  /**
+   * Adds the event to the aggregates
+   * @return whether the full event is to be stored
+   */
+  bool sample(const std::string& component_id, ProvenanceEventRecord::ProvenanceEventType type, uint64_t bytes, uint64_t duration);
+
+  std::shared_ptr<ProvenanceAggregateMetrics> getMetrics() const {
+    return metrics_;
+  }
+
+ private:
+  // fraction of the events to keep, between 0 and 1
+  const double sample_rate_;
+  const std::set<ProvenanceEventRecord::ProvenanceEventType> kept_event_types_;
+  std::atomic<uint64_t> event_counter_{0};
+  std::shared_ptr<ProvenanceAggregateMetrics> metrics_;
+};
+
+}  // namespace provenance
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
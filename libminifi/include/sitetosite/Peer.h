@@ -303,6 +303,14 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
     return stream_->read(data, len);
   }
 
+  bool canWriteFileRegion() const override {
+    return stream_ && stream_->canWriteFileRegion();
+  }
+
+  int64_t writeFileRegion(const org::apache::nifi::minifi::io::FileRegion& region) override {
+    return stream_->writeFileRegion(region);
+  }
+
   // open connection to the peer
   bool Open();
   // close connection to the peer
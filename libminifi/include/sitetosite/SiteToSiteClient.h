@@ -314,6 +314,16 @@ class ReadCallback : public InputStreamCallback {
   DataPacket *_packet;
   int64_t process(const std::shared_ptr<io::BaseStream>& stream) {
     _packet->_size = 0;
+    // file backed content is sent straight from the file when the transaction is over a plain socket
+    const auto transferred = stream->transferTo(_packet->transaction_->getStream(), stream->size());
+    if (transferred) {
+      if (*transferred < 0 || gsl::narrow<size_t>(*transferred) != stream->size()) {
+        logging::LOG_INFO(_packet->logger_reference_) << "Site2Site Send Flow Size " << stream->size() << " Failed " << *transferred;
+        return -1;
+      }
+      _packet->_size = stream->size();
+      return *transferred;
+    }
     uint8_t buffer[8192] = { 0 };
     int readSize;
     size_t size = 0;
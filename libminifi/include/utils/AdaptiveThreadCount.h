@@ -0,0 +1,97 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Decides the number of worker threads of a pool from periodic samples of its load.
+ *
+ * The pool grows while tasks are queued for a worker and the CPU has headroom left: more threads do not help
+ * when the CPU is already saturated. It shrinks only after being idle for several samples in a row, so that
+ * a bursty load does not make it oscillate. The result always stays within [min_threads, max_threads].
+ *
+ * Not thread safe: meant to be sampled by the manager thread of a single pool.
+ */
+class AdaptiveThreadCount {
+ public:
+  // above this share of the available CPU time the pool does not grow any more
+  static constexpr double MAX_CPU_UTILIZATION = 0.9;
+  // number of consecutive idle samples before the pool shrinks
+  static constexpr int IDLE_SAMPLES_BEFORE_SHRINKING = 4;
+
+  AdaptiveThreadCount(int min_threads, int max_threads)
+      : min_threads_((std::max)(min_threads, 1)),
+        max_threads_((std::max)((std::max)(min_threads, 1), max_threads)),
+        idle_samples_(0) {
+  }
+
+  /**
+   * @param current_threads number of worker threads the pool has
+   * @param busy_threads number of worker threads running a task at the time of the sample
+   * @param pending_tasks number of tasks ready to run but waiting for a worker thread
+   * @param cpu_utilization CPU time used by the process since the last sample, relative to the CPU time available
+   * on all cores in the meantime
+   * @return the number of worker threads the pool should have
+   */
+  int update(int current_threads, int busy_threads, size_t pending_tasks, double cpu_utilization) {
+    int target = current_threads;
+    if (pending_tasks > 0 && (busy_threads >= current_threads || pending_tasks >= static_cast<size_t>(current_threads))) {
+      idle_samples_ = 0;
+      if (cpu_utilization < MAX_CPU_UTILIZATION) {
+        // grow geometrically, but not beyond what the queued tasks could use
+        const size_t step = (std::min)(pending_tasks, static_cast<size_t>((std::max)(current_threads / 2, 1)));
+        target = current_threads + static_cast<int>(step);
+      }
+    } else if (pending_tasks == 0 && busy_threads < current_threads) {
+      if (++idle_samples_ >= IDLE_SAMPLES_BEFORE_SHRINKING) {
+        idle_samples_ = 0;
+        // release half of the idle threads at a time
+        target = current_threads - (current_threads - busy_threads + 1) / 2;
+      }
+    } else {
+      idle_samples_ = 0;
+    }
+    return (std::min)((std::max)(target, min_threads_), max_threads_);
+  }
+
+  int getMinThreads() const {
+    return min_threads_;
+  }
+
+  int getMaxThreads() const {
+    return max_threads_;
+  }
+
+ private:
+  const int min_threads_;
+  const int max_threads_;
+  int idle_samples_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,103 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "concurrentqueue.h"
+#include "core/FlowFile.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * FlowFile queue that can be used concurrently by multiple producers and consumers without an external lock.
+ *
+ * FlowFiles that are ready to be processed are kept in a lock-free ring, penalized FlowFiles are kept in a heap
+ * ordered by penalty expiration, guarded by its own mutex. The heap is only touched when a penalized FlowFile
+ * is pushed or when the earliest penalty has expired, so the common put/poll path never takes a lock.
+ * The element count and the total content size are tracked in atomic counters, so back pressure checks are lock-free.
+ *
+ * Ordering is FIFO per producer; FlowFiles whose penalty has expired are queued behind the already ready ones.
+ */
+class ConcurrentFlowFileQueue {
+ public:
+  using value_type = std::shared_ptr<core::FlowFile>;
+
+  ConcurrentFlowFileQueue();
+
+  void push(const value_type& element);
+  void push(value_type&& element);
+
+  /**
+   * Removes the next non-penalized FlowFile from the queue.
+   * @return false if there are no FlowFiles ready to be processed
+   */
+  bool tryPop(value_type& element);
+
+  /**
+   * Removes at most max_count non-penalized FlowFiles from the queue and appends them to elements.
+   * @return the number of FlowFiles appended
+   */
+  size_t tryPopBatch(size_t max_count, std::vector<value_type>& elements);
+
+  /**
+   * Removes every FlowFile from the queue, including the penalized ones.
+   */
+  std::vector<value_type> popAll();
+
+  bool isWorkAvailable() const;
+  bool empty() const;
+  size_t size() const;
+  uint64_t dataSize() const;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  struct FlowFilePenaltyExpirationComparator {
+    bool operator()(const value_type& left, const value_type& right) const;
+  };
+
+  void pushPenalized(value_type element);
+  void releaseExpiredPenalties();
+  void updateNextPenaltyExpiration();
+  void onRemoved(const value_type& element);
+
+  moodycamel::ConcurrentQueue<value_type> ready_queue_;
+
+  std::mutex penalized_mutex_;
+  std::priority_queue<value_type, std::vector<value_type>, FlowFilePenaltyExpirationComparator> penalized_queue_;
+  // expiration of the earliest penalty in penalized_queue_, clock::duration::max() if it is empty
+  std::atomic<clock::rep> next_penalty_expiration_;
+
+  std::atomic<size_t> size_;
+  std::atomic<uint64_t> data_size_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
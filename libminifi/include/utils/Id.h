@@ -85,6 +85,10 @@ class Identifier {
   // 70ns more.
   SmallString<36> to_string() const;
 
+  const Data& getData() const {
+    return data_;
+  }
+
   static utils::optional<Identifier> parse(const std::string& str);
 
  private:
@@ -0,0 +1,156 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Histogram of non-negative integer values, similar to HdrHistogram: every power of two is split into
+ * SUB_BUCKET_COUNT linear buckets, so the values reported by the snapshot are within 1 / SUB_BUCKET_COUNT
+ * of the recorded ones. Values of 2^MAX_EXPONENT and above are counted in the last bucket.
+ *
+ * Recording only does relaxed atomic increments, so it is lock-free and can be done from multiple threads.
+ */
+class LogLinearHistogram {
+ public:
+  static constexpr int SUB_BUCKET_BITS = 3;
+  static constexpr size_t SUB_BUCKET_COUNT = size_t{1} << SUB_BUCKET_BITS;
+  static constexpr int MAX_EXPONENT = 36;
+  static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  class Snapshot {
+   public:
+    Snapshot() {
+      counts_.fill(0);
+    }
+
+    void add(const LogLinearHistogram& histogram) {
+      for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts_[i] += histogram.counts_[i].load(std::memory_order_relaxed);
+      }
+      count_ += histogram.count_.load(std::memory_order_relaxed);
+      sum_ += histogram.sum_.load(std::memory_order_relaxed);
+      max_ = (std::max)(max_, histogram.max_.load(std::memory_order_relaxed));
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t max() const { return max_; }
+
+    uint64_t mean() const {
+      return count_ == 0 ? 0 : sum_ / count_;
+    }
+
+    /**
+     * @param quantile between 0 and 1
+     * @return the upper bound of the bucket holding the value at the quantile, never more than max()
+     */
+    uint64_t percentile(double quantile) const {
+      if (count_ == 0) {
+        return 0;
+      }
+      const auto rank = (std::max)(uint64_t{1}, static_cast<uint64_t>(quantile * static_cast<double>(count_) + 0.5));
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+          return (std::min)(bucketUpperBound(i), max_);
+        }
+      }
+      return max_;
+    }
+
+   private:
+    std::array<uint64_t, BUCKET_COUNT> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+  };
+
+  LogLinearHistogram()
+      : count_(0),
+        sum_(0),
+        max_(0) {
+    for (auto& count : counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  LogLinearHistogram(const LogLinearHistogram&) = delete;
+  LogLinearHistogram& operator=(const LogLinearHistogram&) = delete;
+
+  void record(uint64_t value) {
+    counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+  }
+
+  static size_t bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    const int exponent = highestBit(value);
+    if (exponent >= MAX_EXPONENT) {
+      return BUCKET_COUNT - 1;
+    }
+    const auto sub_bucket = static_cast<size_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket;
+  }
+
+  // the largest value counted in the bucket
+  static uint64_t bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+      return index;
+    }
+    const int exponent = static_cast<int>(index / SUB_BUCKET_COUNT) + SUB_BUCKET_BITS - 1;
+    const uint64_t sub_bucket = index % SUB_BUCKET_COUNT;
+    const uint64_t width = uint64_t{1} << (exponent - SUB_BUCKET_BITS);
+    return (uint64_t{1} << exponent) + (sub_bucket + 1) * width - 1;
+  }
+
+ private:
+  static int highestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+      ++bit;
+    }
+    return bit;
+  }
+
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
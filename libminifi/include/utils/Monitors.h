@@ -48,6 +48,12 @@ class AfterExecute {
    * @return milliseconds since epoch after which we are eligible to re-run this task.
    */
   virtual std::chrono::milliseconds wait_time() = 0;
+  /**
+   * Whether the task should only be re-run when it is notified about new work, or at the latest after wait_time()
+   */
+  virtual bool isWaitingForWork() {
+    return false;
+  }
 };
 
 /**
@@ -106,11 +112,12 @@ class SingleRunMonitor : public utils::AfterExecute<bool>{
 
 
 struct TaskRescheduleInfo {
-  TaskRescheduleInfo(bool result, std::chrono::milliseconds wait_time)
-    : wait_time_(wait_time), finished_(result) {}
+  TaskRescheduleInfo(bool result, std::chrono::milliseconds wait_time, bool wait_for_work = false)
+    : wait_time_(wait_time), finished_(result), wait_for_work_(wait_for_work) {}
 
   std::chrono::milliseconds wait_time_;
   bool finished_;
+  bool wait_for_work_;
 
   static TaskRescheduleInfo Done() {
     return TaskRescheduleInfo(true, std::chrono::milliseconds(0));
@@ -124,11 +131,18 @@ struct TaskRescheduleInfo {
     return TaskRescheduleInfo(false, std::chrono::milliseconds(0));
   }
 
+  /**
+   * The task is re-run when the thread pool is notified about new work for it, but at most after max_wait.
+   */
+  static TaskRescheduleInfo RetryOnWork(std::chrono::milliseconds max_wait) {
+    return TaskRescheduleInfo(false, max_wait, true);
+  }
+
 #if defined(WIN32)
 // https://developercommunity.visualstudio.com/content/problem/60897/c-shared-state-futuresstate-default-constructs-the.html
 // Because of this bug we need to have this object default constructible, which makes no sense otherwise. Hack.
  private:
-  TaskRescheduleInfo() : wait_time_(std::chrono::milliseconds(0)), finished_(true) {}
+  TaskRescheduleInfo() : wait_time_(std::chrono::milliseconds(0)), finished_(true), wait_for_work_(false) {}
   friend class std::_Associated_state<TaskRescheduleInfo>;
 #endif
 };
@@ -142,6 +156,7 @@ class ComplexMonitor : public utils::AfterExecute<TaskRescheduleInfo> {
       return true;
     }
     current_wait_.store(result.wait_time_);
+    waiting_for_work_.store(result.wait_for_work_);
     return false;
   }
   bool isCancelled(const TaskRescheduleInfo& /*result*/) override {
@@ -154,9 +169,13 @@ class ComplexMonitor : public utils::AfterExecute<TaskRescheduleInfo> {
   std::chrono::milliseconds wait_time() override {
     return current_wait_.load();
   }
+  bool isWaitingForWork() override {
+    return waiting_for_work_.load();
+  }
 
  private:
   std::atomic<std::chrono::milliseconds> current_wait_ {std::chrono::milliseconds(0)};
+  std::atomic<bool> waiting_for_work_ {false};
 };
 
 }  // namespace utils
@@ -17,6 +17,7 @@
 #ifndef LIBMINIFI_INCLUDE_UTILS_OSUTILS_H_
 #define LIBMINIFI_INCLUDE_UTILS_OSUTILS_H_
 
+#include <chrono>
 #include <string>
 
 namespace org {
@@ -32,6 +33,12 @@ extern std::string userIdToUsername(const std::string &uid);
 /// Returns memory usage in bytes, including shared memory
 uint64_t getMemoryUsage();
 
+/// Returns the CPU time used by the calling thread, or 0 if it is not available
+std::chrono::nanoseconds getCurrentThreadCpuTime();
+
+/// Returns the CPU time used by all threads of the process, or 0 if it is not available
+std::chrono::nanoseconds getProcessCpuTime();
+
 #ifdef WIN32
 /// Resolves common identifiers
 extern std::string resolve_common_identifiers(const std::string &id);
@@ -0,0 +1,142 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Holds the tasks that wait for work to arrive, keyed by their identifier.
+ *
+ * A task is released either by a notification for its identifier or when its deadline passes. A notification
+ * that arrives while no task of the identifier is parked is remembered, and the next park attempt fails, so a
+ * notification sent between checking for work and parking is never lost.
+ */
+template<typename Identifier, typename Task>
+class TaskParkingLot {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  TaskParkingLot()
+      : next_deadline_(clock::time_point::max().time_since_epoch().count()) {
+  }
+
+  /**
+   * Parks the task until it is notified or the deadline passes.
+   * @return false if a notification is pending for the identifier, in which case the task is left with the caller
+   */
+  bool park(const Identifier& identifier, clock::time_point deadline, Task& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[identifier];
+    if (entry.notified) {
+      entry.notified = false;
+      return false;
+    }
+    entry.tasks.emplace_back(deadline, std::move(task));
+    if (deadline.time_since_epoch().count() < next_deadline_) {
+      next_deadline_ = deadline.time_since_epoch().count();
+    }
+    return true;
+  }
+
+  /**
+   * Releases the longest waiting task of the identifier, or remembers the notification if there is none.
+   * @return true if a task was moved to task
+   */
+  bool notify(const Identifier& identifier, Task& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[identifier];
+    if (entry.tasks.empty()) {
+      entry.notified = true;
+      return false;
+    }
+    task = std::move(entry.tasks.front().second);
+    entry.tasks.erase(entry.tasks.begin());
+    return true;
+  }
+
+  /**
+   * Releases the tasks whose deadline is not later than now.
+   */
+  template<typename Callback>
+  void expire(clock::time_point now, Callback callback) {
+    if (now.time_since_epoch().count() < next_deadline_) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next_deadline = clock::time_point::max();
+    for (auto& identifier_and_entry : entries_) {
+      auto& tasks = identifier_and_entry.second.tasks;
+      for (auto it = tasks.begin(); it != tasks.end();) {
+        if (it->first <= now) {
+          callback(std::move(it->second));
+          it = tasks.erase(it);
+        } else {
+          next_deadline = (std::min)(next_deadline, it->first);
+          ++it;
+        }
+      }
+    }
+    next_deadline_ = next_deadline.time_since_epoch().count();
+  }
+
+  clock::time_point nextDeadline() const {
+    return clock::time_point{clock::duration{next_deadline_.load()}};
+  }
+
+  /**
+   * Drops the parked tasks and the pending notification of the identifier.
+   */
+  void remove(const Identifier& identifier) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(identifier);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    next_deadline_ = clock::time_point::max().time_since_epoch().count();
+  }
+
+ private:
+  struct Entry {
+    std::vector<std::pair<clock::time_point, Task>> tasks;
+    bool notified = false;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<Identifier, Entry> entries_;
+  // earliest deadline of the parked tasks, so expire does not have to lock while none has passed
+  std::atomic<clock::rep> next_deadline_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <iostream>
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <map>
 #include <unordered_map>
@@ -34,9 +35,11 @@
 #include <thread>
 #include <functional>
 
+#include "AdaptiveThreadCount.h"
 #include "BackTrace.h"
 #include "MinifiConcurrentQueue.h"
 #include "Monitors.h"
+#include "TaskParkingLot.h"
 #include "core/expect.h"
 #include "controllers/ThreadManagementService.h"
 #include "core/controller/ControllerService.h"
@@ -60,6 +63,7 @@ class Worker {
   explicit Worker(const std::function<T()> &task, const TaskId &identifier, std::unique_ptr<AfterExecute<T>> run_determinant)
       : identifier_(identifier),
         next_exec_time_(std::chrono::steady_clock::now()),
+        waiting_for_work_(false),
         task(task),
         run_determinant_(std::move(run_determinant)) {
     promise = std::make_shared<std::promise<T>>();
@@ -68,6 +72,7 @@ class Worker {
   explicit Worker(const std::function<T()> &task, const TaskId &identifier)
       : identifier_(identifier),
         next_exec_time_(std::chrono::steady_clock::now()),
+        waiting_for_work_(false),
         task(task),
         run_determinant_(nullptr) {
     promise = std::make_shared<std::promise<T>>();
@@ -75,7 +80,8 @@ class Worker {
 
   explicit Worker(const TaskId& identifier = {})
       : identifier_(identifier),
-        next_exec_time_(std::chrono::steady_clock::now()) {
+        next_exec_time_(std::chrono::steady_clock::now()),
+        waiting_for_work_(false) {
   }
 
   virtual ~Worker() = default;
@@ -86,6 +92,7 @@ class Worker {
   Worker(Worker &&other) noexcept
       : identifier_(std::move(other.identifier_)),
         next_exec_time_(std::move(other.next_exec_time_)),
+        waiting_for_work_(other.waiting_for_work_),
         task(std::move(other.task)),
         run_determinant_(std::move(other.run_determinant_)),
         promise(other.promise) {
@@ -104,10 +111,23 @@ class Worker {
       promise->set_value(result);
       return false;
     }
-    next_exec_time_ = std::max(next_exec_time_ + run_determinant_->wait_time(), std::chrono::steady_clock::now());
+    waiting_for_work_ = run_determinant_->isWaitingForWork();
+    if (waiting_for_work_) {
+      // the wait time is only a deadline for the notification, it does not keep the schedule
+      next_exec_time_ = std::chrono::steady_clock::now() + run_determinant_->wait_time();
+    } else {
+      next_exec_time_ = std::max(next_exec_time_ + run_determinant_->wait_time(), std::chrono::steady_clock::now());
+    }
     return true;
   }
 
+  /**
+   * Whether the last run asked to be run again only when there is new work, see ThreadPool::notifyWork
+   */
+  bool isWaitingForWork() const {
+    return waiting_for_work_;
+  }
+
   virtual void setIdentifier(const TaskId& identifier) {
     identifier_ = identifier;
   }
@@ -134,6 +154,7 @@ class Worker {
  protected:
   TaskId identifier_;
   std::chrono::time_point<std::chrono::steady_clock> next_exec_time_;
+  bool waiting_for_work_;
   std::function<T()> task;
   std::unique_ptr<AfterExecute<T>> run_determinant_;
   std::shared_ptr<std::promise<T>> promise;
@@ -152,6 +173,7 @@ Worker<T>& Worker<T>::operator =(Worker<T> && other) noexcept {
   task = std::move(other.task);
   promise = other.promise;
   next_exec_time_ = std::move(other.next_exec_time_);
+  waiting_for_work_ = other.waiting_for_work_;
   identifier_ = std::move(other.identifier_);
   run_determinant_ = std::move(other.run_determinant_);
   return *this;
@@ -195,8 +217,10 @@ class ThreadPool {
         adjust_threads_(false),
         running_(false),
         controller_service_provider_(controller_service_provider),
-        name_(name) {
+        name_(name),
+        next_thread_index_(0) {
     current_workers_ = 0;
+    busy_workers_ = 0;
     task_count_ = 0;
     thread_manager_ = nullptr;
   }
@@ -206,7 +230,7 @@ class ThreadPool {
   ThreadPool(ThreadPool<T> &&other) = delete;
   ThreadPool<T>& operator=(ThreadPool<T> &&other) = delete;
 
-  ~ThreadPool() {
+  virtual ~ThreadPool() {
     shutdown();
   }
 
@@ -218,29 +242,36 @@ class ThreadPool {
    * @param future future to move new promise to
    * @return true if future can be created and thread pool is in a running state.
    */
-  bool execute(Worker<T> &&task, std::future<T> &future);
+  virtual bool execute(Worker<T> &&task, std::future<T> &future);
 
   /**
    * attempts to stop tasks with the provided identifier.
    * @param identifier for worker tasks. Note that these tasks won't
    * immediately stop.
    */
-  void stopTasks(const TaskId &identifier);
+  virtual void stopTasks(const TaskId &identifier);
+
+  /**
+   * Notifies the tasks with the provided identifier that there is new work for them.
+   * One of them that is waiting for work is run as soon as possible; if none of them
+   * is waiting, the next one that would start waiting is run again instead.
+   */
+  virtual void notifyWork(const TaskId &identifier);
 
   /**
    * resumes work queue processing.
    */
-  void resume();
+  virtual void resume();
 
   /**
    * pauses work queue processing
    */
-  void pause();
+  virtual void pause();
 
   /**
    * Returns true if a task is running.
    */
-  bool isTaskRunning(const TaskId &identifier) {
+  virtual bool isTaskRunning(const TaskId &identifier) {
     std::unique_lock<std::mutex> lock(worker_queue_mutex_);
     const auto iter = task_status_.find(identifier);
     if (iter == task_status_.end())
@@ -271,40 +302,62 @@ class ThreadPool {
   /**
    * Starts the Thread Pool
    */
-  void start();
+  virtual void start();
   /**
    * Shutdown the thread pool and clear any
    * currently running activities
    */
-  void shutdown();
+  virtual void shutdown();
   /**
-   * Set the max concurrent tasks. When this is done
-   * we must start and restart the thread pool if
-   * the number of tasks is less than the currently configured number
+   * Set the max concurrent tasks. A running pool is resized
+   * without being restarted: new worker threads are started right away,
+   * surplus ones exit once they are done with their current task.
    */
-  void setMaxConcurrentTasks(uint16_t max) {
-    std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
-    bool was_running = running_;
-    if (was_running) {
-      shutdown();
-    }
-    max_worker_threads_ = max;
-    if (was_running)
-      start();
-  }
+  virtual void setMaxConcurrentTasks(uint16_t max);
 
-  void setControllerServiceProvider(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider) {
-    std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
-    bool was_running = running_;
-    if (was_running) {
-      shutdown();
-    }
-    controller_service_provider_ = controller_service_provider;
-    if (was_running)
-      start();
+  /**
+   * Sets the provider of the ThreadPoolManager service. Takes effect
+   * without restarting the pool.
+   */
+  virtual void setControllerServiceProvider(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider);
+
+  /**
+   * Lets the pool adjust its number of worker threads between the given
+   * bounds, based on the number of queued tasks and the CPU utilization.
+   * Has no effect while a ThreadPoolManager service controls the pool.
+   */
+  void enableAdaptiveThreadCount(uint16_t min_threads, uint16_t max_threads);
+
+  /**
+   * Returns the number of worker threads the pool has, not counting the
+   * ones that are about to exit.
+   */
+  virtual int getWorkerCount() const {
+    return current_workers_ - (std::max)(thread_reduction_count_.load(), 0);
   }
 
  protected:
+  // period of the manager thread
+  static constexpr std::chrono::milliseconds MANAGEMENT_PERIOD{500};
+
+  /**
+   * Starts or stops worker threads so that the pool has worker_count of them.
+   * Called with manager_mutex_ held, while the pool is running.
+   */
+  virtual void resize(int worker_count);
+
+  /**
+   * Returns the number of tasks that are ready to run but wait for a worker thread.
+   */
+  virtual size_t getPendingTaskCount() const {
+    return worker_queue_.size();
+  }
+
+  /**
+   * Stops the manager thread. Called with running_ already cleared.
+   */
+  void stopManager();
+
   std::thread createThread(std::function<void()> &&functor) {
     return std::thread([ functor ]() mutable {
       functor();
@@ -330,6 +383,8 @@ class ThreadPool {
   int max_worker_threads_;
 // current worker tasks.
   std::atomic<int> current_workers_;
+// worker threads running a task
+  std::atomic<int> busy_workers_;
   std::atomic<int> task_count_;
 // thread queue
   std::vector<std::shared_ptr<WorkerThread>> thread_queue_;
@@ -356,10 +411,29 @@ class ThreadPool {
   std::condition_variable delayed_task_available_;
 // map to identify if a task should be
   std::map<TaskId, bool> task_status_;
+// tasks waiting for work, released by notifyWork or by the delayed scheduler thread when their deadline passes
+  TaskParkingLot<TaskId, Worker<T>> parked_tasks_;
 // manager mutex
   std::recursive_mutex manager_mutex_;
+// wakes up the manager thread when the pool is shut down
+  std::mutex manager_wait_mutex_;
+  std::condition_variable manager_condition_;
+// controls the number of worker threads if enabled, guarded by manager_mutex_
+  std::unique_ptr<AdaptiveThreadCount> adaptive_thread_count_;
   // thread pool name
   std::string name_;
+  // index used in the name of the next worker thread
+  int next_thread_index_;
+
+  /**
+   * Starts a new worker thread.
+   */
+  void startWorkerThread();
+
+  /**
+   * Looks up the ThreadPoolManager service.
+   */
+  void resolveThreadManager();
 
   /**
    * Call for the manager to start worker threads
@@ -0,0 +1,231 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Hierarchical timer wheel with millisecond resolution.
+ *
+ * Items are kept in LEVELS wheels of SLOTS slots each. A slot of level L spans SLOTS^L milliseconds, so scheduling
+ * and expiring an item is O(1) regardless of how many items are waiting; items are moved to a finer level when the
+ * wheel below wraps around. Items further in the future than the span of all levels are parked in the top level
+ * and rescheduled when their slot comes around.
+ *
+ * Not thread safe: meant to be owned by a single thread.
+ */
+template<typename T>
+class TimerWheel {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit TimerWheel(clock::time_point now = clock::now())
+      : origin_(now) {
+  }
+
+  /**
+   * Schedules the item to expire at the deadline. Deadlines in the past expire on the next call to advance.
+   */
+  void schedule(clock::time_point deadline, T item) {
+    ++size_;
+    insert(Entry{toTick(deadline, true), std::move(item)});
+  }
+
+  /**
+   * Advances the wheel to now and passes every expired item to the callback, in the order of their deadlines
+   * (items expiring in the same millisecond are passed in no particular order).
+   */
+  template<typename Callback>
+  void advance(clock::time_point now, Callback&& callback) {
+    const uint64_t target = toTick(now, false);
+    expireDue(callback);
+    while (current_ < target) {
+      // skip the ticks where nothing happens
+      const uint64_t next = nextTick();
+      if (next > target) {
+        current_ = target;
+        break;
+      }
+      current_ = next;
+      cascade(1);
+      expireSlot(levels_[0][current_ & SLOT_MASK], callback);
+      expireDue(callback);
+    }
+  }
+
+  /**
+   * Removes every item from the wheel and passes it to the callback, regardless of its deadline.
+   */
+  template<typename Callback>
+  void drain(Callback&& callback) {
+    expireDue(callback);
+    for (auto& level : levels_) {
+      for (auto& slot : level) {
+        expireSlot(slot, callback);
+      }
+    }
+  }
+
+  /**
+   * @return the earliest point in time at which advance can expire an item, clock::time_point::max() if the wheel is empty
+   */
+  clock::time_point nextExpiration() const {
+    return fromTick(nextTick());
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  static constexpr size_t SLOT_BITS = 6;
+  static constexpr uint64_t SLOTS = uint64_t{1} << SLOT_BITS;
+  static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+  // 64^4 ms, a bit more than 4.6 hours
+  static constexpr size_t LEVELS = 4;
+
+  struct Entry {
+    uint64_t tick;
+    T item;
+  };
+
+  using Slot = std::vector<Entry>;
+
+  // deadlines are rounded up and the current time is rounded down, so that items never expire early
+  uint64_t toTick(clock::time_point time_point, bool round_up) const {
+    if (time_point <= origin_) {
+      return 0;
+    }
+    if (time_point == clock::time_point::max()) {
+      return UINT64_MAX - 1;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time_point - origin_);
+    return static_cast<uint64_t>(elapsed.count()) + (round_up && origin_ + elapsed < time_point ? 1 : 0);
+  }
+
+  // the next tick at which an item expires or has to be moved to a lower level, UINT64_MAX if the wheel is empty
+  uint64_t nextTick() const {
+    if (size_ == 0) {
+      return UINT64_MAX;
+    }
+    if (!due_.empty()) {
+      return current_;
+    }
+    uint64_t next = UINT64_MAX;
+    for (size_t level = 0; level < LEVELS; ++level) {
+      const uint64_t level_tick = current_ >> (SLOT_BITS * level);
+      for (uint64_t offset = 1; offset <= SLOTS; ++offset) {
+        if (!levels_[level][(level_tick + offset) & SLOT_MASK].empty()) {
+          next = (std::min)(next, (level_tick + offset) << (SLOT_BITS * level));
+          break;
+        }
+      }
+    }
+    return next;
+  }
+
+  clock::time_point fromTick(uint64_t tick) const {
+    if (tick == UINT64_MAX) {
+      return clock::time_point::max();
+    }
+    return origin_ + std::chrono::milliseconds(tick);
+  }
+
+  void insert(Entry&& entry) {
+    if (entry.tick <= current_) {
+      due_.push_back(std::move(entry));
+      return;
+    }
+    const uint64_t delta = entry.tick - current_;
+    for (size_t level = 0; level < LEVELS; ++level) {
+      if (delta < (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+        levels_[level][(entry.tick >> (SLOT_BITS * level)) & SLOT_MASK].push_back(std::move(entry));
+        return;
+      }
+    }
+    // beyond the span of the wheel: park it in the top level slot that comes around last, it is rescheduled from there
+    const size_t top = LEVELS - 1;
+    levels_[top][((current_ >> (SLOT_BITS * top)) + SLOT_MASK) & SLOT_MASK].push_back(std::move(entry));
+  }
+
+  // moves the items of the slot that has just come around on the given level to the lower levels
+  void cascade(size_t level) {
+    if (level >= LEVELS || (current_ & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) != 0) {
+      return;
+    }
+    cascade(level + 1);
+    Slot slot;
+    std::swap(slot, levels_[level][(current_ >> (SLOT_BITS * level)) & SLOT_MASK]);
+    for (auto& entry : slot) {
+      insert(std::move(entry));
+    }
+  }
+
+  template<typename Callback>
+  void expireSlot(Slot& slot, Callback& callback) {
+    if (slot.empty()) {
+      return;
+    }
+    Slot expired;
+    std::swap(expired, slot);
+    for (auto& entry : expired) {
+      --size_;
+      callback(std::move(entry.item));
+    }
+  }
+
+  template<typename Callback>
+  void expireDue(Callback& callback) {
+    expireSlot(due_, callback);
+  }
+
+  clock::time_point origin_;
+  uint64_t current_ = 0;
+  size_t size_ = 0;
+  std::array<std::array<Slot, SLOTS>, LEVELS> levels_;
+  Slot due_;
+};
+
+template<typename T>
+constexpr size_t TimerWheel<T>::SLOT_BITS;
+template<typename T>
+constexpr uint64_t TimerWheel<T>::SLOTS;
+template<typename T>
+constexpr uint64_t TimerWheel<T>::SLOT_MASK;
+template<typename T>
+constexpr size_t TimerWheel<T>::LEVELS;
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,162 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "concurrentqueue.h"
+#include "utils/TaskParkingLot.h"
+#include "utils/ThreadPool.h"
+#include "utils/TimerWheel.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Thread pool that avoids the shared task queue of ThreadPool.
+ *
+ * Every worker thread owns a lock-free task queue and a timer wheel: tasks that have to run again are put back to
+ * the queue of the worker that ran them, or to its timer wheel if they have to wait. Tasks submitted from outside go
+ * through a shared lock-free injection queue. A worker without work steals from the queues of the others, and takes
+ * over the expired timers of a worker that is late to expire them, e.g. because it is stuck in a long task. Then it
+ * parks until a timer expires or a task is submitted. Tasks waiting for work are kept aside until notifyWork
+ * releases them to the injection queue. Cancellation is tracked by a flag shared by the tasks of an
+ * identifier, so dequeueing a task takes no lock.
+ *
+ * The number of worker threads can be changed while the pool is running: a worker that is no longer needed hands
+ * its tasks over to the others through the injection queue and exits. Unlike ThreadPool, the number of worker
+ * threads is not adjusted by a ThreadManagementService.
+ */
+template<typename T>
+class WorkStealingThreadPool : public ThreadPool<T> {
+ public:
+  explicit WorkStealingThreadPool(int max_worker_threads = 2, const std::string &name = "NamelessPool");
+
+  ~WorkStealingThreadPool() override;
+
+  bool execute(Worker<T> &&task, std::future<T> &future) override;
+  void stopTasks(const TaskId &identifier) override;
+  void notifyWork(const TaskId &identifier) override;
+  bool isTaskRunning(const TaskId &identifier) override;
+  void resume() override;
+  void pause() override;
+  void start() override;
+  void shutdown() override;
+  void setControllerServiceProvider(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider) override;
+  int getWorkerCount() const override;
+
+ protected:
+  void resize(int worker_count) override;
+  size_t getPendingTaskCount() const override;
+
+ private:
+  // upper limit of parking, in case a wake up is missed
+  static constexpr std::chrono::milliseconds MAX_PARK_TIME{100};
+  // how late a worker can be with expiring its own timers before the idle workers take them over
+  static constexpr std::chrono::milliseconds TIMER_STEAL_DELAY{5};
+  // the worker contexts are allocated up front, so that they can be read without locking while the pool is resized
+  static constexpr size_t MAX_WORKER_THREADS = 256;
+
+  struct Task {
+    Task(Worker<T>&& worker, std::shared_ptr<std::atomic<bool>> enabled)
+        : worker(std::move(worker)),
+          enabled(std::move(enabled)) {
+    }
+
+    Worker<T> worker;
+    std::shared_ptr<std::atomic<bool>> enabled;
+    // handed over from the timer wheel of a retiring worker, it may not be due yet
+    bool handed_over = false;
+  };
+
+  using TaskPtr = std::unique_ptr<Task>;
+
+  enum class WorkerState {
+    ACTIVE,
+    // asked to exit, can still be taken back by resize
+    RETIRING,
+    // handing its tasks over or has already exited
+    EXITING
+  };
+
+  struct WorkerContext {
+    explicit WorkerContext(std::chrono::steady_clock::time_point now)
+        : producer_token(queue),
+          timers(now),
+          next_expiration(std::chrono::steady_clock::time_point::max().time_since_epoch().count()),
+          state(WorkerState::ACTIVE) {
+    }
+
+    // only the thread owning the context enqueues to it, the others steal from it
+    moodycamel::ConcurrentQueue<TaskPtr> queue;
+    moodycamel::ProducerToken producer_token;
+    // only the thread owning the context schedules timers, but any worker can expire them
+    std::mutex timers_mutex;
+    TimerWheel<TaskPtr> timers;
+    // the next expiration of the timer wheel, so that the other workers can check it without locking
+    std::atomic<std::chrono::steady_clock::rep> next_expiration;
+    std::atomic<WorkerState> state;
+  };
+
+  void runWorker(size_t index);
+  void handOverTasks(WorkerContext &context);
+  bool findTask(size_t index, TaskPtr &task);
+  void scheduleTimer(WorkerContext &context, std::chrono::steady_clock::time_point deadline, TaskPtr &&task);
+  // moves the expired timers of the wheel to the queue of self, which has to be the context of the calling thread
+  bool expireTimers(WorkerContext &wheel, WorkerContext &self, std::chrono::steady_clock::time_point now);
+  bool stealExpiredTimers(size_t index);
+  static std::chrono::steady_clock::time_point getNextExpiration(const WorkerContext &context);
+  // the point in time from which the idle workers take over the next timer of the context
+  static std::chrono::steady_clock::time_point getStealTime(const WorkerContext &context);
+  bool isWorkAvailable(size_t index) const;
+  void park(size_t index);
+  void wakeWorker();
+
+  // has MAX_WORKER_THREADS slots, the first worker_count_ of them are in use
+  std::vector<std::unique_ptr<WorkerContext>> workers_;
+  std::atomic<size_t> worker_count_;
+  moodycamel::ConcurrentQueue<TaskPtr> injection_queue_;
+  std::atomic<bool> paused_;
+
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_;
+  std::atomic<int> parked_workers_;
+
+  std::mutex task_status_mutex_;
+  std::unordered_map<TaskId, std::shared_ptr<std::atomic<bool>>> task_enabled_;
+
+  // tasks waiting for work, any worker releases the ones whose deadline has passed
+  TaskParkingLot<TaskId, TaskPtr> waiting_tasks_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -27,8 +27,13 @@ constexpr const char *Configuration::nifi_flow_configuration_file;
 constexpr const char *Configuration::nifi_flow_configuration_file_exit_failure;
 constexpr const char *Configuration::nifi_flow_configuration_file_backup_update;
 constexpr const char *Configuration::nifi_flow_engine_threads;
+constexpr const char *Configuration::nifi_flow_engine_thread_pool;
+constexpr const char *Configuration::nifi_flow_engine_threads_adaptive;
+constexpr const char *Configuration::nifi_flow_engine_threads_min;
+constexpr const char *Configuration::nifi_flow_engine_threads_max;
 constexpr const char *Configuration::nifi_flow_engine_alert_period;
 constexpr const char *Configuration::nifi_flow_engine_event_driven_time_slice;
+constexpr const char *Configuration::nifi_flow_engine_max_wait_for_work;
 constexpr const char *Configuration::nifi_administrative_yield_duration;
 constexpr const char *Configuration::nifi_bored_yield_duration;
 constexpr const char *Configuration::nifi_graceful_shutdown_seconds;
@@ -38,6 +43,13 @@ constexpr const char *Configuration::nifi_server_name;
 constexpr const char *Configuration::nifi_configuration_class_name;
 constexpr const char *Configuration::nifi_flow_repository_class_name;
 constexpr const char *Configuration::nifi_content_repository_class_name;
+constexpr const char *Configuration::nifi_content_repository_streaming_session;
+constexpr const char *Configuration::nifi_content_repository_slab_max_size;
+constexpr const char *Configuration::nifi_content_repository_slab_reclaim_period;
+constexpr const char *Configuration::nifi_content_repository_file_stream;
+constexpr const char *Configuration::nifi_content_repository_durability;
+constexpr const char *Configuration::nifi_content_repository_memory_threshold;
+constexpr const char *Configuration::nifi_content_repository_memory_max_size;
 constexpr const char *Configuration::nifi_volatile_repository_options;
 constexpr const char *Configuration::nifi_provenance_repository_class_name;
 constexpr const char *Configuration::nifi_server_port;
@@ -45,10 +57,25 @@ constexpr const char *Configuration::nifi_server_report_interval;
 constexpr const char *Configuration::nifi_provenance_repository_max_storage_size;
 constexpr const char *Configuration::nifi_provenance_repository_max_storage_time;
 constexpr const char *Configuration::nifi_provenance_repository_directory_default;
+constexpr const char *Configuration::nifi_provenance_repository_indexing_enabled;
 constexpr const char *Configuration::nifi_flowfile_repository_max_storage_size;
 constexpr const char *Configuration::nifi_flowfile_repository_max_storage_time;
+constexpr const char *Configuration::nifi_flowfile_repository_group_commit_window;
+constexpr const char *Configuration::nifi_flowfile_repository_group_commit_sync;
+constexpr const char *Configuration::nifi_flowfile_repository_recovery_threads;
 constexpr const char *Configuration::nifi_flowfile_repository_directory_default;
 constexpr const char *Configuration::nifi_dbcontent_repository_directory_default;
+constexpr const char *Configuration::nifi_dbcontent_repository_chunk_size;
+constexpr const char *Configuration::nifi_dbcontent_repository_write_buffer_size;
+constexpr const char *Configuration::nifi_dbcontent_repository_max_write_buffer_number;
+constexpr const char *Configuration::nifi_dbcontent_repository_target_file_size_base;
+constexpr const char *Configuration::nifi_dbcontent_repository_max_bytes_for_level_base;
+constexpr const char *Configuration::nifi_dbcontent_repository_max_background_jobs;
+constexpr const char *Configuration::nifi_dbcontent_repository_statistics_enabled;
+constexpr const char *Configuration::nifi_rocksdb_memory_limit;
+constexpr const char *Configuration::nifi_rocksdb_background_threads;
+constexpr const char *Configuration::nifi_flowfile_swap_directory;
+constexpr const char *Configuration::nifi_queue_swap_threshold;
 constexpr const char *Configuration::nifi_remote_input_secure;
 constexpr const char *Configuration::nifi_remote_input_http;
 constexpr const char *Configuration::nifi_security_need_ClientAuth;
@@ -29,6 +29,9 @@
 #include <thread>
 #include <iostream>
 #include <list>
+#include <limits>
+#include <iterator>
+#include <algorithm>
 #include "core/FlowFile.h"
 #include "core/Processor.h"
 #include "core/logging/LoggerConfiguration.h"
@@ -50,6 +53,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   expired_duration_ = 0;
   queued_data_size_ = 0;
   drop_empty_ = false;
+  lock_free_queue_ = false;
+  swap_threshold_ = 0;
+  swapped_count_ = 0;
+  swapped_data_size_ = 0;
+  next_swap_out_size_ = 0;
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -66,6 +74,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   expired_duration_ = 0;
   queued_data_size_ = 0;
   drop_empty_ = false;
+  lock_free_queue_ = false;
+  swap_threshold_ = 0;
+  swapped_count_ = 0;
+  swapped_data_size_ = 0;
+  next_swap_out_size_ = 0;
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -86,6 +99,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   expired_duration_ = 0;
   queued_data_size_ = 0;
   drop_empty_ = false;
+  lock_free_queue_ = false;
+  swap_threshold_ = 0;
+  swapped_count_ = 0;
+  swapped_data_size_ = 0;
+  next_swap_out_size_ = 0;
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -107,24 +125,39 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   expired_duration_ = 0;
   queued_data_size_ = 0;
   drop_empty_ = false;
+  lock_free_queue_ = false;
+  swap_threshold_ = 0;
+  swapped_count_ = 0;
+  swapped_data_size_ = 0;
+  next_swap_out_size_ = 0;
 
   logger_->log_debug("Connection %s created", name_);
 }
 
 bool Connection::isEmpty() const {
+  if (lock_free_queue_) {
+    return concurrent_queue_.empty();
+  }
   std::lock_guard<std::mutex> lock(mutex_);
 
-  return queue_.empty();
+  return queuedCount() == 0;
 }
 
 bool Connection::isFull() {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   if (max_queue_size_ <= 0 && max_data_queue_size_ <= 0)
     // No back pressure setting
     return false;
 
-  if (max_queue_size_ > 0 && queue_.size() >= max_queue_size_)
+  if (lock_free_queue_) {
+    if (max_queue_size_ > 0 && concurrent_queue_.size() >= max_queue_size_)
+      return true;
+
+    return max_data_queue_size_ > 0 && concurrent_queue_.dataSize() >= max_data_queue_size_;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (max_queue_size_ > 0 && queuedCount() >= max_queue_size_)
     return true;
 
   if (max_data_queue_size_ > 0 && queued_data_size_ >= max_data_queue_size_)
@@ -133,19 +166,34 @@ bool Connection::isFull() {
   return false;
 }
 
+void Connection::enqueue(const std::shared_ptr<core::FlowFile>& flow_file) {
+  if (lock_free_queue_) {
+    concurrent_queue_.push(flow_file);
+  } else if (isSwapEnabled() && (queue_.size() >= swap_threshold_ || !swap_buffer_.empty() || !swap_locations_.empty())) {
+    // keep the queue in order: everything arriving after a swapped out flow file has to wait behind it
+    swap_buffer_.push_back(flow_file);
+    queued_data_size_ += flow_file->getSize();
+    if (swap_buffer_.size() >= (std::max)(swapBatchSize(), next_swap_out_size_)) {
+      swapOut();
+    }
+  } else {
+    queue_.push(flow_file);
+    queued_data_size_ += flow_file->getSize();
+  }
+
+  logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow_file->getUUIDStr(), name_);
+}
+
 void Connection::put(const std::shared_ptr<core::FlowFile>& flow) {
   if (drop_empty_ && flow->getSize() == 0) {
     logger_->log_info("Dropping empty flow file: %s", flow->getUUIDStr());
     return;
   }
-  {
+  if (lock_free_queue_) {
+    enqueue(flow);
+  } else {
     std::lock_guard<std::mutex> lock(mutex_);
-
-    queue_.push(flow);
-
-    queued_data_size_ += flow->getSize();
-
-    logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+    enqueue(flow);
   }
 
   // Notify receiving processor that work may be available
@@ -155,20 +203,20 @@ void Connection::put(const std::shared_ptr<core::FlowFile>& flow) {
   }
 }
 
-void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
+void Connection::multiPut(const std::vector<std::shared_ptr<core::FlowFile>>& flows) {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    if (!lock_free_queue_) {
+      lock.lock();
+    }
 
-    for (auto &ff : flows) {
+    for (const auto &ff : flows) {
       if (drop_empty_ && ff->getSize() == 0) {
         logger_->log_info("Dropping empty flow file: %s", ff->getUUIDStr());
         continue;
       }
 
-      queue_.push(ff);
-      queued_data_size_ += ff->getSize();
-
-      logger_->log_debug("Enqueue flow file UUID %s to connection %s", ff->getUUIDStr(), name_);
+      enqueue(ff);
     }
   }
 
@@ -178,44 +226,155 @@ void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
   }
 }
 
+bool Connection::isExpired(const std::shared_ptr<core::FlowFile>& flow_file) const {
+  // We need to check for flow expiration
+  return expired_duration_ > 0 && utils::timeutils::getTimeMillis() > (flow_file->getEntryDate() + expired_duration_);
+}
+
 std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files = pollBatch(1, expiredFlowRecords);
+  return flow_files.empty() ? nullptr : flow_files.front();
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> Connection::pollBatch(size_t max_count, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  return pollBatch(max_count, std::numeric_limits<uint64_t>::max(), expiredFlowRecords);
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> Connection::pollBatch(size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  std::vector<std::shared_ptr<core::FlowFile>> polled;
+  uint64_t polled_bytes = 0;
+  const auto budget_left = [&] { return polled.size() < max_count && polled_bytes < max_bytes; };
+  const auto should_keep = [&](const std::shared_ptr<core::FlowFile>& item) {
+    if (isExpired(item)) {
+      // Flow record expired
+      expiredFlowRecords.insert(item);
+      logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+      return false;
+    }
+    polled_bytes += item->getSize();
+    return true;
+  };
+
+  if (lock_free_queue_) {
+    // with a byte budget we can not tell in advance how many flow files fit, so they are popped one by one
+    const bool has_byte_budget = max_bytes != std::numeric_limits<uint64_t>::max();
+    std::vector<std::shared_ptr<core::FlowFile>> popped;
+    while (budget_left() && concurrent_queue_.tryPopBatch(has_byte_budget ? 1 : max_count - polled.size(), popped) > 0) {
+      for (auto& item : popped) {
+        if (should_keep(item)) {
+          polled.push_back(std::move(item));
+        }
+      }
+      popped.clear();
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (shouldSwapIn()) {
+      swapIn();
+    }
+    while (budget_left() && queue_.isWorkAvailable()) {
+      std::shared_ptr<core::FlowFile> item = queue_.pop();
+      queued_data_size_ -= item->getSize();
 
-  while (queue_.isWorkAvailable()) {
-    std::shared_ptr<core::FlowFile> item = queue_.pop();
-    queued_data_size_ -= item->getSize();
-
-    if (expired_duration_ > 0) {
-      // We need to check for flow expiration
-      if (utils::timeutils::getTimeMillis() > (item->getEntryDate() + expired_duration_)) {
-        // Flow record expired
-        expiredFlowRecords.insert(item);
-        logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
-      } else {
-        std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-        item->setConnection(connectable);
-        logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-        return item;
+      if (should_keep(item)) {
+        polled.push_back(std::move(item));
       }
-    } else {
-      std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+    }
+  }
+
+  if (!polled.empty()) {
+    std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+    for (const auto& item : polled) {
       item->setConnection(connectable);
       logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-      return item;
     }
   }
 
-  return NULL;
+  return polled;
+}
+
+uint64_t Connection::queuedCount() const {
+  return queue_.size() + swap_buffer_.size() + swapped_count_;
+}
+
+bool Connection::isSwapEnabled() const {
+  return swap_threshold_ > 0 && swap_manager_ != nullptr;
+}
+
+uint64_t Connection::swapBatchSize() const {
+  static constexpr uint64_t MAX_SWAP_BATCH_SIZE = 10000;
+  return (std::max)(uint64_t{1}, (std::min)(MAX_SWAP_BATCH_SIZE, swap_threshold_ / 2));
+}
+
+bool Connection::shouldSwapIn() const {
+  return (!swap_locations_.empty() || !swap_buffer_.empty()) && queue_.size() <= swap_threshold_ / 2;
+}
+
+void Connection::swapOut() {
+  auto location = swap_manager_->swapOut(getUUIDStr(), swap_buffer_);
+  if (!location) {
+    logger_->log_warn("Failed to swap out %zu flow files of connection %s, keeping them in memory", swap_buffer_.size(), name_);
+    // retry once the buffer has doubled instead of serializing the growing buffer on every enqueue
+    next_swap_out_size_ = swap_buffer_.size() * 2;
+    return;
+  }
+  next_swap_out_size_ = 0;
+  swapped_count_ += location->count;
+  swapped_data_size_ += location->data_size;
+  swap_locations_.push_back(std::move(*location));
+  swap_buffer_.clear();
+}
+
+void Connection::swapIn() {
+  while (shouldSwapIn()) {
+    if (swap_locations_.empty()) {
+      // nothing left on disk, the flow files waiting to be swapped out can move to the queue directly
+      for (auto& flow_file : swap_buffer_) {
+        queue_.push(std::move(flow_file));
+      }
+      swap_buffer_.clear();
+      next_swap_out_size_ = 0;
+      return;
+    }
+    const SwapLocation location = std::move(swap_locations_.front());
+    swap_locations_.pop_front();
+    swapped_count_ -= location.count;
+    swapped_data_size_ -= location.data_size;
+    queued_data_size_ -= location.data_size;
+    for (auto& flow_file : swap_manager_->swapIn(location)) {
+      queued_data_size_ += flow_file->getSize();
+      queue_.push(std::move(flow_file));
+    }
+    logger_->log_debug("Swapped in %zu flow files to connection %s", location.count, name_);
+  }
 }
 
 void Connection::drain(bool delete_permanently) {
   std::lock_guard<std::mutex> lock(mutex_);
 
+  std::vector<std::shared_ptr<core::FlowFile>> drained;
+  if (lock_free_queue_) {
+    drained = concurrent_queue_.popAll();
+  }
   while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.pop();
+    drained.push_back(queue_.pop());
+  }
+  for (const auto& location : swap_locations_) {
+    auto swapped_in = swap_manager_->swapIn(location);
+    std::move(swapped_in.begin(), swapped_in.end(), std::back_inserter(drained));
+  }
+  swap_locations_.clear();
+  swapped_count_ = 0;
+  swapped_data_size_ = 0;
+  next_swap_out_size_ = 0;
+  std::move(swap_buffer_.begin(), swap_buffer_.end(), std::back_inserter(drained));
+  swap_buffer_.clear();
+
+  for (const auto& item : drained) {
     logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
     if (delete_permanently) {
-      if (item->isStored() && flow_repository_->Delete(item->getUUIDStr())) {
+      if (item->isStored() && flow_repository_->Delete(item->getUUIDStr(), item->getStoredResourceClaim())) {
         item->setStoredToRepository(false);
         auto claim = item->getResourceClaim();
         if (claim) claim->decreaseFlowFileRecordOwnedCount();
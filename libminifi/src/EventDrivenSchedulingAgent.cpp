@@ -47,7 +47,11 @@ utils::TaskRescheduleInfo EventDrivenSchedulingAgent::run(const std::shared_ptr<
         // Honor the yield
         return utils::TaskRescheduleInfo::RetryIn(std::chrono::milliseconds(processor->getYieldTime()));
       } else if (shouldYield) {
-        // No work to do or need to apply back pressure
+        if (!hasWorkToDo(processor)) {
+          // the inputs are empty, sleep until something is queued
+          return waitForWork();
+        }
+        // need to apply back pressure
         return utils::TaskRescheduleInfo::RetryIn(
             std::chrono::milliseconds((this->bored_yield_duration_ > 0) ? this->bored_yield_duration_ : 10));  // No work left to do, stand by
       }
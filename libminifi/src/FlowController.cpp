@@ -18,6 +18,7 @@
  * limitations under the License.
  */
 #include <time.h>
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <chrono>
@@ -50,6 +51,8 @@
 #include "utils/file/FileSystem.h"
 #include "utils/HTTPClient.h"
 #include "utils/GeneralUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/WorkStealingThreadPool.h"
 #include "io/NetworkPrioritizer.h"
 #include "io/validation.h"
 
@@ -58,6 +61,29 @@ namespace apache {
 namespace nifi {
 namespace minifi {
 
+namespace {
+
+std::unique_ptr<utils::ThreadPool<utils::TaskRescheduleInfo>> createThreadPool(const std::shared_ptr<Configure>& configuration) {
+  std::unique_ptr<utils::ThreadPool<utils::TaskRescheduleInfo>> pool;
+  std::string pool_type;
+  if (configuration && configuration->get(Configure::nifi_flow_engine_thread_pool, pool_type) && utils::StringUtils::equalsIgnoreCase(utils::StringUtils::trim(pool_type), "work-stealing")) {
+    pool = utils::make_unique<utils::WorkStealingThreadPool<utils::TaskRescheduleInfo>>(2, "Flowcontroller threadpool");
+  } else {
+    pool = utils::make_unique<utils::ThreadPool<utils::TaskRescheduleInfo>>(2, false, nullptr, "Flowcontroller threadpool");
+  }
+  std::string adaptive;
+  if (configuration && configuration->get(Configure::nifi_flow_engine_threads_adaptive, adaptive) && utils::StringUtils::toBool(adaptive).value_or(false)) {
+    const int threads = configuration->getInt(Configure::nifi_flow_engine_threads, 2);
+    const int default_max_threads = (std::max)(threads, 2 * static_cast<int>(std::thread::hardware_concurrency()));
+    const int min_threads = (std::max)(configuration->getInt(Configure::nifi_flow_engine_threads_min, 1), 1);
+    const int max_threads = (std::max)(configuration->getInt(Configure::nifi_flow_engine_threads_max, default_max_threads), min_threads);
+    pool->enableAdaptiveThreadCount(static_cast<uint16_t>(min_threads), static_cast<uint16_t>(max_threads));
+  }
+  return pool;
+}
+
+}  // namespace
+
 FlowController::FlowController(std::shared_ptr<core::Repository> provenance_repo, std::shared_ptr<core::Repository> flow_file_repo,
                                std::shared_ptr<Configure> configure, std::unique_ptr<core::FlowConfiguration> flow_configuration,
                                std::shared_ptr<core::ContentRepository> content_repo, const std::string /*name*/, bool headless_mode,
@@ -68,7 +94,7 @@ FlowController::FlowController(std::shared_ptr<core::Repository> provenance_repo
       running_(false),
       updating_(false),
       initialized_(false),
-      thread_pool_(2, false, nullptr, "Flowcontroller threadpool"),
+      thread_pool_(createThreadPool(configuration_)),
       logger_(logging::LoggerFactory<FlowController>::getLogger()) {
   if (provenance_repo_ == nullptr)
     throw std::runtime_error("Provenance Repo should not be null");
@@ -201,7 +227,7 @@ int16_t FlowController::stop() {
     timer_scheduler_->stop();
     event_scheduler_->stop();
     cron_scheduler_->stop();
-    thread_pool_.shutdown();
+    thread_pool_->shutdown();
     /* STOP! Before you change it, consider the following:
      * -Stopping the schedulers doesn't actually quit the onTrigger functions of processors
      * -They only guarantee that the processors are not scheduled any more
@@ -307,11 +333,11 @@ void FlowController::load(const std::shared_ptr<core::ProcessGroup> &root, bool
     controller_service_provider_impl_ = flow_configuration_->getControllerServiceProvider();
     auto base_shared_ptr = std::dynamic_pointer_cast<core::controller::ControllerServiceProvider>(shared_from_this());
 
-    if (!thread_pool_.isRunning() || reload) {
-      thread_pool_.shutdown();
-      thread_pool_.setMaxConcurrentTasks(configuration_->getInt(Configure::nifi_flow_engine_threads, 2));
-      thread_pool_.setControllerServiceProvider(base_shared_ptr);
-      thread_pool_.start();
+    if (!thread_pool_->isRunning() || reload) {
+      thread_pool_->shutdown();
+      thread_pool_->setMaxConcurrentTasks(configuration_->getInt(Configure::nifi_flow_engine_threads, 2));
+      thread_pool_->setControllerServiceProvider(base_shared_ptr);
+      thread_pool_->start();
     }
 
     conditionalReloadScheduler<TimerDrivenSchedulingAgent>(timer_scheduler_, !timer_scheduler_ || reload);
@@ -384,7 +410,7 @@ int16_t FlowController::start() {
       this->protocol_->start();
       this->provenance_repo_->start();
       this->flow_file_repo_->start();
-      thread_pool_.start();
+      thread_pool_->start();
       logger_->log_info("Started Flow Controller");
     }
     return 0;
@@ -399,7 +425,7 @@ int16_t FlowController::pause() {
   }
 
   logger_->log_info("Pausing Flow Controller");
-  thread_pool_.pause();
+  thread_pool_->pause();
   return 0;
 }
 
@@ -411,7 +437,7 @@ int16_t FlowController::resume() {
   }
 
   logger_->log_info("Resuming Flow Controller");
-  thread_pool_.resume();
+  thread_pool_->resume();
   return 0;
 }
 
@@ -426,6 +452,12 @@ int16_t FlowController::applyUpdate(const std::string &source, const std::string
   }
 }
 
+int16_t FlowController::setThreadPoolSize(uint16_t threads) {
+  logger_->log_info("Resizing the thread pool to %d threads", static_cast<int>(threads));
+  thread_pool_->setMaxConcurrentTasks(threads);
+  return 0;
+}
+
 int16_t FlowController::clearConnection(const std::string &connection) {
   if (root_ != nullptr) {
     logger_->log_info("Attempting to clear connection %s", connection);
@@ -506,7 +538,7 @@ uint64_t FlowController::getUptime() {
 }
 
 std::vector<BackTrace> FlowController::getTraces() {
-  std::vector<BackTrace> traces{thread_pool_.getTraces()};
+  std::vector<BackTrace> traces{thread_pool_->getTraces()};
   auto prov_repo_trace = provenance_repo_->getTraces();
   traces.emplace_back(std::move(prov_repo_trace));
   auto flow_repo_trace = flow_file_repo_->getTraces();
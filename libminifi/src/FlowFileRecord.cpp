@@ -18,7 +18,11 @@
  * limitations under the License.
  */
 #include <time.h>
+#include <algorithm>
+#include <array>
 #include <cstdio>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <queue>
 #include <map>
@@ -38,6 +42,115 @@ namespace apache {
 namespace nifi {
 namespace minifi {
 
+namespace {
+
+// Records in the compact format start with this byte. The original format starts with the big-endian
+// event time in milliseconds, whose most significant byte is zero for any realistic timestamp.
+constexpr uint8_t COMPACT_FORMAT_MAGIC = 0xFE;
+constexpr uint8_t COMPACT_FORMAT_VERSION = 1;
+
+// Attribute keys encoded by their position (starting from 1, 0 means a literal key follows) in the compact format.
+// The codes are persisted in the FlowFile repository: only append to this list.
+const std::array<const char*, 24> ATTRIBUTE_KEY_DICTIONARY{{
+  "filename", "path", "absolute.path", "uuid", "priority", "mime.type", "discard.reason", "alternate.identifier", "flow.id",
+  "file.size", "file.creationTime", "file.lastModifiedTime", "file.lastAccessTime", "file.owner", "file.group", "file.permissions",
+  "fragment.identifier", "fragment.index", "fragment.count", "segment.original.filename",
+  "invokehttp.status.code", "invokehttp.status.message", "invokehttp.request.url", "invokehttp.tx.id"
+}};
+
+enum class ClaimEncoding : uint8_t {
+  NONE = 0,
+  // the claim id relative to the storage path of the content repository
+  ID = 1,
+  FULL_PATH = 2
+};
+
+const std::unordered_map<std::string, uint64_t>& attributeKeyCodes() {
+  static const std::unordered_map<std::string, uint64_t> codes = [] {
+    std::unordered_map<std::string, uint64_t> result;
+    for (size_t i = 0; i < ATTRIBUTE_KEY_DICTIONARY.size(); ++i) {
+      result.emplace(ATTRIBUTE_KEY_DICTIONARY[i], i + 1);
+    }
+    return result;
+  }();
+  return codes;
+}
+
+// claims are created under the default directory if their repository has no storage path, see ResourceClaim
+std::string claimStoragePath(const std::string& storage_path) {
+  return storage_path.empty() ? default_directory_path : storage_path;
+}
+
+bool writeVarInt(io::OutputStream& stream, uint64_t value) {
+  uint8_t buffer[10];
+  int size = 0;
+  do {
+    buffer[size] = gsl::narrow_cast<uint8_t>(value & 0x7F);
+    value >>= 7;
+    if (value != 0) {
+      buffer[size] |= 0x80;
+    }
+    ++size;
+  } while (value != 0);
+  return stream.write(buffer, size) == size;
+}
+
+bool readVarInt(io::InputStream& stream, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t byte = 0;
+    if (stream.read(&byte, 1) != 1) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool writeBytes(io::OutputStream& stream, const std::string& str) {
+  if (!writeVarInt(stream, str.size())) {
+    return false;
+  }
+  return str.empty() || stream.write(reinterpret_cast<const uint8_t*>(str.data()), gsl::narrow<int>(str.size())) == gsl::narrow<int>(str.size());
+}
+
+bool readBytes(io::InputStream& stream, std::string& str) {
+  uint64_t remaining = 0;
+  if (!readVarInt(stream, remaining)) {
+    return false;
+  }
+  // read in chunks, so that a corrupt length cannot trigger a huge allocation
+  str.clear();
+  uint8_t buffer[4096];
+  while (remaining > 0) {
+    const int chunk = gsl::narrow<int>((std::min<uint64_t>)(remaining, sizeof(buffer)));
+    if (stream.read(buffer, chunk) != chunk) {
+      return false;
+    }
+    str.append(reinterpret_cast<const char*>(buffer), chunk);
+    remaining -= chunk;
+  }
+  return true;
+}
+
+bool writeIdentifier(io::OutputStream& stream, const utils::Identifier& id) {
+  return stream.write(id.getData().data(), gsl::narrow<int>(id.getData().size())) == gsl::narrow<int>(id.getData().size());
+}
+
+bool readIdentifier(io::InputStream& stream, utils::Identifier& id) {
+  utils::Identifier::Data data;
+  if (stream.read(data.data(), gsl::narrow<int>(data.size())) != gsl::narrow<int>(data.size())) {
+    return false;
+  }
+  id = utils::Identifier(data);
+  return true;
+}
+
+}  // namespace
+
 std::shared_ptr<logging::Logger> FlowFileRecord::logger_ = logging::LoggerFactory<FlowFileRecord>::getLogger();
 std::atomic<uint64_t> FlowFileRecord::local_flow_seq_number_(0);
 
@@ -70,25 +183,12 @@ std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(const std::string& k
 }
 
 bool FlowFileRecord::Serialize(io::OutputStream &outStream) {
-  int ret;
-
-  ret = outStream.write(event_time_);
-  if (ret != 8) {
+  const uint8_t header[] = {COMPACT_FORMAT_MAGIC, COMPACT_FORMAT_VERSION};
+  if (outStream.write(header, sizeof(header)) != sizeof(header)) {
     return false;
   }
 
-  ret = outStream.write(entry_date_);
-  if (ret != 8) {
-    return false;
-  }
-
-  ret = outStream.write(lineage_start_date_);
-  if (ret != 8) {
-    return false;
-  }
-
-  ret = outStream.write(uuid_);
-  if (ret <= 0) {
+  if (!writeVarInt(outStream, event_time_) || !writeVarInt(outStream, entry_date_) || !writeVarInt(outStream, lineage_start_date_)) {
     return false;
   }
 
@@ -96,44 +196,46 @@ bool FlowFileRecord::Serialize(io::OutputStream &outStream) {
   if (connection_) {
     containerId = connection_->getUUID();
   }
-  ret = outStream.write(containerId);
-  if (ret <= 0) {
+  if (!writeIdentifier(outStream, uuid_) || !writeIdentifier(outStream, containerId)) {
     return false;
   }
+
   // write flow attributes
-  uint32_t numAttributes = gsl::narrow<uint32_t>(attributes_.size());
-  ret = outStream.write(numAttributes);
-  if (ret != 4) {
+  if (!writeVarInt(outStream, attributes_.size())) {
     return false;
   }
-
-  for (auto& itAttribute : attributes_) {
-    ret = outStream.write(itAttribute.first, true);
-    if (ret <= 0) {
+  const auto& dictionary = attributeKeyCodes();
+  for (const auto& attribute : attributes_) {
+    const auto code = dictionary.find(attribute.first);
+    if (code != dictionary.end()) {
+      if (!writeVarInt(outStream, code->second)) {
+        return false;
+      }
+    } else if (!writeVarInt(outStream, 0) || !writeBytes(outStream, attribute.first)) {
       return false;
     }
-    ret = outStream.write(itAttribute.second, true);
-    if (ret <= 0) {
+    if (!writeBytes(outStream, attribute.second)) {
       return false;
     }
   }
 
-  ret = outStream.write(getContentFullPath());
-  if (ret <= 0) {
-    return false;
-  }
-
-  ret = outStream.write(size_);
-  if (ret != 8) {
-    return false;
-  }
-
-  ret = outStream.write(offset_);
-  if (ret != 8) {
-    return false;
+  if (!claim_) {
+    if (!writeVarInt(outStream, static_cast<uint8_t>(ClaimEncoding::NONE))) {
+      return false;
+    }
+  } else {
+    const std::string path = claim_->getContentFullPath();
+    const std::string storage_prefix = claimStoragePath(claim_->getStoragePath()) + "/";
+    if (path.size() > storage_prefix.size() && path.compare(0, storage_prefix.size(), storage_prefix) == 0) {
+      if (!writeVarInt(outStream, static_cast<uint8_t>(ClaimEncoding::ID)) || !writeBytes(outStream, path.substr(storage_prefix.size()))) {
+        return false;
+      }
+    } else if (!writeVarInt(outStream, static_cast<uint8_t>(ClaimEncoding::FULL_PATH)) || !writeBytes(outStream, path)) {
+      return false;
+    }
   }
 
-  return true;
+  return writeVarInt(outStream, size_) && writeVarInt(outStream, offset_);
 }
 
 bool FlowFileRecord::Persist(const std::shared_ptr<core::Repository>& flowRepository) {
@@ -161,14 +263,105 @@ bool FlowFileRecord::Persist(const std::shared_ptr<core::Repository>& flowReposi
 }
 
 std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(io::InputStream& inStream, const std::shared_ptr<core::ContentRepository>& content_repo, utils::Identifier& container) {
+  uint8_t first_byte = 0;
+  if (inStream.read(&first_byte, 1) != 1) {
+    return {};
+  }
+  if (first_byte == COMPACT_FORMAT_MAGIC) {
+    return DeSerializeCompact(inStream, content_repo, container);
+  }
+  return DeSerializeOriginal(first_byte, inStream, content_repo, container);
+}
+
+std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerializeCompact(io::InputStream& inStream, const std::shared_ptr<core::ContentRepository>& content_repo, utils::Identifier& container) {
+  uint8_t version = 0;
+  if (inStream.read(&version, 1) != 1 || version != COMPACT_FORMAT_VERSION) {
+    logger_->log_error("Unsupported FlowFile record format version %" PRIu8, version);
+    return {};
+  }
+
+  auto file = std::make_shared<FlowFileRecord>();
+  if (!readVarInt(inStream, file->event_time_) || !readVarInt(inStream, file->entry_date_) || !readVarInt(inStream, file->lineage_start_date_)) {
+    return {};
+  }
+
+  if (!readIdentifier(inStream, file->uuid_) || !readIdentifier(inStream, container)) {
+    return {};
+  }
+
+  // read flow attributes
+  uint64_t numAttributes = 0;
+  if (!readVarInt(inStream, numAttributes)) {
+    return {};
+  }
+  for (uint64_t i = 0; i < numAttributes; i++) {
+    uint64_t code = 0;
+    if (!readVarInt(inStream, code)) {
+      return {};
+    }
+    std::string key;
+    if (code == 0) {
+      if (!readBytes(inStream, key)) {
+        return {};
+      }
+    } else if (code <= ATTRIBUTE_KEY_DICTIONARY.size()) {
+      key = ATTRIBUTE_KEY_DICTIONARY[code - 1];
+    } else {
+      logger_->log_error("Unknown attribute key code %" PRIu64, code);
+      return {};
+    }
+    std::string value;
+    if (!readBytes(inStream, value)) {
+      return {};
+    }
+    file->attributes_[key] = std::move(value);
+  }
+
+  uint64_t claim_encoding = 0;
+  if (!readVarInt(inStream, claim_encoding)) {
+    return {};
+  }
+  std::string content_full_path;
+  if (claim_encoding == static_cast<uint8_t>(ClaimEncoding::ID)) {
+    std::string claim_id;
+    if (!readBytes(inStream, claim_id)) {
+      return {};
+    }
+    content_full_path = claimStoragePath(content_repo ? content_repo->getStoragePath() : "") + "/" + claim_id;
+  } else if (claim_encoding == static_cast<uint8_t>(ClaimEncoding::FULL_PATH)) {
+    if (!readBytes(inStream, content_full_path)) {
+      return {};
+    }
+  } else if (claim_encoding != static_cast<uint8_t>(ClaimEncoding::NONE)) {
+    return {};
+  }
+
+  if (!readVarInt(inStream, file->size_) || !readVarInt(inStream, file->offset_)) {
+    return {};
+  }
+
+  if (claim_encoding != static_cast<uint8_t>(ClaimEncoding::NONE)) {
+    file->claim_ = std::make_shared<ResourceClaim>(content_full_path, content_repo);
+  }
+
+  return file;
+}
+
+std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerializeOriginal(uint8_t first_byte, io::InputStream& inStream, const std::shared_ptr<core::ContentRepository>& content_repo,
+    utils::Identifier& container) {
   int ret;
 
   auto file = std::make_shared<FlowFileRecord>();
 
-  ret = inStream.read(file->event_time_);
-  if (ret != 8) {
+  // the first byte of the event time has already been consumed to detect the format
+  uint8_t event_time_rest[7];
+  if (inStream.read(event_time_rest, sizeof(event_time_rest)) != sizeof(event_time_rest)) {
     return {};
   }
+  file->event_time_ = first_byte;
+  for (uint8_t byte : event_time_rest) {
+    file->event_time_ = (file->event_time_ << 8) | byte;
+  }
 
   ret = inStream.read(file->entry_date_);
   if (ret != 8) {
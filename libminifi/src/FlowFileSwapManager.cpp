@@ -0,0 +1,167 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "FlowFileSwapManager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "FlowFileRecord.h"
+#include "io/BufferStream.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "utils/file/FileUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+constexpr uint32_t FlowFileSwapManager::SWAP_FILE_VERSION;
+
+namespace {
+
+constexpr const char* SWAP_FILE_EXTENSION = ".swap";
+
+bool serialize(const std::shared_ptr<core::FlowFile>& flow_file, io::OutputStream& stream) {
+  const auto record = std::dynamic_pointer_cast<FlowFileRecord>(flow_file);
+  if (record) {
+    return record->Serialize(stream);
+  }
+  FlowFileRecord copy;
+  static_cast<core::FlowFile&>(copy) = *flow_file;
+  return copy.Serialize(stream);
+}
+
+}  // namespace
+
+FlowFileSwapManager::FlowFileSwapManager(std::string swap_directory, std::shared_ptr<core::ContentRepository> content_repo)
+    : swap_directory_(std::move(swap_directory)),
+      content_repo_(std::move(content_repo)),
+      swap_file_counter_(0),
+      logger_(logging::LoggerFactory<FlowFileSwapManager>::getLogger()) {
+  utils::file::FileUtils::create_dir(swap_directory_);
+}
+
+utils::optional<SwapLocation> FlowFileSwapManager::swapOut(const std::string& queue_id, const std::vector<std::shared_ptr<core::FlowFile>>& flow_files) {
+  SwapLocation location;
+  location.path = utils::file::FileUtils::concat_path(swap_directory_, queue_id + "-" + std::to_string(swap_file_counter_++) + SWAP_FILE_EXTENSION);
+
+  io::BufferStream stream;
+  stream.write(SWAP_FILE_VERSION);
+  stream.write(gsl::narrow<uint32_t>(flow_files.size()));
+  for (const auto& flow_file : flow_files) {
+    stream.write(flow_file->getResourceClaim() != nullptr);
+    stream.write(flow_file->isStored());
+    // swap files are only read by the same process, so the steady clock can be used
+    stream.write(static_cast<int64_t>(flow_file->getPenaltyExpiration().time_since_epoch().count()));
+    if (!serialize(flow_file, stream)) {
+      logger_->log_error("Could not serialize flow file %s for swapping", flow_file->getUUIDStr());
+      return utils::nullopt;
+    }
+    location.data_size += flow_file->getSize();
+  }
+  location.count = flow_files.size();
+
+  {
+    std::ofstream file(location.path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(stream.getBuffer()), stream.size());
+    if (!file) {
+      logger_->log_error("Could not write swap file %s", location.path);
+      file.close();
+      std::remove(location.path.c_str());
+      return utils::nullopt;
+    }
+  }
+
+  // the swap file takes over the in-memory FlowFiles' reference on the content
+  for (const auto& flow_file : flow_files) {
+    if (const auto claim = flow_file->getResourceClaim()) {
+      claim->increaseFlowFileRecordOwnedCount();
+    }
+  }
+
+  logger_->log_debug("Swapped out %zu flow files (%" PRIu64 " bytes) to %s", location.count, location.data_size, location.path);
+  return location;
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> FlowFileSwapManager::swapIn(const SwapLocation& location) {
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+
+  std::ifstream file(location.path, std::ios::binary);
+  const std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  file.close();
+  io::BufferStream stream(content);
+
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (stream.read(version) != sizeof(version) || version != SWAP_FILE_VERSION || stream.read(count) != sizeof(count)) {
+    logger_->log_error("Invalid swap file %s, %zu flow files are lost from the queue", location.path, location.count);
+    std::remove(location.path.c_str());
+    return flow_files;
+  }
+
+  flow_files.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    bool has_claim = false;
+    bool stored = false;
+    int64_t penalty_expiration = 0;
+    if (stream.read(has_claim) != 1 || stream.read(stored) != 1 || stream.read(penalty_expiration) != sizeof(penalty_expiration)) {
+      logger_->log_error("Truncated swap file %s", location.path);
+      break;
+    }
+    utils::Identifier container;
+    auto record = FlowFileRecord::DeSerialize(stream, has_claim ? content_repo_ : nullptr, container);
+    if (!record) {
+      logger_->log_error("Could not deserialize flow file from swap file %s", location.path);
+      break;
+    }
+    if (has_claim) {
+      // release the reference held on behalf of the swap file
+      record->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
+    } else {
+      record->setResourceClaim(nullptr);
+    }
+    record->setStoredToRepository(stored);
+    const std::chrono::steady_clock::time_point penalty_expiration_time(std::chrono::steady_clock::duration(penalty_expiration));
+    record->penalize(penalty_expiration_time - std::chrono::steady_clock::now());
+    flow_files.push_back(std::move(record));
+  }
+
+  std::remove(location.path.c_str());
+  logger_->log_debug("Swapped in %zu flow files from %s", flow_files.size(), location.path);
+  return flow_files;
+}
+
+void FlowFileSwapManager::removeStaleSwapFiles() {
+  utils::file::FileUtils::list_dir(swap_directory_, [this](const std::string& dir, const std::string& filename) {
+    if (utils::StringUtils::endsWith(filename, SWAP_FILE_EXTENSION)) {
+      const auto path = utils::file::FileUtils::concat_path(dir, filename);
+      logger_->log_debug("Removing stale swap file %s", path);
+      std::remove(path.c_str());
+    }
+    return true;
+  }, logger_, false);
+}
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
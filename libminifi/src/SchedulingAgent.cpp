@@ -24,6 +24,7 @@
 #include <memory>
 #include "core/Processor.h"
 #include "utils/GeneralUtils.h"
+#include "utils/OsUtils.h"
 #include "utils/gsl.h"
 
 namespace org {
@@ -33,7 +34,7 @@ namespace minifi {
 
 bool SchedulingAgent::hasWorkToDo(const std::shared_ptr<core::Processor>& processor) {
   // Whether it has work to do
-  if (processor->getTriggerWhenEmpty() || !processor->hasIncomingConnections() || processor->isWorkAvailable())
+  if (processor->getTriggerWhenEmpty() || (!processor->hasIncomingConnections() && !processor->notifiesOwnWork()) || processor->isWorkAvailable())
     return true;
   else
     return false;
@@ -117,6 +118,8 @@ bool SchedulingAgent::onTrigger(const std::shared_ptr<core::Processor> &processo
   });
 
   processor->incrementActiveTasks();
+  const auto trigger_start = std::chrono::steady_clock::now();
+  const auto cpu_time_start = utils::OsUtils::getCurrentThreadCpuTime();
   try {
     processor->onTrigger(processContext, sessionFactory);
     processor->decrementActiveTask();
@@ -129,6 +132,7 @@ bool SchedulingAgent::onTrigger(const std::shared_ptr<core::Processor> &processo
     processor->yield(admin_yield_duration_);
     processor->decrementActiveTask();
   }
+  processor->getStatistics().recordTrigger(std::chrono::steady_clock::now() - trigger_start, utils::OsUtils::getCurrentThreadCpuTime() - cpu_time_start);
 
   return false;
 }
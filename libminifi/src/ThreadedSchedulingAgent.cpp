@@ -67,6 +67,15 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
     }
   }
 
+  max_wait_for_work_ = SCHEDULING_DEFAULT_MAX_WAIT_FOR_WORK_MS;
+  if (configure_->get(Configure::nifi_flow_engine_max_wait_for_work, yieldValue)) {
+    utils::optional<core::TimePeriodValue> value = core::TimePeriodValue::fromString(yieldValue);
+    if (value && value->getMilliseconds() > 0) {
+      max_wait_for_work_ = value->getMilliseconds();
+      logger_->log_debug("nifi_flow_engine_max_wait_for_work: [%" PRId64 "] ms", max_wait_for_work_.load());
+    }
+  }
+
   if (processor->getScheduledState() != core::RUNNING) {
     logger_->log_debug("Can not schedule threads for processor %s because it is not running", processor->getName());
     return;
@@ -90,35 +99,78 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
 
   processor->onSchedule(processContext, sessionFactory);
 
-  std::vector<std::thread *> threads;
+  if (processor->hasIncomingConnections() || processor->notifiesOwnWork()) {
+    // wakes up the tasks of the processor that wait for work, see SchedulingAgent::waitForWork()
+    utils::ThreadPool<utils::TaskRescheduleInfo> *pool = &thread_pool_;
+    const std::string task_id = processor->getUUIDStr();
+    processor->setWorkNotificationCallback([pool, task_id] {
+      pool->notifyWork(task_id);
+    });
+  }
 
-  ThreadedSchedulingAgent *agent = this;
+  RunningProcessor& running_processor = processors_running_[processor->getUUID()];
+  running_processor.process_context = processContext;
+  running_processor.session_factory = sessionFactory;
+  running_processor.task_slots.clear();
   for (int i = 0; i < processor->getMaxConcurrentTasks(); i++) {
-    // reference the disable function from serviceNode
-    processor->incrementActiveTasks();
-
-    std::function<utils::TaskRescheduleInfo()> f_ex = [agent, processor, processContext, sessionFactory] () {
-      return agent->run(processor, processContext, sessionFactory);
-    };
-
-    // create a functor that will be submitted to the thread pool.
-    auto monitor = utils::make_unique<utils::ComplexMonitor>();
-    utils::Worker<utils::TaskRescheduleInfo> functor(f_ex, processor->getUUIDStr(), std::move(monitor));
-    // move the functor into the thread pool. While a future is returned
-    // we aren't terribly concerned with the result.
-    std::future<utils::TaskRescheduleInfo> future;
-    thread_pool_.execute(std::move(functor), future);
+    submitTask(processor, running_processor);
   }
   logger_->log_debug("Scheduled thread %d concurrent workers for for process %s", processor->getMaxConcurrentTasks(), processor->getName());
-  processors_running_.insert(processor->getUUID());
+}
+
+void ThreadedSchedulingAgent::submitTask(const std::shared_ptr<core::Processor> &processor, RunningProcessor &running_processor) {
+  // reference the disable function from serviceNode
+  processor->incrementActiveTasks();
+
+  auto slot = std::make_shared<std::atomic<bool>>(true);
+  running_processor.task_slots.push_back(slot);
+  ThreadedSchedulingAgent *agent = this;
+  const auto processContext = running_processor.process_context;
+  const auto sessionFactory = running_processor.session_factory;
+  std::function<utils::TaskRescheduleInfo()> f_ex = [agent, processor, processContext, sessionFactory, slot] () {
+    if (!slot->load()) {
+      // retired by setMaxConcurrentTasks
+      processor->decrementActiveTask();
+      return utils::TaskRescheduleInfo::Done();
+    }
+    return agent->run(processor, processContext, sessionFactory);
+  };
+
+  // create a functor that will be submitted to the thread pool.
+  auto monitor = utils::make_unique<utils::ComplexMonitor>();
+  utils::Worker<utils::TaskRescheduleInfo> functor(f_ex, processor->getUUIDStr(), std::move(monitor));
+  // move the functor into the thread pool. While a future is returned
+  // we aren't terribly concerned with the result.
+  std::future<utils::TaskRescheduleInfo> future;
+  thread_pool_.execute(std::move(functor), future);
+}
+
+void ThreadedSchedulingAgent::setMaxConcurrentTasks(const std::shared_ptr<core::Processor> &processor, uint8_t tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  processor->setMaxConcurrentTasks(tasks);
+  const auto it = processors_running_.find(processor->getUUID());
+  if (it == processors_running_.end()) {
+    // takes effect when the processor is scheduled
+    return;
+  }
+  auto& task_slots = it->second.task_slots;
+  while (task_slots.size() < tasks) {
+    submitTask(processor, it->second);
+  }
+  while (task_slots.size() > tasks) {
+    // the task finishes the next time it is due, without triggering the processor
+    task_slots.back()->store(false);
+    task_slots.pop_back();
+  }
+  logger_->log_debug("Changed the number of concurrent tasks of processor %s to %d", processor->getName(), static_cast<int>(tasks));
 }
 
 void ThreadedSchedulingAgent::stop() {
   SchedulingAgent::stop();
   std::lock_guard<std::mutex> lock(mutex_);
-  for (const auto& processor_id : processors_running_) {
-    logger_->log_error("SchedulingAgent is stopped before processor was unscheduled: %s", processor_id.to_string());
-    thread_pool_.stopTasks(processor_id.to_string());
+  for (const auto& running_processor : processors_running_) {
+    logger_->log_error("SchedulingAgent is stopped before processor was unscheduled: %s", running_processor.first.to_string());
+    thread_pool_.stopTasks(running_processor.first.to_string());
   }
 }
 
@@ -131,6 +183,7 @@ void ThreadedSchedulingAgent::unschedule(std::shared_ptr<core::Processor> proces
     return;
   }
 
+  processor->setWorkNotificationCallback({});
   thread_pool_.stopTasks(processor->getUUIDStr());
 
   processor->clearActiveTask();
@@ -36,6 +36,9 @@ utils::TaskRescheduleInfo TimerDrivenSchedulingAgent::run(const std::shared_ptr<
     if (processor->isYield()) {
       // Honor the yield
       return utils::TaskRescheduleInfo::RetryIn(std::chrono::milliseconds(processor->getYieldTime()));
+    } else if (shouldYield && processor->getSchedulingPeriodNano() == 0 && !hasWorkToDo(processor)) {
+      // there is no schedule to keep and the inputs are empty, sleep until something is queued
+      return waitForWork();
     } else if (shouldYield && this->bored_yield_duration_ > 0) {
       // No work to do or need to apply back pressure
       return utils::TaskRescheduleInfo::RetryIn(std::chrono::milliseconds(this->bored_yield_duration_));
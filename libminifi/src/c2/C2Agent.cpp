@@ -31,7 +31,9 @@
 #include "c2/ControllerSocketProtocol.h"
 #include "core/ProcessContext.h"
 #include "core/CoreComponentState.h"
+#include "core/state/ProcessorController.h"
 #include "core/state/UpdateController.h"
+#include "provenance/ProvenanceQuery.h"
 #include "core/logging/Logger.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/file/DiffUtils.h"
@@ -51,6 +53,13 @@ namespace nifi {
 namespace minifi {
 namespace c2 {
 
+namespace {
+
+// upper limit of the events returned for a provenance query
+const size_t MAX_PROVENANCE_QUERY_RESULTS = 1000;
+
+}  // namespace
+
 C2Agent::C2Agent(core::controller::ControllerServiceProvider *controller,
                  state::Pausable *pause_handler,
                  const std::shared_ptr<state::StateMonitor> &updateSink,
@@ -561,11 +570,92 @@ void C2Agent::handle_describe(const C2ContentResponse &resp) {
     response.addPayload(std::move(states));
     enqueue_c2_response(std::move(response));
     return;
+  } else if (resp.name == "provenance") {
+    if (reporter != nullptr) {
+      enqueue_c2_response(prepareProvenanceEvents(resp, *reporter));
+      return;
+    }
   }
   C2Payload response(Operation::ACKNOWLEDGE, resp.ident, true);
   enqueue_c2_response(std::move(response));
 }
 
+C2Payload C2Agent::prepareProvenanceEvents(const C2ContentResponse &resp, const state::response::NodeReporter &reporter) const {
+  provenance::ProvenanceQuery query;
+  auto argument = [&resp](const std::string& name) -> utils::optional<std::string> {
+    const auto it = resp.operation_arguments.find(name);
+    if (it == resp.operation_arguments.end()) {
+      return utils::nullopt;
+    }
+    return it->second.to_string();
+  };
+  bool valid = true;
+  if (const auto flow_file_uuid = argument("flowFileUuid")) {
+    query.flow_file_uuid = utils::Identifier::parse(*flow_file_uuid);
+    valid &= query.flow_file_uuid.has_value();
+  }
+  if (const auto component_id = argument("componentId")) {
+    query.component_id = *component_id;
+  }
+  if (const auto event_type = argument("eventType")) {
+    for (int type = provenance::ProvenanceEventRecord::CREATE; type <= provenance::ProvenanceEventRecord::REPLAY; ++type) {
+      if (*event_type == provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[type]) {
+        query.event_type = static_cast<provenance::ProvenanceEventRecord::ProvenanceEventType>(type);
+      }
+    }
+    valid &= query.event_type.has_value();
+  }
+  if (const auto start_time = argument("startTime")) {
+    valid &= core::Property::StringToInt(*start_time, query.start_time);
+  }
+  if (const auto end_time = argument("endTime")) {
+    valid &= core::Property::StringToInt(*end_time, query.end_time);
+  }
+  uint64_t max_results = query.max_results;
+  if (const auto max_results_argument = argument("maxResults")) {
+    valid &= core::Property::StringToInt(*max_results_argument, max_results);
+  }
+  query.max_results = gsl::narrow<size_t>((std::min<uint64_t>)(max_results, MAX_PROVENANCE_QUERY_RESULTS));
+
+  if (!valid) {
+    logger_->log_error("Invalid provenance query arguments");
+    return C2Payload(Operation::ACKNOWLEDGE, state::UpdateState::NOT_APPLIED, resp.ident, true);
+  }
+  const auto events = reporter.queryProvenance(query);
+  if (!events) {
+    logger_->log_error("The provenance repository cannot be queried");
+    return C2Payload(Operation::ACKNOWLEDGE, state::UpdateState::NOT_APPLIED, resp.ident, true);
+  }
+
+  C2Payload response(Operation::ACKNOWLEDGE, resp.ident, true);
+  response.setLabel("provenance");
+  C2Payload event_payloads(Operation::ACKNOWLEDGE, resp.ident, true);
+  event_payloads.setLabel("provenance");
+  for (const auto& event : *events) {
+    C2Payload event_payload(Operation::ACKNOWLEDGE, resp.ident, true);
+    event_payload.setLabel(event->getEventId().to_string());
+    const std::map<std::string, std::string> fields{
+      {"eventType", provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[event->getEventType()]},
+      {"eventTime", std::to_string(event->getEventTime())},
+      {"componentId", event->getComponentId()},
+      {"componentType", event->getComponentType()},
+      {"flowFileUuid", event->getFlowFileUuid().to_string()},
+      {"fileSize", std::to_string(event->getFileSize())},
+      {"details", event->getDetails()},
+      {"transitUri", event->getTransitUri()}
+    };
+    for (const auto& field : fields) {
+      C2ContentResponse entry(Operation::ACKNOWLEDGE);
+      entry.name = field.first;
+      entry.operation_arguments[field.first] = field.second;
+      event_payload.addContent(std::move(entry));
+    }
+    event_payloads.addPayload(std::move(event_payload));
+  }
+  response.addPayload(std::move(event_payloads));
+  return response;
+}
+
 void C2Agent::handle_update(const C2ContentResponse &resp) {
   // we've been told to update something
   if (resp.name == "configuration") {
@@ -583,6 +673,15 @@ void C2Agent::handle_update(const C2ContentResponse &resp) {
     }
     C2Payload response(Operation::ACKNOWLEDGE, result, resp.ident, true);
     enqueue_c2_response(std::move(response));
+  } else if (resp.name == "concurrency") {
+    state::UpdateState result = state::UpdateState::FULLY_APPLIED;
+    for (const auto& entry : resp.operation_arguments) {
+      if (!update_concurrency(entry.first, entry.second.to_string())) {
+        result = state::UpdateState::PARTIALLY_APPLIED;
+      }
+    }
+    C2Payload response(Operation::ACKNOWLEDGE, result, resp.ident, true);
+    enqueue_c2_response(std::move(response));
   } else if (resp.name == "c2") {
     // prior configuration options were already in place. thus
     // we clear the map so that we don't go through replacing
@@ -662,12 +761,39 @@ bool C2Agent::update_property(const std::string &property_name, const std::strin
     return false;
   }
   configuration_->set(property_name, property_value);
+  if (property_name == minifi::Configure::nifi_flow_engine_threads && update_sink_ != nullptr) {
+    // the thread pool can be resized without a restart
+    int32_t threads = 0;
+    if (core::Property::StringToInt(property_value, threads) && threads > 0 && threads <= (std::numeric_limits<uint16_t>::max)()) {
+      update_sink_->setThreadPoolSize(static_cast<uint16_t>(threads));
+    }
+  }
   if (!persist) {
     return true;
   }
   return configuration_->persistProperties();
 }
 
+bool C2Agent::update_concurrency(const std::string &processor_name, const std::string &tasks) {
+  int32_t max_concurrent_tasks = 0;
+  if (!core::Property::StringToInt(tasks, max_concurrent_tasks) || max_concurrent_tasks < 1 || max_concurrent_tasks > (std::numeric_limits<uint8_t>::max)()) {
+    logger_->log_error("Invalid number of concurrent tasks for processor %s: %s", processor_name, tasks);
+    return false;
+  }
+  bool updated = false;
+  for (const auto& component : update_sink_->getComponents(processor_name)) {
+    auto processor_controller = std::dynamic_pointer_cast<state::ProcessorController>(component);
+    if (processor_controller != nullptr) {
+      processor_controller->setMaxConcurrentTasks(static_cast<uint8_t>(max_concurrent_tasks));
+      updated = true;
+    }
+  }
+  if (!updated) {
+    logger_->log_error("Could not find processor %s to change its concurrent tasks", processor_name);
+  }
+  return updated;
+}
+
 void C2Agent::restart_agent() {
   std::string cwd = utils::Environment::getCurrentWorkingDirectory();
   if (cwd.empty()) {
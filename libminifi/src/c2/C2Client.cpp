@@ -20,6 +20,7 @@
 #include <map>
 #include "c2/C2Client.h"
 #include "core/state/nodes/MetricsBase.h"
+#include "core/state/nodes/ProcessorPerformanceMetrics.h"
 #include "core/state/nodes/QueueMetrics.h"
 #include "core/state/nodes/AgentInformation.h"
 #include "core/state/nodes/RepositoryMetrics.h"
@@ -28,6 +29,8 @@
 #include "core/controller/ControllerServiceProvider.h"
 #include "c2/C2Agent.h"
 #include "core/state/nodes/FlowInformation.h"
+#include "provenance/ProvenanceQuery.h"
+#include "provenance/ProvenanceSampler.h"
 #include "utils/file/FileSystem.h"
 
 namespace org {
@@ -139,11 +142,46 @@ void C2Client::initializeComponentMetrics() {
     component_metrics_.clear();
   }
 
+  const std::vector<std::shared_ptr<state::response::ResponseNodeSource>> repository_metrics{
+    std::dynamic_pointer_cast<state::response::ResponseNodeSource>(content_repo_),
+    std::dynamic_pointer_cast<state::response::ResponseNodeSource>(flow_file_repo_)
+  };
+  for (const auto& repository : repository_metrics) {
+    if (repository == nullptr) {
+      continue;
+    }
+    std::vector<std::shared_ptr<state::response::ResponseNode>> metric_vector;
+    repository->getResponseNodes(metric_vector);
+    std::lock_guard<std::mutex> guard(metrics_mutex_);
+    for (auto& metric : metric_vector) {
+      component_metrics_[metric->getName()] = metric;
+    }
+  }
+
   if (root_ == nullptr) {
     return;
   }
   std::vector<std::shared_ptr<core::Processor>> processors;
   root_->getAllProcessors(processors);
+
+  auto performance_metrics = std::make_shared<state::response::ProcessorPerformanceMetrics>();
+  for (const auto &processor : processors) {
+    performance_metrics->addProcessor(processor);
+  }
+  {
+    std::lock_guard<std::mutex> guard(metrics_mutex_);
+    component_metrics_[performance_metrics->getName()] = performance_metrics;
+  }
+
+  // process groups in the sampled provenance mode share one sampler between their processors
+  for (const auto &processor : processors) {
+    if (const auto sampler = processor->getProvenanceSampler()) {
+      const auto aggregates = sampler->getMetrics();
+      std::lock_guard<std::mutex> guard(metrics_mutex_);
+      component_metrics_[aggregates->getName()] = aggregates;
+    }
+  }
+
   for (const auto &processor : processors) {
     auto rep = std::dynamic_pointer_cast<state::response::ResponseNodeSource>(processor);
     if (rep == nullptr) {
@@ -298,6 +336,14 @@ std::shared_ptr<state::response::ResponseNode> C2Client::getMetricsNode(const st
   return nullptr;
 }
 
+utils::optional<std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>>> C2Client::queryProvenance(const provenance::ProvenanceQuery& query) const {
+  auto queryable = std::dynamic_pointer_cast<provenance::ProvenanceQueryable>(provenance_repo_);
+  if (queryable == nullptr) {
+    return utils::nullopt;
+  }
+  return queryable->query(query);
+}
+
 std::vector<std::shared_ptr<state::response::ResponseNode>> C2Client::getHeartbeatNodes(bool include_manifest) const {
   std::string fullHb{"true"};
   configuration_->get("nifi.c2.full.heartbeat", fullHb);
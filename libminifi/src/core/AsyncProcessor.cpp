@@ -0,0 +1,347 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/AsyncProcessor.h"
+
+#include <stdexcept>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "Exception.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+struct AsyncProcessor::SessionState {
+  SessionState(std::shared_ptr<ProcessSession> session, std::shared_ptr<CompletionQueue> completions)
+      : session(std::move(session)),
+        completions(std::move(completions)) {
+  }
+
+  const std::shared_ptr<ProcessSession> session;
+  // where the operations of the session are completed to
+  const std::shared_ptr<CompletionQueue> completions;
+
+  // held by onTriggerAsync and the continuations of the session, guards the members below
+  std::mutex mutex;
+  size_t operations_in_flight{0};
+  // the first exception of onTriggerAsync or the continuations
+  std::exception_ptr error;
+  // committed or rolled back
+  bool closed{false};
+};
+
+class AsyncProcessor::CompletionQueue {
+ public:
+  explicit CompletionQueue(std::function<void()> on_completion)
+      : on_completion_(std::move(on_completion)) {
+  }
+
+  void enqueue(Completion completion) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      completions_.push_back(std::move(completion));
+    }
+    condition_.notify_all();
+    std::lock_guard<std::mutex> lock(on_completion_mutex_);
+    if (on_completion_) {
+      on_completion_();
+    }
+  }
+
+  std::deque<Completion> takeAll() {
+    std::deque<Completion> completions;
+    std::lock_guard<std::mutex> lock(mutex_);
+    completions.swap(completions_);
+    return completions;
+  }
+
+  bool empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completions_.empty();
+  }
+
+  void waitForCompletion() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return !completions_.empty(); });
+  }
+
+  // stops calling on_completion, which may refer to a processor being destroyed
+  void detach() {
+    std::lock_guard<std::mutex> lock(on_completion_mutex_);
+    on_completion_ = nullptr;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<Completion> completions_;
+
+  std::mutex on_completion_mutex_;
+  std::function<void()> on_completion_;
+};
+
+struct AsyncProcessor::OperationState {
+  explicit OperationState(std::shared_ptr<SessionState> session)
+      : session(std::move(session)) {
+  }
+
+  ~OperationState() {
+    if (!completed) {
+      session->completions->enqueue({session, nullptr});
+    }
+  }
+
+  const std::shared_ptr<SessionState> session;
+  std::atomic<bool> completed{false};
+};
+
+AsyncProcessor::Operation::Operation(std::shared_ptr<OperationState> state)
+    : state_(std::move(state)) {
+}
+
+void AsyncProcessor::Operation::complete(std::function<void()> continuation) const {
+  if (state_->completed.exchange(true)) {
+    return;
+  }
+  if (!continuation) {
+    continuation = [] {};
+  }
+  state_->session->completions->enqueue({state_->session, std::move(continuation)});
+}
+
+AsyncProcessor::AsyncProcessor(const std::string& name, const utils::Identifier& uuid)
+    : Processor(name, uuid),
+      completions_(std::make_shared<CompletionQueue>([this] { notifyWork(); })),
+      logger_(logging::LoggerFactory<AsyncProcessor>::getLogger()) {
+}
+
+AsyncProcessor::AsyncProcessor(const std::string& name)
+    : Processor(name),
+      completions_(std::make_shared<CompletionQueue>([this] { notifyWork(); })),
+      logger_(logging::LoggerFactory<AsyncProcessor>::getLogger()) {
+}
+
+AsyncProcessor::~AsyncProcessor() {
+  completions_->detach();
+  // the continuations may refer to the already destroyed members of the derived processor, so they are not run
+  rollbackSessionsInFlight();
+}
+
+void AsyncProcessor::onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSessionFactory> &sessionFactory) {
+  runCompletions();
+  if (getSessionsInFlight() >= max_sessions_in_flight_) {
+    return;
+  }
+
+  const auto state = std::make_shared<SessionState>(sessionFactory->createSession(), completions_);
+  registerSession(state);
+  std::exception_ptr error;
+  bool done = false;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    try {
+      onTriggerAsync(context, state->session);
+    } catch (const std::exception &exception) {
+      logger_->log_warn("Caught \"%s\" (%s) during AsyncProcessor::onTriggerAsync of processor: %s (%s)",
+          exception.what(), typeid(exception).name(), getUUIDStr(), getName());
+      state->error = error = std::current_exception();
+    } catch (...) {
+      logger_->log_warn("Caught unknown exception during AsyncProcessor::onTriggerAsync of processor: %s (%s)", getUUIDStr(), getName());
+      state->error = error = std::current_exception();
+    }
+    done = state->operations_in_flight == 0;
+  }
+  if (done) {
+    finishSession(state);
+  }
+  if (error) {
+    // lets the scheduling agent yield as it does for the exceptions of synchronous processors
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncProcessor::onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSession> &session) {
+  const auto state = std::make_shared<SessionState>(session, std::make_shared<CompletionQueue>(nullptr));
+  registerSession(state);
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    try {
+      onTriggerAsync(context, session);
+    } catch (...) {
+      state->error = std::current_exception();
+    }
+  }
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->operations_in_flight == 0) {
+        break;
+      }
+    }
+    state->completions->waitForCompletion();
+    for (const auto& completion : state->completions->takeAll()) {
+      runContinuation(completion);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    sessions_in_flight_.erase(session.get());
+  }
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+bool AsyncProcessor::isWorkAvailable() {
+  if (!completions_->empty()) {
+    return true;
+  }
+  if (getSessionsInFlight() >= max_sessions_in_flight_) {
+    return false;
+  }
+  return !hasIncomingConnections() || Processor::isWorkAvailable();
+}
+
+size_t AsyncProcessor::getSessionsInFlight() const {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  return sessions_in_flight_.size();
+}
+
+AsyncProcessor::Operation AsyncProcessor::startOperation(const std::shared_ptr<ProcessSession> &session) {
+  std::shared_ptr<SessionState> state;
+  {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    const auto it = sessions_in_flight_.find(session.get());
+    if (it != sessions_in_flight_.end()) {
+      state = it->second;
+    }
+  }
+  if (!state) {
+    throw Exception(PROCESSOR_EXCEPTION, "Operations can only be started by onTriggerAsync or the continuations of the session");
+  }
+  // the caller holds state->mutex
+  ++state->operations_in_flight;
+  return Operation(std::make_shared<OperationState>(state));
+}
+
+void AsyncProcessor::closeSessionsInFlight() {
+  runCompletions();
+  rollbackSessionsInFlight();
+}
+
+void AsyncProcessor::registerSession(const std::shared_ptr<SessionState> &state) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  sessions_in_flight_.emplace(state->session.get(), state);
+}
+
+void AsyncProcessor::runCompletions() {
+  for (const auto& completion : completions_->takeAll()) {
+    if (runContinuation(completion)) {
+      finishSession(completion.session);
+    }
+  }
+}
+
+bool AsyncProcessor::runContinuation(const Completion &completion) {
+  SessionState& state = *completion.session;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.closed) {
+    return false;
+  }
+  if (!completion.continuation) {
+    logger_->log_warn("An operation of processor %s (%s) was abandoned without completing it", getName(), getUUIDStr());
+    if (!state.error) {
+      state.error = std::make_exception_ptr(Exception(PROCESSOR_EXCEPTION, "Operation abandoned without completing it"));
+    }
+  } else if (!state.error) {
+    try {
+      completion.continuation();
+    } catch (const std::exception &exception) {
+      logger_->log_warn("Caught \"%s\" (%s) during a continuation of processor: %s (%s)",
+          exception.what(), typeid(exception).name(), getUUIDStr(), getName());
+      state.error = std::current_exception();
+    } catch (...) {
+      logger_->log_warn("Caught unknown exception during a continuation of processor: %s (%s)", getUUIDStr(), getName());
+      state.error = std::current_exception();
+    }
+  }
+  return --state.operations_in_flight == 0;
+}
+
+void AsyncProcessor::finishSession(const std::shared_ptr<SessionState> &state) {
+  {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    sessions_in_flight_.erase(state->session.get());
+  }
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (state->closed) {
+    return;
+  }
+  state->closed = true;
+  try {
+    if (state->error) {
+      state->session->rollback();
+    } else {
+      commitAndRecordStatistics(*state->session);
+    }
+  } catch (const std::exception &exception) {
+    logger_->log_warn("Caught \"%s\" (%s) while finishing a session of processor: %s (%s)",
+        exception.what(), typeid(exception).name(), getUUIDStr(), getName());
+    state->session->rollback();
+  }
+}
+
+void AsyncProcessor::rollbackSessionsInFlight() {
+  std::vector<std::shared_ptr<SessionState>> sessions;
+  {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (auto it = sessions_in_flight_.begin(); it != sessions_in_flight_.end();) {
+      // the sessions of synchronous triggers belong to their callers
+      if (it->second->completions == completions_) {
+        sessions.push_back(it->second);
+        it = sessions_in_flight_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (const auto& session : sessions) {
+    SessionState& state = *session;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.closed) {
+      continue;
+    }
+    state.closed = true;
+    logger_->log_warn("Rolling back a session of processor %s (%s) with %zu operations in flight", getName(), getUUIDStr(), state.operations_in_flight);
+    try {
+      state.session->rollback();
+    } catch (const std::exception &exception) {
+      logger_->log_warn("Caught \"%s\" while rolling back a session of processor %s (%s)", exception.what(), getName(), getUUIDStr());
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -127,6 +127,10 @@ void Connectable::waitForWork(uint64_t timeoutMs) {
 }
 
 void Connectable::notifyWork() {
+  if (const auto callback = std::atomic_load(&work_notification_callback_)) {
+    (*callback)();
+  }
+
   // Do nothing if we are not event-driven
   if (strategy_ != EVENT_DRIVEN) {
     return;
@@ -141,6 +145,14 @@ void Connectable::notifyWork() {
   }
 }
 
+void Connectable::setWorkNotificationCallback(std::function<void()> callback) {
+  std::shared_ptr<const std::function<void()>> new_callback;
+  if (callback) {
+    new_callback = std::make_shared<const std::function<void()>>(std::move(callback));
+  }
+  std::atomic_store(&work_notification_callback_, std::move(new_callback));
+}
+
 std::set<std::shared_ptr<Connectable>> Connectable::getOutGoingConnections(const std::string &relationship) const {
   std::set<std::shared_ptr<Connectable>> empty;
 
@@ -74,7 +74,7 @@ void ContentSession::commit() {
     }
     const int size = gsl::narrow<int>(resource.second->size());
     const int bytes_written = outStream->write(const_cast<uint8_t*>(resource.second->getBuffer()), size);
-    if (bytes_written != size) {
+    if (bytes_written != size || !outStream->flush()) {
       throw Exception(REPOSITORY_EXCEPTION, "Failed to write new resource: " + resource.first->getContentFullPath());
     }
   }
@@ -85,7 +85,7 @@ void ContentSession::commit() {
     }
     const int size = gsl::narrow<int>(resource.second->size());
     const int bytes_written = outStream->write(const_cast<uint8_t*>(resource.second->getBuffer()), size);
-    if (bytes_written != size) {
+    if (bytes_written != size || !outStream->flush()) {
       throw Exception(REPOSITORY_EXCEPTION, "Failed to append to resource: " + resource.first->getContentFullPath());
     }
   }
@@ -22,6 +22,7 @@
 #include <string>
 #include "core/ClassLoader.h"
 #include "utils/StringUtils.h"
+#include "utils/file/FileUtils.h"
 #include "processors/ProcessorUtils.h"
 
 namespace org {
@@ -128,6 +129,29 @@ std::shared_ptr<minifi::Connection> FlowConfiguration::createConnection(std::str
   return std::make_shared<minifi::Connection>(flow_file_repo_, content_repo_, name, uuid);
 }
 
+std::shared_ptr<FlowFileSwapManager> FlowConfiguration::getSwapManager() {
+  if (!swap_manager_) {
+    std::string swap_directory;
+    if (!configuration_->get(Configure::nifi_flowfile_swap_directory, swap_directory)) {
+      swap_directory = utils::file::FileUtils::concat_path(configuration_->getHome(), "flowfile_swap");
+    }
+    swap_manager_ = std::make_shared<FlowFileSwapManager>(swap_directory, content_repo_);
+    // the swapped out flow files of the previous run are restored from the flow file repository
+    swap_manager_->removeStaleSwapFiles();
+  }
+  return swap_manager_;
+}
+
+uint64_t FlowConfiguration::getDefaultSwapThreshold() {
+  std::string value;
+  uint64_t threshold = 0;
+  if (configuration_->get(Configure::nifi_queue_swap_threshold, value) && !core::Property::StringToInt(value, threshold)) {
+    logger_->log_error("Invalid value for %s: %s, swapping is disabled", Configure::nifi_queue_swap_threshold, value);
+    return 0;
+  }
+  return threshold;
+}
+
 std::shared_ptr<core::controller::ControllerServiceNode> FlowConfiguration::createControllerService(const std::string &class_name, const std::string &full_class_name, const std::string &name,
     const utils::Identifier& uuid) {
   std::shared_ptr<core::controller::ControllerServiceNode> controllerServicesNode = service_provider_->createControllerService(class_name, full_class_name, name, true);
@@ -67,6 +67,7 @@ FlowFile& FlowFile::operator=(const FlowFile& other) {
   to_be_processed_after_ = other.to_be_processed_after_;
   attributes_ = other.attributes_;
   claim_ = other.claim_;
+  stored_claim_ = other.stored_claim_;
   connection_ = other.connection_;
   return *this;
 }
@@ -104,6 +104,7 @@ void ProcessGroup::addProcessor(const std::shared_ptr<Processor>& processor) {
   if (processors_.find(processor) == processors_.end()) {
     // We do not have the same processor in this process group yet
     processors_.insert(processor);
+    processor->setProvenanceSampler(provenance_sampler_);
     logger_->log_debug("Add processor %s into process group %s", processor->getName(), name_);
   }
 }
@@ -124,10 +125,33 @@ void ProcessGroup::addProcessGroup(std::unique_ptr<ProcessGroup> child) {
   if (child_process_groups_.find(child) == child_process_groups_.end()) {
     // We do not have the same child process group in this process group yet
     logger_->log_debug("Add child process group %s into process group %s", child->getName(), name_);
+    if (!child->has_own_provenance_sampler_) {
+      std::lock_guard<std::recursive_mutex> child_lock(child->mutex_);
+      child->applyProvenanceSampler(provenance_sampler_);
+    }
     child_process_groups_.emplace(std::move(child));
   }
 }
 
+void ProcessGroup::setProvenanceSampler(std::shared_ptr<provenance::ProvenanceSampler> sampler) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  has_own_provenance_sampler_ = true;
+  applyProvenanceSampler(sampler);
+}
+
+void ProcessGroup::applyProvenanceSampler(const std::shared_ptr<provenance::ProvenanceSampler>& sampler) {
+  provenance_sampler_ = sampler;
+  for (const auto& processor : processors_) {
+    processor->setProvenanceSampler(sampler);
+  }
+  for (const auto& child : child_process_groups_) {
+    std::lock_guard<std::recursive_mutex> child_lock(child->mutex_);
+    if (!child->has_own_provenance_sampler_) {
+      child->applyProvenanceSampler(sampler);
+    }
+  }
+}
+
 void ProcessGroup::startProcessingProcessors(const std::shared_ptr<TimerDrivenSchedulingAgent>& timeScheduler,
     const std::shared_ptr<EventDrivenSchedulingAgent> &eventScheduler, const std::shared_ptr<CronDrivenSchedulingAgent> &cronScheduler) {
   std::unique_lock<std::recursive_mutex> lock(mutex_);
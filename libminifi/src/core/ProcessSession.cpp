@@ -28,9 +28,13 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "core/Processor.h"
 #include "core/ProcessSessionReadCallback.h"
+#include "io/StreamPipe.h"
+#include "io/StreamSlice.h"
 #include "utils/gsl.h"
 
 /* This implementation is only for native Windows systems.  */
@@ -59,8 +63,54 @@ namespace nifi {
 namespace minifi {
 namespace core {
 
+namespace {
+
+/**
+ * Writes the current content of the flow file, followed by the data written by the wrapped callback.
+ */
+class AppendToCopyCallback : public OutputStreamCallback {
+ public:
+  AppendToCopyCallback(ProcessSession& session, std::shared_ptr<core::FlowFile> flow, OutputStreamCallback* callback)
+      : session_(session),
+        flow_(std::move(flow)),
+        callback_(callback) {
+  }
+
+  int64_t process(const std::shared_ptr<io::BaseStream>& stream) override {
+    InputStreamPipe copy(stream);
+    const int64_t copied = session_.read(flow_, &copy);
+    if (copied < 0) {
+      return copied;
+    }
+    const int64_t appended = callback_->process(stream);
+    if (appended < 0) {
+      return appended;
+    }
+    return copied + appended;
+  }
+
+ private:
+  ProcessSession& session_;
+  std::shared_ptr<core::FlowFile> flow_;
+  OutputStreamCallback* callback_;
+};
+
+}  // namespace
+
 std::shared_ptr<utils::IdGenerator> ProcessSession::id_generator_ = utils::IdGenerator::getIdGenerator();
 
+ProcessSession::ProcessSession(std::shared_ptr<ProcessContext> processContext)
+    : process_context_(std::move(processContext)),
+      logger_(logging::LoggerFactory<ProcessSession>::getLogger()) {
+  logger_->log_trace("ProcessSession created for %s", process_context_->getProcessorNode()->getName());
+  auto repo = process_context_->getProvenanceRepository();
+  provenance_report_ = std::make_shared<provenance::ProvenanceReporter>(repo, process_context_->getProcessorNode()->getName(), process_context_->getProcessorNode()->getName());
+  if (auto processor = std::dynamic_pointer_cast<Processor>(process_context_->getProcessorNode()->getProcessor())) {
+    provenance_report_->setSampler(processor->getProvenanceSampler());
+  }
+  content_session_ = process_context_->getContentRepository()->createSession();
+}
+
 ProcessSession::~ProcessSession() {
   removeReferences();
 }
@@ -98,9 +148,9 @@ std::shared_ptr<core::FlowFile> ProcessSession::create(const std::shared_ptr<cor
   utils::Identifier uuid = record->getUUID();
   _addedFlowFiles[uuid] = record;
   logger_->log_debug("Create FlowFile with UUID %s", record->getUUIDStr());
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " creates flow record " << record->getUUIDStr();
-  provenance_report_->create(record, details.str());
+  provenance_report_->create(record, [&] {
+    return process_context_->getProcessorNode()->getName() + " creates flow record " + record->getUUIDStr();
+  });
 
   return record;
 }
@@ -185,16 +235,16 @@ void ProcessSession::remove(const std::shared_ptr<core::FlowFile> &flow) {
 
 void ProcessSession::putAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key, std::string value) {
   flow->setAttribute(key, value);
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " modify flow record " << flow->getUUIDStr() << " attribute " << key << ":" << value;
-  provenance_report_->modifyAttributes(flow, details.str());
+  provenance_report_->modifyAttributes(flow, [&] {
+    return process_context_->getProcessorNode()->getName() + " modify flow record " + flow->getUUIDStr() + " attribute " + key + ":" + value;
+  });
 }
 
 void ProcessSession::removeAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key) {
   flow->removeAttribute(key);
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " remove flow record " << flow->getUUIDStr() << " attribute " + key;
-  provenance_report_->modifyAttributes(flow, details.str());
+  provenance_report_->modifyAttributes(flow, [&] {
+    return process_context_->getProcessorNode()->getName() + " remove flow record " + flow->getUUIDStr() + " attribute " + key;
+  });
 }
 
 void ProcessSession::penalize(const std::shared_ptr<core::FlowFile> &flow) {
@@ -225,13 +275,14 @@ void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputSt
     }
 
     flow->setSize(stream->size());
-    flow->setOffset(0);
+    flow->setOffset(content_session_->getWriteOffset(claim));
     flow->setResourceClaim(claim);
 
     stream->close();
-    std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
     uint64_t endTime = utils::timeutils::getTimeMillis();
-    provenance_report_->modifyContent(flow, details, endTime - startTime);
+    provenance_report_->modifyContent(flow, [&] {
+      return process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
+    }, endTime - startTime);
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
     throw;
@@ -247,6 +298,11 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
     // No existed claim for append, we need to create new claim
     return write(flow, callback);
   }
+  if (!content_session_->canAppend(claim)) {
+    // the content cannot be extended in place, so it is copied to a new claim followed by the appended data
+    AppendToCopyCallback copy_callback(*this, flow, callback);
+    return write(flow, &copy_callback);
+  }
 
   try {
     uint64_t startTime = utils::timeutils::getTimeMillis();
@@ -265,10 +321,10 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
     }
     flow->setSize(stream->size());
 
-    std::stringstream details;
-    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
     uint64_t endTime = utils::timeutils::getTimeMillis();
-    provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+    provenance_report_->modifyContent(flow, [&] {
+      return process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
+    }, endTime - startTime);
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
     throw;
@@ -299,9 +355,8 @@ int ProcessSession::read(const std::shared_ptr<core::FlowFile> &flow, InputStrea
       throw Exception(FILE_OPERATION_EXCEPTION, "Failed to open flowfile content for read");
     }
 
-    stream->seek(flow->getOffset());
-
-    auto ret = callback->process(stream);
+    // the claim may hold more than the content of this flow file, e.g. after a clone with offset
+    auto ret = callback->process(std::make_shared<io::StreamSlice>(stream, flow->getOffset(), flow->getSize()));
     if (ret < 0) {
       throw Exception(FILE_OPERATION_EXCEPTION, "Failed to process flowfile content");
     }
@@ -315,6 +370,55 @@ int ProcessSession::read(const std::shared_ptr<core::FlowFile> &flow, InputStrea
   }
 }
 
+std::shared_ptr<io::ContentView> ProcessSession::readView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size) {
+  return readView(flow, max_size, true);
+}
+
+std::shared_ptr<io::ContentView> ProcessSession::mapView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size) {
+  return readView(flow, max_size, false);
+}
+
+std::shared_ptr<io::ContentView> ProcessSession::readView(const std::shared_ptr<core::FlowFile> &flow, uint64_t max_size, bool copy_unmapped) {
+  std::shared_ptr<ResourceClaim> claim = flow->getResourceClaim();
+  if (claim == nullptr) {
+    if (flow->getSize() == 0) {
+      return std::make_shared<io::ContentView>(std::vector<uint8_t>{});
+    }
+    throw Exception(FILE_OPERATION_EXCEPTION, "No Content Claim existed for read");
+  }
+
+  std::shared_ptr<io::BaseStream> stream = content_session_->read(claim);
+  if (nullptr == stream) {
+    throw Exception(FILE_OPERATION_EXCEPTION, "Failed to open flowfile content for read");
+  }
+  const uint64_t size = (std::min)(max_size, flow->getSize());
+  io::StreamSlice slice(stream, flow->getOffset(), size);
+  auto view = slice.map(size);
+  if (view && view->size() == size) {
+    return view;
+  }
+  if (!copy_unmapped) {
+    return nullptr;
+  }
+
+  // content that is not in a file, e.g. in RocksDB or in memory, is copied instead
+  std::vector<uint8_t> buffer(gsl::narrow<size_t>(size));
+  size_t read_size = 0;
+  while (read_size < buffer.size()) {
+    const int ret = slice.read(buffer.data() + read_size, gsl::narrow<int>((std::min)(buffer.size() - read_size, size_t{std::numeric_limits<int>::max()})));
+    if (ret <= 0) {
+      throw Exception(FILE_OPERATION_EXCEPTION, "Failed to read flowfile content");
+    }
+    read_size += gsl::narrow<size_t>(ret);
+  }
+  return std::make_shared<io::ContentView>(std::move(buffer));
+}
+
+std::vector<uint8_t> ProcessSession::readBuffer(const std::shared_ptr<core::FlowFile> &flow) {
+  const auto view = readView(flow);
+  return std::vector<uint8_t>(view->begin(), view->end());
+}
+
 void ProcessSession::importFrom(io::InputStream&& stream, const std::shared_ptr<core::FlowFile> &flow) {
   importFrom(stream, flow);
 }
@@ -348,17 +452,17 @@ void ProcessSession::importFrom(io::InputStream &stream, const std::shared_ptr<c
     // Open the source file and stream to the flow file
 
     flow->setSize(content_stream->size());
-    flow->setOffset(0);
+    flow->setOffset(content_session_->getWriteOffset(claim));
     flow->setResourceClaim(claim);
 
     logger_->log_debug("Import offset %" PRIu64 " length %" PRIu64 " into content %s for FlowFile UUID %s",
         flow->getOffset(), flow->getSize(), flow->getResourceClaim()->getContentFullPath(), flow->getUUIDStr());
 
     content_stream->close();
-    std::stringstream details;
-    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
     auto endTime = utils::timeutils::getTimeMillis();
-    provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+    provenance_report_->modifyContent(flow, [&] {
+      return process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
+    }, endTime - startTime);
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
     throw;
@@ -409,7 +513,7 @@ void ProcessSession::import(std::string source, const std::shared_ptr<FlowFile>
 
       if (!invalidWrite) {
         flow->setSize(stream->size());
-        flow->setOffset(0);
+        flow->setOffset(content_session_->getWriteOffset(claim));
         flow->setResourceClaim(claim);
 
         logger_->log_debug("Import offset %" PRIu64 " length %" PRIu64 " into content %s for FlowFile UUID %s", flow->getOffset(), flow->getSize(), flow->getResourceClaim()->getContentFullPath(),
@@ -419,10 +523,10 @@ void ProcessSession::import(std::string source, const std::shared_ptr<FlowFile>
         input.close();
         if (!keepSource)
           std::remove(source.c_str());
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
         auto endTime = utils::timeutils::getTimeMillis();
-        provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+        provenance_report_->modifyContent(flow, [&] {
+          return process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
+        }, endTime - startTime);
       } else {
         stream->close();
         input.close();
@@ -513,14 +617,15 @@ void ProcessSession::import(const std::string& source, std::vector<std::shared_p
         }
         flowFile = create();
         flowFile->setSize(stream->size());
-        flowFile->setOffset(0);
+        flowFile->setOffset(content_session_->getWriteOffset(claim));
         flowFile->setResourceClaim(claim);
         logging::LOG_DEBUG(logger_) << "Import offset " << flowFile->getOffset() << " length " << flowFile->getSize() << " content " << flowFile->getResourceClaim()->getContentFullPath()
                                     << ", FlowFile UUID " << flowFile->getUUIDStr();
         stream->close();
-        std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flowFile->getUUIDStr();
         uint64_t endTime = utils::timeutils::getTimeMillis();
-        provenance_report_->modifyContent(flowFile, details, endTime - startTime);
+        provenance_report_->modifyContent(flowFile, [&] {
+          return process_context_->getProcessorNode()->getName() + " modify flow record content " + flowFile->getUUIDStr();
+        }, endTime - startTime);
         flows.push_back(flowFile);
 
         /* Reset these to start processing the next FlowFile with a clean slate */
@@ -738,7 +843,7 @@ void ProcessSession::commit() {
         if (!record->isDeleted()) {
           continue;
         }
-        if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr())) {
+        if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr(), record->getStoredResourceClaim())) {
           // mark for deletion in the flowFileRepository
           record->setStoredToRepository(false);
         }
@@ -750,6 +855,18 @@ void ProcessSession::commit() {
 
     persistFlowFilesBeforeTransfer(connectionQueues, _updatedFlowFiles);
 
+    TransferStatistics transferred;
+    for (const auto& it : _updatedFlowFiles) {
+      ++transferred.flow_files_in;
+      transferred.bytes_in += it.second.snapshot->getSize();
+    }
+    for (const auto& cq : connectionQueues) {
+      transferred.flow_files_out += cq.second.size();
+      for (const auto& file : cq.second) {
+        transferred.bytes_out += file->getSize();
+      }
+    }
+
     for (auto& cq : connectionQueues) {
       auto connection = std::dynamic_pointer_cast<Connection>(cq.first);
       if (connection) {
@@ -761,6 +878,11 @@ void ProcessSession::commit() {
       }
     }
 
+    transfer_statistics_.flow_files_in += transferred.flow_files_in;
+    transfer_statistics_.bytes_in += transferred.bytes_in;
+    transfer_statistics_.flow_files_out += transferred.flow_files_out;
+    transfer_statistics_.bytes_out += transferred.bytes_out;
+
     // All done
     _updatedFlowFiles.clear();
     _addedFlowFiles.clear();
@@ -874,7 +996,7 @@ void ProcessSession::persistFlowFilesBeforeTransfer(
       auto original = snapshotIt != modifiedFlowFiles.end() ? snapshotIt->second.snapshot : nullptr;
       if (shouldDropEmptyFiles && ff->getSize() == 0) {
         // the receiver promised to drop this FF, no need for it anymore
-        if (ff->isStored() && flowFileRepo->Delete(ff->getUUIDStr())) {
+        if (ff->isStored() && flowFileRepo->Delete(ff->getUUIDStr(), ff->getStoredResourceClaim())) {
           // original must be non-null since this flowFile is already stored in the repos ->
           // must have come from a session->get()
           assert(original);
@@ -910,6 +1032,33 @@ void ProcessSession::ensureNonNullResourceClaim(
   }
 }
 
+void ProcessSession::removeExpired(const std::set<std::shared_ptr<core::FlowFile>>& expired) {
+  if (expired.empty()) {
+    return;
+  }
+  provenance_report_->expire(expired, process_context_->getProcessorNode()->getName() + " expire flow record ");
+  for (const auto& record : expired) {
+    // there is no rolling back expired FlowFiles
+    if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr(), record->getStoredResourceClaim())) {
+      record->setStoredToRepository(false);
+    }
+  }
+}
+
+void ProcessSession::addPolled(const std::shared_ptr<core::FlowFile>& flow_file) {
+  // add the flow record to the current process session update map
+  flow_file->setDeleted(false);
+  std::shared_ptr<FlowFile> snapshot = std::make_shared<FlowFileRecord>();
+  *snapshot = *flow_file;
+  logger_->log_debug("Create Snapshot FlowFile with UUID %s", snapshot->getUUIDStr());
+  utils::Identifier uuid = flow_file->getUUID();
+  _updatedFlowFiles[uuid] = {flow_file, snapshot};
+  auto flow_version = process_context_->getProcessorNode()->getFlowIdentifier();
+  if (flow_version != nullptr) {
+    flow_file->setAttribute(SpecialFlowAttribute::FLOW_ID, flow_version->getFlowId());
+  }
+}
+
 std::shared_ptr<core::FlowFile> ProcessSession::get() {
   std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->pickIncomingConnection();
 
@@ -923,30 +1072,9 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   do {
     std::set<std::shared_ptr<core::FlowFile> > expired;
     std::shared_ptr<core::FlowFile> ret = current->poll(expired);
-    if (!expired.empty()) {
-      // Remove expired flow record
-      for (const auto& record : expired) {
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
-        provenance_report_->expire(record, details.str());
-        // there is no rolling back expired FlowFiles
-        if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr())) {
-          record->setStoredToRepository(false);
-        }
-      }
-    }
+    removeExpired(expired);
     if (ret) {
-      // add the flow record to the current process session update map
-      ret->setDeleted(false);
-      std::shared_ptr<FlowFile> snapshot = std::make_shared<FlowFileRecord>();
-      *snapshot = *ret;
-      logger_->log_debug("Create Snapshot FlowFile with UUID %s", snapshot->getUUIDStr());
-      utils::Identifier uuid = ret->getUUID();
-      _updatedFlowFiles[uuid] = {ret, snapshot};
-      auto flow_version = process_context_->getProcessorNode()->getFlowIdentifier();
-      if (flow_version != nullptr) {
-        ret->setAttribute(SpecialFlowAttribute::FLOW_ID, flow_version->getFlowId());
-      }
+      addPolled(ret);
       return ret;
     }
     current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->pickIncomingConnection());
@@ -955,6 +1083,37 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   return nullptr;
 }
 
+std::vector<std::shared_ptr<core::FlowFile>> ProcessSession::get(size_t max_count, uint64_t max_bytes) {
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->pickIncomingConnection();
+
+  if (first == nullptr || max_count == 0 || max_bytes == 0) {
+    logger_->log_trace("Get is null for %s", process_context_->getProcessorNode()->getName());
+    return flow_files;
+  }
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  uint64_t total_bytes = 0;
+  std::shared_ptr<Connection> current = std::static_pointer_cast<Connection>(first);
+
+  do {
+    for (auto& flow_file : current->pollBatch(max_count - flow_files.size(), max_bytes - total_bytes, expired)) {
+      total_bytes += flow_file->getSize();
+      addPolled(flow_file);
+      flow_files.push_back(std::move(flow_file));
+    }
+    if (flow_files.size() >= max_count || total_bytes >= max_bytes) {
+      break;
+    }
+    current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->pickIncomingConnection());
+  } while (current != nullptr && current != first);
+
+  // report every expired FlowFile of the pass at once
+  removeExpired(expired);
+
+  return flow_files;
+}
+
 void ProcessSession::flushContent() {
   content_session_->commit();
 }
@@ -60,6 +60,7 @@ Processor::Processor(const std::string& name)
   _triggerWhenEmpty = false;
   scheduling_period_nano_ = MINIMUM_SCHEDULING_NANOS;
   run_duration_nano_ = DEFAULT_RUN_DURATION;
+  max_batch_size_ = DEFAULT_MAX_BATCH_SIZE;
   yield_period_msec_ = DEFAULT_YIELD_PERIOD_SECONDS * 1000;
   penalization_period_ = DEFAULT_PENALIZATION_PERIOD;
   max_concurrent_tasks_ = DEFAULT_MAX_CONCURRENT_TASKS;
@@ -81,6 +82,7 @@ Processor::Processor(const std::string& name, const utils::Identifier &uuid)
   _triggerWhenEmpty = false;
   scheduling_period_nano_ = MINIMUM_SCHEDULING_NANOS;
   run_duration_nano_ = DEFAULT_RUN_DURATION;
+  max_batch_size_ = DEFAULT_MAX_BATCH_SIZE;
   yield_period_msec_ = DEFAULT_YIELD_PERIOD_SECONDS * 1000;
   penalization_period_ = DEFAULT_PENALIZATION_PERIOD;
   max_concurrent_tasks_ = DEFAULT_MAX_CONCURRENT_TASKS;
@@ -228,9 +230,14 @@ void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessio
   auto session = sessionFactory->createSession();
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session.get());
-    session->commit();
+    const auto batch_start = std::chrono::steady_clock::now();
+    size_t flow_files_before_trigger;
+    do {
+      flow_files_before_trigger = session->getFlowFileCount();
+      // Call the virtual trigger function
+      onTrigger(context, session.get());
+    } while (continueBatch(*session, batch_start, flow_files_before_trigger));
+    commitAndRecordStatistics(*session);
   } catch (std::exception &exception) {
     logger_->log_warn("Caught \"%s\" (%s) during Processor::onTrigger of processor: %s (%s)",
         exception.what(), typeid(exception).name(), getUUIDStr(), getName());
@@ -247,9 +254,14 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   auto session = sessionFactory->createSession();
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session);
-    session->commit();
+    const auto batch_start = std::chrono::steady_clock::now();
+    size_t flow_files_before_trigger;
+    do {
+      flow_files_before_trigger = session->getFlowFileCount();
+      // Call the virtual trigger function
+      onTrigger(context, session);
+    } while (continueBatch(*session, batch_start, flow_files_before_trigger));
+    commitAndRecordStatistics(*session);
   } catch (std::exception &exception) {
     logger_->log_warn("Caught \"%s\" (%s) during Processor::onTrigger of processor: %s (%s)",
         exception.what(), typeid(exception).name(), getUUIDStr(), getName());
@@ -262,6 +274,36 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   }
 }
 
+bool Processor::continueBatch(const ProcessSession& session, std::chrono::steady_clock::time_point batch_start, size_t flow_files_before_trigger) {
+  const uint64_t run_duration = run_duration_nano_;
+  if (run_duration == 0 || !supportsBatching()) {
+    return false;
+  }
+  if (session.getFlowFileCount() == flow_files_before_trigger) {
+    // the last trigger found nothing to do, let the scheduling agent decide when to trigger again
+    return false;
+  }
+  if (std::chrono::steady_clock::now() - batch_start >= std::chrono::nanoseconds(run_duration)) {
+    return false;
+  }
+  const uint64_t max_batch_size = max_batch_size_;
+  if (max_batch_size > 0 && session.getFlowFileCount() >= max_batch_size) {
+    return false;
+  }
+  if (!isRunning() || isYield() || isThrottledByBackpressure()) {
+    return false;
+  }
+  return getTriggerWhenEmpty() || !hasIncomingConnections() || isWorkAvailable();
+}
+
+void Processor::commitAndRecordStatistics(ProcessSession& session) {
+  const auto commit_start = std::chrono::steady_clock::now();
+  session.commit();
+  const auto& transferred = session.getTransferStatistics();
+  statistics_.recordCommit(std::chrono::steady_clock::now() - commit_start,
+      transferred.flow_files_in, transferred.bytes_in, transferred.flow_files_out, transferred.bytes_out);
+}
+
 bool Processor::isWorkAvailable() {
   // We have work if any incoming connection has work
   std::lock_guard<std::mutex> lock(mutex_);
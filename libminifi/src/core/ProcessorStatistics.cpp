@@ -0,0 +1,79 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/ProcessorStatistics.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr size_t ProcessorStatistics::SLOT_COUNT;
+
+namespace {
+
+uint64_t toMicros(std::chrono::nanoseconds duration) {
+  const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+}
+
+}  // namespace
+
+size_t ProcessorStatistics::currentThreadSlot() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local const size_t slot = next_slot++ % SLOT_COUNT;
+  return slot;
+}
+
+void ProcessorStatistics::recordTrigger(std::chrono::nanoseconds duration, std::chrono::nanoseconds cpu_time) {
+  Slot& slot = slots_[currentThreadSlot()];
+  slot.trigger_duration.record(toMicros(duration));
+  if (cpu_time.count() > 0) {
+    slot.cpu_time_ns.fetch_add(static_cast<uint64_t>(cpu_time.count()), std::memory_order_relaxed);
+  }
+}
+
+void ProcessorStatistics::recordCommit(std::chrono::nanoseconds duration, uint64_t flow_files_in, uint64_t bytes_in, uint64_t flow_files_out, uint64_t bytes_out) {
+  Slot& slot = slots_[currentThreadSlot()];
+  slot.commit_duration.record(toMicros(duration));
+  slot.flow_files_in.fetch_add(flow_files_in, std::memory_order_relaxed);
+  slot.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+  slot.flow_files_out.fetch_add(flow_files_out, std::memory_order_relaxed);
+  slot.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+}
+
+ProcessorStatistics::Snapshot ProcessorStatistics::getSnapshot() const {
+  Snapshot snapshot;
+  for (const auto& slot : slots_) {
+    snapshot.trigger_duration.add(slot.trigger_duration);
+    snapshot.commit_duration.add(slot.commit_duration);
+    snapshot.cpu_time += std::chrono::nanoseconds(slot.cpu_time_ns.load(std::memory_order_relaxed));
+    snapshot.flow_files_in += slot.flow_files_in.load(std::memory_order_relaxed);
+    snapshot.bytes_in += slot.bytes_in.load(std::memory_order_relaxed);
+    snapshot.flow_files_out += slot.flow_files_out.load(std::memory_order_relaxed);
+    snapshot.bytes_out += slot.bytes_out.load(std::memory_order_relaxed);
+  }
+  snapshot.triggers = snapshot.trigger_duration.count();
+  snapshot.commits = snapshot.commit_duration.count();
+  return snapshot;
+}
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
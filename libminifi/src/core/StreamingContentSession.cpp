@@ -0,0 +1,209 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/StreamingContentSession.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include <vector>
+#include "core/ContentRepository.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "utils/file/FileUtils.h"
+#include "utils/Id.h"
+#include "utils/StringUtils.h"
+#include "Exception.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr const char* StreamingContentSession::STAGING_FILE_EXTENSION;
+
+namespace {
+
+constexpr int COPY_BUFFER_SIZE = 1024 * 1024;
+
+}  // namespace
+
+StreamingContentSession::StreamingContentSession(std::shared_ptr<ContentRepository> repository, std::string staging_directory, io::FileStreamFactory file_streams)
+    : ContentSession(std::move(repository)),
+      staging_directory_(std::move(staging_directory)),
+      file_streams_(std::move(file_streams)),
+      logger_(logging::LoggerFactory<StreamingContentSession>::getLogger()) {
+}
+
+StreamingContentSession::~StreamingContentSession() {
+  removeStagingFiles();
+}
+
+std::shared_ptr<ResourceClaim> StreamingContentSession::create() {
+  std::shared_ptr<ResourceClaim> claim = std::make_shared<ResourceClaim>(repository_);
+  stagedResources_[claim] = createStagingFile();
+  return claim;
+}
+
+std::shared_ptr<io::BaseStream> StreamingContentSession::write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode) {
+  auto it = stagedResources_.find(resourceId);
+  if (it == stagedResources_.end()) {
+    if (mode == WriteMode::OVERWRITE) {
+      throw Exception(REPOSITORY_EXCEPTION, "Can only overwrite owned resource");
+    }
+    auto& extension = stagedExtensions_[resourceId];
+    if (extension.empty()) {
+      extension = createStagingFile();
+    }
+    return openStagingFile(extension, true);
+  }
+  return openStagingFile(it->second, mode == WriteMode::APPEND);
+}
+
+std::shared_ptr<io::BaseStream> StreamingContentSession::read(const std::shared_ptr<ResourceClaim>& resourceId) {
+  if (stagedResources_.find(resourceId) != stagedResources_.end() || stagedExtensions_.find(resourceId) != stagedExtensions_.end()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Can only read non-modified resource");
+  }
+  return repository_->read(*resourceId);
+}
+
+void StreamingContentSession::commit() {
+  // the streams may still hold buffered content, or fail to sync it, after the writer has reported success
+  for (const auto& stream : stagingStreams_) {
+    if (!stream.second->flush()) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to write staged content: " + stream.first);
+    }
+  }
+  stagingStreams_.clear();
+  std::vector<std::shared_ptr<ResourceClaim>> published;
+  std::vector<std::pair<std::shared_ptr<ResourceClaim>, uint64_t>> appended;
+  try {
+    for (const auto& resource : stagedResources_) {
+      publish(*resource.first, resource.second, false);
+      published.push_back(resource.first);
+    }
+    for (const auto& resource : stagedExtensions_) {
+      // recorded before the append, so that a partially written append is reverted as well
+      appended.emplace_back(resource.first, getContentSize(*resource.first));
+      publish(*resource.first, resource.second, true);
+    }
+  } catch (...) {
+    // the new resources are not referenced by anything yet, so they can be dropped
+    for (const auto& claim : published) {
+      repository_->remove(*claim);
+    }
+    for (const auto& append : appended) {
+      if (!revertAppend(*append.first, append.second)) {
+        logger_->log_error("Could not revert the content appended to %s by the failed commit", append.first->getContentFullPath());
+      }
+    }
+    throw;
+  }
+
+  removeStagingFiles();
+}
+
+void StreamingContentSession::rollback() {
+  removeStagingFiles();
+}
+
+void StreamingContentSession::publish(const ResourceClaim& claim, const std::string& staging_path, bool append) {
+  auto output = repository_->write(claim, append);
+  if (output == nullptr) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + claim.getContentFullPath());
+  }
+  copyStagingFile(claim, staging_path, *output);
+}
+
+bool StreamingContentSession::revertAppend(const ResourceClaim& /*claim*/, uint64_t /*original_size*/) {
+  return false;
+}
+
+void StreamingContentSession::copyStagingFile(const ResourceClaim& claim, const std::string& staging_path, io::BaseStream& output, const std::function<void()>& on_chunk) const {
+  const auto input = file_streams_.openForRead(staging_path);
+  std::vector<uint8_t> buffer(COPY_BUFFER_SIZE);
+  while (true) {
+    const int read = input->read(buffer.data(), COPY_BUFFER_SIZE);
+    if (read < 0) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to read staged content: " + staging_path);
+    }
+    if (read == 0) {
+      break;
+    }
+    if (output.write(buffer.data(), read) != read) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to write resource: " + claim.getContentFullPath());
+    }
+    if (on_chunk) {
+      on_chunk();
+    }
+  }
+  if (!output.flush()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to write resource: " + claim.getContentFullPath());
+  }
+}
+
+uint64_t StreamingContentSession::getContentSize(const ResourceClaim& claim) const {
+  const auto stream = repository_->read(claim);
+  return stream ? stream->size() : 0;
+}
+
+std::shared_ptr<io::BaseStream> StreamingContentSession::openStagingFile(const std::string& path, bool append) {
+  auto stream = file_streams_.openForWrite(path, append);
+  stagingStreams_.emplace_back(path, stream);
+  return stream;
+}
+
+std::string StreamingContentSession::createStagingFile() {
+  const std::string path = utils::file::FileUtils::concat_path(staging_directory_,
+      utils::IdGenerator::getIdGenerator()->generate().to_string() + STAGING_FILE_EXTENSION);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't create staging file: " + path);
+  }
+  return path;
+}
+
+void StreamingContentSession::removeStagingFiles() {
+  stagingStreams_.clear();
+  for (const auto& resource : stagedResources_) {
+    std::remove(resource.second.c_str());
+  }
+  for (const auto& resource : stagedExtensions_) {
+    std::remove(resource.second.c_str());
+  }
+  stagedResources_.clear();
+  stagedExtensions_.clear();
+}
+
+void StreamingContentSession::removeStaleStagingFiles(const std::string& staging_directory) {
+  auto logger = logging::LoggerFactory<StreamingContentSession>::getLogger();
+  utils::file::FileUtils::list_dir(staging_directory, [&logger](const std::string& dir, const std::string& filename) {
+    if (utils::StringUtils::endsWith(filename, STAGING_FILE_EXTENSION)) {
+      const auto path = utils::file::FileUtils::concat_path(dir, filename);
+      logger->log_debug("Removing stale staging file %s", path);
+      std::remove(path.c_str());
+    }
+    return true;
+  }, logger, false);
+}
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
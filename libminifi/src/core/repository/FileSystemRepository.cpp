@@ -19,8 +19,12 @@
 #include "core/repository/FileSystemRepository.h"
 #include <memory>
 #include <string>
-#include "io/FileStream.h"
+#include <cstdio>
+#include <utility>
+#include <vector>
 #include "utils/file/FileUtils.h"
+#include "utils/StringUtils.h"
+#include "Exception.h"
 
 namespace org {
 namespace apache {
@@ -37,13 +41,88 @@ bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &
     directory_ = configuration->getHome();
   }
   utils::file::FileUtils::create_dir(directory_);
+  if (!file_streams_.initialize(configuration)) {
+    return false;
+  }
+  if (configuration->get(Configure::nifi_content_repository_streaming_session, value)) {
+    utils::StringUtils::StringToBool(value, streaming_session_);
+  }
+  if (streaming_session_) {
+    StreamingContentSession::removeStaleStagingFiles(directory_);
+  }
   return true;
 }
 void FileSystemRepository::stop() {
 }
 
+FileSystemRepository::Session::Session(std::shared_ptr<ContentRepository> repository, std::string staging_directory, const io::FileStreamFactory& file_streams)
+    : StreamingContentSession(std::move(repository), std::move(staging_directory), file_streams) {}
+
+void FileSystemRepository::Session::publish(const minifi::ResourceClaim& claim, const std::string& staging_path, bool append) {
+  if (append) {
+    StreamingContentSession::publish(claim, staging_path, append);
+    // with SYNC_ON_CLOSE the repository stream has already synced the appended content
+    if (isSyncOnPublish() && !io::FileStreamFactory::sync(claim.getContentFullPath())) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to sync resource: " + claim.getContentFullPath());
+    }
+    return;
+  }
+  // with SYNC_ON_CLOSE the staging streams have synced the staging files, otherwise they are synced here before they become visible
+  if (isSyncOnPublish() && !io::FileStreamFactory::sync(staging_path)) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to sync staged content: " + staging_path);
+  }
+  // the staging file is in the same directory as the content, so it can be published atomically
+  if (std::rename(staging_path.c_str(), claim.getContentFullPath().c_str()) != 0) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to publish staged content to " + claim.getContentFullPath());
+  }
+  // the rename only persists once the directory is synced
+  const std::string directory = utils::file::FileUtils::get_parent_path(claim.getContentFullPath());
+  if (isDurable() && !io::FileStreamFactory::syncDirectory(directory)) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to sync directory: " + directory);
+  }
+}
+
+bool FileSystemRepository::Session::revertAppend(const minifi::ResourceClaim& claim, uint64_t original_size) {
+  return io::FileStreamFactory::truncate(claim.getContentFullPath(), original_size);
+}
+
+void FileSystemRepository::SyncingSession::commit() {
+  std::vector<std::string> paths;
+  for (const auto& resource : managedResources_) {
+    paths.push_back(resource.first->getContentFullPath());
+  }
+  for (const auto& resource : extendedResources_) {
+    paths.push_back(resource.first->getContentFullPath());
+  }
+  const bool created = !managedResources_.empty();
+  ContentSession::commit();
+  for (const auto& path : paths) {
+    if (!io::FileStreamFactory::sync(path)) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to sync resource: " + path);
+    }
+  }
+  // the entries of the newly created files only persist once their directory is synced
+  if (created) {
+    const std::string directory = utils::file::FileUtils::get_parent_path(paths.front());
+    if (!io::FileStreamFactory::syncDirectory(directory)) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to sync directory: " + directory);
+    }
+  }
+}
+
+std::shared_ptr<ContentSession> FileSystemRepository::createSession() {
+  const auto durability = file_streams_.getDurability();
+  if (streaming_session_) {
+    return std::make_shared<Session>(sharedFromThis(), directory_, file_streams_);
+  }
+  if (durability == io::FileStreamFactory::Durability::SYNC_ON_COMMIT) {
+    return std::make_shared<SyncingSession>(sharedFromThis());
+  }
+  return ContentRepository::createSession();
+}
+
 std::shared_ptr<io::BaseStream> FileSystemRepository::write(const minifi::ResourceClaim &claim, bool append) {
-  return std::make_shared<io::FileStream>(claim.getContentFullPath(), append);
+  return file_streams_.openForWrite(claim.getContentFullPath(), append);
 }
 
 bool FileSystemRepository::exists(const minifi::ResourceClaim &streamId) {
@@ -52,7 +131,7 @@ bool FileSystemRepository::exists(const minifi::ResourceClaim &streamId) {
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::read(const minifi::ResourceClaim &claim) {
-  return std::make_shared<io::FileStream>(claim.getContentFullPath(), 0, false);
+  return file_streams_.openForRead(claim.getContentFullPath());
 }
 
 bool FileSystemRepository::remove(const minifi::ResourceClaim &claim) {
@@ -0,0 +1,272 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/repository/HybridContentRepository.h"
+
+#include <cinttypes>
+#include <utility>
+
+#include "core/TypedValues.h"
+#include "io/FileStreamFactory.h"
+#include "utils/gsl.h"
+#include "Exception.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+namespace {
+
+constexpr uint64_t DEFAULT_MEMORY_THRESHOLD = 4 * 1024;
+constexpr uint64_t DEFAULT_MAX_MEMORY_SIZE = 64 * 1024 * 1024;
+
+}  // namespace
+
+HybridContentRepository::Session::Session(std::shared_ptr<HybridContentRepository> repository)
+    : ContentSession(repository),
+      hybrid_repository_(std::move(repository)) {
+}
+
+void HybridContentRepository::Session::commit() {
+  std::vector<std::string> written_paths;
+  for (const auto& resource : managedResources_) {
+    if (!hybrid_repository_->storeInMemory(*resource.first, resource.second)) {
+      hybrid_repository_->writeToDisk(*resource.first, {resource.second.get()}, false);
+      written_paths.push_back(resource.first->getContentFullPath());
+    }
+  }
+  for (const auto& resource : extendedResources_) {
+    auto path = hybrid_repository_->append(*resource.first, *resource.second);
+    if (!path.empty()) {
+      written_paths.push_back(std::move(path));
+    }
+  }
+  if (hybrid_repository_->syncOnCommit()) {
+    for (const auto& path : written_paths) {
+      if (!io::FileStreamFactory::sync(path)) {
+        throw Exception(REPOSITORY_EXCEPTION, "Failed to sync resource: " + path);
+      }
+    }
+  }
+
+  managedResources_.clear();
+  extendedResources_.clear();
+}
+
+HybridContentRepository::HybridContentRepository(std::string name)
+    : core::CoreComponent(name),
+      memory_threshold_(DEFAULT_MEMORY_THRESHOLD),
+      max_memory_size_(DEFAULT_MAX_MEMORY_SIZE),
+      disk_repository_(std::make_shared<FileSystemRepository>(name)),
+      memory_size_(0),
+      logger_(logging::LoggerFactory<HybridContentRepository>::getLogger()) {
+}
+
+HybridContentRepository::~HybridContentRepository() {
+  stop();
+}
+
+bool HybridContentRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
+  if (!disk_repository_->initialize(configuration)) {
+    return false;
+  }
+  directory_ = disk_repository_->getStoragePath();
+
+  std::string value;
+  if (configuration->get(Configure::nifi_content_repository_memory_threshold, value) && !core::DataSizeValue::StringToInt(value, memory_threshold_)) {
+    logger_->log_error("Invalid value for %s: %s", Configure::nifi_content_repository_memory_threshold, value);
+    return false;
+  }
+  if (configuration->get(Configure::nifi_content_repository_memory_max_size, value) && !core::DataSizeValue::StringToInt(value, max_memory_size_)) {
+    logger_->log_error("Invalid value for %s: %s", Configure::nifi_content_repository_memory_max_size, value);
+    return false;
+  }
+  logger_->log_info("Keeping content of up to %" PRIu64 " bytes in memory, using at most %" PRIu64 " bytes", memory_threshold_, max_memory_size_);
+  return true;
+}
+
+void HybridContentRepository::stop() {
+  std::unordered_map<std::string, std::shared_ptr<io::BufferStream>> memory_content;
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    memory_content = memory_content_;
+  }
+  for (const auto& content : memory_content) {
+    try {
+      writeToDisk(minifi::ResourceClaim(content.first, nullptr), {content.second.get()}, false);
+      eraseFromMemory(content.first);
+    } catch (const std::exception& exception) {
+      logger_->log_error("Failed to move the content of %s to the file system: %s", content.first, exception.what());
+    }
+  }
+  disk_repository_->stop();
+}
+
+std::shared_ptr<ContentSession> HybridContentRepository::createSession() {
+  return std::make_shared<Session>(std::static_pointer_cast<HybridContentRepository>(sharedFromThis()));
+}
+
+bool HybridContentRepository::exists(const minifi::ResourceClaim &streamId) {
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    if (memory_content_.count(streamId.getContentFullPath()) > 0) {
+      return true;
+    }
+  }
+  return disk_repository_->exists(streamId);
+}
+
+std::shared_ptr<io::BaseStream> HybridContentRepository::write(const minifi::ResourceClaim &claim, bool append) {
+  if (append) {
+    moveToDisk(claim);
+  } else {
+    eraseFromMemory(claim.getContentFullPath());
+  }
+  return disk_repository_->write(claim, append);
+}
+
+std::shared_ptr<io::BaseStream> HybridContentRepository::read(const minifi::ResourceClaim &claim) {
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto content = memory_content_.find(claim.getContentFullPath());
+    if (content != memory_content_.end()) {
+      return std::make_shared<io::BufferStream>(content->second->getBuffer(), gsl::narrow<unsigned int>(content->second->size()));
+    }
+  }
+  return disk_repository_->read(claim);
+}
+
+bool HybridContentRepository::remove(const minifi::ResourceClaim &claim) {
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto content = memory_content_.find(claim.getContentFullPath());
+    if (content != memory_content_.end()) {
+      memory_size_ -= content->second->size();
+      memory_content_.erase(content);
+      return true;
+    }
+  }
+  return disk_repository_->remove(claim);
+}
+
+bool HybridContentRepository::isInMemory(const minifi::ResourceClaim &claim) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  return memory_content_.count(claim.getContentFullPath()) > 0;
+}
+
+uint64_t HybridContentRepository::getMemoryUsage() {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  return memory_size_;
+}
+
+bool HybridContentRepository::storeInMemory(const minifi::ResourceClaim &claim, const std::shared_ptr<io::BufferStream> &content) {
+  if (content->size() > memory_threshold_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  auto& stored = memory_content_[claim.getContentFullPath()];
+  const uint64_t previous_size = stored ? stored->size() : 0;
+  if (memory_size_ - previous_size + content->size() > max_memory_size_) {
+    if (!stored) {
+      memory_content_.erase(claim.getContentFullPath());
+    }
+    return false;
+  }
+  memory_size_ = memory_size_ - previous_size + content->size();
+  stored = content;
+  return true;
+}
+
+std::string HybridContentRepository::append(const minifi::ResourceClaim &claim, const io::BufferStream &extension) {
+  std::shared_ptr<io::BufferStream> content;
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto stored = memory_content_.find(claim.getContentFullPath());
+    if (stored != memory_content_.end()) {
+      if (stored->second->size() + extension.size() <= memory_threshold_ && memory_size_ + extension.size() <= max_memory_size_) {
+        // readers may still use the previous buffer, so the extended content is a new one
+        auto extended = std::make_shared<io::BufferStream>(stored->second->getBuffer(), gsl::narrow<unsigned int>(stored->second->size()));
+        extended->write(extension.getBuffer(), gsl::narrow<int>(extension.size()));
+        memory_size_ += extension.size();
+        stored->second = std::move(extended);
+        return {};
+      }
+      content = stored->second;
+    }
+  }
+  if (content) {
+    // the content is readable from memory until it is complete on the file system
+    writeToDisk(claim, {content.get(), &extension}, false);
+    eraseFromMemory(claim.getContentFullPath());
+  } else {
+    writeToDisk(claim, {&extension}, true);
+  }
+  return claim.getContentFullPath();
+}
+
+void HybridContentRepository::writeToDisk(const minifi::ResourceClaim &claim, const std::vector<const io::BufferStream*> &contents, bool append) {
+  auto stream = disk_repository_->write(claim, append);
+  if (stream == nullptr) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + claim.getContentFullPath());
+  }
+  for (const auto* content : contents) {
+    const int size = gsl::narrow<int>(content->size());
+    if (stream->write(content->getBuffer(), size) != size) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to write resource: " + claim.getContentFullPath());
+    }
+  }
+  if (!stream->flush()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to write resource: " + claim.getContentFullPath());
+  }
+}
+
+void HybridContentRepository::moveToDisk(const minifi::ResourceClaim &claim) {
+  std::shared_ptr<io::BufferStream> content;
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto stored = memory_content_.find(claim.getContentFullPath());
+    if (stored == memory_content_.end()) {
+      return;
+    }
+    content = stored->second;
+  }
+  writeToDisk(claim, {content.get()}, false);
+  eraseFromMemory(claim.getContentFullPath());
+}
+
+void HybridContentRepository::eraseFromMemory(const std::string &path) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  auto stored = memory_content_.find(path);
+  if (stored != memory_content_.end()) {
+    memory_size_ -= stored->second->size();
+    memory_content_.erase(stored);
+  }
+}
+
+bool HybridContentRepository::syncOnCommit() const {
+  return disk_repository_->getDurability() == io::FileStreamFactory::Durability::SYNC_ON_COMMIT;
+}
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,410 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/repository/SlabFileSystemRepository.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+
+#include "core/TypedValues.h"
+#include "io/BaseStream.h"
+#include "utils/file/FileUtils.h"
+#include "utils/Id.h"
+#include "utils/StringUtils.h"
+#include "utils/gsl.h"
+#include "Exception.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+constexpr const char* SlabFileSystemRepository::SLAB_FILE_EXTENSION;
+
+namespace {
+
+constexpr uint64_t DEFAULT_MAX_SLAB_SIZE = 1024 * 1024;
+constexpr std::chrono::milliseconds DEFAULT_RECLAIM_PERIOD{1000};
+constexpr size_t COPY_BUFFER_SIZE = 4096;
+
+}  // namespace
+
+/**
+ * Write-only stream of a region; the data is always appended to the end of the slab.
+ * If another region was started in the slab since this one was last written, the region is first moved to the end of the slab.
+ */
+class SlabFileSystemRepository::RegionStream : public io::BaseStream {
+ public:
+  explicit RegionStream(std::shared_ptr<Region> region)
+      : region_(std::move(region)) {
+  }
+
+  size_t size() const override {
+    return gsl::narrow<size_t>(region_->length);
+  }
+
+  void seek(uint64_t /*offset*/) override {
+    // writes always go to the end of the region
+  }
+
+  using BaseStream::read;
+  using BaseStream::write;
+
+  int read(uint8_t* /*value*/, int /*len*/) override {
+    return -1;
+  }
+
+  int write(const uint8_t *value, int len) override {
+    gsl_Expects(len >= 0);
+    Slab& slab = *region_->slab;
+    if (region_->offset + region_->length != slab.size && !relocate()) {
+      return -1;
+    }
+    slab.stream.write(reinterpret_cast<const char*>(value), len);
+    if (!slab.stream) {
+      return -1;
+    }
+    slab.size += len;
+    region_->length += len;
+    return len;
+  }
+
+ private:
+  bool relocate() {
+    Slab& slab = *region_->slab;
+    if (!slab.stream.flush()) {
+      return false;
+    }
+    std::ifstream input(slab.path, std::ios::binary);
+    input.seekg(gsl::narrow<std::streamoff>(region_->offset));
+    const uint64_t new_offset = slab.size;
+    std::vector<char> buffer(COPY_BUFFER_SIZE);
+    uint64_t remaining = region_->length;
+    while (remaining > 0) {
+      const auto chunk = gsl::narrow<std::streamsize>((std::min)(remaining, static_cast<uint64_t>(buffer.size())));
+      if (!input.read(buffer.data(), chunk) || !slab.stream.write(buffer.data(), chunk)) {
+        return false;
+      }
+      slab.size += chunk;
+      remaining -= chunk;
+    }
+    region_->offset = new_offset;
+    return true;
+  }
+
+  std::shared_ptr<Region> region_;
+};
+
+SlabFileSystemRepository::Slab::Slab(std::string slab_path)
+    : path(std::move(slab_path)),
+      stream(path, std::ios::binary | std::ios::app),
+      size(0) {
+}
+
+SlabFileSystemRepository::Session::Session(std::shared_ptr<SlabFileSystemRepository> repository)
+    : ContentSession(repository),
+      slab_repository_(std::move(repository)) {
+}
+
+SlabFileSystemRepository::Session::~Session() {
+  rollback();
+}
+
+std::shared_ptr<ResourceClaim> SlabFileSystemRepository::Session::create() {
+  if (slabs_.empty() || slabs_.back()->size >= slab_repository_->max_slab_size_) {
+    slabs_.push_back(slab_repository_->acquireSlab());
+  }
+  const auto& slab = slabs_.back();
+  auto claim = std::make_shared<ResourceClaim>(slab->path, repository_);
+  regions_[claim] = std::make_shared<Region>(Region{slab, slab->size, 0});
+  return claim;
+}
+
+std::shared_ptr<io::BaseStream> SlabFileSystemRepository::Session::write(const std::shared_ptr<ResourceClaim>& resourceId, WriteMode mode) {
+  auto it = regions_.find(resourceId);
+  if (it == regions_.end()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Can only write owned resource");
+  }
+  const auto& region = it->second;
+  if (mode == WriteMode::OVERWRITE) {
+    // the previous content is left behind as garbage
+    region->offset = region->slab->size;
+    region->length = 0;
+  }
+  return std::make_shared<RegionStream>(region);
+}
+
+std::shared_ptr<io::BaseStream> SlabFileSystemRepository::Session::read(const std::shared_ptr<ResourceClaim>& resourceId) {
+  auto it = regions_.find(resourceId);
+  if (it != regions_.end() && !it->second->slab->stream.flush()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to flush slab " + it->second->slab->path);
+  }
+  return repository_->read(*resourceId);
+}
+
+uint64_t SlabFileSystemRepository::Session::getWriteOffset(const std::shared_ptr<ResourceClaim>& resourceId) const {
+  auto it = regions_.find(resourceId);
+  return it != regions_.end() ? it->second->offset : 0;
+}
+
+bool SlabFileSystemRepository::Session::canAppend(const std::shared_ptr<ResourceClaim>& resourceId) const {
+  auto it = regions_.find(resourceId);
+  return it != regions_.end() && it->second->offset + it->second->length == it->second->slab->size;
+}
+
+void SlabFileSystemRepository::Session::commit() {
+  const bool sync = slab_repository_->file_streams_.getDurability() != io::FileStreamFactory::Durability::NONE;
+  for (const auto& slab : slabs_) {
+    if (!slab->stream.flush()) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to write slab " + slab->path);
+    }
+    // the slabs stay open between sessions, so they are synced on commit with either durability policy
+    if (sync && !io::FileStreamFactory::sync(slab->path)) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to sync slab " + slab->path);
+    }
+  }
+  regions_.clear();
+  releaseSlabs();
+}
+
+void SlabFileSystemRepository::Session::rollback() {
+  regions_.clear();
+  releaseSlabs();
+}
+
+void SlabFileSystemRepository::Session::releaseSlabs() {
+  for (const auto& slab : slabs_) {
+    slab_repository_->releaseSlab(slab);
+  }
+  slabs_.clear();
+}
+
+SlabFileSystemRepository::SlabFileSystemRepository(std::string name)
+    : core::CoreComponent(std::move(name)),
+      max_slab_size_(DEFAULT_MAX_SLAB_SIZE),
+      reclaim_period_(DEFAULT_RECLAIM_PERIOD),
+      running_(false),
+      logger_(logging::LoggerFactory<SlabFileSystemRepository>::getLogger()) {
+}
+
+SlabFileSystemRepository::~SlabFileSystemRepository() {
+  stop();
+}
+
+bool SlabFileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
+  std::string value;
+  if (configuration->get(Configure::nifi_dbcontent_repository_directory_default, value)) {
+    directory_ = value;
+  } else {
+    directory_ = configuration->getHome();
+  }
+  utils::file::FileUtils::create_dir(directory_);
+  if (!file_streams_.initialize(configuration)) {
+    return false;
+  }
+
+  if (configuration->get(Configure::nifi_content_repository_slab_max_size, value) && !core::DataSizeValue::StringToInt(value, max_slab_size_)) {
+    logger_->log_error("Invalid value for %s: %s", Configure::nifi_content_repository_slab_max_size, value);
+    return false;
+  }
+  if (configuration->get(Configure::nifi_content_repository_slab_reclaim_period, value)) {
+    const auto period = core::TimePeriodValue::fromString(value);
+    if (!period) {
+      logger_->log_error("Invalid value for %s: %s", Configure::nifi_content_repository_slab_reclaim_period, value);
+      return false;
+    }
+    reclaim_period_ = std::chrono::milliseconds(period->getMilliseconds());
+  }
+
+  std::lock_guard<std::mutex> lock(reclaim_mutex_);
+  startup_slabs_.clear();
+  utils::file::FileUtils::list_dir(directory_, [this](const std::string& dir, const std::string& filename) {
+    if (isSlab(filename)) {
+      startup_slabs_.insert(utils::file::FileUtils::concat_path(dir, filename));
+    }
+    return true;
+  }, logger_, false);
+  if (!running_) {
+    running_ = true;
+    reclaim_thread_ = std::thread(&SlabFileSystemRepository::runReclaimer, this);
+  }
+  return true;
+}
+
+void SlabFileSystemRepository::stop() {
+  {
+    std::lock_guard<std::mutex> lock(reclaim_mutex_);
+    running_ = false;
+  }
+  reclaim_condition_.notify_all();
+  if (reclaim_thread_.joinable()) {
+    reclaim_thread_.join();
+  }
+  std::lock_guard<std::mutex> lock(slab_mutex_);
+  for (const auto& slab : available_slabs_) {
+    slab->stream.close();
+    writable_slabs_.erase(slab->path);
+  }
+  available_slabs_.clear();
+}
+
+std::shared_ptr<ContentSession> SlabFileSystemRepository::createSession() {
+  return std::make_shared<Session>(std::static_pointer_cast<SlabFileSystemRepository>(sharedFromThis()));
+}
+
+bool SlabFileSystemRepository::exists(const minifi::ResourceClaim &streamId) {
+  std::ifstream file(streamId.getContentFullPath());
+  return file.good();
+}
+
+std::shared_ptr<io::BaseStream> SlabFileSystemRepository::write(const minifi::ResourceClaim &claim, bool append) {
+  if (isSlab(claim.getContentFullPath())) {
+    logger_->log_error("Slab %s can only be written through a content session", claim.getContentFullPath());
+    return nullptr;
+  }
+  return file_streams_.openForWrite(claim.getContentFullPath(), append);
+}
+
+std::shared_ptr<io::BaseStream> SlabFileSystemRepository::read(const minifi::ResourceClaim &claim) {
+  return file_streams_.openForRead(claim.getContentFullPath());
+}
+
+bool SlabFileSystemRepository::remove(const minifi::ResourceClaim &claim) {
+  const auto& path = claim.getContentFullPath();
+  if (isSlab(path)) {
+    // called with the claim count lock held, the slab is checked and deleted later by the reclaimer
+    std::lock_guard<std::mutex> lock(reclaim_mutex_);
+    reclaim_candidates_.insert(path);
+    return true;
+  }
+  logger_->log_debug("Deleting resource %s", path);
+  std::remove(path.c_str());
+  return true;
+}
+
+void SlabFileSystemRepository::reclaim() {
+  std::set<std::string> candidates;
+  {
+    std::lock_guard<std::mutex> lock(reclaim_mutex_);
+    candidates.swap(reclaim_candidates_);
+  }
+  for (const auto& path : candidates) {
+    {
+      // writable slabs become candidates again when they are sealed
+      std::lock_guard<std::mutex> lock(slab_mutex_);
+      if (writable_slabs_.count(path) > 0) {
+        continue;
+      }
+    }
+    // nothing can start referring to a sealed slab that is not referred to anymore
+    if (!isReferenced(path)) {
+      deleteSlab(path);
+    }
+  }
+
+  // slabs waiting to be reused are dropped if none of their content is referenced, so that they do not keep garbage on disk
+  std::lock_guard<std::mutex> lock(slab_mutex_);
+  for (auto it = available_slabs_.begin(); it != available_slabs_.end();) {
+    const auto& slab = *it;
+    if (slab->size > 0 && !isReferenced(slab->path)) {
+      slab->stream.close();
+      writable_slabs_.erase(slab->path);
+      deleteSlab(slab->path);
+      it = available_slabs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SlabFileSystemRepository::clearOrphans() {
+  std::lock_guard<std::mutex> lock(reclaim_mutex_);
+  logger_->log_debug("Checking %zu slabs of the previous run for orphaned content", startup_slabs_.size());
+  reclaim_candidates_.insert(startup_slabs_.begin(), startup_slabs_.end());
+  startup_slabs_.clear();
+}
+
+bool SlabFileSystemRepository::isSlab(const std::string& path) {
+  return utils::StringUtils::endsWith(path, SLAB_FILE_EXTENSION);
+}
+
+std::shared_ptr<SlabFileSystemRepository::Slab> SlabFileSystemRepository::acquireSlab() {
+  std::lock_guard<std::mutex> lock(slab_mutex_);
+  if (!available_slabs_.empty()) {
+    auto slab = available_slabs_.front();
+    available_slabs_.pop_front();
+    return slab;
+  }
+  auto slab = std::make_shared<Slab>(utils::file::FileUtils::concat_path(directory_,
+      utils::IdGenerator::getIdGenerator()->generate().to_string() + SLAB_FILE_EXTENSION));
+  if (!slab->stream) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't create slab " + slab->path);
+  }
+  writable_slabs_.insert(slab->path);
+  logger_->log_debug("Created slab %s", slab->path);
+  return slab;
+}
+
+void SlabFileSystemRepository::releaseSlab(const std::shared_ptr<Slab>& slab) {
+  {
+    std::lock_guard<std::mutex> lock(slab_mutex_);
+    if (slab->size < max_slab_size_ && slab->stream.good()) {
+      available_slabs_.push_back(slab);
+      return;
+    }
+    slab->stream.close();
+    writable_slabs_.erase(slab->path);
+  }
+  logger_->log_debug("Sealed slab %s of %" PRIu64 " bytes", slab->path, slab->size);
+  std::lock_guard<std::mutex> lock(reclaim_mutex_);
+  reclaim_candidates_.insert(slab->path);
+}
+
+bool SlabFileSystemRepository::isReferenced(const std::string& path) {
+  std::lock_guard<std::mutex> lock(count_map_mutex_);
+  return count_map_.find(path) != count_map_.end();
+}
+
+void SlabFileSystemRepository::deleteSlab(const std::string& path) {
+  logger_->log_debug("Deleting slab %s", path);
+  std::remove(path.c_str());
+}
+
+void SlabFileSystemRepository::runReclaimer() {
+  std::unique_lock<std::mutex> lock(reclaim_mutex_);
+  while (running_) {
+    reclaim_condition_.wait_for(lock, reclaim_period_, [this] { return !running_; });
+    if (!running_) {
+      break;
+    }
+    lock.unlock();
+    reclaim();
+    lock.lock();
+  }
+}
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
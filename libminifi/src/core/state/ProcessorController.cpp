@@ -59,6 +59,11 @@ int16_t ProcessorController::resume() {
   return start();
 }
 
+int16_t ProcessorController::setMaxConcurrentTasks(uint8_t tasks) {
+  scheduler_->setMaxConcurrentTasks(processor_, tasks);
+  return 0;
+}
+
 } /* namespace state */
 } /* namespace minifi */
 } /* namespace nifi */
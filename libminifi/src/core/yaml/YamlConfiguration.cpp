@@ -26,6 +26,7 @@
 #include "core/yaml/YamlConnectionParser.h"
 #include "core/state/Value.h"
 #include "Defaults.h"
+#include "provenance/ProvenanceSampler.h"
 
 #ifdef YAML_CONFIGURATION_USE_REGEX
 #include <regex>
@@ -100,9 +101,66 @@ std::unique_ptr<core::ProcessGroup> YamlConfiguration::createProcessGroup(const
     }
   }
 
+  if (yamlNode[CONFIG_YAML_PROVENANCE_MODE_KEY] && group) {
+    parseProvenanceModeYaml(yamlNode[CONFIG_YAML_PROVENANCE_MODE_KEY], group.get());
+  }
+
   return group;
 }
 
+void YamlConfiguration::parseProvenanceModeYaml(const YAML::Node& provenanceNode, core::ProcessGroup* group) {
+  const auto mode = provenanceNode["mode"] ? provenanceNode["mode"].as<std::string>() : std::string("full");
+  if (utils::StringUtils::equalsIgnoreCase(mode, "full")) {
+    logger_->log_debug("parseProvenanceMode: keeping every provenance event of process group %s", group->getName());
+    group->setProvenanceSampler(nullptr);
+    return;
+  }
+  if (!utils::StringUtils::equalsIgnoreCase(mode, "sampled")) {
+    throw std::invalid_argument("Invalid provenance mode " + mode + " of process group " + group->getName());
+  }
+
+  double sample_rate = 0.0;
+  if (provenanceNode["sample rate"]) {
+    sample_rate = provenanceNode["sample rate"].as<double>();
+    if (sample_rate < 0.0 || sample_rate > 1.0) {
+      throw std::invalid_argument("Provenance sample rate of process group " + group->getName() + " must be between 0 and 1");
+    }
+  }
+
+  std::set<provenance::ProvenanceEventRecord::ProvenanceEventType> kept_event_types;
+  if (provenanceNode["keep event types"]) {
+    for (const auto& type_name : utils::StringUtils::splitAndTrim(provenanceNode["keep event types"].as<std::string>(), ",")) {
+      if (type_name.empty()) {
+        continue;
+      }
+      bool found = false;
+      for (int type = provenance::ProvenanceEventRecord::CREATE; type <= provenance::ProvenanceEventRecord::REPLAY; ++type) {
+        if (utils::StringUtils::equalsIgnoreCase(type_name, provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[type])) {
+          kept_event_types.insert(static_cast<provenance::ProvenanceEventRecord::ProvenanceEventType>(type));
+          found = true;
+        }
+      }
+      if (!found) {
+        throw std::invalid_argument("Invalid provenance event type " + type_name + " of process group " + group->getName());
+      }
+    }
+  }
+
+  int64_t window_ms = 60000;
+  if (provenanceNode["aggregation window"]) {
+    const auto window = provenanceNode["aggregation window"].as<std::string>();
+    core::TimeUnit unit;
+    if (!core::Property::StringToTime(window, window_ms, unit) || !core::Property::ConvertTimeUnitToMS(window_ms, unit, window_ms) || window_ms <= 0) {
+      throw std::invalid_argument("Invalid provenance aggregation window " + window + " of process group " + group->getName());
+    }
+  }
+
+  logger_->log_debug("parseProvenanceMode: sampling provenance events of process group %s at rate %f, aggregated over %" PRId64 " ms windows",
+      group->getName(), sample_rate, window_ms);
+  group->setProvenanceSampler(std::make_shared<provenance::ProvenanceSampler>(group->getName(), sample_rate, std::move(kept_event_types),
+      std::chrono::milliseconds(window_ms)));
+}
+
 std::unique_ptr<core::ProcessGroup> YamlConfiguration::parseProcessGroupYaml(const YAML::Node& headerNode, const YAML::Node& yamlNode, bool is_root) {
   auto group = createProcessGroup(headerNode, is_root);
   YAML::Node processorsNode = yamlNode[CONFIG_YAML_PROCESSORS_KEY];
@@ -245,6 +303,11 @@ void YamlConfiguration::parseProcessorNodeYaml(const YAML::Node& processorsNode,
       logger_->log_debug("parseProcessorNode: run duration nanos => [%s]", procCfg.runDurationNanos);
     }
 
+    if (procNode["max batch size"]) {
+      procCfg.maxBatchSize = procNode["max batch size"].as<std::string>();
+      logger_->log_debug("parseProcessorNode: max batch size => [%s]", procCfg.maxBatchSize);
+    }
+
     // handle auto-terminated relationships
     if (procNode["auto-terminated relationships list"]) {
       YAML::Node autoTerminatedSequence = procNode["auto-terminated relationships list"];
@@ -307,9 +370,20 @@ void YamlConfiguration::parseProcessorNodeYaml(const YAML::Node& processorsNode,
       processor->setMaxConcurrentTasks((uint8_t) maxConcurrentTasks);
     }
 
-    if (core::Property::StringToInt(procCfg.runDurationNanos, runDurationNanos)) {
-      logger_->log_debug("parseProcessorNode: runDurationNanos => [%d]", runDurationNanos);
+    // the run duration is either a plain number of nanoseconds or a time period with a unit
+    if ((core::Property::StringToTime(procCfg.runDurationNanos, runDurationNanos, unit) && core::Property::ConvertTimeUnitToNS(runDurationNanos, unit, runDurationNanos))
+        || core::Property::StringToInt(procCfg.runDurationNanos, runDurationNanos)) {
+      logger_->log_debug("parseProcessorNode: runDurationNanos => [%" PRId64 "] ns", runDurationNanos);
       processor->setRunDurationNano((uint64_t) runDurationNanos);
+      if (runDurationNanos > 0 && !processor->supportsBatching()) {
+        logger_->log_warn("Processor %s does not support batching, its run duration is ignored", procCfg.name);
+      }
+    }
+
+    uint64_t maxBatchSize;
+    if (core::Property::StringToInt(procCfg.maxBatchSize, maxBatchSize)) {
+      logger_->log_debug("parseProcessorNode: maxBatchSize => [%" PRIu64 "]", maxBatchSize);
+      processor->setMaxBatchSize(maxBatchSize);
     }
 
     std::set<core::Relationship> autoTerminatedRelationships;
@@ -621,6 +695,12 @@ void YamlConfiguration::parseConnectionYaml(const YAML::Node& connectionsNode, c
     connection->setDestinationUUID(connectionParser.getDestinationUUIDFromYaml());
     connection->setFlowExpirationDuration(connectionParser.getFlowFileExpirationFromYaml());
     connection->setDropEmptyFlowFiles(connectionParser.getDropEmptyFromYaml());
+    connection->setLockFreeQueue(connectionParser.getLockFreeQueueFromYaml());
+    const uint64_t swap_threshold = connectionParser.getSwapThresholdFromYaml(getDefaultSwapThreshold());
+    if (swap_threshold > 0) {
+      connection->setSwapThreshold(swap_threshold);
+      connection->setSwapManager(getSwapManager());
+    }
 
     parent->addConnection(connection);
   }
@@ -174,6 +174,29 @@ bool YamlConnectionParser::getDropEmptyFromYaml() const {
   return false;
 }
 
+uint64_t YamlConnectionParser::getSwapThresholdFromYaml(uint64_t default_threshold) const {
+  const YAML::Node swap_threshold_node = connectionNode_["swap threshold"];
+  if (swap_threshold_node) {
+    auto swap_threshold_str = swap_threshold_node.as<std::string>();
+    uint64_t swap_threshold;
+    if (core::Property::StringToInt(swap_threshold_str, swap_threshold)) {
+      logger_->log_debug("Setting %" PRIu64 " as the swap threshold.", swap_threshold);
+      return swap_threshold;
+    }
+    logger_->log_info("Invalid swap threshold value: %s.", swap_threshold_str);
+  }
+  return default_threshold;
+}
+
+bool YamlConnectionParser::getLockFreeQueueFromYaml() const {
+  const YAML::Node lock_free_queue_node = connectionNode_["lock free queue"];
+  if (lock_free_queue_node) {
+    bool lockFreeQueue = false;
+    return utils::StringUtils::StringToBool(lock_free_queue_node.as<std::string>(), lockFreeQueue) && lockFreeQueue;
+  }
+  return false;
+}
+
 }  // namespace yaml
 }  // namespace core
 }  // namespace minifi
@@ -18,4 +18,51 @@
 
 #include "io/CRCStream.h"
 #include <zlib.h>
+#include <algorithm>
 #include <memory>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+namespace internal {
+
+bool updateCRC(uLong& crc, const FileRegion& region) {
+#ifdef WIN32
+  (void)crc;
+  (void)region;
+  return false;
+#else
+  constexpr uint64_t MAPPING_SIZE = 64 * 1024 * 1024;
+  static const uint64_t page_size = gsl::narrow<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t end = region.offset + region.size;
+  uint64_t position = region.offset;
+  while (position < end) {
+    // mappings have to start at a page boundary
+    const uint64_t mapping_offset = position - position % page_size;
+    const uint64_t mapping_size = (std::min)(end - mapping_offset, MAPPING_SIZE);
+    void* mapping = mmap(nullptr, gsl::narrow<size_t>(mapping_size), PROT_READ, MAP_SHARED, region.fd, gsl::narrow<off_t>(mapping_offset));
+    if (mapping == MAP_FAILED) {
+      return false;
+    }
+    const uint64_t skipped = position - mapping_offset;
+    crc = crc32(crc, static_cast<const Bytef*>(mapping) + skipped, gsl::narrow<uInt>(mapping_size - skipped));
+    munmap(mapping, gsl::narrow<size_t>(mapping_size));
+    position = mapping_offset + mapping_size;
+  }
+  return true;
+#endif
+}
+
+}  // namespace internal
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -22,6 +22,9 @@
 #include <netinet/in.h>
 #include <ifaddrs.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #else
 #include <WS2tcpip.h>
 #pragma comment(lib, "Ws2_32.lib")
@@ -33,6 +36,7 @@
 #include <arpa/inet.h>
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -523,6 +527,43 @@ int Socket::write(const uint8_t *value, int size) {
   return bytes;
 }
 
+bool Socket::canWriteFileRegion() const {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+int64_t Socket::writeFileRegion(const FileRegion& region) {
+#ifdef __linux__
+  int fd = select_descriptor(1000);
+  if (fd < 0) { return -1; }
+  off_t offset = gsl::narrow<off_t>(region.offset);
+  uint64_t bytes = 0;
+  while (bytes < region.size) {
+    // sendfile transfers at most 0x7ffff000 bytes at once
+    const size_t chunk = gsl::narrow<size_t>((std::min)(region.size - bytes, uint64_t{0x7ffff000}));
+    const ssize_t ret = sendfile(fd, region.fd, &offset, chunk);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      utils::file::FileUtils::close(fd);
+      logger_->log_error("Could not send file to %d, error: %s", fd, ret == 0 ? "unexpected end of file" : get_last_socket_error_message());
+      return -1;
+    }
+    bytes += gsl::narrow<uint64_t>(ret);
+  }
+  logger_->log_trace("Sent file region of size %" PRIu64 " over socket %d", bytes, fd);
+  total_written_ += bytes;
+  return gsl::narrow<int64_t>(bytes);
+#else
+  (void)region;
+  return -1;
+#endif
+}
+
 int Socket::read(uint8_t *buf, int buflen, bool retrieve_all_bytes) {
   gsl_Expects(buflen >= 0);
   int32_t total_read = 0;
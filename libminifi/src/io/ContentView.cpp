@@ -0,0 +1,85 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/ContentView.h"
+
+#include <utility>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+ContentView::ContentView(std::vector<uint8_t> buffer)
+    : buffer_(std::move(buffer)),
+      mapping_(nullptr),
+      mapping_size_(0),
+      data_(buffer_.data()),
+      size_(buffer_.size()) {
+}
+
+ContentView::ContentView(void* mapping, size_t mapping_size, const uint8_t* data, size_t size)
+    : mapping_(mapping),
+      mapping_size_(mapping_size),
+      data_(data),
+      size_(size) {
+}
+
+ContentView::~ContentView() {
+#ifndef WIN32
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+}
+
+std::shared_ptr<ContentView> ContentView::map(int fd, uint64_t offset, uint64_t size) {
+  if (size == 0) {
+    return std::make_shared<ContentView>(std::vector<uint8_t>{});
+  }
+#ifdef WIN32
+  (void)fd;
+  (void)offset;
+  return nullptr;
+#else
+  static const uint64_t page_size = gsl::narrow<uint64_t>(sysconf(_SC_PAGESIZE));
+  // mappings have to start at a page boundary
+  const uint64_t mapping_offset = offset - offset % page_size;
+  const auto mapping_size = gsl::narrow<size_t>(offset - mapping_offset + size);
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, gsl::narrow<off_t>(mapping_offset));
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+  madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+  const auto data = static_cast<const uint8_t*>(mapping) + (offset - mapping_offset);
+  return std::shared_ptr<ContentView>(new ContentView(mapping, mapping_size, data, gsl::narrow<size_t>(size)));
+#endif
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -16,12 +16,19 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <fstream>
 #include <vector>
 #include <memory>
 #include <string>
 #include <Exception.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "io/validation.h"
+#include "io/ContentView.h"
 #include "io/FileStream.h"
 #include "io/InputStream.h"
 #include "io/OutputStream.h"
@@ -180,6 +187,30 @@ int FileStream::read(uint8_t *buf, int buflen) {
   }
 }
 
+std::shared_ptr<ContentView> FileStream::map(uint64_t max_size) {
+#ifdef WIN32
+  (void)max_size;
+  return nullptr;
+#else
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (file_stream_ == nullptr || !file_stream_->is_open() || !file_stream_->flush()) {
+    return nullptr;
+  }
+  const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  std::shared_ptr<ContentView> view;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && gsl::narrow<uint64_t>(file_stat.st_size) >= offset_) {
+    // the mapping must not reach past the end of the file
+    view = ContentView::map(fd, offset_, (std::min)(max_size, gsl::narrow<uint64_t>(file_stat.st_size) - offset_));
+  }
+  ::close(fd);
+  return view;
+#endif
+}
+
 void FileStream::seekToEndOfFile(const char *caller_error_msg) {
   if (!file_stream_->seekg(0, file_stream_->end))
     logging::LOG_ERROR(logger_) << caller_error_msg << SEEKG_CALL_ERROR_MSG;
@@ -0,0 +1,163 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/FileStreamFactory.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "io/FileStream.h"
+#include "io/PosixFileStream.h"
+#include "utils/StringUtils.h"
+
+#ifdef WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+FileStreamFactory::FileStreamFactory()
+    : implementation_(Implementation::FSTREAM),
+      durability_(Durability::NONE),
+      logger_(logging::LoggerFactory<FileStreamFactory>::getLogger()) {
+}
+
+bool FileStreamFactory::initialize(const std::shared_ptr<minifi::Configure>& configuration) {
+  std::string value;
+  if (configuration->get(Configure::nifi_content_repository_file_stream, value)) {
+    value = utils::StringUtils::trim(value);
+    if (utils::StringUtils::equalsIgnoreCase(value, "fstream")) {
+      implementation_ = Implementation::FSTREAM;
+    } else if (utils::StringUtils::equalsIgnoreCase(value, "posix")) {
+#ifdef WIN32
+      logger_->log_warn("POSIX file streams are not available on Windows, using fstream");
+      implementation_ = Implementation::FSTREAM;
+#else
+      implementation_ = Implementation::POSIX;
+#endif
+    } else {
+      logger_->log_error("Invalid value for %s: %s, expected fstream or posix", Configure::nifi_content_repository_file_stream, value);
+      return false;
+    }
+  }
+  if (configuration->get(Configure::nifi_content_repository_durability, value)) {
+    value = utils::StringUtils::trim(value);
+    if (utils::StringUtils::equalsIgnoreCase(value, "none")) {
+      durability_ = Durability::NONE;
+    } else if (utils::StringUtils::equalsIgnoreCase(value, "close")) {
+      durability_ = Durability::SYNC_ON_CLOSE;
+    } else if (utils::StringUtils::equalsIgnoreCase(value, "commit")) {
+      durability_ = Durability::SYNC_ON_COMMIT;
+    } else {
+      logger_->log_error("Invalid value for %s: %s, expected none, close or commit", Configure::nifi_content_repository_durability, value);
+      return false;
+    }
+  }
+  if (implementation_ == Implementation::FSTREAM && durability_ == Durability::SYNC_ON_CLOSE) {
+    // fstream does not expose its file descriptor, the files are synced by the content session instead
+    logger_->log_info("fstream based content files are synced on commit instead of on close");
+    durability_ = Durability::SYNC_ON_COMMIT;
+  }
+  return true;
+}
+
+std::shared_ptr<io::BaseStream> FileStreamFactory::openForRead(const std::string& path) const {
+#ifndef WIN32
+  if (implementation_ == Implementation::POSIX) {
+    return std::make_shared<io::PosixFileStream>(path, 0, false);
+  }
+#endif
+  return std::make_shared<io::FileStream>(path, 0, false);
+}
+
+std::shared_ptr<io::BaseStream> FileStreamFactory::openForWrite(const std::string& path, bool append) const {
+#ifndef WIN32
+  if (implementation_ == Implementation::POSIX) {
+    return std::make_shared<io::PosixFileStream>(path, append ? io::PosixFileStream::WriteMode::APPEND : io::PosixFileStream::WriteMode::TRUNCATE,
+        durability_ == Durability::SYNC_ON_CLOSE);
+  }
+#endif
+  return std::make_shared<io::FileStream>(path, append);
+}
+
+bool FileStreamFactory::sync(const std::string& path) {
+#ifdef WIN32
+  const int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool synced = _commit(fd) == 0;
+  _close(fd);
+  return synced;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+#ifdef __APPLE__
+  const bool synced = fsync(fd) == 0;
+#else
+  const bool synced = fdatasync(fd) == 0;
+#endif
+  ::close(fd);
+  return synced;
+#endif
+}
+
+bool FileStreamFactory::syncDirectory(const std::string& path) {
+#ifdef WIN32
+  // directories cannot be opened as files on Windows, NTFS journals the changes of the directory entries
+  (void)path;
+  return true;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool synced = fsync(fd) == 0;
+  ::close(fd);
+  return synced;
+#endif
+}
+
+bool FileStreamFactory::truncate(const std::string& path, uint64_t size) {
+#ifdef WIN32
+  const int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool truncated = _chsize_s(fd, static_cast<__int64>(size)) == 0;
+  _close(fd);
+  return truncated;
+#else
+  return ::truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
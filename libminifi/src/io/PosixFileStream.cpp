@@ -0,0 +1,283 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/PosixFileStream.h"
+
+#ifndef WIN32
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "io/ContentView.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+constexpr size_t PosixFileStream::WRITE_BUFFER_SIZE;
+
+namespace {
+
+int openFile(const std::string& path, int flags) {
+  int fd;
+  do {
+    fd = ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+  } while (fd < 0 && errno == EINTR);
+  return fd;
+}
+
+bool syncDescriptor(int fd) {
+#ifdef __APPLE__
+  return fsync(fd) == 0;
+#else
+  return fdatasync(fd) == 0;
+#endif
+}
+
+}  // namespace
+
+PosixFileStream::PosixFileStream(const std::string& path, uint64_t offset, bool write_enable)
+    : path_(path),
+      fd_(openFile(path, write_enable ? O_RDWR : O_RDONLY)),
+      sync_on_close_(false),
+      offset_(offset),
+      length_(0),
+      sync_pending_(false),
+      failed_(false),
+      logger_(logging::LoggerFactory<PosixFileStream>::getLogger()) {
+  if (fd_ < 0) {
+    logger_->log_error("Error opening file %s: %s", path_, std::strerror(errno));
+    return;
+  }
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == 0) {
+    length_ = gsl::narrow<size_t>(file_stat.st_size);
+  }
+#ifdef POSIX_FADV_SEQUENTIAL
+  // content is almost always read from the beginning to the end, let the kernel read ahead aggressively
+  posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+PosixFileStream::PosixFileStream(const std::string& path, WriteMode mode, bool sync_on_close)
+    : path_(path),
+      fd_(openFile(path, O_RDWR | O_CREAT | (mode == WriteMode::TRUNCATE ? O_TRUNC : 0))),
+      sync_on_close_(sync_on_close),
+      offset_(0),
+      length_(0),
+      sync_pending_(false),
+      failed_(false),
+      logger_(logging::LoggerFactory<PosixFileStream>::getLogger()) {
+  if (fd_ < 0) {
+    logger_->log_error("Error opening file %s: %s", path_, std::strerror(errno));
+    return;
+  }
+  struct stat file_stat;
+  if (mode == WriteMode::APPEND && fstat(fd_, &file_stat) == 0) {
+    length_ = gsl::narrow<size_t>(file_stat.st_size);
+    offset_ = length_;
+  }
+}
+
+PosixFileStream::~PosixFileStream() {
+  close();
+}
+
+void PosixFileStream::close() {
+  if (fd_ < 0) {
+    return;
+  }
+  // the failure is logged here, and it is reported by flush to the owners of the stream
+  flush();
+  if (::close(fd_) != 0) {
+    logger_->log_error("Error closing file %s: %s", path_, std::strerror(errno));
+  }
+  fd_ = -1;
+}
+
+void PosixFileStream::seek(uint64_t offset) {
+  if (fd_ < 0) {
+    logger_->log_error("Error seeking in file %s: invalid file descriptor", path_);
+    return;
+  }
+  flushBuffer();
+  offset_ = offset;
+}
+
+int PosixFileStream::read(uint8_t *buf, int buflen) {
+  gsl_Expects(buflen >= 0);
+  if (buflen == 0) {
+    return 0;
+  }
+  if (buf == nullptr) {
+    logger_->log_error("Error reading from file %s: invalid buffer", path_);
+    return -1;
+  }
+  if (fd_ < 0) {
+    logger_->log_error("Error reading from file %s: invalid file descriptor", path_);
+    return -1;
+  }
+  if (!flushBuffer()) {
+    return -1;
+  }
+  const auto len = gsl::narrow<size_t>(buflen);
+  size_t total = 0;
+  while (total < len) {
+    const ssize_t ret = pread(fd_, buf + total, len - total, gsl::narrow<off_t>(offset_ + total));
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      logger_->log_error("Error reading from file %s: %s", path_, std::strerror(errno));
+      return -1;
+    }
+    if (ret == 0) {
+      break;
+    }
+    total += gsl::narrow<size_t>(ret);
+  }
+  offset_ += total;
+  length_ = (std::max)(length_, gsl::narrow<size_t>(offset_));
+  return gsl::narrow<int>(total);
+}
+
+int PosixFileStream::write(const uint8_t *value, int size) {
+  gsl_Expects(size >= 0);
+  if (size == 0) {
+    return 0;
+  }
+  if (value == nullptr) {
+    logger_->log_error("Error writing to file %s: empty message", path_);
+    return -1;
+  }
+  if (fd_ < 0) {
+    logger_->log_error("Error writing to file %s: invalid file descriptor", path_);
+    return -1;
+  }
+  const auto len = gsl::narrow<size_t>(size);
+  if (write_buffer_.size() + len > WRITE_BUFFER_SIZE && !flushBuffer()) {
+    return -1;
+  }
+  sync_pending_ = true;
+  if (len >= WRITE_BUFFER_SIZE) {
+    // large writes go to the file directly instead of being copied through the buffer
+    if (!writeAt(value, len, offset_)) {
+      return -1;
+    }
+  } else {
+    if (write_buffer_.capacity() < WRITE_BUFFER_SIZE) {
+      write_buffer_.reserve(WRITE_BUFFER_SIZE);
+    }
+    write_buffer_.insert(write_buffer_.end(), value, value + len);
+  }
+  offset_ += len;
+  length_ = (std::max)(length_, gsl::narrow<size_t>(offset_));
+  return size;
+}
+
+utils::optional<int64_t> PosixFileStream::transferTo(OutputStream& output, uint64_t max_size) {
+  if (fd_ < 0 || !output.canWriteFileRegion()) {
+    return utils::nullopt;
+  }
+  if (!flushBuffer()) {
+    return -1;
+  }
+  const uint64_t remaining = length_ > offset_ ? length_ - offset_ : 0;
+  const int64_t transferred = output.writeFileRegion(FileRegion{fd_, offset_, (std::min)(max_size, remaining)});
+  if (transferred > 0) {
+    offset_ += gsl::narrow<uint64_t>(transferred);
+  }
+  return transferred;
+}
+
+std::shared_ptr<ContentView> PosixFileStream::map(uint64_t max_size) {
+  if (fd_ < 0 || !flushBuffer()) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) != 0 || gsl::narrow<uint64_t>(file_stat.st_size) < offset_) {
+    return nullptr;
+  }
+  // the mapping must not reach past the end of the file
+  return ContentView::map(fd_, offset_, (std::min)(max_size, gsl::narrow<uint64_t>(file_stat.st_size) - offset_));
+}
+
+bool PosixFileStream::flush() {
+  if (fd_ >= 0 && flushBuffer() && sync_on_close_ && sync_pending_) {
+    sync();
+  }
+  return !failed_;
+}
+
+bool PosixFileStream::sync() {
+  if (fd_ < 0 || !flushBuffer()) {
+    return false;
+  }
+  if (!syncDescriptor(fd_)) {
+    // the kernel may drop the pages it failed to write, so a later successful sync does not mean the data is stored
+    logger_->log_error("Error syncing file %s: %s", path_, std::strerror(errno));
+    failed_ = true;
+    return false;
+  }
+  sync_pending_ = false;
+  return true;
+}
+
+bool PosixFileStream::flushBuffer() {
+  if (write_buffer_.empty()) {
+    return true;
+  }
+  const bool written = writeAt(write_buffer_.data(), write_buffer_.size(), offset_ - write_buffer_.size());
+  write_buffer_.clear();
+  if (!written) {
+    failed_ = true;
+  }
+  return written;
+}
+
+bool PosixFileStream::writeAt(const uint8_t* data, size_t size, uint64_t offset) {
+  size_t total = 0;
+  while (total < size) {
+    const ssize_t ret = pwrite(fd_, data + total, size - total, gsl::narrow<off_t>(offset + total));
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      logger_->log_error("Error writing to file %s: %s", path_, std::strerror(errno));
+      return false;
+    }
+    total += gsl::narrow<size_t>(ret);
+  }
+  return true;
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // WIN32
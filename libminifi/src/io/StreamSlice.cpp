@@ -0,0 +1,78 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/StreamSlice.h"
+
+#include <algorithm>
+#include <utility>
+#include "io/ContentView.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+StreamSlice::StreamSlice(std::shared_ptr<BaseStream> stream, uint64_t offset, uint64_t size)
+    : stream_(std::move(stream)),
+      offset_(offset),
+      size_(gsl::narrow<size_t>(size)),
+      position_(0) {
+  stream_->seek(offset_);
+}
+
+void StreamSlice::seek(uint64_t offset) {
+  position_ = gsl::narrow<size_t>((std::min)(offset, static_cast<uint64_t>(size_)));
+  stream_->seek(offset_ + position_);
+}
+
+int StreamSlice::read(uint8_t *value, int len) {
+  gsl_Expects(len >= 0);
+  const size_t to_read = (std::min)(static_cast<size_t>(len), size_ - position_);
+  if (to_read == 0) {
+    return 0;
+  }
+  const int ret = stream_->read(value, gsl::narrow<int>(to_read));
+  if (ret > 0) {
+    position_ += ret;
+  }
+  return ret;
+}
+
+utils::optional<int64_t> StreamSlice::transferTo(OutputStream& output, uint64_t max_size) {
+  const auto transferred = stream_->transferTo(output, (std::min)(max_size, static_cast<uint64_t>(size_ - position_)));
+  if (transferred && *transferred > 0) {
+    position_ += gsl::narrow<size_t>(*transferred);
+  }
+  return transferred;
+}
+
+std::shared_ptr<ContentView> StreamSlice::map(uint64_t max_size) {
+  return stream_->map((std::min)(max_size, static_cast<uint64_t>(size_ - position_)));
+}
+
+void StreamSlice::close() {
+  stream_->close();
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -29,6 +29,8 @@
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "FlowController.h"
+#include "provenance/ProvenanceQuery.h"
+#include "provenance/ProvenanceSampler.h"
 #include "utils/gsl.h"
 
 namespace org {
@@ -390,6 +392,18 @@ void ProvenanceReporter::commit() {
     return;
   }
 
+  // repositories indexing the events take the indexed fields from the events, so they do not parse them again
+  if (auto queryable = std::dynamic_pointer_cast<ProvenanceQueryable>(repo_)) {
+    std::vector<std::pair<std::shared_ptr<ProvenanceEventRecord>, std::unique_ptr<io::BufferStream>>> events;
+    for (auto& event : _events) {
+      std::unique_ptr<io::BufferStream> stream(new io::BufferStream());
+      event->Serialize(*stream);
+      events.emplace_back(event, std::move(stream));
+    }
+    queryable->storeEvents(events);
+    return;
+  }
+
   std::vector<std::pair<std::string, std::unique_ptr<io::BufferStream>>> flowData;
 
   for (auto& event : _events) {
@@ -401,17 +415,28 @@ void ProvenanceReporter::commit() {
   repo_->MultiPut(flowData);
 }
 
-void ProvenanceReporter::create(std::shared_ptr<core::FlowFile> flow, std::string detail) {
-  auto event = allocate(ProvenanceEventRecord::CREATE, flow);
-
-  if (event) {
-    event->setDetails(detail);
-    add(event);
+std::shared_ptr<ProvenanceEventRecord> ProvenanceReporter::allocate(ProvenanceEventRecord::ProvenanceEventType eventType, const std::shared_ptr<core::FlowFile>& flow,
+    uint64_t processingDuration) {
+  if (repo_->isNoop()) {
+    return nullptr;
+  }
+  if (sampler_ && !sampler_->sample(_componentId, eventType, flow->getSize(), processingDuration)) {
+    return nullptr;
   }
+
+  auto event = std::make_shared<ProvenanceEventRecord>(eventType, _componentId, _componentType);
+  if (event)
+    event->fromFlowFile(flow);
+
+  return event;
+}
+
+void ProvenanceReporter::create(std::shared_ptr<core::FlowFile> flow, std::string detail) {
+  create(flow, [&detail] { return detail; });
 }
 
 void ProvenanceReporter::route(std::shared_ptr<core::FlowFile> flow, core::Relationship relation, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::ROUTE, flow);
+  auto event = allocate(ProvenanceEventRecord::ROUTE, flow, processingDuration);
 
   if (event) {
     event->setDetails(detail);
@@ -422,22 +447,11 @@ void ProvenanceReporter::route(std::shared_ptr<core::FlowFile> flow, core::Relat
 }
 
 void ProvenanceReporter::modifyAttributes(std::shared_ptr<core::FlowFile> flow, std::string detail) {
-  auto event = allocate(ProvenanceEventRecord::ATTRIBUTES_MODIFIED, flow);
-
-  if (event) {
-    event->setDetails(detail);
-    add(event);
-  }
+  modifyAttributes(flow, [&detail] { return detail; });
 }
 
 void ProvenanceReporter::modifyContent(std::shared_ptr<core::FlowFile> flow, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::CONTENT_MODIFIED, flow);
-
-  if (event) {
-    event->setDetails(detail);
-    event->setEventDuration(processingDuration);
-    add(event);
-  }
+  modifyContent(flow, [&detail] { return detail; }, processingDuration);
 }
 
 void ProvenanceReporter::clone(std::shared_ptr<core::FlowFile> parent, std::shared_ptr<core::FlowFile> child) {
@@ -451,7 +465,7 @@ void ProvenanceReporter::clone(std::shared_ptr<core::FlowFile> parent, std::shar
 }
 
 void ProvenanceReporter::join(std::vector<std::shared_ptr<core::FlowFile> > parents, std::shared_ptr<core::FlowFile> child, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::JOIN, child);
+  auto event = allocate(ProvenanceEventRecord::JOIN, child, processingDuration);
 
   if (event) {
     event->addChildFlowFile(child);
@@ -467,7 +481,7 @@ void ProvenanceReporter::join(std::vector<std::shared_ptr<core::FlowFile> > pare
 }
 
 void ProvenanceReporter::fork(std::vector<std::shared_ptr<core::FlowFile> > child, std::shared_ptr<core::FlowFile> parent, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::FORK, parent);
+  auto event = allocate(ProvenanceEventRecord::FORK, parent, processingDuration);
 
   if (event) {
     event->addParentFlowFile(parent);
@@ -491,6 +505,19 @@ void ProvenanceReporter::expire(std::shared_ptr<core::FlowFile> flow, std::strin
   }
 }
 
+void ProvenanceReporter::expire(const std::set<std::shared_ptr<core::FlowFile>>& flows, const std::string& detail_prefix) {
+  if (repo_->isNoop()) {
+    return;
+  }
+  for (const auto& flow : flows) {
+    auto event = allocate(ProvenanceEventRecord::EXPIRE, flow);
+    if (event) {
+      event->setDetails(detail_prefix + flow->getUUIDStr());
+      add(event);
+    }
+  }
+}
+
 void ProvenanceReporter::drop(std::shared_ptr<core::FlowFile> flow, std::string reason) {
   auto event = allocate(ProvenanceEventRecord::DROP, flow);
 
@@ -502,7 +529,7 @@ void ProvenanceReporter::drop(std::shared_ptr<core::FlowFile> flow, std::string
 }
 
 void ProvenanceReporter::send(std::shared_ptr<core::FlowFile> flow, std::string transitUri, std::string detail, uint64_t processingDuration, bool force) {
-  auto event = allocate(ProvenanceEventRecord::SEND, flow);
+  auto event = allocate(ProvenanceEventRecord::SEND, flow, processingDuration);
 
   if (event) {
     event->setTransitUri(transitUri);
@@ -518,7 +545,7 @@ void ProvenanceReporter::send(std::shared_ptr<core::FlowFile> flow, std::string
 }
 
 void ProvenanceReporter::receive(std::shared_ptr<core::FlowFile> flow, std::string transitUri, std::string sourceSystemFlowFileIdentifier, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::RECEIVE, flow);
+  auto event = allocate(ProvenanceEventRecord::RECEIVE, flow, processingDuration);
 
   if (event) {
     event->setTransitUri(transitUri);
@@ -530,7 +557,7 @@ void ProvenanceReporter::receive(std::shared_ptr<core::FlowFile> flow, std::stri
 }
 
 void ProvenanceReporter::fetch(std::shared_ptr<core::FlowFile> flow, std::string transitUri, std::string detail, uint64_t processingDuration) {
-  auto event = allocate(ProvenanceEventRecord::FETCH, flow);
+  auto event = allocate(ProvenanceEventRecord::FETCH, flow, processingDuration);
 
   if (event) {
     event->setTransitUri(transitUri);
@@ -0,0 +1,136 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "provenance/ProvenanceSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+constexpr size_t ProvenanceSampler::MAX_AGGREGATE_WINDOWS;
+constexpr size_t ProvenanceAggregateMetrics::SHARD_COUNT;
+
+ProvenanceAggregateMetrics::ProvenanceAggregateMetrics(const std::string& group_name, std::chrono::milliseconds window_length, size_t max_windows)
+    : state::response::ResponseNode("ProvenanceAggregates-" + group_name),
+      window_length_((std::max<uint64_t>)(window_length.count(), 1)),
+      max_windows_(max_windows) {
+}
+
+void ProvenanceAggregateMetrics::add(const std::string& component_id, ProvenanceEventRecord::ProvenanceEventType type, uint64_t bytes, uint64_t duration, uint64_t event_time) {
+  const uint64_t window_start = event_time - event_time % window_length_;
+  Shard& shard = shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARD_COUNT];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  Window& window = shard.windows[window_start];
+  // the component id is only copied when the first event of the component is added to the window
+  auto it = window.find(std::pair<const std::string&, ProvenanceEventRecord::ProvenanceEventType>(component_id, type));
+  if (it == window.end()) {
+    it = window.emplace(std::make_pair(component_id, type), ProvenanceAggregate{}).first;
+  }
+  ++it->second.count;
+  it->second.bytes += bytes;
+  it->second.duration += duration;
+  while (shard.windows.size() > max_windows_) {
+    shard.windows.erase(shard.windows.begin());
+  }
+}
+
+std::map<uint64_t, ProvenanceAggregateMetrics::Window> ProvenanceAggregateMetrics::getWindows() const {
+  std::map<uint64_t, Window> windows;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& shard_window : shard.windows) {
+      Window& window = windows[shard_window.first];
+      for (const auto& entry : shard_window.second) {
+        auto& aggregate = window[entry.first];
+        aggregate.count += entry.second.count;
+        aggregate.bytes += entry.second.bytes;
+        aggregate.duration += entry.second.duration;
+      }
+    }
+  }
+  // the shards can be at different windows
+  while (windows.size() > max_windows_) {
+    windows.erase(windows.begin());
+  }
+  return windows;
+}
+
+std::vector<state::response::SerializedResponseNode> ProvenanceAggregateMetrics::serialize() {
+  std::vector<state::response::SerializedResponseNode> serialized;
+  for (const auto& window : getWindows()) {
+    state::response::SerializedResponseNode window_node;
+    window_node.name = std::to_string(window.first);
+    for (const auto& entry : window.second) {
+      state::response::SerializedResponseNode aggregate_node;
+      aggregate_node.name = entry.first.first + "." + ProvenanceEventRecord::ProvenanceEventTypeStr[entry.first.second];
+
+      state::response::SerializedResponseNode count;
+      count.name = "count";
+      count.value = entry.second.count;
+      aggregate_node.children.push_back(count);
+
+      state::response::SerializedResponseNode bytes;
+      bytes.name = "bytes";
+      bytes.value = entry.second.bytes;
+      aggregate_node.children.push_back(bytes);
+
+      state::response::SerializedResponseNode duration;
+      duration.name = "duration";
+      duration.value = entry.second.duration;
+      aggregate_node.children.push_back(duration);
+
+      window_node.children.push_back(aggregate_node);
+    }
+    serialized.push_back(window_node);
+  }
+  return serialized;
+}
+
+ProvenanceSampler::ProvenanceSampler(const std::string& group_name, double sample_rate, std::set<ProvenanceEventRecord::ProvenanceEventType> kept_event_types,
+    std::chrono::milliseconds aggregation_window)
+    : sample_rate_((std::max)(0.0, (std::min)(sample_rate, 1.0))),
+      kept_event_types_(std::move(kept_event_types)),
+      metrics_(std::make_shared<ProvenanceAggregateMetrics>(group_name, aggregation_window, MAX_AGGREGATE_WINDOWS)) {
+}
+
+bool ProvenanceSampler::sample(const std::string& component_id, ProvenanceEventRecord::ProvenanceEventType type, uint64_t bytes, uint64_t duration) {
+  metrics_->add(component_id, type, bytes, duration, utils::timeutils::getTimeMillis());
+  if (kept_event_types_.count(type) > 0) {
+    return true;
+  }
+  if (sample_rate_ <= 0) {
+    return false;
+  }
+  const uint64_t n = event_counter_++;
+  return std::floor(static_cast<double>(n + 1) * sample_rate_) > std::floor(static_cast<double>(n) * sample_rate_);
+}
+
+}  // namespace provenance
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,147 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/ConcurrentFlowFileQueue.h"
+
+#include <iterator>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+bool ConcurrentFlowFileQueue::FlowFilePenaltyExpirationComparator::operator()(const value_type& left, const value_type& right) const {
+  // this is operator< implemented using > so that top() is the element with the earliest expiration
+  return left->getPenaltyExpiration() > right->getPenaltyExpiration();
+}
+
+ConcurrentFlowFileQueue::ConcurrentFlowFileQueue()
+    : next_penalty_expiration_(clock::duration::max().count()),
+      size_(0),
+      data_size_(0) {
+}
+
+void ConcurrentFlowFileQueue::push(const value_type& element) {
+  push(value_type{element});
+}
+
+void ConcurrentFlowFileQueue::push(value_type&& element) {
+  // the counters are increased before the element becomes visible, so a concurrent pop can never make them underflow
+  ++size_;
+  data_size_ += element->getSize();
+  if (element->isPenalized()) {
+    pushPenalized(std::move(element));
+  } else {
+    ready_queue_.enqueue(std::move(element));
+  }
+}
+
+bool ConcurrentFlowFileQueue::tryPop(value_type& element) {
+  releaseExpiredPenalties();
+  if (!ready_queue_.try_dequeue(element)) {
+    return false;
+  }
+  onRemoved(element);
+  return true;
+}
+
+size_t ConcurrentFlowFileQueue::tryPopBatch(size_t max_count, std::vector<value_type>& elements) {
+  releaseExpiredPenalties();
+  const size_t first_new = elements.size();
+  const size_t count = ready_queue_.try_dequeue_bulk(std::back_inserter(elements), max_count);
+  for (size_t i = first_new; i < elements.size(); ++i) {
+    onRemoved(elements[i]);
+  }
+  return count;
+}
+
+std::vector<ConcurrentFlowFileQueue::value_type> ConcurrentFlowFileQueue::popAll() {
+  std::vector<value_type> elements;
+  {
+    std::lock_guard<std::mutex> lock(penalized_mutex_);
+    while (!penalized_queue_.empty()) {
+      elements.push_back(penalized_queue_.top());
+      penalized_queue_.pop();
+    }
+    next_penalty_expiration_ = clock::duration::max().count();
+  }
+  value_type element;
+  while (ready_queue_.try_dequeue(element)) {
+    elements.push_back(std::move(element));
+  }
+  for (const auto& removed : elements) {
+    onRemoved(removed);
+  }
+  return elements;
+}
+
+bool ConcurrentFlowFileQueue::isWorkAvailable() const {
+  return ready_queue_.size_approx() > 0 || next_penalty_expiration_ <= clock::now().time_since_epoch().count();
+}
+
+bool ConcurrentFlowFileQueue::empty() const {
+  return size_ == 0;
+}
+
+size_t ConcurrentFlowFileQueue::size() const {
+  return size_;
+}
+
+uint64_t ConcurrentFlowFileQueue::dataSize() const {
+  return data_size_;
+}
+
+void ConcurrentFlowFileQueue::pushPenalized(value_type element) {
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  penalized_queue_.push(std::move(element));
+  updateNextPenaltyExpiration();
+}
+
+void ConcurrentFlowFileQueue::releaseExpiredPenalties() {
+  if (next_penalty_expiration_ > clock::now().time_since_epoch().count()) {
+    return;
+  }
+  // if another consumer is already moving the expired FlowFiles, there is no need to wait for it
+  std::unique_lock<std::mutex> lock(penalized_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  while (!penalized_queue_.empty() && !penalized_queue_.top()->isPenalized()) {
+    ready_queue_.enqueue(penalized_queue_.top());
+    penalized_queue_.pop();
+  }
+  updateNextPenaltyExpiration();
+}
+
+void ConcurrentFlowFileQueue::updateNextPenaltyExpiration() {
+  next_penalty_expiration_ = penalized_queue_.empty()
+      ? clock::duration::max().count()
+      : penalized_queue_.top()->getPenaltyExpiration().time_since_epoch().count();
+}
+
+void ConcurrentFlowFileQueue::onRemoved(const value_type& element) {
+  --size_;
+  data_size_ -= element->getSize();
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
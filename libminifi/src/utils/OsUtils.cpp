@@ -40,6 +40,7 @@
 #else
 #include <pwd.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include <fstream>
 
@@ -201,6 +202,44 @@ uint64_t OsUtils::getMemoryUsage() {
   throw std::runtime_error("getMemoryUsage() is not implemented for this platform");
 }
 
+std::chrono::nanoseconds OsUtils::getCurrentThreadCpuTime() {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::chrono::nanoseconds(0);
+  }
+  const auto to_100ns = [](const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+  };
+  return std::chrono::nanoseconds((to_100ns(kernel_time) + to_100ns(user_time)) * 100);
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+std::chrono::nanoseconds OsUtils::getProcessCpuTime() {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::chrono::nanoseconds(0);
+  }
+  const auto to_100ns = [](const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+  };
+  return std::chrono::nanoseconds((to_100ns(kernel_time) + to_100ns(user_time)) * 100);
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
 }  // namespace utils
 }  // namespace minifi
 }  // namespace nifi
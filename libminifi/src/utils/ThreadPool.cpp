@@ -17,6 +17,8 @@
 
 #include "utils/ThreadPool.h"
 #include "core/state/UpdateController.h"
+#include "utils/GeneralUtils.h"
+#include "utils/OsUtils.h"
 
 namespace org {
 namespace apache {
@@ -24,6 +26,9 @@ namespace nifi {
 namespace minifi {
 namespace utils {
 
+template<typename T>
+constexpr std::chrono::milliseconds ThreadPool<T>::MANAGEMENT_PERIOD;
+
 template<typename T>
 void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
   thread->is_running_ = true;
@@ -39,7 +44,8 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
     }
 
     Worker<T> task;
-    if (worker_queue_.dequeueWait(task)) {
+    // wake up every now and then to see if this thread has to exit
+    if (worker_queue_.dequeueWaitFor(task, MANAGEMENT_PERIOD)) {
       {
         std::unique_lock<std::mutex> lock(worker_queue_mutex_);
         if (!task_status_[task.getIdentifier()]) {
@@ -49,7 +55,22 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
           continue;
         }
       }
-      if (task.run()) {
+      ++busy_workers_;
+      const bool reschedule = task.run();
+      --busy_workers_;
+      if (reschedule) {
+        if (task.isWaitingForWork()) {
+          const auto identifier = task.getIdentifier();
+          if (parked_tasks_.park(identifier, task.getNextExecutionTime(), task)) {
+            // the delayed scheduler thread has to wake up for the deadline of the parked task
+            std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+            delayed_task_available_.notify_all();
+          } else {
+            // there has been new work since the task checked
+            worker_queue_.enqueue(std::move(task));
+          }
+          continue;
+        }
         if (task.getNextExecutionTime() <= std::chrono::steady_clock::now()) {
           // it can be rescheduled again as soon as there is a worker available
           worker_queue_.enqueue(std::move(task));
@@ -66,9 +87,9 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
           delayed_task_available_.notify_all();
         }
       }
-    } else {
-      // The threadpool is running, but the ConcurrentQueue is stopped -> shouldn't happen during normal conditions
-      // Might happen during startup or shutdown for a very short time
+    } else if (!worker_queue_.isRunning()) {
+      // The threadpool is running, but the ConcurrentQueue is stopped -> the pool is paused
+      // Might also happen during startup or shutdown for a very short time
       if (running_.load()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
       }
@@ -90,11 +111,18 @@ void ThreadPool<T>::manage_delayed_queue() {
       delayed_worker_queue_.pop();
       worker_queue_.enqueue(std::move(task));
     }
-    if (delayed_worker_queue_.empty()) {
+    parked_tasks_.expire(std::chrono::steady_clock::now(), [this](Worker<T>&& task) {
+      worker_queue_.enqueue(std::move(task));
+    });
+
+    auto next_deadline = parked_tasks_.nextDeadline();
+    if (!delayed_worker_queue_.empty()) {
+      next_deadline = (std::min)(next_deadline, delayed_worker_queue_.top().getNextExecutionTime());
+    }
+    if (next_deadline == std::chrono::steady_clock::time_point::max()) {
       delayed_task_available_.wait(lock);
     } else {
-      auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-          delayed_worker_queue_.top().getNextExecutionTime() - std::chrono::steady_clock::now());
+      auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(next_deadline - std::chrono::steady_clock::now());
       delayed_task_available_.wait_for(lock, std::max(wait_time, std::chrono::milliseconds(1)));
     }
   }
@@ -115,80 +143,142 @@ bool ThreadPool<T>::execute(Worker<T> &&task, std::future<T> &future) {
 }
 
 template<typename T>
-void ThreadPool<T>::manageWorkers() {
-  for (int i = 0; i < max_worker_threads_; i++) {
-    std::stringstream thread_name;
-    thread_name << name_ << " #" << i;
-    auto worker_thread = std::make_shared<WorkerThread>(thread_name.str());
-    worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
-    thread_queue_.push_back(worker_thread);
-    current_workers_++;
+void ThreadPool<T>::startWorkerThread() {
+  std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+  auto worker_thread = std::make_shared<WorkerThread>(name_ + " #" + std::to_string(next_thread_index_++));
+  current_workers_++;
+  worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
+  if (daemon_threads_) {
+    worker_thread->thread_.detach();
   }
+  thread_queue_.push_back(worker_thread);
+}
 
-  if (daemon_threads_) {
-    for (auto &thread : thread_queue_) {
-      thread->thread_.detach();
+template<typename T>
+void ThreadPool<T>::resize(int worker_count) {
+  int difference = worker_count - getWorkerCount();
+  if (difference > 0) {
+    // take back the pending reductions first, the threads affected by them have not exited yet
+    int pending_reductions = thread_reduction_count_.load();
+    while (difference > 0 && pending_reductions > 0) {
+      if (thread_reduction_count_.compare_exchange_weak(pending_reductions, pending_reductions - 1)) {
+        --difference;
+        --pending_reductions;
+      }
     }
+    for (; difference > 0; --difference) {
+      startWorkerThread();
+    }
+  } else if (difference < 0) {
+    thread_reduction_count_ -= difference;
   }
+}
 
-  if (nullptr != thread_manager_) {
-    while (running_) {
-      auto waitperiod = std::chrono::milliseconds(500);
-      {
-        std::unique_lock<std::recursive_mutex> lock(manager_mutex_, std::try_to_lock);
-        if (!lock.owns_lock()) {
-          // Threadpool is being stopped/started or config is being changed, better wait a bit
-          std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-        if (thread_manager_->isAboveMax(current_workers_)) {
-          auto max = thread_manager_->getMaxConcurrentTasks();
-          auto differential = current_workers_ - max;
-          thread_reduction_count_ += differential;
-        } else if (thread_manager_->shouldReduce()) {
-          if (current_workers_ > 1)
-            thread_reduction_count_++;
-          thread_manager_->reduce();
-        } else if (thread_manager_->canIncrease() && max_worker_threads_ > current_workers_) {  // increase slowly
-          std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-          auto worker_thread = std::make_shared<WorkerThread>();
-          worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
-          if (daemon_threads_) {
-            worker_thread->thread_.detach();
-          }
-          thread_queue_.push_back(worker_thread);
-          current_workers_++;
-        }
-        std::shared_ptr<WorkerThread> thread_ref;
-        while (deceased_thread_queue_.tryDequeue(thread_ref)) {
-          std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-          if (thread_ref->thread_.joinable())
-            thread_ref->thread_.join();
-          thread_queue_.erase(std::remove(thread_queue_.begin(), thread_queue_.end(), thread_ref), thread_queue_.end());
-        }
+template<typename T>
+void ThreadPool<T>::manageWorkers() {
+  auto last_sample_time = std::chrono::steady_clock::now();
+  auto last_cpu_time = OsUtils::getProcessCpuTime();
+  const unsigned cpu_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+  while (running_) {
+    {
+      std::unique_lock<std::mutex> wait_lock(manager_wait_mutex_);
+      manager_condition_.wait_for(wait_lock, MANAGEMENT_PERIOD, [this] { return !running_; });
+    }
+    std::unique_lock<std::recursive_mutex> lock(manager_mutex_, std::try_to_lock);
+    if (!running_ || !lock.owns_lock()) {
+      // Threadpool is being stopped or config is being changed, check again in the next period
+      continue;
+    }
+    if (nullptr != thread_manager_) {
+      if (thread_manager_->isAboveMax(current_workers_)) {
+        auto max = thread_manager_->getMaxConcurrentTasks();
+        auto differential = current_workers_ - max;
+        thread_reduction_count_ += differential;
+      } else if (thread_manager_->shouldReduce()) {
+        if (current_workers_ > 1)
+          thread_reduction_count_++;
+        thread_manager_->reduce();
+      } else if (thread_manager_->canIncrease() && max_worker_threads_ > current_workers_) {  // increase slowly
+        startWorkerThread();
+      }
+    } else if (adaptive_thread_count_) {
+      const auto now = std::chrono::steady_clock::now();
+      const auto cpu_time = OsUtils::getProcessCpuTime();
+      const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_sample_time);
+      const double cpu_utilization = elapsed.count() > 0 ? static_cast<double>((cpu_time - last_cpu_time).count()) / (static_cast<double>(elapsed.count()) * cpu_count) : 0.0;
+      last_sample_time = now;
+      last_cpu_time = cpu_time;
+      const int worker_count = getWorkerCount();
+      const int target = adaptive_thread_count_->update(worker_count, busy_workers_, getPendingTaskCount(), cpu_utilization);
+      if (target != worker_count) {
+        resize(target);
       }
-      std::this_thread::sleep_for(waitperiod);
     }
-  } else {
-    for (auto &thread : thread_queue_) {
-      if (thread->thread_.joinable())
-        thread->thread_.join();
+    std::shared_ptr<WorkerThread> thread_ref;
+    while (deceased_thread_queue_.tryDequeue(thread_ref)) {
+      std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+      if (thread_ref->thread_.joinable())
+        thread_ref->thread_.join();
+      thread_queue_.erase(std::remove(thread_queue_.begin(), thread_queue_.end(), thread_ref), thread_queue_.end());
     }
   }
 }
 
 template<typename T>
-void ThreadPool<T>::start() {
+void ThreadPool<T>::stopManager() {
+  {
+    std::lock_guard<std::mutex> wait_lock(manager_wait_mutex_);
+    manager_condition_.notify_all();
+  }
+  if (manager_thread_.joinable()) {
+    manager_thread_.join();
+  }
+}
+
+template<typename T>
+void ThreadPool<T>::resolveThreadManager() {
   if (nullptr != controller_service_provider_) {
     auto thread_man = controller_service_provider_->getControllerService("ThreadPoolManager");
     thread_manager_ = thread_man != nullptr ? std::dynamic_pointer_cast<controllers::ThreadManagementService>(thread_man) : nullptr;
   } else {
     thread_manager_ = nullptr;
   }
+}
+
+template<typename T>
+void ThreadPool<T>::setMaxConcurrentTasks(uint16_t max) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
+  max_worker_threads_ = max;
+  if (running_) {
+    resize(max);
+  }
+}
 
+template<typename T>
+void ThreadPool<T>::setControllerServiceProvider(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
+  controller_service_provider_ = controller_service_provider;
+  if (running_) {
+    resolveThreadManager();
+  }
+}
+
+template<typename T>
+void ThreadPool<T>::enableAdaptiveThreadCount(uint16_t min_threads, uint16_t max_threads) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
+  adaptive_thread_count_ = utils::make_unique<AdaptiveThreadCount>(min_threads, max_threads);
+}
+
+template<typename T>
+void ThreadPool<T>::start() {
   std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
   if (!running_) {
+    resolveThreadManager();
     running_ = true;
     worker_queue_.start();
+    for (int i = 0; i < max_worker_threads_; i++) {
+      startWorkerThread();
+    }
     manager_thread_ = std::thread(&ThreadPool::manageWorkers, this);
 
     std::lock_guard<std::mutex> quee_lock(worker_queue_mutex_);
@@ -200,6 +290,15 @@ template<typename T>
 void ThreadPool<T>::stopTasks(const TaskId &identifier) {
   std::unique_lock<std::mutex> lock(worker_queue_mutex_);
   task_status_[identifier] = false;
+  parked_tasks_.remove(identifier);
+}
+
+template<typename T>
+void ThreadPool<T>::notifyWork(const TaskId &identifier) {
+  Worker<T> task;
+  if (parked_tasks_.notify(identifier, task)) {
+    worker_queue_.enqueue(std::move(task));
+  }
 }
 
 template<typename T>
@@ -225,9 +324,8 @@ void ThreadPool<T>::shutdown() {
     drain();
 
     task_status_.clear();
-    if (manager_thread_.joinable()) {
-      manager_thread_.join();
-    }
+    parked_tasks_.clear();
+    stopManager();
 
     delayed_task_available_.notify_all();
     if (delayed_scheduler_thread_.joinable()) {
@@ -241,6 +339,8 @@ void ThreadPool<T>::shutdown() {
 
     thread_queue_.clear();
     current_workers_ = 0;
+    thread_reduction_count_ = 0;
+    next_thread_index_ = 0;
     while (!delayed_worker_queue_.empty()) {
       delayed_worker_queue_.pop();
     }
@@ -0,0 +1,431 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils/WorkStealingThreadPool.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "core/state/UpdateController.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+template<typename T>
+constexpr std::chrono::milliseconds WorkStealingThreadPool<T>::MAX_PARK_TIME;
+template<typename T>
+constexpr std::chrono::milliseconds WorkStealingThreadPool<T>::TIMER_STEAL_DELAY;
+template<typename T>
+constexpr size_t WorkStealingThreadPool<T>::MAX_WORKER_THREADS;
+
+template<typename T>
+WorkStealingThreadPool<T>::WorkStealingThreadPool(int max_worker_threads, const std::string &name)
+    : ThreadPool<T>(max_worker_threads, false, nullptr, name),
+      workers_(MAX_WORKER_THREADS),
+      worker_count_(0),
+      paused_(false),
+      parked_workers_(0) {
+}
+
+template<typename T>
+WorkStealingThreadPool<T>::~WorkStealingThreadPool() {
+  shutdown();
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::execute(Worker<T> &&task, std::future<T> &future) {
+  std::shared_ptr<std::atomic<bool>> enabled;
+  {
+    std::lock_guard<std::mutex> lock(task_status_mutex_);
+    auto& status = task_enabled_[task.getIdentifier()];
+    // tasks stopped earlier keep their own flag, so they are not revived by the new one
+    if (!status || !status->load()) {
+      status = std::make_shared<std::atomic<bool>>(true);
+    }
+    enabled = status;
+  }
+  future = task.getPromise()->get_future();
+  injection_queue_.enqueue(utils::make_unique<Task>(std::move(task), std::move(enabled)));
+  this->task_count_++;
+  wakeWorker();
+  return true;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::stopTasks(const TaskId &identifier) {
+  std::lock_guard<std::mutex> lock(task_status_mutex_);
+  const auto it = task_enabled_.find(identifier);
+  if (it != task_enabled_.end()) {
+    it->second->store(false);
+  }
+  waiting_tasks_.remove(identifier);
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::notifyWork(const TaskId &identifier) {
+  TaskPtr task;
+  if (waiting_tasks_.notify(identifier, task)) {
+    injection_queue_.enqueue(std::move(task));
+    wakeWorker();
+  }
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::isTaskRunning(const TaskId &identifier) {
+  std::lock_guard<std::mutex> lock(task_status_mutex_);
+  const auto it = task_enabled_.find(identifier);
+  return it != task_enabled_.end() && it->second->load();
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::resume() {
+  paused_ = false;
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  park_condition_.notify_all();
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::pause() {
+  paused_ = true;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::start() {
+  std::lock_guard<std::recursive_mutex> lock(this->manager_mutex_);
+  if (this->running_) {
+    return;
+  }
+  this->running_ = true;
+  paused_ = false;
+  resize(this->max_worker_threads_);
+  // only adjusts the number of worker threads when enableAdaptiveThreadCount has been called
+  this->manager_thread_ = std::thread(&WorkStealingThreadPool::manageWorkers, this);
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::shutdown() {
+  std::lock_guard<std::recursive_mutex> lock(this->manager_mutex_);
+  if (!this->running_) {
+    return;
+  }
+  this->running_ = false;
+  this->stopManager();
+  {
+    std::lock_guard<std::mutex> park_lock(park_mutex_);
+    park_condition_.notify_all();
+  }
+  for (const auto &thread : this->thread_queue_) {
+    if (thread->thread_.joinable()) {
+      thread->thread_.join();
+    }
+  }
+  this->thread_queue_.clear();
+  // the pending tasks are dropped, just like in ThreadPool
+  worker_count_ = 0;
+  for (auto& worker : workers_) {
+    worker.reset();
+  }
+  TaskPtr task;
+  while (injection_queue_.try_dequeue(task)) {}
+  waiting_tasks_.clear();
+  std::lock_guard<std::mutex> status_lock(task_status_mutex_);
+  task_enabled_.clear();
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::setControllerServiceProvider(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider) {
+  std::lock_guard<std::recursive_mutex> lock(this->manager_mutex_);
+  this->controller_service_provider_ = controller_service_provider;
+}
+
+template<typename T>
+int WorkStealingThreadPool<T>::getWorkerCount() const {
+  return static_cast<int>(worker_count_.load());
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::resize(int worker_count) {
+  const size_t target = (std::min)(static_cast<size_t>((std::max)(worker_count, 0)), MAX_WORKER_THREADS);
+  const size_t count = worker_count_.load();
+  if (target > count) {
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = count; i < target; ++i) {
+      auto& context = workers_[i];
+      if (context) {
+        auto expected = WorkerState::RETIRING;
+        if (context->state.compare_exchange_strong(expected, WorkerState::ACTIVE)) {
+          // the worker has not left yet, it just carries on
+          continue;
+        }
+        // the worker is leaving, its tasks are handed over by the time it can be joined
+        if (this->thread_queue_[i]->thread_.joinable()) {
+          this->thread_queue_[i]->thread_.join();
+        }
+        context->state = WorkerState::ACTIVE;
+      } else {
+        context = utils::make_unique<WorkerContext>(now);
+      }
+      auto worker_thread = std::make_shared<WorkerThread>(this->name_ + " #" + std::to_string(i));
+      worker_thread->thread_ = std::thread(&WorkStealingThreadPool::runWorker, this, i);
+      worker_thread->is_running_ = true;
+      if (i < this->thread_queue_.size()) {
+        this->thread_queue_[i] = worker_thread;
+      } else {
+        this->thread_queue_.push_back(worker_thread);
+      }
+    }
+    // publishes the new contexts to the other workers
+    worker_count_.store(target, std::memory_order_release);
+  } else if (target < count) {
+    worker_count_.store(target, std::memory_order_release);
+    for (size_t i = target; i < count; ++i) {
+      workers_[i]->state = WorkerState::RETIRING;
+    }
+    std::lock_guard<std::mutex> park_lock(park_mutex_);
+    park_condition_.notify_all();
+  }
+}
+
+template<typename T>
+size_t WorkStealingThreadPool<T>::getPendingTaskCount() const {
+  size_t pending = injection_queue_.size_approx();
+  const size_t count = worker_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    pending += workers_[i]->queue.size_approx();
+  }
+  return pending;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::runWorker(size_t index) {
+  WorkerContext& self = *workers_[index];
+  while (true) {
+    while (this->running_ && self.state == WorkerState::ACTIVE) {
+      const auto now = std::chrono::steady_clock::now();
+      bool expired = expireTimers(self, self, now);
+      waiting_tasks_.expire(now, [&](TaskPtr&& task) {
+        self.queue.enqueue(self.producer_token, std::move(task));
+        expired = true;
+      });
+      if (expired && self.queue.size_approx() > 1) {
+        // let an idle worker steal some of them
+        wakeWorker();
+      }
+
+      TaskPtr task;
+      if (paused_ || !findTask(index, task)) {
+        if (!paused_ && stealExpiredTimers(index)) {
+          continue;
+        }
+        park(index);
+        continue;
+      }
+      if (!task->enabled->load()) {
+        continue;
+      }
+      if (task->handed_over) {
+        task->handed_over = false;
+        const auto next_execution_time = task->worker.getNextExecutionTime();
+        if (next_execution_time > std::chrono::steady_clock::now()) {
+          scheduleTimer(self, next_execution_time, std::move(task));
+          continue;
+        }
+      }
+      ++this->busy_workers_;
+      const bool reschedule = task->worker.run();
+      --this->busy_workers_;
+      if (!reschedule) {
+        continue;
+      }
+      if (task->worker.isWaitingForWork()) {
+        const auto identifier = task->worker.getIdentifier();
+        if (!waiting_tasks_.park(identifier, task->worker.getNextExecutionTime(), task)) {
+          // there has been new work since the task checked
+          self.queue.enqueue(self.producer_token, std::move(task));
+        }
+        continue;
+      }
+      const auto next_execution_time = task->worker.getNextExecutionTime();
+      if (next_execution_time <= std::chrono::steady_clock::now()) {
+        // it can run again as soon as this or an idle worker is available
+        self.queue.enqueue(self.producer_token, std::move(task));
+        if (self.queue.size_approx() > 1) {
+          wakeWorker();
+        }
+      } else {
+        scheduleTimer(self, next_execution_time, std::move(task));
+      }
+    }
+    if (!this->running_) {
+      return;
+    }
+    // retired, unless resize has taken it back in the meantime
+    auto expected = WorkerState::RETIRING;
+    if (self.state.compare_exchange_strong(expected, WorkerState::EXITING)) {
+      break;
+    }
+  }
+  handOverTasks(self);
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::handOverTasks(WorkerContext &context) {
+  // nothing else enqueues to the context any more, the other workers get the tasks from the injection queue
+  {
+    std::lock_guard<std::mutex> lock(context.timers_mutex);
+    context.timers.drain([this](TaskPtr&& task) {
+      task->handed_over = true;
+      injection_queue_.enqueue(std::move(task));
+    });
+    context.next_expiration = std::chrono::steady_clock::time_point::max().time_since_epoch().count();
+  }
+  TaskPtr task;
+  while (context.queue.try_dequeue(task)) {
+    injection_queue_.enqueue(std::move(task));
+  }
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  park_condition_.notify_all();
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::findTask(size_t index, TaskPtr &task) {
+  if (workers_[index]->queue.try_dequeue(task) || injection_queue_.try_dequeue(task)) {
+    return true;
+  }
+  const size_t count = worker_count_.load(std::memory_order_acquire);
+  for (size_t offset = 1; offset <= count; ++offset) {
+    const size_t victim = (index + offset) % count;
+    if (victim != index && workers_[victim]->queue.try_dequeue(task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::scheduleTimer(WorkerContext &context, std::chrono::steady_clock::time_point deadline, TaskPtr &&task) {
+  std::lock_guard<std::mutex> lock(context.timers_mutex);
+  context.timers.schedule(deadline, std::move(task));
+  // the wheel expires it at the deadline rounded up, checking a bit early only costs an empty advance
+  const auto deadline_rep = deadline.time_since_epoch().count();
+  if (deadline_rep < context.next_expiration.load()) {
+    context.next_expiration = deadline_rep;
+  }
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::expireTimers(WorkerContext &wheel, WorkerContext &self, std::chrono::steady_clock::time_point now) {
+  if (getNextExpiration(wheel) > now) {
+    return false;
+  }
+  bool expired = false;
+  std::lock_guard<std::mutex> lock(wheel.timers_mutex);
+  wheel.timers.advance(now, [&](TaskPtr&& task) {
+    self.queue.enqueue(self.producer_token, std::move(task));
+    expired = true;
+  });
+  wheel.next_expiration = wheel.timers.nextExpiration().time_since_epoch().count();
+  return expired;
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::stealExpiredTimers(size_t index) {
+  const auto now = std::chrono::steady_clock::now();
+  const size_t count = worker_count_.load(std::memory_order_acquire);
+  for (size_t offset = 1; offset < count; ++offset) {
+    WorkerContext& victim = *workers_[(index + offset) % count];
+    // the owner expires its timers on time unless it is busy, only take over the ones it is late with
+    if (getStealTime(victim) <= now && expireTimers(victim, *workers_[index], now)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T>
+std::chrono::steady_clock::time_point WorkStealingThreadPool<T>::getNextExpiration(const WorkerContext &context) {
+  return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(context.next_expiration.load()));
+}
+
+template<typename T>
+std::chrono::steady_clock::time_point WorkStealingThreadPool<T>::getStealTime(const WorkerContext &context) {
+  const auto next_expiration = getNextExpiration(context);
+  if (next_expiration == std::chrono::steady_clock::time_point::max()) {
+    return next_expiration;
+  }
+  return next_expiration + TIMER_STEAL_DELAY;
+}
+
+template<typename T>
+bool WorkStealingThreadPool<T>::isWorkAvailable(size_t index) const {
+  if (paused_) {
+    return false;
+  }
+  if (injection_queue_.size_approx() > 0) {
+    return true;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  const size_t count = worker_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    if (workers_[i]->queue.size_approx() > 0 || (i != index && getStealTime(*workers_[i]) <= now)) {
+      return true;
+    }
+  }
+  return getNextExpiration(*workers_[index]) <= now || waiting_tasks_.nextDeadline() <= now;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::park(size_t index) {
+  auto deadline = (std::min)({getNextExpiration(*workers_[index]), waiting_tasks_.nextDeadline(), std::chrono::steady_clock::now() + MAX_PARK_TIME});
+  // wake up in time to take over the timers of the workers that are stuck in a task
+  const size_t count = worker_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    if (i != index) {
+      deadline = (std::min)(deadline, getStealTime(*workers_[i]));
+    }
+  }
+  std::unique_lock<std::mutex> lock(park_mutex_);
+  // paired with the fence in wakeWorker: either we see the new task or the submitter sees us parked
+  ++parked_workers_;
+  if (this->running_ && workers_[index]->state == WorkerState::ACTIVE && !isWorkAvailable(index)) {
+    park_condition_.wait_until(lock, deadline);
+  }
+  --parked_workers_;
+}
+
+template<typename T>
+void WorkStealingThreadPool<T>::wakeWorker() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parked_workers_ > 0) {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_condition_.notify_one();
+  }
+}
+
+template class utils::WorkStealingThreadPool<utils::TaskRescheduleInfo>;
+template class utils::WorkStealingThreadPool<int>;
+template class utils::WorkStealingThreadPool<bool>;
+template class utils::WorkStealingThreadPool<state::Update>;
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
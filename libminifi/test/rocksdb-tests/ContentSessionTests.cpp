@@ -30,11 +30,12 @@
 template<typename ContentRepositoryClass>
 class ContentSessionController : public TestController {
  public:
-  ContentSessionController() {
+  explicit ContentSessionController(bool streaming = false) {
     char format[] = "/var/tmp/content_repo.XXXXXX";
-    std::string contentRepoPath = createTempDirectory(format);
+    contentRepoPath = createTempDirectory(format);
     auto config = std::make_shared<minifi::Configure>();
     config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, contentRepoPath);
+    config->set(minifi::Configure::nifi_content_repository_streaming_session, streaming ? "true" : "false");
     contentRepository = std::make_shared<ContentRepositoryClass>();
     contentRepository->initialize(config);
   }
@@ -43,6 +44,7 @@ class ContentSessionController : public TestController {
     log.reset();
   }
 
+  std::string contentRepoPath;
   std::shared_ptr<core::ContentRepository> contentRepository;
 };
 
@@ -70,8 +72,8 @@ const std::shared_ptr<minifi::io::BaseStream>& operator>>(const std::shared_ptr<
 //  seems like the current version of Catch2 does not support templated tests
 //  we should update instead of creating make-shift macros
 template<typename ContentRepositoryClass>
-void test_template() {
-  ContentSessionController<ContentRepositoryClass> controller;
+void test_template(bool streaming = false) {
+  ContentSessionController<ContentRepositoryClass> controller(streaming);
   std::shared_ptr<core::ContentRepository> contentRepository = controller.contentRepository;
 
 
@@ -151,3 +153,45 @@ TEST_CASE("ContentSession behavior") {
     test_template<core::repository::DatabaseContentRepository>();
   }
 }
+
+TEST_CASE("Streaming ContentSession behavior") {
+  SECTION("FileSystemRepository") {
+    test_template<core::repository::FileSystemRepository>(true);
+  }
+  SECTION("DatabaseContentRepository") {
+    test_template<core::repository::DatabaseContentRepository>(true);
+  }
+}
+
+TEST_CASE("Streaming ContentSession keeps the content in staging files until commit") {
+  ContentSessionController<core::repository::FileSystemRepository> controller(true);
+  const auto staging_files = [&] {
+    size_t count = 0;
+    utils::file::FileUtils::list_dir(controller.contentRepoPath, [&](const std::string&, const std::string& filename) {
+      if (utils::StringUtils::endsWith(filename, core::StreamingContentSession::STAGING_FILE_EXTENSION)) {
+        ++count;
+      }
+      return true;
+    }, logging::LoggerFactory<core::ContentSession>::getLogger(), false);
+    return count;
+  };
+
+  auto session = controller.contentRepository->createSession();
+  auto claim = session->create();
+  session->write(claim) << "staged content";
+  REQUIRE(1 == staging_files());
+  REQUIRE_FALSE(controller.contentRepository->exists(*claim));
+
+  SECTION("Commit publishes the staging file") {
+    session->commit();
+    REQUIRE(controller.contentRepository->exists(*claim));
+    std::string content;
+    controller.contentRepository->read(*claim) >> content;
+    REQUIRE(content == "staged content");
+  }
+  SECTION("Rollback discards the staging file") {
+    session->rollback();
+    REQUIRE_FALSE(controller.contentRepository->exists(*claim));
+  }
+  REQUIRE(0 == staging_files());
+}
@@ -16,8 +16,10 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/Core.h"
 #include "DatabaseContentRepository.h"
@@ -232,3 +234,50 @@ TEST_CASE("Delete Remove Count Claim", "[TestDBCR5]") {
 
   REQUIRE(readstr == "well hello there");
 }
+
+TEST_CASE("Database content repository reports its write statistics", "[TestDBCR6]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = std::make_shared<core::repository::DatabaseContentRepository>();
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_write_buffer_size, "1 MB");
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_statistics_enabled, "true");
+  REQUIRE(content_repo->initialize(configuration));
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  content_repo->write(*claim)->write("well hello there");
+
+  std::vector<std::shared_ptr<minifi::state::response::ResponseNode>> metrics;
+  REQUIRE(content_repo->getMetricNodes(metrics) == 0);
+  REQUIRE(metrics.size() == 1);
+  REQUIRE(metrics[0]->getName() == "DatabaseContentRepositoryMetrics");
+
+  const auto serialized = metrics[0]->serialize();
+  const auto user_bytes = std::find_if(serialized.begin(), serialized.end(), [](const minifi::state::response::SerializedResponseNode& node) {
+    return node.name == "UserBytesWritten";
+  });
+  REQUIRE(user_bytes != serialized.end());
+  REQUIRE(user_bytes->value.to_string() != "0");
+  const auto write_amplification = std::find_if(serialized.begin(), serialized.end(), [](const minifi::state::response::SerializedResponseNode& node) {
+    return node.name == "WriteAmplification";
+  });
+  REQUIRE(write_amplification != serialized.end());
+}
+
+TEST_CASE("Database content repository does not collect statistics by default", "[TestDBCR7]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = std::make_shared<core::repository::DatabaseContentRepository>();
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  REQUIRE(content_repo->initialize(configuration));
+
+  std::vector<std::shared_ptr<minifi::state::response::ResponseNode>> metrics;
+  REQUIRE(content_repo->getMetricNodes(metrics) == 0);
+  REQUIRE(metrics.empty());
+}
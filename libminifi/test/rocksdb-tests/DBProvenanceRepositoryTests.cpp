@@ -18,9 +18,13 @@
 
 #include <array>
 #include <chrono>
+#include <memory>
 #include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "FlowFileRecord.h"
 #include "ProvenanceRepository.h"
 #include "../TestBase.h"
 
@@ -119,3 +123,173 @@ TEST_CASE("Test time limit", "[timeLimitTest]") {
 
   verifyMaxKeyCount(provdb, 400);
 }
+
+namespace {
+
+class TestProvenanceEvent : public minifi::provenance::ProvenanceEventRecord {
+ public:
+  TestProvenanceEvent(ProvenanceEventType type, const std::string& component_id, std::shared_ptr<core::FlowFile> flow_file, uint64_t event_time)
+      : ProvenanceEventRecord(type, component_id, "TestProcessor") {
+    fromFlowFile(flow_file);
+    _eventTime = event_time;
+  }
+};
+
+void storeEvents(minifi::provenance::ProvenanceRepository& repo, const std::vector<std::shared_ptr<TestProvenanceEvent>>& events) {
+  std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>> data;
+  for (const auto& event : events) {
+    std::unique_ptr<minifi::io::BufferStream> stream(new minifi::io::BufferStream());
+    REQUIRE(event->Serialize(*stream));
+    data.emplace_back(event->getUUIDStr(), std::move(stream));
+  }
+  REQUIRE(repo.MultiPut(data));
+}
+
+std::vector<uint64_t> eventTimes(const std::vector<std::shared_ptr<minifi::provenance::ProvenanceEventRecord>>& events) {
+  std::vector<uint64_t> times;
+  for (const auto& event : events) {
+    times.push_back(event->getEventTime());
+  }
+  return times;
+}
+
+void verifyQueries(bool indexing_enabled) {
+  using minifi::provenance::ProvenanceEventRecord;
+  TestController testController;
+  char dirtemplate[] = "/var/tmp/db.XXXXXX";
+  auto temp_dir = testController.createTempDirectory(dirtemplate);
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, MAX_PROVENANCE_ENTRY_LIFE_TIME, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1000);
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_indexing_enabled, indexing_enabled ? "true" : "false");
+  REQUIRE(provdb.initialize(configuration));
+
+  std::shared_ptr<core::FlowFile> first = std::make_shared<minifi::FlowFileRecord>();
+  std::shared_ptr<core::FlowFile> second = std::make_shared<minifi::FlowFileRecord>();
+  storeEvents(provdb, {
+    std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::CREATE, "generator", first, 1000),
+    std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::SEND, "sender", first, 2000),
+    std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::CREATE, "generator", second, 3000),
+    std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::SEND, "sender", second, 4000),
+    std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::DROP, "generator", second, 5000)
+  });
+
+  minifi::provenance::ProvenanceQuery query;
+  SECTION("Every event, the most recent first") {
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{5000, 4000, 3000, 2000, 1000}));
+  }
+  SECTION("Events of a FlowFile") {
+    query.flow_file_uuid = first->getUUID();
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{2000, 1000}));
+  }
+  SECTION("Events of a component") {
+    query.component_id = "sender";
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{4000, 2000}));
+  }
+  SECTION("Events of a type") {
+    query.event_type = ProvenanceEventRecord::DROP;
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{5000}));
+  }
+  SECTION("Events in a time range") {
+    query.start_time = 2000;
+    query.end_time = 4000;
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{4000, 3000, 2000}));
+  }
+  SECTION("Every condition has to match") {
+    query.component_id = "generator";
+    query.event_type = ProvenanceEventRecord::CREATE;
+    query.end_time = 2500;
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{1000}));
+  }
+  SECTION("Limited number of results") {
+    query.flow_file_uuid = second->getUUID();
+    query.max_results = 2;
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{5000, 4000}));
+  }
+  SECTION("Limited number of the most recent events") {
+    query.max_results = 3;
+    REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{5000, 4000, 3000}));
+  }
+  SECTION("No matching event") {
+    query.component_id = "receiver";
+    REQUIRE(provdb.query(query).empty());
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Query the provenance repository using its indexes", "[provenanceQuery]") {
+  verifyQueries(true);
+}
+
+TEST_CASE("Query the provenance repository without indexes", "[provenanceQuery]") {
+  verifyQueries(false);
+}
+
+TEST_CASE("Events stored along with their records are indexed without parsing them", "[provenanceQuery]") {
+  using minifi::provenance::ProvenanceEventRecord;
+  TestController testController;
+  char dirtemplate[] = "/var/tmp/db.XXXXXX";
+  auto temp_dir = testController.createTempDirectory(dirtemplate);
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, MAX_PROVENANCE_ENTRY_LIFE_TIME, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1000);
+  REQUIRE(provdb.initialize(std::make_shared<org::apache::nifi::minifi::Configure>()));
+
+  std::shared_ptr<core::FlowFile> flow_file = std::make_shared<minifi::FlowFileRecord>();
+  std::vector<std::pair<std::shared_ptr<ProvenanceEventRecord>, std::unique_ptr<minifi::io::BufferStream>>> events;
+  for (const auto& event : {std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::CREATE, "generator", flow_file, 1000),
+                            std::make_shared<TestProvenanceEvent>(ProvenanceEventRecord::SEND, "sender", flow_file, 2000)}) {
+    std::unique_ptr<minifi::io::BufferStream> stream(new minifi::io::BufferStream());
+    REQUIRE(event->Serialize(*stream));
+    events.emplace_back(event, std::move(stream));
+  }
+  REQUIRE(provdb.storeEvents(events));
+
+  minifi::provenance::ProvenanceQuery query;
+  query.flow_file_uuid = flow_file->getUUID();
+  REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{2000, 1000}));
+  query.component_id = "sender";
+  REQUIRE(eventTimes(provdb.query(query)) == (std::vector<uint64_t>{2000}));
+}
+
+TEST_CASE("Cost of maintaining the provenance indexes", "[.][benchmark]") {
+  using minifi::provenance::ProvenanceEventRecord;
+  const size_t event_count = 100000;
+  const size_t batch_size = 100;
+  const size_t flow_file_count = 1000;
+  const auto run = [&](bool indexing_enabled) {
+    TestController testController;
+    char dirtemplate[] = "/var/tmp/db.XXXXXX";
+    auto temp_dir = testController.createTempDirectory(dirtemplate);
+    minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, MAX_PROVENANCE_ENTRY_LIFE_TIME, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1000);
+    auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+    configuration->set(minifi::Configure::nifi_provenance_repository_indexing_enabled, indexing_enabled ? "true" : "false");
+    REQUIRE(provdb.initialize(configuration));
+
+    std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+    for (size_t i = 0; i < flow_file_count; ++i) {
+      flow_files.push_back(std::make_shared<minifi::FlowFileRecord>());
+    }
+    std::vector<std::shared_ptr<TestProvenanceEvent>> events;
+    const auto write_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < event_count; ++i) {
+      const auto type = static_cast<ProvenanceEventRecord::ProvenanceEventType>(i % (ProvenanceEventRecord::REPLAY + 1));
+      events.push_back(std::make_shared<TestProvenanceEvent>(type, "component" + std::to_string(i % 10), flow_files[i % flow_file_count], 1000 + i));
+      if (events.size() == batch_size) {
+        storeEvents(provdb, events);
+        events.clear();
+      }
+    }
+    const auto write_end = std::chrono::steady_clock::now();
+
+    minifi::provenance::ProvenanceQuery query;
+    query.flow_file_uuid = flow_files.front()->getUUID();
+    const auto results = provdb.query(query);
+    const auto query_end = std::chrono::steady_clock::now();
+    REQUIRE(results.size() == query.max_results);
+
+    WARN((indexing_enabled ? "With indexes:    " : "Without indexes: ")
+        << "writing " << event_count << " events took " << std::chrono::duration_cast<std::chrono::milliseconds>(write_end - write_start).count() << " ms\n"
+        << "querying the events of a FlowFile took " << std::chrono::duration_cast<std::chrono::milliseconds>(query_end - write_end).count() << " ms");
+  };
+  run(false);
+  run(true);
+}
@@ -16,17 +16,23 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <map>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "core/Core.h"
 #include "core/repository/AtomicRepoEntries.h"
 #include "core/RepositoryFactory.h"
 #include "FlowFileRecord.h"
 #include "FlowFileRepository.h"
+#include "RocksDbEnvironment.h"
+#include "core/state/nodes/RepositoryMetrics.h"
 #include "provenance/Provenance.h"
 #include "properties/Configure.h"
 #include "../unit/ProvenanceTestHelper.h"
@@ -430,4 +436,286 @@ TEST_CASE("Flush deleted flowfiles before shutdown", "[TestFFR7]") {
   }
 }
 
+TEST_CASE("Concurrent MultiPut calls are grouped into shared commits", "[TestFFR8]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto repository = std::make_shared<core::repository::FlowFileRepository>("ff", REPOTEST_FLOWFILE_CHECKPOINT_DIR, dir, 0, 0, 1);
+
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_flowfile_repository_directory_default, dir);
+  SECTION("Without a group commit window") {
+    config->set(minifi::Configure::nifi_flowfile_repository_group_commit_window, "0 ms");
+  }
+  SECTION("With a group commit window") {
+    config->set(minifi::Configure::nifi_flowfile_repository_group_commit_window, "5 ms");
+  }
+  REQUIRE(repository->initialize(config));
+
+  const int thread_count = 8;
+  const int commits_per_thread = 50;
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+    threads.emplace_back([&, thread_idx] {
+      for (int commit_idx = 0; commit_idx < commits_per_thread; ++commit_idx) {
+        std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>> data;
+        for (int item_idx = 0; item_idx < 2; ++item_idx) {
+          const std::string key = std::to_string(thread_idx) + "-" + std::to_string(commit_idx) + "-" + std::to_string(item_idx);
+          data.emplace_back(key, utils::make_unique<minifi::io::BufferStream>("value of " + key));
+        }
+        if (!repository->MultiPut(data)) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(failures == 0);
+
+  for (int thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+    for (int commit_idx = 0; commit_idx < commits_per_thread; ++commit_idx) {
+      for (int item_idx = 0; item_idx < 2; ++item_idx) {
+        const std::string key = std::to_string(thread_idx) + "-" + std::to_string(commit_idx) + "-" + std::to_string(item_idx);
+        std::string value;
+        REQUIRE(repository->Get(key, value));
+        REQUIRE(value == "value of " + key);
+      }
+    }
+  }
+}
+
+TEST_CASE("FlowFiles are recovered in parallel from a snapshot", "[TestFFR9]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_flowfile_repository_directory_default, utils::file::FileUtils::concat_path(dir, "flowfile_repository"));
+  config->set(minifi::Configure::nifi_flowfile_repository_recovery_threads, "4");
+
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "Connection");
+  auto other_connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "OtherConnection");
+  std::map<std::string, std::shared_ptr<core::Connectable>> connectionMap{{connection->getUUIDStr(), connection}};
+
+  const size_t flow_file_count = 1000;
+  {
+    auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR);
+    REQUIRE(ff_repository->initialize(config));
+    for (size_t i = 0; i < flow_file_count; ++i) {
+      auto file = std::make_shared<minifi::FlowFileRecord>();
+      file->setConnection(connection);
+      REQUIRE(file->Persist(ff_repository));
+    }
+    // its connection is not part of the flow after the restart
+    auto orphan = std::make_shared<minifi::FlowFileRecord>();
+    orphan->setConnection(other_connection);
+    REQUIRE(orphan->Persist(ff_repository));
+  }
+
+  auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR,
+      FLOWFILE_REPOSITORY_DIRECTORY, MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME, MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE, 1);
+  ff_repository->setConnectionMap(connectionMap);
+  REQUIRE(ff_repository->initialize(config));
+  ff_repository->loadComponent(content_repo);
+
+  // persisted after the snapshot, it is not recovered again
+  auto new_file = std::make_shared<minifi::FlowFileRecord>();
+  new_file->setConnection(connection);
+  REQUIRE(new_file->Persist(ff_repository));
+
+  ff_repository->start();
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  const auto all_restored = [&connection] { return connection->getQueueSize() == flow_file_count; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), all_restored, std::chrono::milliseconds(50)));
+
+  std::vector<std::shared_ptr<minifi::state::response::ResponseNode>> metrics;
+  ff_repository->getMetricNodes(metrics);
+  REQUIRE(metrics.size() == 1);
+  const auto get_value = [&metrics](const std::string& name) {
+    for (const auto& node : metrics[0]->serialize()) {
+      if (node.name == name) {
+        return node.value.to_string();
+      }
+    }
+    return std::string();
+  };
+  const auto recovery_finished = [&get_value] { return get_value("recovering") == "false"; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), recovery_finished, std::chrono::milliseconds(50)));
+  REQUIRE(get_value("recoveredFlowFiles") == std::to_string(flow_file_count));
+  REQUIRE(get_value("discardedFlowFiles") == "1");
+  REQUIRE(get_value("recoveryThreads") == "4");
+  ff_repository->stop();
+  REQUIRE(connection->getQueueSize() == flow_file_count);
+}
+
+TEST_CASE("Keys sharing their leading bytes are recovered in parallel", "[TestFFR9]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_flowfile_repository_directory_default, utils::file::FileUtils::concat_path(dir, "flowfile_repository"));
+  config->set(minifi::Configure::nifi_flowfile_repository_recovery_threads, "4");
+
+  auto connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "Connection");
+  std::map<std::string, std::shared_ptr<core::Connectable>> connectionMap{{connection->getUUIDStr(), connection}};
+
+  const size_t flow_file_count = 1000;
+  {
+    auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR);
+    REQUIRE(ff_repository->initialize(config));
+    // like the ids of the minifi_uid generator, the keys only differ in their last bytes
+    for (size_t i = 0; i < flow_file_count; ++i) {
+      auto file = std::make_shared<minifi::FlowFileRecord>();
+      file->setConnection(connection);
+      minifi::io::BufferStream stream;
+      REQUIRE(file->Serialize(stream));
+      char key[32];
+      std::snprintf(key, sizeof(key), "00000000-0000-0000-%04zu", i);
+      REQUIRE(ff_repository->Put(key, stream.getBuffer(), stream.size()));
+    }
+  }
+
+  auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR,
+      FLOWFILE_REPOSITORY_DIRECTORY, MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME, MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE, 1);
+  ff_repository->setConnectionMap(connectionMap);
+  REQUIRE(ff_repository->initialize(config));
+  ff_repository->loadComponent(std::make_shared<core::repository::VolatileContentRepository>());
+  ff_repository->start();
+
+  std::vector<std::shared_ptr<minifi::state::response::ResponseNode>> metrics;
+  ff_repository->getMetricNodes(metrics);
+  REQUIRE(metrics.size() == 1);
+  const auto get_value = [&metrics](const std::string& name) {
+    for (const auto& node : metrics[0]->serialize()) {
+      if (node.name == name) {
+        return node.value.to_string();
+      }
+    }
+    return std::string();
+  };
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  const auto recovery_finished = [&get_value] { return get_value("recoveryThreads") != "0" && get_value("recovering") == "false"; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), recovery_finished, std::chrono::milliseconds(50)));
+  REQUIRE(get_value("recoveryThreads") == "4");
+  REQUIRE(get_value("recoveredFlowFiles") == std::to_string(flow_file_count));
+  ff_repository->stop();
+  REQUIRE(connection->getQueueSize() == flow_file_count);
+}
+
+TEST_CASE("Deleting FlowFiles releases the claims carried along with the keys", "[TestFFR10]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto repository = std::make_shared<core::repository::FlowFileRepository>("ff", REPOTEST_FLOWFILE_CHECKPOINT_DIR, dir, 0, 0, 1);
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  REQUIRE(content_repo->initialize(std::make_shared<minifi::Configure>()));
+  REQUIRE(repository->initialize(std::make_shared<minifi::Configure>()));
+  repository->loadComponent(content_repo);
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+  flow_file->setResourceClaim(claim);
+  REQUIRE(flow_file->Persist(repository));
+  flow_file->setStoredToRepository(true);
+  // one reference of the claim itself and one of the persisted record
+  REQUIRE(content_repo->getStreamCount(*claim) == 2);
+
+  // modifying the content does not change the claim of the persisted record
+  flow_file->setResourceClaim(std::make_shared<minifi::ResourceClaim>(content_repo));
+  REQUIRE(flow_file->getStoredResourceClaim() == claim);
+
+  REQUIRE(repository->Delete(flow_file->getUUIDStr(), flow_file->getStoredResourceClaim()));
+  REQUIRE(content_repo->getStreamCount(*claim) == 2);
+  repository->flush();
+  REQUIRE(content_repo->getStreamCount(*claim) == 1);
+  std::string value;
+  REQUIRE_FALSE(repository->Get(flow_file->getUUIDStr(), value));
+}
+
+TEST_CASE("The FlowFile repository charges its write buffers to the shared RocksDB memory limit", "[TestFFR11]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_rocksdb_memory_limit, "16 MB");
+  config->set(minifi::Configure::nifi_rocksdb_background_threads, "2");
+
+  auto& environment = minifi::internal::RocksDbEnvironment::getInstance();
+  {
+    auto repository = std::make_shared<core::repository::FlowFileRepository>("ff", REPOTEST_FLOWFILE_CHECKPOINT_DIR, dir, 0, 0, 1);
+    REQUIRE(repository->initialize(config));
+    REQUIRE(environment.getMemoryLimit() == 16 * 1024 * 1024);
+    REQUIRE(environment.getBackgroundThreads() == 2);
+
+    const std::string value(1024, 'x');
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(repository->Put("key" + std::to_string(i), reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+    }
+    auto memory_usage = repository->getMemoryUsage();
+    REQUIRE(memory_usage);
+    REQUIRE(*memory_usage > 0);
+    // the write buffers are charged to the shared cache, which never grows beyond the limit
+    REQUIRE(environment.getSharedCacheUsage() > 0);
+    REQUIRE(environment.getSharedCacheUsage() <= environment.getMemoryLimit());
+
+    minifi::state::response::RepositoryMetrics metrics;
+    metrics.addRepository(repository);
+    auto serialized = metrics.serialize();
+    REQUIRE(serialized.size() == 1);
+    REQUIRE(serialized.at(0).children.size() == 4);
+    REQUIRE(serialized.at(0).children.at(3).name == "memoryUsage");
+  }
+
+  // the environment is shared by the process, the other tests get the default caches and thread pools
+  config->set(minifi::Configure::nifi_rocksdb_memory_limit, "0");
+  config->set(minifi::Configure::nifi_rocksdb_background_threads, "0");
+  environment.configure(*config);
+  REQUIRE(environment.getMemoryLimit() == 0);
+  REQUIRE(environment.getSharedCacheUsage() == 0);
+  REQUIRE(environment.getBackgroundThreads() == 0);
+}
+
+TEST_CASE("Delete throughput of the FlowFile repository with and without reading the records", "[.][benchmark]") {
+  const size_t flow_file_count = 100000;
+  const auto run = [&](bool carry_claims) {
+    TestController testController;
+    char format[] = "/var/tmp/testRepo.XXXXXX";
+    auto dir = testController.createTempDirectory(format);
+    auto repository = std::make_shared<core::repository::FlowFileRepository>("ff", REPOTEST_FLOWFILE_CHECKPOINT_DIR, dir, 0, 0, 1);
+    auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+    REQUIRE(content_repo->initialize(std::make_shared<minifi::Configure>()));
+    REQUIRE(repository->initialize(std::make_shared<minifi::Configure>()));
+    repository->loadComponent(content_repo);
+
+    std::vector<std::shared_ptr<minifi::FlowFileRecord>> flow_files;
+    for (size_t i = 0; i < flow_file_count; ++i) {
+      auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+      flow_file->setResourceClaim(std::make_shared<minifi::ResourceClaim>(content_repo));
+      flow_file->addAttribute("filename", "file" + std::to_string(i));
+      REQUIRE(flow_file->Persist(repository));
+      flow_file->setStoredToRepository(true);
+      flow_files.push_back(flow_file);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& flow_file : flow_files) {
+      if (carry_claims) {
+        repository->Delete(flow_file->getUUIDStr(), flow_file->getStoredResourceClaim());
+      } else {
+        repository->Delete(flow_file->getUUIDStr());
+      }
+    }
+    repository->flush();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    WARN((carry_claims ? "Carrying the claims: " : "Reading the records: ") << flow_file_count << " FlowFiles deleted in " << elapsed.count() << " ms");
+  };
+  run(false);
+  run(true);
+}
+
 }  // namespace
@@ -46,6 +46,7 @@ TEST_CASE_METHOD(RocksDBStreamTest, "Verify simple operation") {
   minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true);
   outStream.write(content);
   REQUIRE(outStream.write(content) > 0);
+  outStream.close();
   minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
   std::string str;
   inStream.read(str);
@@ -65,6 +66,7 @@ TEST_CASE_METHOD(RocksDBStreamTest, "Write zero bytes") {
 TEST_CASE_METHOD(RocksDBStreamTest, "Read zero bytes") {
   minifi::io::RocksDbStream one("one", gsl::make_not_null(db.get()), true);
   REQUIRE(one.write("banana") > 0);
+  one.close();
 
   minifi::io::RocksDbStream stream("one", gsl::make_not_null(db.get()));
 
@@ -74,3 +76,190 @@ TEST_CASE_METHOD(RocksDBStreamTest, "Read zero bytes") {
 
   REQUIRE(nonExistingStream.read(nullptr, 0) == -1);
 }
+
+namespace {
+
+int writeString(minifi::io::RocksDbStream& stream, const std::string& content) {
+  return stream.write(reinterpret_cast<const uint8_t*>(content.data()), gsl::narrow<int>(content.size()));
+}
+
+std::string readRemaining(minifi::io::RocksDbStream& stream) {
+  // reads in small pieces to cross the chunk boundaries
+  std::string result;
+  uint8_t buffer[3];
+  int read;
+  while ((read = stream.read(buffer, sizeof(buffer))) > 0) {
+    result.append(reinterpret_cast<const char*>(buffer), read);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Content is stored in chunks") {
+  minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, nullptr, false, 4);
+  REQUIRE(writeString(outStream, "0123456") == 7);
+  REQUIRE(writeString(outStream, "789") == 3);
+  outStream.close();
+
+  minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+  REQUIRE(inStream.size() == 10);
+
+  SECTION("Read the whole content") {
+    REQUIRE(readRemaining(inStream) == "0123456789");
+  }
+
+  SECTION("Seek into the content") {
+    inStream.seek(5);
+    REQUIRE(readRemaining(inStream) == "56789");
+    inStream.seek(1);
+    REQUIRE(readRemaining(inStream) == "123456789");
+  }
+
+  SECTION("Seek past the end") {
+    inStream.seek(42);
+    uint8_t buffer[1];
+    REQUIRE(inStream.read(buffer, 1) == 0);
+  }
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Append to and overwrite chunked content") {
+  {
+    minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, nullptr, false, 4);
+    REQUIRE(writeString(outStream, "abcdef") == 6);
+  }
+
+  SECTION("Append") {
+    minifi::io::RocksDbStream appendStream("one", gsl::make_not_null(db.get()), true, nullptr, true);
+    REQUIRE(writeString(appendStream, "ghijk") == 5);
+    appendStream.close();
+
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(inStream.size() == 11);
+    REQUIRE(readRemaining(inStream) == "abcdefghijk");
+  }
+
+  SECTION("Overwrite") {
+    minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, nullptr, false, 4);
+    REQUIRE(writeString(outStream, "xyz") == 3);
+    outStream.close();
+
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(inStream.size() == 3);
+    REQUIRE(readRemaining(inStream) == "xyz");
+  }
+
+  SECTION("Remove") {
+    auto opendb = db->open();
+    REQUIRE(opendb);
+    REQUIRE(minifi::io::RocksDbStream::exists(*opendb, "one"));
+    rocksdb::WriteBatch batch;
+    minifi::io::RocksDbStream::remove(batch, "one");
+    REQUIRE(opendb->Write(rocksdb::WriteOptions(), &batch).ok());
+    REQUIRE_FALSE(minifi::io::RocksDbStream::exists(*opendb, "one"));
+  }
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "The last chunk is written when it is complete or the stream is closed") {
+  minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, nullptr, false, 4);
+  REQUIRE(writeString(outStream, "abc") == 3);
+  {
+    auto opendb = db->open();
+    REQUIRE(opendb);
+    REQUIRE_FALSE(minifi::io::RocksDbStream::exists(*opendb, "one"));
+  }
+
+  REQUIRE(writeString(outStream, "defghi") == 6);
+  {
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(inStream.size() == 8);
+    REQUIRE(readRemaining(inStream) == "abcdefgh");
+  }
+
+  outStream.close();
+  minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+  REQUIRE(inStream.size() == 9);
+  REQUIRE(readRemaining(inStream) == "abcdefghi");
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Truncate chunked content") {
+  {
+    minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, nullptr, false, 4);
+    REQUIRE(writeString(outStream, "abcdefghij") == 10);
+  }
+  auto opendb = db->open();
+  REQUIRE(opendb);
+  rocksdb::WriteBatch batch;
+  REQUIRE(minifi::io::RocksDbStream::truncate(*opendb, batch, "one", 5));
+  REQUIRE(opendb->Write(rocksdb::WriteOptions(), &batch).ok());
+
+  {
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(inStream.size() == 5);
+    REQUIRE(readRemaining(inStream) == "abcde");
+  }
+
+  // the truncated content can be appended to again
+  {
+    minifi::io::RocksDbStream appendStream("one", gsl::make_not_null(db.get()), true, nullptr, true);
+    REQUIRE(writeString(appendStream, "xyz") == 3);
+  }
+  minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+  REQUIRE(readRemaining(inStream) == "abcdexyz");
+
+  rocksdb::WriteBatch missing_batch;
+  REQUIRE_FALSE(minifi::io::RocksDbStream::truncate(*opendb, missing_batch, "two", 1));
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Content stored as a single value is still supported") {
+  {
+    auto opendb = db->open();
+    REQUIRE(opendb);
+    REQUIRE(opendb->Put(rocksdb::WriteOptions(), "one", "hello").ok());
+  }
+
+  SECTION("Read") {
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(inStream.size() == 5);
+    inStream.seek(1);
+    REQUIRE(readRemaining(inStream) == "ello");
+  }
+
+  SECTION("Append") {
+    minifi::io::RocksDbStream appendStream("one", gsl::make_not_null(db.get()), true, nullptr, true, 4);
+    REQUIRE(writeString(appendStream, " world") == 6);
+    appendStream.close();
+
+    minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+    REQUIRE(readRemaining(inStream) == "hello world");
+
+    auto opendb = db->open();
+    REQUIRE(opendb);
+    std::string value;
+    REQUIRE_FALSE(opendb->Get(rocksdb::ReadOptions(), "one", &value).ok());
+  }
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Writing a new claim does not remove previous content") {
+  rocksdb::WriteBatch batch;
+  {
+    minifi::io::RocksDbStream outStream("one", gsl::make_not_null(db.get()), true, &batch, false, 4, true);
+    REQUIRE(writeString(outStream, "abcdef") == 6);
+  }
+  // two chunks and a header after each of them, without the deletion of the previous content
+  REQUIRE(batch.Count() == 4);
+
+  rocksdb::WriteBatch replacing_batch;
+  {
+    minifi::io::RocksDbStream outStream("two", gsl::make_not_null(db.get()), true, &replacing_batch, false, 4);
+    REQUIRE(writeString(outStream, "abcdef") == 6);
+  }
+  // the range of the previous chunks and the single value of earlier versions are deleted as well
+  REQUIRE(replacing_batch.Count() == 6);
+
+  auto opendb = db->open();
+  REQUIRE(opendb);
+  REQUIRE(opendb->Write(rocksdb::WriteOptions(), &batch).ok());
+  minifi::io::RocksDbStream inStream("one", gsl::make_not_null(db.get()));
+  REQUIRE(readRemaining(inStream) == "abcdef");
+}
@@ -76,3 +76,32 @@ TEST_CASE("Test Put Content", "[PutSQLPutContent]") {
   REQUIRE(rows[0].text_col == "fdsa");
 }
 
+
+TEST_CASE("Test Put in batches", "[PutSQLPutBatch]") {
+  SQLTestController testController;
+
+  auto plan = testController.createSQLPlan("PutSQL", {{"success", "d"}});
+  auto sql_proc = plan->getSQLProcessor();
+  sql_proc->setProperty("Batch Size", "2");
+  sql_proc->setProperty(
+      "SQL Statement",
+      "INSERT INTO test_table (int_col, text_col) VALUES (?, ?)");
+
+  plan->addInput({{"sql.args.1.value", "1"}, {"sql.args.2.value", "one"}});
+  plan->addInput({{"sql.args.1.value", "2"}, {"sql.args.2.value", "two"}});
+  plan->addInput({{"sql.args.1.value", "3"}, {"sql.args.2.value", "three"}});
+
+  plan->run();
+
+  auto rows = testController.fetchValues();
+  REQUIRE(rows.size() == 2);
+  REQUIRE(rows[0].int_col == 1);
+  REQUIRE(rows[1].int_col == 2);
+  REQUIRE(plan->getOutputs({"success", "d"}).size() == 2);
+
+  plan->run();
+
+  rows = testController.fetchValues();
+  REQUIRE(rows.size() == 3);
+  REQUIRE(rows[2].text_col == "three");
+}
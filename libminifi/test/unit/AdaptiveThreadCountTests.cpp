@@ -0,0 +1,65 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../TestBase.h"
+#include "utils/AdaptiveThreadCount.h"
+
+TEST_CASE("AdaptiveThreadCount grows while tasks are waiting for a worker", "[AdaptiveThreadCount]") {
+  utils::AdaptiveThreadCount thread_count(1, 16);
+  REQUIRE(thread_count.update(4, 4, 10, 0.5) == 6);
+  REQUIRE(thread_count.update(6, 6, 1, 0.5) == 7);
+  // a single thread can still double
+  REQUIRE(thread_count.update(1, 1, 10, 0.5) == 2);
+  REQUIRE(thread_count.update(12, 12, 100, 0.5) == 16);
+}
+
+TEST_CASE("AdaptiveThreadCount does not grow when the CPU is saturated", "[AdaptiveThreadCount]") {
+  utils::AdaptiveThreadCount thread_count(1, 16);
+  REQUIRE(thread_count.update(4, 4, 10, 0.95) == 4);
+}
+
+TEST_CASE("AdaptiveThreadCount shrinks after being idle for a while", "[AdaptiveThreadCount]") {
+  utils::AdaptiveThreadCount thread_count(2, 16);
+  for (int sample = 1; sample < utils::AdaptiveThreadCount::IDLE_SAMPLES_BEFORE_SHRINKING; ++sample) {
+    REQUIRE(thread_count.update(8, 0, 0, 0.1) == 8);
+  }
+  REQUIRE(thread_count.update(8, 0, 0, 0.1) == 4);
+
+  SECTION("a busy sample restarts the count") {
+    REQUIRE(thread_count.update(4, 1, 0, 0.1) == 4);
+    REQUIRE(thread_count.update(4, 4, 0, 0.1) == 4);
+    for (int sample = 1; sample < utils::AdaptiveThreadCount::IDLE_SAMPLES_BEFORE_SHRINKING; ++sample) {
+      REQUIRE(thread_count.update(4, 1, 0, 0.1) == 4);
+    }
+    REQUIRE(thread_count.update(4, 1, 0, 0.1) == 2);
+  }
+
+  SECTION("it does not go below the minimum") {
+    for (int sample = 0; sample < 10 * utils::AdaptiveThreadCount::IDLE_SAMPLES_BEFORE_SHRINKING; ++sample) {
+      REQUIRE(thread_count.update(2, 0, 0, 0.0) == 2);
+    }
+  }
+}
+
+TEST_CASE("AdaptiveThreadCount keeps the thread count within its bounds", "[AdaptiveThreadCount]") {
+  utils::AdaptiveThreadCount thread_count(4, 8);
+  REQUIRE(thread_count.update(2, 2, 0, 0.5) == 4);
+  REQUIRE(thread_count.update(20, 20, 0, 0.5) == 8);
+
+  utils::AdaptiveThreadCount invalid_bounds(0, 0);
+  REQUIRE(invalid_bounds.getMinThreads() == 1);
+  REQUIRE(invalid_bounds.getMaxThreads() == 1);
+}
@@ -0,0 +1,194 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../TestBase.h"
+#include "core/AsyncProcessor.h"
+#include "utils/IntegrationTestUtils.h"
+
+namespace {
+
+// creates a flow file in every trigger and transfers it when the test completes the operation of the trigger
+class AsyncTestProcessor : public core::AsyncProcessor {
+ public:
+  explicit AsyncTestProcessor(const std::string& name)
+      : AsyncProcessor(name) {
+  }
+
+  static core::Relationship Success;
+
+  void initialize() override {
+    setSupportedRelationships({Success});
+  }
+
+  // completes the oldest operation in flight, with a continuation throwing an exception if fail
+  bool completeNext(bool fail = false) {
+    std::function<void(bool)> complete;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (operations_.empty()) {
+        return false;
+      }
+      complete = std::move(operations_.front());
+      operations_.pop_front();
+    }
+    complete(fail);
+    return true;
+  }
+
+  // drops the handle of the oldest operation in flight without completing it
+  void abandonNext() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    operations_.pop_front();
+  }
+
+  int getOperationsStarted() const {
+    return operations_started_;
+  }
+
+ protected:
+  void onTriggerAsync(const std::shared_ptr<core::ProcessContext>& /*context*/, const std::shared_ptr<core::ProcessSession>& session) override {
+    const auto flow_file = session->create();
+    const Operation operation = startOperation(session);
+    ++operations_started_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    operations_.push_back([operation, session, flow_file](bool fail) {
+      operation.complete([session, flow_file, fail] {
+        if (fail) {
+          throw std::runtime_error("operation failed");
+        }
+        session->transfer(flow_file, Success);
+      });
+    });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<std::function<void(bool)>> operations_;
+  std::atomic<int> operations_started_{0};
+};
+
+core::Relationship AsyncTestProcessor::Success("success", "description");
+
+struct AsyncTestFixture {
+  AsyncTestFixture()
+      : plan(test_controller.createPlan()),
+        processor(std::make_shared<AsyncTestProcessor>("async")) {
+    plan->addProcessor(processor, "async");
+    processor->setAutoTerminatedRelationships({AsyncTestProcessor::Success});
+    context = plan->getProcessContextForProcessor(processor);
+    session_factory = std::make_shared<core::ProcessSessionFactory>(context);
+  }
+
+  void trigger() {
+    processor->onTrigger(context, session_factory);
+  }
+
+  uint64_t getCommits() const {
+    return processor->getStatistics().getSnapshot().commits;
+  }
+
+  TestController test_controller;
+  std::shared_ptr<TestPlan> plan;
+  std::shared_ptr<AsyncTestProcessor> processor;
+  std::shared_ptr<core::ProcessContext> context;
+  std::shared_ptr<core::ProcessSessionFactory> session_factory;
+};
+
+}  // namespace
+
+TEST_CASE("AsyncProcessor keeps the sessions open until their operations complete", "[AsyncProcessor]") {
+  AsyncTestFixture fixture;
+  auto& processor = *fixture.processor;
+  std::atomic<int> notifications{0};
+  processor.setWorkNotificationCallback([&notifications] { ++notifications; });
+  processor.setMaxSessionsInFlight(3);
+
+  REQUIRE(processor.isWorkAvailable());
+  for (int i = 0; i < 3; ++i) {
+    fixture.trigger();
+  }
+  REQUIRE(processor.getOperationsStarted() == 3);
+  REQUIRE(processor.getSessionsInFlight() == 3);
+  REQUIRE_FALSE(processor.isWorkAvailable());
+
+  // no new session is started while the maximum is in flight
+  fixture.trigger();
+  REQUIRE(processor.getOperationsStarted() == 3);
+
+  // completions notify the scheduling agent, their continuations run in the next trigger
+  REQUIRE(processor.completeNext());
+  REQUIRE(processor.completeNext());
+  REQUIRE(notifications == 2);
+  REQUIRE(processor.isWorkAvailable());
+  REQUIRE(fixture.getCommits() == 0);
+
+  fixture.trigger();
+  REQUIRE(fixture.getCommits() == 2);
+  REQUIRE(processor.getOperationsStarted() == 4);
+  REQUIRE(processor.getSessionsInFlight() == 2);
+
+  // the session of a failed continuation is rolled back
+  REQUIRE(processor.completeNext(true));
+  fixture.trigger();
+  REQUIRE(fixture.getCommits() == 2);
+  REQUIRE(processor.getOperationsStarted() == 5);
+  REQUIRE(processor.getSessionsInFlight() == 2);
+
+  // so is the session of an abandoned operation
+  processor.abandonNext();
+  fixture.trigger();
+  REQUIRE(fixture.getCommits() == 2);
+  REQUIRE(processor.getSessionsInFlight() == 2);
+
+  processor.setWorkNotificationCallback({});
+}
+
+TEST_CASE("AsyncProcessor waits for the operations when triggered with a session", "[AsyncProcessor]") {
+  TestController test_controller;
+  auto plan = test_controller.createPlan();
+  const auto processor = std::make_shared<AsyncTestProcessor>("async");
+  plan->addProcessor(processor, "async");
+
+  bool fail = false;
+  SECTION("Successful operation") {
+  }
+  SECTION("Failed operation") {
+    fail = true;
+  }
+
+  std::thread completer([&processor, fail] {
+    const auto completed = [&processor, fail] { return processor->completeNext(fail); };
+    utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), completed);
+  });
+  if (fail) {
+    REQUIRE_THROWS_AS(plan->runNextProcessor(), std::runtime_error);
+  } else {
+    plan->runNextProcessor();
+    REQUIRE(plan->getNumFlowFileProducedByCurrentProcessor() == 1);
+  }
+  completer.join();
+  REQUIRE(processor->getSessionsInFlight() == 0);
+}
@@ -18,6 +18,7 @@
 #include <memory>
 
 #include "../../include/core/state/nodes/ProcessMetrics.h"
+#include "../../include/core/state/nodes/ProcessorPerformanceMetrics.h"
 #include "../../include/core/state/nodes/QueueMetrics.h"
 #include "../../include/core/state/nodes/RepositoryMetrics.h"
 #include "../../include/core/state/nodes/SystemMetrics.h"
@@ -85,7 +86,7 @@ TEST_CASE("QueueMetricsTestConnections", "[c2m3]") {
 
   REQUIRE("testconnection" == resp.name);
 
-  REQUIRE(4 == resp.children.size());
+  REQUIRE(6 == resp.children.size());
 
   minifi::state::response::SerializedResponseNode datasize = resp.children.at(0);
 
@@ -106,6 +107,16 @@ TEST_CASE("QueueMetricsTestConnections", "[c2m3]") {
 
   REQUIRE("queuedmax" == queuedmax.name);
   REQUIRE("1024" == queuedmax.value.to_string());
+
+  minifi::state::response::SerializedResponseNode swapped = resp.children.at(4);
+
+  REQUIRE("swapped" == swapped.name);
+  REQUIRE("0" == swapped.value.to_string());
+
+  minifi::state::response::SerializedResponseNode swappeddatasize = resp.children.at(5);
+
+  REQUIRE("swappeddatasize" == swappeddatasize.name);
+  REQUIRE("0" == swappeddatasize.value.to_string());
 }
 
 TEST_CASE("RepositorymetricsNoRepo", "[c2m4]") {
@@ -229,3 +240,65 @@ TEST_CASE("RepositorymetricsHaveRepo", "[c2m4]") {
     REQUIRE("0" == size.value);
   }
 }
+
+TEST_CASE("ProcessorPerformanceMetricsNoProcessors", "[c2m6]") {
+  minifi::state::response::ProcessorPerformanceMetrics metrics;
+
+  REQUIRE("ProcessorPerformanceMetrics" == metrics.getName());
+
+  REQUIRE(0 == metrics.serialize().size());
+}
+
+TEST_CASE("ProcessorPerformanceMetricsHaveProcessor", "[c2m6]") {
+  minifi::state::response::ProcessorPerformanceMetrics metrics;
+
+  auto processor = std::make_shared<core::Processor>("test_processor");
+  metrics.addProcessor(processor);
+
+  for (int i = 1; i <= 100; ++i) {
+    processor->getStatistics().recordTrigger(std::chrono::microseconds(i), std::chrono::microseconds(2));
+  }
+  processor->getStatistics().recordCommit(std::chrono::microseconds(5), 3, 300, 2, 150);
+
+  REQUIRE(1 == metrics.serialize().size());
+
+  minifi::state::response::SerializedResponseNode resp = metrics.serialize().at(0);
+
+  REQUIRE("test_processor" == resp.name);
+  REQUIRE(9 == resp.children.size());
+
+  REQUIRE("uuid" == resp.children.at(0).name);
+  REQUIRE(processor->getUUIDStr() == resp.children.at(0).value.to_string());
+  REQUIRE("triggers" == resp.children.at(1).name);
+  REQUIRE("100" == resp.children.at(1).value.to_string());
+  REQUIRE("cputimens" == resp.children.at(2).name);
+  REQUIRE("200000" == resp.children.at(2).value.to_string());
+  REQUIRE("flowfilesin" == resp.children.at(3).name);
+  REQUIRE("3" == resp.children.at(3).value.to_string());
+  REQUIRE("bytesin" == resp.children.at(4).name);
+  REQUIRE("300" == resp.children.at(4).value.to_string());
+  REQUIRE("flowfilesout" == resp.children.at(5).name);
+  REQUIRE("2" == resp.children.at(5).value.to_string());
+  REQUIRE("bytesout" == resp.children.at(6).name);
+  REQUIRE("150" == resp.children.at(6).value.to_string());
+
+  minifi::state::response::SerializedResponseNode trigger_duration = resp.children.at(7);
+
+  REQUIRE("ontriggerus" == trigger_duration.name);
+  REQUIRE(6 == trigger_duration.children.size());
+  REQUIRE("count" == trigger_duration.children.at(0).name);
+  REQUIRE("100" == trigger_duration.children.at(0).value.to_string());
+  REQUIRE("mean" == trigger_duration.children.at(1).name);
+  REQUIRE("50" == trigger_duration.children.at(1).value.to_string());
+  REQUIRE("p50" == trigger_duration.children.at(2).name);
+  // 50 falls into the [48, 51] bucket
+  REQUIRE("51" == trigger_duration.children.at(2).value.to_string());
+  REQUIRE("max" == trigger_duration.children.at(5).name);
+  REQUIRE("100" == trigger_duration.children.at(5).value.to_string());
+
+  minifi::state::response::SerializedResponseNode commit_duration = resp.children.at(8);
+
+  REQUIRE("commitus" == commit_duration.name);
+  REQUIRE("1" == commit_duration.children.at(0).value.to_string());
+  REQUIRE("5" == commit_duration.children.at(5).value.to_string());
+}
@@ -0,0 +1,141 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+
+#include "ConcurrentFlowFileQueue.h"
+
+#include "../TestBase.h"
+#include "utils/IntegrationTestUtils.h"
+
+TEST_CASE("After construction, a ConcurrentFlowFileQueue is empty", "[ConcurrentFlowFileQueue]") {
+  utils::ConcurrentFlowFileQueue queue;
+
+  REQUIRE(queue.empty());
+  REQUIRE(queue.size() == 0);
+  REQUIRE(queue.dataSize() == 0);
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  std::shared_ptr<core::FlowFile> flow_file;
+  REQUIRE_FALSE(queue.tryPop(flow_file));
+}
+
+TEST_CASE("If a non-penalized flow file is added to the ConcurrentFlowFileQueue, we can pop it", "[ConcurrentFlowFileQueue][tryPop]") {
+  utils::ConcurrentFlowFileQueue queue;
+  const auto flow_file = std::make_shared<core::FlowFile>();
+  flow_file->setSize(10);
+  queue.push(flow_file);
+
+  REQUIRE_FALSE(queue.empty());
+  REQUIRE(queue.size() == 1);
+  REQUIRE(queue.dataSize() == 10);
+  REQUIRE(queue.isWorkAvailable());
+  std::shared_ptr<core::FlowFile> popped;
+  REQUIRE(queue.tryPop(popped));
+  REQUIRE(popped == flow_file);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.dataSize() == 0);
+}
+
+TEST_CASE("A penalized flow file is only popped from the ConcurrentFlowFileQueue after its penalty expires", "[ConcurrentFlowFileQueue][tryPop]") {
+  utils::ConcurrentFlowFileQueue queue;
+  const auto penalized_flow_file = std::make_shared<core::FlowFile>();
+  penalized_flow_file->penalize(std::chrono::milliseconds{20});
+  queue.push(penalized_flow_file);
+  const auto flow_file = std::make_shared<core::FlowFile>();
+  queue.push(flow_file);
+
+  REQUIRE(queue.size() == 2);
+  std::shared_ptr<core::FlowFile> popped;
+  REQUIRE(queue.tryPop(popped));
+  REQUIRE(popped == flow_file);
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  REQUIRE_FALSE(queue.tryPop(popped));
+  REQUIRE_FALSE(queue.empty());
+
+  const auto work_is_available = [&queue] { return queue.isWorkAvailable(); };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds{1}, work_is_available, std::chrono::milliseconds{5}));
+  REQUIRE(queue.tryPop(popped));
+  REQUIRE(popped == penalized_flow_file);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("Flow files can be popped from the ConcurrentFlowFileQueue in batches", "[ConcurrentFlowFileQueue][tryPopBatch]") {
+  utils::ConcurrentFlowFileQueue queue;
+  for (int i = 0; i < 10; ++i) {
+    queue.push(std::make_shared<core::FlowFile>());
+  }
+
+  std::vector<std::shared_ptr<core::FlowFile>> popped;
+  REQUIRE(queue.tryPopBatch(4, popped) == 4);
+  REQUIRE(popped.size() == 4);
+  REQUIRE(queue.size() == 6);
+  REQUIRE(queue.tryPopBatch(100, popped) == 6);
+  REQUIRE(popped.size() == 10);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.tryPopBatch(100, popped) == 0);
+}
+
+TEST_CASE("popAll() returns every flow file from the ConcurrentFlowFileQueue, whether penalized or not", "[ConcurrentFlowFileQueue][popAll]") {
+  utils::ConcurrentFlowFileQueue queue;
+  const auto penalized_flow_file = std::make_shared<core::FlowFile>();
+  penalized_flow_file->penalize(std::chrono::seconds{10});
+  queue.push(penalized_flow_file);
+  const auto flow_file = std::make_shared<core::FlowFile>();
+  queue.push(flow_file);
+
+  const auto popped = queue.popAll();
+  REQUIRE(popped.size() == 2);
+  REQUIRE(std::find(popped.begin(), popped.end(), penalized_flow_file) != popped.end());
+  REQUIRE(std::find(popped.begin(), popped.end(), flow_file) != popped.end());
+  REQUIRE(queue.empty());
+  REQUIRE_FALSE(queue.isWorkAvailable());
+}
+
+TEST_CASE("The ConcurrentFlowFileQueue can be used by multiple producers and consumers", "[ConcurrentFlowFileQueue][concurrency]") {
+  utils::ConcurrentFlowFileQueue queue;
+  constexpr int NUM_THREADS = 4;
+  constexpr int FLOW_FILES_PER_THREAD = 1000;
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    producers.emplace_back([&queue] {
+      for (int j = 0; j < FLOW_FILES_PER_THREAD; ++j) {
+        auto flow_file = std::make_shared<core::FlowFile>();
+        flow_file->setSize(1);
+        queue.push(std::move(flow_file));
+      }
+    });
+  }
+
+  std::atomic<int> consumed{0};
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    consumers.emplace_back([&queue, &consumed] {
+      std::vector<std::shared_ptr<core::FlowFile>> batch;
+      while (consumed < NUM_THREADS * FLOW_FILES_PER_THREAD) {
+        batch.clear();
+        consumed += gsl::narrow<int>(queue.tryPopBatch(16, batch));
+      }
+    });
+  }
+
+  for (auto& producer : producers) { producer.join(); }
+  for (auto& consumer : consumers) { consumer.join(); }
+
+  REQUIRE(consumed == NUM_THREADS * FLOW_FILES_PER_THREAD);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.dataSize() == 0);
+}
@@ -14,6 +14,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <fstream>
+
 #include "Connection.h"
 
 #include "../TestBase.h"
@@ -82,3 +84,137 @@ TEST_CASE("Connection::poll() works correctly", "[poll]") {
     REQUIRE(nullptr == connection->poll(expired_flow_files));
   }
 }
+
+TEST_CASE("Connection::pollBatch() works correctly", "[poll][pollBatch]") {
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto id_generator = utils::IdGenerator::getIdGenerator();
+  utils::Identifier connection_id = id_generator->generate();
+  utils::Identifier src_id = id_generator->generate();
+  utils::Identifier dest_id = id_generator->generate();
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection", connection_id, src_id, dest_id);
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+
+  SECTION("with the default queue") {}
+  SECTION("with the lock-free queue") { connection->setLockFreeQueue(true); }
+
+  const auto penalized_flow_file = std::make_shared<core::FlowFile>();
+  penalized_flow_file->penalize(std::chrono::seconds{10});
+  connection->put(penalized_flow_file);
+
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  for (int i = 0; i < 5; ++i) {
+    flow_files.push_back(std::make_shared<core::FlowFile>());
+    connection->put(flow_files.back());
+  }
+  REQUIRE(6 == connection->getQueueSize());
+
+  const auto first_batch = connection->pollBatch(3, expired_flow_files);
+  REQUIRE(3 == first_batch.size());
+  const auto second_batch = connection->pollBatch(3, expired_flow_files);
+  REQUIRE(2 == second_batch.size());
+  REQUIRE(connection->pollBatch(3, expired_flow_files).empty());
+  REQUIRE(expired_flow_files.empty());
+  REQUIRE(1 == connection->getQueueSize());
+
+  std::set<std::shared_ptr<core::FlowFile>> polled(first_batch.begin(), first_batch.end());
+  polled.insert(second_batch.begin(), second_batch.end());
+  REQUIRE(std::set<std::shared_ptr<core::FlowFile>>(flow_files.begin(), flow_files.end()) == polled);
+  REQUIRE(polled.count(penalized_flow_file) == 0);
+}
+
+TEST_CASE("Connection with a lock-free queue applies back pressure", "[isFull]") {
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setLockFreeQueue(true);
+  connection->setMaxQueueSize(2);
+
+  REQUIRE(connection->isEmpty());
+  REQUIRE_FALSE(connection->isFull());
+  connection->put(std::make_shared<core::FlowFile>());
+  REQUIRE_FALSE(connection->isFull());
+  connection->put(std::make_shared<core::FlowFile>());
+  REQUIRE(connection->isFull());
+
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+  REQUIRE(connection->poll(expired_flow_files));
+  REQUIRE_FALSE(connection->isFull());
+
+  connection->drain(false);
+  REQUIRE(connection->isEmpty());
+  REQUIRE(0 == connection->getQueueSize());
+}
+
+TEST_CASE("Connection swaps FlowFiles to disk above the swap threshold", "[swap]") {
+  TestController test_controller;
+  char format[] = "/tmp/swap.XXXXXX";
+  const auto swap_directory = test_controller.createTempDirectory(format);
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setSwapThreshold(4);
+  connection->setSwapManager(std::make_shared<minifi::FlowFileSwapManager>(swap_directory, content_repo));
+
+  for (int i = 0; i < 20; ++i) {
+    const auto flow_file = std::make_shared<core::FlowFile>();
+    flow_file->addAttribute("index", std::to_string(i));
+    connection->put(flow_file);
+  }
+  REQUIRE(20 == connection->getQueueSize());
+  REQUIRE(connection->getSwappedCount() > 0);
+  REQUIRE(connection->isWorkAvailable());
+
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+  SECTION("FlowFiles are polled in FIFO order") {
+    for (int i = 0; i < 20; ++i) {
+      const auto flow_file = connection->poll(expired_flow_files);
+      REQUIRE(flow_file);
+      std::string index;
+      REQUIRE(flow_file->getAttribute("index", index));
+      REQUIRE(std::to_string(i) == index);
+    }
+    REQUIRE(nullptr == connection->poll(expired_flow_files));
+  }
+  SECTION("drain removes the swapped out FlowFiles") {
+    connection->drain(false);
+  }
+  REQUIRE(expired_flow_files.empty());
+  REQUIRE(connection->isEmpty());
+  REQUIRE(0 == connection->getQueueSize());
+  REQUIRE(0 == connection->getSwappedCount());
+  REQUIRE(0 == connection->getSwappedDataSize());
+}
+
+TEST_CASE("Connection backs off after a failed swap out", "[swap]") {
+  TestController test_controller;
+  LogTestController::getInstance().setWarn<minifi::Connection>();
+  char format[] = "/tmp/swap.XXXXXX";
+  const auto directory = test_controller.createTempDirectory(format);
+  // the swap directory cannot be created below a regular file, so every swap out fails
+  const auto blocking_file = utils::file::FileUtils::concat_path(directory, "file");
+  std::ofstream(blocking_file) << "not a directory";
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setSwapThreshold(4);
+  connection->setSwapManager(std::make_shared<minifi::FlowFileSwapManager>(utils::file::FileUtils::concat_path(blocking_file, "swap"), content_repo));
+
+  for (int i = 0; i < 36; ++i) {
+    connection->put(std::make_shared<core::FlowFile>());
+  }
+  REQUIRE(36 == connection->getQueueSize());
+  REQUIRE(0 == connection->getSwappedCount());
+  // 32 flow files are waiting to be swapped out, the swap out is retried at 2, 4, 8, 16 and 32 of them
+  REQUIRE(5 == LogTestController::getInstance().countOccurrences("Failed to swap out"));
+  LogTestController::getInstance().reset();
+}
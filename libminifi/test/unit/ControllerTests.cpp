@@ -151,6 +151,10 @@ class TestUpdateSink : public minifi::state::StateMonitor {
     return 0;
   }
 
+  int16_t setThreadPoolSize(uint16_t /*threads*/) override {
+    return 0;
+  }
+
   /**
    * Apply an update with the provided string.
    *
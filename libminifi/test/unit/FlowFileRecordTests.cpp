@@ -0,0 +1,196 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "ResourceClaim.h"
+#include "core/repository/VolatileContentRepository.h"
+#include "io/BufferStream.h"
+
+namespace {
+
+// writes the record in the format used before the compact format was introduced
+void serializeOriginal(minifi::FlowFileRecord& record, const utils::Identifier& container, minifi::io::OutputStream& stream) {
+  stream.write(record.getEventTime());
+  stream.write(record.getEntryDate());
+  stream.write(record.getlineageStartDate());
+  stream.write(record.getUUID());
+  stream.write(container);
+  stream.write(gsl::narrow<uint32_t>(record.getAttributes().size()));
+  for (const auto& attribute : record.getAttributes()) {
+    stream.write(attribute.first, true);
+    stream.write(attribute.second, true);
+  }
+  stream.write(record.getResourceClaim() ? record.getResourceClaim()->getContentFullPath() : "");
+  stream.write(record.getSize());
+  stream.write(record.getOffset());
+}
+
+std::shared_ptr<minifi::FlowFileRecord> createRecord(const std::shared_ptr<core::ContentRepository>& content_repo) {
+  auto record = std::make_shared<minifi::FlowFileRecord>();
+  record->addAttribute(core::SpecialFlowAttribute::PATH, "/var/data/in");
+  record->addAttribute(core::SpecialFlowAttribute::ABSOLUTE_PATH, "/var/data/in/");
+  record->addAttribute("file.size", "1234");
+  record->addAttribute("custom.attribute", "custom value");
+  record->addAttribute("", "empty key");
+  record->setResourceClaim(std::make_shared<minifi::ResourceClaim>(content_repo));
+  record->setSize(1234);
+  record->setOffset(56);
+  return record;
+}
+
+void requireSameRecord(const minifi::FlowFileRecord& expected, const minifi::FlowFileRecord& actual) {
+  REQUIRE(expected.getUUID() == actual.getUUID());
+  REQUIRE(expected.getEventTime() == actual.getEventTime());
+  REQUIRE(expected.getEntryDate() == actual.getEntryDate());
+  REQUIRE(expected.getlineageStartDate() == actual.getlineageStartDate());
+  REQUIRE(expected.getAttributes() == actual.getAttributes());
+  REQUIRE(expected.getSize() == actual.getSize());
+  REQUIRE(expected.getOffset() == actual.getOffset());
+}
+
+}  // namespace
+
+TEST_CASE("FlowFileRecord round trip in the compact format", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "connection");
+  auto record = createRecord(content_repo);
+  record->setConnection(connection);
+
+  minifi::io::BufferStream stream;
+  REQUIRE(record->Serialize(stream));
+
+  utils::Identifier container;
+  auto restored = minifi::FlowFileRecord::DeSerialize(stream.getBuffer(), gsl::narrow<int>(stream.size()), content_repo, container);
+  REQUIRE(restored);
+  requireSameRecord(*record, *restored);
+  REQUIRE(container == connection->getUUID());
+  REQUIRE(restored->getResourceClaim());
+  REQUIRE(restored->getContentFullPath() == record->getContentFullPath());
+}
+
+TEST_CASE("The compact format keeps claims outside of the content repository by their full path", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto record = createRecord(content_repo);
+  record->setResourceClaim(std::make_shared<minifi::ResourceClaim>("/some/other/directory/claim", content_repo));
+
+  minifi::io::BufferStream stream;
+  REQUIRE(record->Serialize(stream));
+
+  utils::Identifier container;
+  auto restored = minifi::FlowFileRecord::DeSerialize(stream, content_repo, container);
+  REQUIRE(restored);
+  REQUIRE(restored->getContentFullPath() == "/some/other/directory/claim");
+}
+
+TEST_CASE("The compact format restores FlowFiles without content without a claim", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto record = createRecord(content_repo);
+  record->setResourceClaim(nullptr);
+
+  minifi::io::BufferStream stream;
+  REQUIRE(record->Serialize(stream));
+
+  utils::Identifier container;
+  auto restored = minifi::FlowFileRecord::DeSerialize(stream, content_repo, container);
+  REQUIRE(restored);
+  requireSameRecord(*record, *restored);
+  REQUIRE_FALSE(restored->getResourceClaim());
+}
+
+TEST_CASE("Records in the original format can still be deserialized", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto record = createRecord(content_repo);
+  utils::Identifier container = utils::IdGenerator::getIdGenerator()->generate();
+
+  minifi::io::BufferStream stream;
+  serializeOriginal(*record, container, stream);
+
+  utils::Identifier restored_container;
+  auto restored = minifi::FlowFileRecord::DeSerialize(stream, content_repo, restored_container);
+  REQUIRE(restored);
+  requireSameRecord(*record, *restored);
+  REQUIRE(restored_container == container);
+  REQUIRE(restored->getContentFullPath() == record->getContentFullPath());
+}
+
+TEST_CASE("The compact format is smaller than the original one", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto record = createRecord(content_repo);
+
+  minifi::io::BufferStream original;
+  serializeOriginal(*record, utils::Identifier{}, original);
+  minifi::io::BufferStream compact;
+  REQUIRE(record->Serialize(compact));
+
+  REQUIRE(compact.size() < original.size());
+}
+
+TEST_CASE("Truncated compact records are rejected", "[FlowFileRecord]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto record = createRecord(content_repo);
+
+  minifi::io::BufferStream stream;
+  REQUIRE(record->Serialize(stream));
+
+  for (size_t size = 0; size < stream.size(); ++size) {
+    utils::Identifier container;
+    REQUIRE_FALSE(minifi::FlowFileRecord::DeSerialize(stream.getBuffer(), gsl::narrow<int>(size), content_repo, container));
+  }
+}
+
+TEST_CASE("FlowFileRecord serialization benchmark", "[.][benchmark]") {
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  std::vector<std::shared_ptr<minifi::FlowFileRecord>> records;
+  for (int i = 0; i < 100000; ++i) {
+    records.push_back(createRecord(content_repo));
+  }
+
+  const auto measure = [&](const std::string& name, const std::function<void(minifi::FlowFileRecord&, minifi::io::OutputStream&)>& serialize) {
+    std::vector<std::unique_ptr<minifi::io::BufferStream>> buffers;
+    buffers.reserve(records.size());
+    uint64_t total_size = 0;
+    const auto serialize_start = std::chrono::steady_clock::now();
+    for (const auto& record : records) {
+      buffers.push_back(utils::make_unique<minifi::io::BufferStream>());
+      serialize(*record, *buffers.back());
+      total_size += buffers.back()->size();
+    }
+    const auto deserialize_start = std::chrono::steady_clock::now();
+    for (const auto& buffer : buffers) {
+      utils::Identifier container;
+      REQUIRE(minifi::FlowFileRecord::DeSerialize(buffer->getBuffer(), gsl::narrow<int>(buffer->size()), content_repo, container));
+    }
+    const auto end = std::chrono::steady_clock::now();
+    WARN(name << ": " << total_size / records.size() << " bytes per FlowFile, serialize "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(deserialize_start - serialize_start).count() << " ms, deserialize "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - deserialize_start).count() << " ms for " << records.size() << " FlowFiles");
+  };
+
+  measure("original format", [](minifi::FlowFileRecord& record, minifi::io::OutputStream& stream) {
+    serializeOriginal(record, utils::Identifier{}, stream);
+  });
+  measure("compact format", [](minifi::FlowFileRecord& record, minifi::io::OutputStream& stream) {
+    record.Serialize(stream);
+  });
+}
@@ -0,0 +1,157 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/repository/HybridContentRepository.h"
+#include "utils/file/FileUtils.h"
+#include "utils/gsl.h"
+
+namespace {
+
+class HybridRepositoryController : public TestController {
+ public:
+  explicit HybridRepositoryController(const std::string& max_memory_size = "1 KB") {
+    char format[] = "/var/tmp/hybrid_repo.XXXXXX";
+    directory = createTempDirectory(format);
+    auto config = std::make_shared<minifi::Configure>();
+    config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, directory);
+    config->set(minifi::Configure::nifi_content_repository_memory_threshold, "10 B");
+    config->set(minifi::Configure::nifi_content_repository_memory_max_size, max_memory_size);
+    repository = std::make_shared<core::repository::HybridContentRepository>();
+    REQUIRE(repository->initialize(config));
+  }
+
+  std::string directory;
+  std::shared_ptr<core::repository::HybridContentRepository> repository;
+};
+
+void write(const std::shared_ptr<core::ContentSession>& session, const std::shared_ptr<minifi::ResourceClaim>& claim, const std::string& data,
+    core::ContentSession::WriteMode mode = core::ContentSession::WriteMode::OVERWRITE) {
+  const auto stream = session->write(claim, mode);
+  REQUIRE(stream->write(reinterpret_cast<const uint8_t*>(data.data()), gsl::narrow<int>(data.size())) == gsl::narrow<int>(data.size()));
+}
+
+std::string read(core::ContentRepository& repository, const minifi::ResourceClaim& claim) {
+  const auto stream = repository.read(claim);
+  REQUIRE(stream);
+  std::vector<uint8_t> buffer(stream->size());
+  if (!buffer.empty()) {
+    REQUIRE(stream->read(buffer.data(), gsl::narrow<int>(buffer.size())) == gsl::narrow<int>(buffer.size()));
+  }
+  return std::string(buffer.begin(), buffer.end());
+}
+
+bool isOnDisk(const minifi::ResourceClaim& claim) {
+  return utils::file::FileUtils::exists(claim.getContentFullPath());
+}
+
+}  // namespace
+
+TEST_CASE("HybridContentRepository keeps small content in memory and writes large content to disk", "[hybrid]") {
+  HybridRepositoryController controller;
+  auto session = controller.repository->createSession();
+  const auto small = session->create();
+  write(session, small, "small");
+  const auto large = session->create();
+  write(session, large, "larger than the threshold");
+  session->commit();
+
+  REQUIRE(controller.repository->isInMemory(*small));
+  REQUIRE_FALSE(isOnDisk(*small));
+  REQUIRE_FALSE(controller.repository->isInMemory(*large));
+  REQUIRE(isOnDisk(*large));
+  REQUIRE(controller.repository->getMemoryUsage() == 5);
+  REQUIRE(read(*controller.repository, *small) == "small");
+  REQUIRE(read(*controller.repository, *large) == "larger than the threshold");
+
+  REQUIRE(controller.repository->remove(*small));
+  REQUIRE_FALSE(controller.repository->exists(*small));
+  REQUIRE(controller.repository->getMemoryUsage() == 0);
+}
+
+TEST_CASE("HybridContentRepository writes content to disk once the memory budget is used up", "[hybrid]") {
+  HybridRepositoryController controller("12 B");
+  auto session = controller.repository->createSession();
+  const auto first = session->create();
+  write(session, first, "0123456789");
+  session->commit();
+  const auto second = session->create();
+  write(session, second, "abcdef");
+  session->commit();
+
+  REQUIRE(controller.repository->isInMemory(*first));
+  REQUIRE_FALSE(controller.repository->isInMemory(*second));
+  REQUIRE(read(*controller.repository, *second) == "abcdef");
+
+  controller.repository->remove(*first);
+  auto next_session = controller.repository->createSession();
+  const auto third = next_session->create();
+  write(next_session, third, "ghijkl");
+  next_session->commit();
+  REQUIRE(controller.repository->isInMemory(*third));
+}
+
+TEST_CASE("HybridContentRepository moves content to disk when appending makes it too large", "[hybrid]") {
+  HybridRepositoryController controller;
+  auto session = controller.repository->createSession();
+  const auto claim = session->create();
+  write(session, claim, "begin");
+  session->commit();
+
+  auto append_session = controller.repository->createSession();
+  write(append_session, claim, "-mid", core::ContentSession::WriteMode::APPEND);
+  append_session->commit();
+  REQUIRE(controller.repository->isInMemory(*claim));
+  REQUIRE(read(*controller.repository, *claim) == "begin-mid");
+
+  auto spilling_session = controller.repository->createSession();
+  write(spilling_session, claim, "-end", core::ContentSession::WriteMode::APPEND);
+  spilling_session->commit();
+  REQUIRE_FALSE(controller.repository->isInMemory(*claim));
+  REQUIRE(isOnDisk(*claim));
+  REQUIRE(controller.repository->getMemoryUsage() == 0);
+  REQUIRE(read(*controller.repository, *claim) == "begin-mid-end");
+}
+
+TEST_CASE("HybridContentRepository writes the content in memory to disk when stopped", "[hybrid]") {
+  HybridRepositoryController controller;
+  auto session = controller.repository->createSession();
+  const auto claim = session->create();
+  write(session, claim, "content");
+  session->commit();
+  REQUIRE_FALSE(isOnDisk(*claim));
+
+  controller.repository->stop();
+  REQUIRE(isOnDisk(*claim));
+  REQUIRE_FALSE(controller.repository->isInMemory(*claim));
+  REQUIRE(read(*controller.repository, *claim) == "content");
+}
+
+TEST_CASE("HybridContentRepository drops the content of rolled back sessions", "[hybrid]") {
+  HybridRepositoryController controller;
+  auto session = controller.repository->createSession();
+  const auto claim = session->create();
+  write(session, claim, "content");
+  session->rollback();
+
+  REQUIRE_FALSE(controller.repository->exists(*claim));
+  REQUIRE(controller.repository->getMemoryUsage() == 0);
+}
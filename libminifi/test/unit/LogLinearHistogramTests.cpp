@@ -0,0 +1,103 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/ProcessorStatistics.h"
+#include "utils/LogLinearHistogram.h"
+
+using utils::LogLinearHistogram;
+
+TEST_CASE("LogLinearHistogram buckets are accurate to the sub-bucket resolution", "[LogLinearHistogram]") {
+  for (uint64_t value = 0; value < LogLinearHistogram::SUB_BUCKET_COUNT * 2; ++value) {
+    REQUIRE(LogLinearHistogram::bucketUpperBound(LogLinearHistogram::bucketIndex(value)) == value);
+  }
+
+  size_t previous_index = 0;
+  for (uint64_t value = 1; value < (uint64_t{1} << 30); value = value * 3 / 2 + 1) {
+    const size_t index = LogLinearHistogram::bucketIndex(value);
+    REQUIRE(index >= previous_index);
+    REQUIRE(index < LogLinearHistogram::BUCKET_COUNT);
+    const uint64_t upper_bound = LogLinearHistogram::bucketUpperBound(index);
+    REQUIRE(upper_bound >= value);
+    REQUIRE(upper_bound - value <= value / LogLinearHistogram::SUB_BUCKET_COUNT);
+    if (index > 0) {
+      REQUIRE(LogLinearHistogram::bucketUpperBound(index - 1) < value);
+    }
+    previous_index = index;
+  }
+
+  REQUIRE(LogLinearHistogram::bucketIndex(UINT64_MAX) == LogLinearHistogram::BUCKET_COUNT - 1);
+}
+
+TEST_CASE("LogLinearHistogram reports percentiles", "[LogLinearHistogram]") {
+  LogLinearHistogram histogram;
+  {
+    LogLinearHistogram::Snapshot snapshot;
+    snapshot.add(histogram);
+    REQUIRE(snapshot.count() == 0);
+    REQUIRE(snapshot.percentile(0.99) == 0);
+  }
+
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.record(value);
+  }
+  LogLinearHistogram::Snapshot snapshot;
+  snapshot.add(histogram);
+  REQUIRE(snapshot.count() == 1000);
+  REQUIRE(snapshot.sum() == 500500);
+  REQUIRE(snapshot.mean() == 500);
+  REQUIRE(snapshot.max() == 1000);
+  REQUIRE(snapshot.percentile(0.0) == 1);
+  REQUIRE(snapshot.percentile(1.0) == 1000);
+
+  const uint64_t p50 = snapshot.percentile(0.5);
+  REQUIRE(p50 >= 500);
+  REQUIRE(p50 <= 500 + 500 / LogLinearHistogram::SUB_BUCKET_COUNT);
+  const uint64_t p99 = snapshot.percentile(0.99);
+  REQUIRE(p99 >= 990);
+  REQUIRE(p99 <= 1000);
+}
+
+TEST_CASE("ProcessorStatistics sums the samples of concurrent threads", "[ProcessorStatistics]") {
+  core::ProcessorStatistics statistics;
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < 8; ++thread_index) {
+    threads.emplace_back([&statistics] {
+      for (int i = 0; i < 1000; ++i) {
+        statistics.recordTrigger(std::chrono::microseconds(10), std::chrono::nanoseconds(100));
+        statistics.recordCommit(std::chrono::microseconds(1), 1, 10, 2, 20);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto snapshot = statistics.getSnapshot();
+  REQUIRE(snapshot.triggers == 8000);
+  REQUIRE(snapshot.commits == 8000);
+  REQUIRE(snapshot.cpu_time == std::chrono::nanoseconds(800000));
+  REQUIRE(snapshot.flow_files_in == 8000);
+  REQUIRE(snapshot.bytes_in == 80000);
+  REQUIRE(snapshot.flow_files_out == 16000);
+  REQUIRE(snapshot.bytes_out == 160000);
+  REQUIRE(snapshot.trigger_duration.max() == 10);
+  REQUIRE(snapshot.commit_duration.percentile(0.5) == 1);
+}
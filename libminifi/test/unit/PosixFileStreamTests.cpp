@@ -0,0 +1,312 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WIN32
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/repository/FileSystemRepository.h"
+#include "io/ContentView.h"
+#include "io/FileStream.h"
+#include "io/FileStreamFactory.h"
+#include "io/PosixFileStream.h"
+#include "io/StreamSlice.h"
+#include "utils/file/FileUtils.h"
+#include "utils/gsl.h"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+int write(minifi::io::BaseStream& stream, const std::string& data) {
+  return stream.write(reinterpret_cast<const uint8_t*>(data.data()), gsl::narrow<int>(data.size()));
+}
+
+std::string read(minifi::io::BaseStream& stream, size_t size) {
+  std::vector<uint8_t> buffer(size);
+  const int read = stream.read(buffer.data(), gsl::narrow<int>(size));
+  REQUIRE(read >= 0);
+  return std::string(buffer.begin(), buffer.begin() + read);
+}
+
+}  // namespace
+
+TEST_CASE("PosixFileStream overwrites part of an existing file", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "file");
+  writeFile(path, "tempFile");
+
+  minifi::io::PosixFileStream stream(path, 0, true);
+  REQUIRE(8 == stream.size());
+  REQUIRE("tempFile" == read(stream, stream.size()));
+  stream.seek(4);
+  REQUIRE(4 == write(stream, "file"));
+  stream.seek(0);
+  REQUIRE("tempfile" == read(stream, stream.size()));
+  REQUIRE(0 == stream.read(nullptr, 0));
+  REQUIRE("" == read(stream, 1));
+  stream.close();
+  REQUIRE("tempfile" == readFile(path));
+}
+
+TEST_CASE("PosixFileStream buffers writes until the stream is flushed", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "file");
+
+  minifi::io::PosixFileStream stream(path, minifi::io::PosixFileStream::WriteMode::TRUNCATE);
+  REQUIRE(5 == write(stream, "hello"));
+  REQUIRE(5 == stream.size());
+  REQUIRE(readFile(path).empty());
+
+  SECTION("flush") {
+    REQUIRE(stream.flush());
+    REQUIRE("hello" == readFile(path));
+  }
+  SECTION("sync") {
+    REQUIRE(stream.sync());
+    REQUIRE("hello" == readFile(path));
+  }
+  SECTION("read") {
+    stream.seek(1);
+    REQUIRE("ell" == read(stream, 3));
+    REQUIRE("hello" == readFile(path));
+  }
+  SECTION("close") {
+    stream.close();
+    REQUIRE("hello" == readFile(path));
+    REQUIRE(-1 == write(stream, "closed"));
+  }
+}
+
+TEST_CASE("PosixFileStream appends to or truncates existing files", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "file");
+  writeFile(path, "head");
+
+  SECTION("append") {
+    minifi::io::PosixFileStream(path, minifi::io::PosixFileStream::WriteMode::APPEND, true).write(reinterpret_cast<const uint8_t*>("-tail"), 5);
+    REQUIRE("head-tail" == readFile(path));
+  }
+  SECTION("truncate") {
+    minifi::io::PosixFileStream(path, minifi::io::PosixFileStream::WriteMode::TRUNCATE).write(reinterpret_cast<const uint8_t*>("new"), 3);
+    REQUIRE("new" == readFile(path));
+  }
+}
+
+TEST_CASE("PosixFileStream writes content larger than its buffer", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "file");
+  const std::string small(100, 'a');
+  const std::string large(3 * minifi::io::PosixFileStream::WRITE_BUFFER_SIZE, 'b');
+
+  {
+    minifi::io::PosixFileStream stream(path, minifi::io::PosixFileStream::WriteMode::TRUNCATE);
+    REQUIRE(gsl::narrow<int>(small.size()) == write(stream, small));
+    REQUIRE(gsl::narrow<int>(large.size()) == write(stream, large));
+    REQUIRE(gsl::narrow<int>(small.size()) == write(stream, small));
+  }
+  REQUIRE(small + large + small == readFile(path));
+
+  minifi::io::PosixFileStream stream(path, 0, false);
+  REQUIRE(small + large + small == read(stream, stream.size()));
+}
+
+TEST_CASE("PosixFileStream reports files that cannot be opened", "[posixfilestream]") {
+  minifi::io::PosixFileStream stream("/this/path/does/not/exist", 0, false);
+  REQUIRE(0 == stream.size());
+  uint8_t buffer[4];
+  REQUIRE(-1 == stream.read(buffer, 4));
+  REQUIRE(-1 == stream.write(buffer, 4));
+}
+
+TEST_CASE("PosixFileStream reports buffered writes that could not be stored", "[posixfilestream]") {
+#ifdef __linux__
+  // every write to /dev/full fails with ENOSPC
+  minifi::io::PosixFileStream stream("/dev/full", minifi::io::PosixFileStream::WriteMode::APPEND);
+  REQUIRE(5 == write(stream, "hello"));
+  SECTION("flush") {
+    REQUIRE_FALSE(stream.flush());
+  }
+  SECTION("seek") {
+    stream.seek(0);
+    REQUIRE_FALSE(stream.flush());
+  }
+  SECTION("close") {
+    stream.close();
+    REQUIRE_FALSE(stream.flush());
+  }
+#endif
+}
+
+TEST_CASE("File streams map their remaining content into memory", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "file");
+  // the slice starts after the first page, so that the mapping has to be aligned
+  const std::string padding(5000, '-');
+  writeFile(path, padding + "content" + padding);
+
+  std::shared_ptr<minifi::io::BaseStream> stream;
+  SECTION("FileStream") {
+    stream = std::make_shared<minifi::io::FileStream>(path, 0, false);
+  }
+  SECTION("PosixFileStream") {
+    stream = std::make_shared<minifi::io::PosixFileStream>(path, 0);
+  }
+  minifi::io::StreamSlice slice(stream, padding.size(), 7);
+  const auto view = slice.map(100);
+  REQUIRE(view);
+  REQUIRE(view->isMapped());
+  REQUIRE("content" == view->toString());
+  REQUIRE("cont" == slice.map(4)->toString());
+
+  stream->seek(2 * padding.size() + 5);
+  REQUIRE(2 == stream->map(100)->size());
+}
+
+TEST_CASE("FileStreamFactory is configured from minifi.properties", "[posixfilestream]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  minifi::io::FileStreamFactory factory;
+  REQUIRE(factory.getImplementation() == minifi::io::FileStreamFactory::Implementation::FSTREAM);
+  REQUIRE(factory.getDurability() == minifi::io::FileStreamFactory::Durability::NONE);
+
+  SECTION("posix with sync on close") {
+    configuration->set(minifi::Configure::nifi_content_repository_file_stream, "posix");
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "close");
+    REQUIRE(factory.initialize(configuration));
+    REQUIRE(factory.getImplementation() == minifi::io::FileStreamFactory::Implementation::POSIX);
+    REQUIRE(factory.getDurability() == minifi::io::FileStreamFactory::Durability::SYNC_ON_CLOSE);
+    REQUIRE(std::dynamic_pointer_cast<minifi::io::PosixFileStream>(factory.openForRead("/tmp")));
+  }
+  SECTION("fstream syncs on commit instead of on close") {
+    configuration->set(minifi::Configure::nifi_content_repository_file_stream, "fstream");
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "close");
+    REQUIRE(factory.initialize(configuration));
+    REQUIRE(factory.getDurability() == minifi::io::FileStreamFactory::Durability::SYNC_ON_COMMIT);
+    REQUIRE(std::dynamic_pointer_cast<minifi::io::FileStream>(factory.openForRead("/tmp")));
+  }
+  SECTION("invalid values") {
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "always");
+    REQUIRE_FALSE(factory.initialize(configuration));
+  }
+}
+
+TEST_CASE("FileStreamFactory syncs directories", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  REQUIRE(minifi::io::FileStreamFactory::syncDirectory(controller.createTempDirectory(format)));
+  REQUIRE_FALSE(minifi::io::FileStreamFactory::syncDirectory("/this/path/does/not/exist"));
+}
+
+TEST_CASE("Streaming content sessions publish their content with the configured durability", "[posixfilestream]") {
+  TestController controller;
+  char format[] = "/tmp/posix_stream.XXXXXX";
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, controller.createTempDirectory(format));
+  configuration->set(minifi::Configure::nifi_content_repository_streaming_session, "true");
+  SECTION("posix without sync") {
+    configuration->set(minifi::Configure::nifi_content_repository_file_stream, "posix");
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "none");
+  }
+  SECTION("posix with sync on close") {
+    configuration->set(minifi::Configure::nifi_content_repository_file_stream, "posix");
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "close");
+  }
+  SECTION("fstream with sync on commit") {
+    configuration->set(minifi::Configure::nifi_content_repository_file_stream, "fstream");
+    configuration->set(minifi::Configure::nifi_content_repository_durability, "commit");
+  }
+  auto repository = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(repository->initialize(configuration));
+
+  std::shared_ptr<minifi::ResourceClaim> claim;
+  {
+    auto session = repository->createSession();
+    claim = session->create();
+    REQUIRE(write(*session->write(claim), "staged") == 6);
+    session->commit();
+  }
+  {
+    auto session = repository->createSession();
+    REQUIRE(write(*session->write(claim, core::ContentSession::WriteMode::APPEND), " content") == 8);
+    session->commit();
+  }
+  REQUIRE("staged content" == readFile(claim->getContentFullPath()));
+}
+
+namespace {
+
+std::chrono::milliseconds writeAndReadContent(const std::string& file_stream, const std::string& durability, size_t flow_file_count, size_t flow_file_size) {
+  TestController controller;
+  char format[] = "/var/tmp/file_stream_benchmark.XXXXXX";
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, controller.createTempDirectory(format));
+  configuration->set(minifi::Configure::nifi_content_repository_file_stream, file_stream);
+  configuration->set(minifi::Configure::nifi_content_repository_durability, durability);
+  auto repository = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(repository->initialize(configuration));
+
+  const std::string chunk(1024, 'x');
+  std::vector<uint8_t> buffer(chunk.size());
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < flow_file_count; ++i) {
+    minifi::ResourceClaim claim(repository);
+    {
+      const auto output = repository->write(claim);
+      for (size_t written = 0; written < flow_file_size; written += chunk.size()) {
+        REQUIRE(write(*output, chunk) == gsl::narrow<int>(chunk.size()));
+      }
+    }
+    const auto input = repository->read(claim);
+    while (input->read(buffer.data(), gsl::narrow<int>(buffer.size())) > 0) {}
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+TEST_CASE("Content repository throughput with fstream and POSIX file streams", "[.][benchmark]") {
+  const size_t flow_file_count = 1000;
+  const size_t flow_file_size = 1024 * 1024;
+  for (const auto& durability : {"none", "close"}) {
+    const auto fstream = writeAndReadContent("fstream", durability, flow_file_count, flow_file_size);
+    const auto posix = writeAndReadContent("posix", durability, flow_file_count, flow_file_size);
+    WARN(flow_file_count << " flow files of " << flow_file_size << " bytes written in 1 KB chunks, durability: " << durability << "\n"
+        << "fstream: " << fstream.count() << " ms\n"
+        << "posix:   " << posix.count() << " ms");
+  }
+}
+
+#endif  // WIN32
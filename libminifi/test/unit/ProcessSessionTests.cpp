@@ -19,6 +19,7 @@
 
 #include <catch.hpp>
 #include "core/ProcessSession.h"
+#include "io/BufferStream.h"
 #include "../TestBase.h"
 
 namespace {
@@ -102,3 +103,60 @@ TEST_CASE("ProcessSession::rollback penalizes affected flowfiles", "[rollback]")
   next_flow_file_to_be_processed = process_session.get();
   REQUIRE(next_flow_file_to_be_processed == flow_file_3);
 }
+
+TEST_CASE("ProcessSession::get can get a batch of flowfiles limited by count and size", "[getBatch]") {
+  Fixture fixture;
+  core::ProcessSession &process_session = fixture.processSession();
+
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  for (int i = 0; i < 5; ++i) {
+    flow_files.push_back(process_session.create());
+    process_session.importFrom(minifi::io::BufferStream{std::string(10, 'x')}, flow_files.back());
+    process_session.transfer(flow_files.back(), Success);
+  }
+  process_session.commit();
+
+  const auto first_batch = process_session.get(2);
+  REQUIRE(first_batch == (std::vector<std::shared_ptr<core::FlowFile>>{flow_files[0], flow_files[1]}));
+
+  // the flowfile crossing the size limit is still part of the batch
+  const auto second_batch = process_session.get(10, 15);
+  REQUIRE(second_batch == (std::vector<std::shared_ptr<core::FlowFile>>{flow_files[2], flow_files[3]}));
+
+  const auto third_batch = process_session.get(10);
+  REQUIRE(third_batch == std::vector<std::shared_ptr<core::FlowFile>>{flow_files[4]});
+
+  REQUIRE(process_session.get(10).empty());
+}
+
+TEST_CASE("ProcessSession::readView and readBuffer return the content of the flowfile", "[readView]") {
+  Fixture fixture;
+  core::ProcessSession &process_session = fixture.processSession();
+
+  const auto flow_file = process_session.create();
+  process_session.importFrom(minifi::io::BufferStream{std::string("content of the flowfile")}, flow_file);
+  const auto empty_flow_file = process_session.create();
+  process_session.transfer(flow_file, Success);
+  process_session.transfer(empty_flow_file, Success);
+  process_session.commit();
+
+  REQUIRE("content of the flowfile" == process_session.readView(flow_file)->toString());
+  REQUIRE("content" == process_session.readView(flow_file, 7)->toString());
+  REQUIRE(0 == process_session.readView(empty_flow_file)->size());
+  const auto buffer = process_session.readBuffer(flow_file);
+  REQUIRE("content of the flowfile" == std::string(buffer.begin(), buffer.end()));
+}
+
+TEST_CASE("ProcessSession::mapView does not copy content that cannot be mapped", "[readView]") {
+  Fixture fixture;
+  core::ProcessSession &process_session = fixture.processSession();
+
+  const auto flow_file = process_session.create();
+  process_session.importFrom(minifi::io::BufferStream{std::string("content of the flowfile")}, flow_file);
+  process_session.transfer(flow_file, Success);
+  process_session.commit();
+
+  // the fixture uses the VolatileContentRepository, which cannot map its content
+  REQUIRE(nullptr == process_session.mapView(flow_file));
+  REQUIRE("content of the flowfile" == process_session.readView(flow_file)->toString());
+}
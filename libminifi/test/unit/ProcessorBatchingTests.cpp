@@ -0,0 +1,145 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "../TestBase.h"
+#include "core/Processor.h"
+
+namespace {
+
+// creates a flow file in every trigger, until the given number of triggers yielding or being idle
+class BatchingTestProcessor : public core::Processor {
+ public:
+  explicit BatchingTestProcessor(const std::string& name)
+      : Processor(name) {
+  }
+
+  using Processor::onTrigger;
+
+  static core::Relationship Success;
+
+  void initialize() override {
+    setSupportedRelationships({Success});
+  }
+
+  bool supportsBatching() const override {
+    return supports_batching_;
+  }
+
+  void onTrigger(core::ProcessContext* /*context*/, core::ProcessSession* session) override {
+    ++triggers_;
+    if (triggers_ == idle_after_) {
+      return;
+    }
+    session->transfer(session->create(), Success);
+    if (triggers_ == yield_after_) {
+      yield();
+    }
+  }
+
+  bool supports_batching_ = true;
+  int triggers_ = 0;
+  int yield_after_ = 0;
+  int idle_after_ = 0;
+};
+
+core::Relationship BatchingTestProcessor::Success("success", "description");
+
+struct BatchingTestFixture {
+  BatchingTestFixture()
+      : plan(test_controller.createPlan()),
+        processor(std::make_shared<BatchingTestProcessor>("batching")) {
+    plan->addProcessor(processor, "batching");
+    processor->setAutoTerminatedRelationships({BatchingTestProcessor::Success});
+    processor->incrementActiveTasks();
+    processor->setScheduledState(core::ScheduledState::RUNNING);
+    context = plan->getProcessContextForProcessor(processor);
+    session_factory = std::make_shared<core::ProcessSessionFactory>(context);
+  }
+
+  void trigger() {
+    processor->onTrigger(context, session_factory);
+  }
+
+  uint64_t getCommits() const {
+    return processor->getStatistics().getSnapshot().commits;
+  }
+
+  TestController test_controller;
+  std::shared_ptr<TestPlan> plan;
+  std::shared_ptr<BatchingTestProcessor> processor;
+  std::shared_ptr<core::ProcessContext> context;
+  std::shared_ptr<core::ProcessSessionFactory> session_factory;
+};
+
+}  // namespace
+
+TEST_CASE("Every trigger is committed without a run duration", "[ProcessorBatching]") {
+  BatchingTestFixture fixture;
+  fixture.processor->setMaxBatchSize(10);
+
+  fixture.trigger();
+  fixture.trigger();
+  REQUIRE(fixture.processor->triggers_ == 2);
+  REQUIRE(fixture.getCommits() == 2);
+}
+
+TEST_CASE("Triggers are batched in a session over the run duration", "[ProcessorBatching]") {
+  BatchingTestFixture fixture;
+  fixture.processor->setRunDurationNano(std::chrono::nanoseconds(std::chrono::seconds(10)).count());
+  fixture.processor->setMaxBatchSize(10);
+
+  SECTION("until the batch is full") {
+    fixture.trigger();
+    REQUIRE(fixture.processor->triggers_ == 10);
+    REQUIRE(fixture.getCommits() == 1);
+  }
+
+  SECTION("until the processor yields") {
+    fixture.processor->yield_after_ = 3;
+    fixture.trigger();
+    REQUIRE(fixture.processor->triggers_ == 3);
+    REQUIRE(fixture.getCommits() == 1);
+  }
+
+  SECTION("until a trigger finds nothing to do") {
+    fixture.processor->idle_after_ = 4;
+    fixture.trigger();
+    REQUIRE(fixture.processor->triggers_ == 4);
+    REQUIRE(fixture.getCommits() == 1);
+  }
+
+  SECTION("unless the processor does not support batching") {
+    fixture.processor->supports_batching_ = false;
+    fixture.trigger();
+    REQUIRE(fixture.processor->triggers_ == 1);
+    REQUIRE(fixture.getCommits() == 1);
+  }
+}
+
+TEST_CASE("A batch ends when the run duration elapses", "[ProcessorBatching]") {
+  BatchingTestFixture fixture;
+  fixture.processor->setRunDurationNano(std::chrono::nanoseconds(std::chrono::milliseconds(20)).count());
+
+  const auto start = std::chrono::steady_clock::now();
+  fixture.trigger();
+  REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+  REQUIRE(fixture.processor->triggers_ > 1);
+  REQUIRE(fixture.getCommits() == 1);
+}
@@ -0,0 +1,177 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "FlowFileRecord.h"
+#include "core/ProcessGroup.h"
+#include "provenance/ProvenanceSampler.h"
+
+using minifi::provenance::ProvenanceEventRecord;
+using minifi::provenance::ProvenanceSampler;
+
+TEST_CASE("ProvenanceSampler keeps one in every 1/rate events", "[provenanceSampler]") {
+  ProvenanceSampler sampler("group", 0.25, {}, std::chrono::minutes(1));
+  size_t kept = 0;
+  for (size_t i = 0; i < 100; ++i) {
+    kept += sampler.sample("processor", ProvenanceEventRecord::ROUTE, 10, 1) ? 1 : 0;
+  }
+  REQUIRE(kept == 25);
+}
+
+TEST_CASE("ProvenanceSampler follows rates that are not one in every N events", "[provenanceSampler]") {
+  ProvenanceSampler sampler("group", 0.3, {}, std::chrono::minutes(1));
+  size_t kept = 0;
+  for (size_t i = 0; i < 1000; ++i) {
+    kept += sampler.sample("processor", ProvenanceEventRecord::ROUTE, 10, 1) ? 1 : 0;
+  }
+  REQUIRE(kept == 300);
+}
+
+TEST_CASE("ProvenanceSampler always keeps the listed event types", "[provenanceSampler]") {
+  ProvenanceSampler sampler("group", 0.0, {ProvenanceEventRecord::SEND, ProvenanceEventRecord::DROP}, std::chrono::minutes(1));
+  for (size_t i = 0; i < 10; ++i) {
+    REQUIRE_FALSE(sampler.sample("processor", ProvenanceEventRecord::ROUTE, 10, 1));
+    REQUIRE(sampler.sample("processor", ProvenanceEventRecord::SEND, 10, 1));
+    REQUIRE(sampler.sample("processor", ProvenanceEventRecord::DROP, 10, 1));
+  }
+}
+
+TEST_CASE("ProvenanceSampler aggregates every event", "[provenanceSampler]") {
+  ProvenanceSampler sampler("group", 0.0, {ProvenanceEventRecord::SEND}, std::chrono::hours(24));
+  for (size_t i = 0; i < 10; ++i) {
+    sampler.sample("A", ProvenanceEventRecord::ROUTE, 10, 2);
+  }
+  sampler.sample("A", ProvenanceEventRecord::SEND, 100, 5);
+  sampler.sample("B", ProvenanceEventRecord::ROUTE, 7, 3);
+
+  const auto metrics = sampler.getMetrics();
+  REQUIRE(metrics->getName() == "ProvenanceAggregates-group");
+  auto windows = metrics->getWindows();
+  // the events of the test can only straddle a day boundary at midnight UTC
+  REQUIRE(windows.size() <= 2);
+  minifi::provenance::ProvenanceAggregateMetrics::Window total;
+  for (const auto& window : windows) {
+    for (const auto& entry : window.second) {
+      auto& aggregate = total[entry.first];
+      aggregate.count += entry.second.count;
+      aggregate.bytes += entry.second.bytes;
+      aggregate.duration += entry.second.duration;
+    }
+  }
+  REQUIRE(total.size() == 3);
+  const auto& a_route = total[std::make_pair(std::string("A"), ProvenanceEventRecord::ROUTE)];
+  REQUIRE(a_route.count == 10);
+  REQUIRE(a_route.bytes == 100);
+  REQUIRE(a_route.duration == 20);
+  const auto& a_send = total[std::make_pair(std::string("A"), ProvenanceEventRecord::SEND)];
+  REQUIRE(a_send.count == 1);
+  REQUIRE(a_send.bytes == 100);
+  const auto& b_route = total[std::make_pair(std::string("B"), ProvenanceEventRecord::ROUTE)];
+  REQUIRE(b_route.count == 1);
+  REQUIRE(b_route.duration == 3);
+  REQUIRE_FALSE(metrics->serialize().empty());
+}
+
+TEST_CASE("ProvenanceAggregateMetrics keeps the most recent windows", "[provenanceSampler]") {
+  minifi::provenance::ProvenanceAggregateMetrics metrics("group", std::chrono::milliseconds(10), 3);
+  for (uint64_t time = 0; time < 100; time += 5) {
+    metrics.add("A", ProvenanceEventRecord::ROUTE, 1, 1, time);
+  }
+  const auto windows = metrics.getWindows();
+  REQUIRE(windows.size() == 3);
+  REQUIRE(windows.begin()->first == 70);
+  REQUIRE(windows.rbegin()->first == 90);
+  REQUIRE(windows.rbegin()->second.begin()->second.count == 2);
+}
+
+TEST_CASE("ProvenanceAggregateMetrics merges the events added by several threads", "[provenanceSampler]") {
+  minifi::provenance::ProvenanceAggregateMetrics metrics("group", std::chrono::hours(1), 3);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 8; ++i) {
+    threads.emplace_back([&metrics] {
+      for (size_t j = 0; j < 1000; ++j) {
+        metrics.add("A", ProvenanceEventRecord::ROUTE, 2, 1, 0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto windows = metrics.getWindows();
+  REQUIRE(windows.size() == 1);
+  const auto& aggregate = windows.begin()->second.at(std::make_pair(std::string("A"), ProvenanceEventRecord::ROUTE));
+  REQUIRE(aggregate.count == 8000);
+  REQUIRE(aggregate.bytes == 16000);
+}
+
+TEST_CASE("ProvenanceReporter does not format the details of events that are not kept", "[provenanceSampler]") {
+  auto repo = std::make_shared<TestRepository>();
+  minifi::provenance::ProvenanceReporter reporter(repo, "processor", "processor");
+  reporter.setSampler(std::make_shared<ProvenanceSampler>("group", 0.0, std::set<ProvenanceEventRecord::ProvenanceEventType>{ProvenanceEventRecord::CREATE},
+      std::chrono::minutes(1)));
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+
+  size_t formatted = 0;
+  reporter.create(flow_file, [&] { ++formatted; return std::string("created"); });
+  reporter.modifyAttributes(flow_file, [&] { ++formatted; return std::string("modified attributes"); });
+  reporter.modifyContent(flow_file, [&] { ++formatted; return std::string("modified content"); }, 10);
+  reporter.route(flow_file, core::Relationship("success", ""), "routed", 10);
+
+  REQUIRE(formatted == 1);
+  const auto events = reporter.getEvents();
+  REQUIRE(events.size() == 1);
+  REQUIRE((*events.begin())->getEventType() == ProvenanceEventRecord::CREATE);
+  REQUIRE((*events.begin())->getDetails() == "created");
+}
+
+TEST_CASE("Process groups pass their provenance sampler to their processors and inheriting child groups", "[provenanceSampler]") {
+  TestController test_controller;
+  auto sampler = std::make_shared<ProvenanceSampler>("root", 0.5, std::set<ProvenanceEventRecord::ProvenanceEventType>{}, std::chrono::minutes(1));
+
+  auto root = utils::make_unique<core::ProcessGroup>(core::ROOT_PROCESS_GROUP, "root");
+  auto root_processor = std::make_shared<core::Processor>("root_processor");
+  root->addProcessor(root_processor);
+
+  auto inheriting = utils::make_unique<core::ProcessGroup>(core::SIMPLE_PROCESS_GROUP, "inheriting");
+  auto inheriting_processor = std::make_shared<core::Processor>("inheriting_processor");
+  inheriting->addProcessor(inheriting_processor);
+
+  auto full = utils::make_unique<core::ProcessGroup>(core::SIMPLE_PROCESS_GROUP, "full");
+  full->setProvenanceSampler(nullptr);
+  auto full_processor = std::make_shared<core::Processor>("full_processor");
+  full->addProcessor(full_processor);
+
+  root->addProcessGroup(std::move(inheriting));
+  root->setProvenanceSampler(sampler);
+  root->addProcessGroup(std::move(full));
+
+  REQUIRE(root_processor->getProvenanceSampler() == sampler);
+  REQUIRE(inheriting_processor->getProvenanceSampler() == sampler);
+  REQUIRE(full_processor->getProvenanceSampler() == nullptr);
+
+  auto late_processor = std::make_shared<core::Processor>("late_processor");
+  root->addProcessor(late_processor);
+  REQUIRE(late_processor->getProvenanceSampler() == sampler);
+}
@@ -0,0 +1,237 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/repository/FileSystemRepository.h"
+#include "core/repository/SlabFileSystemRepository.h"
+#include "io/StreamSlice.h"
+#include "utils/file/FileUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/gsl.h"
+
+namespace {
+
+class SlabRepositoryController : public TestController {
+ public:
+  explicit SlabRepositoryController(const std::string& max_slab_size = "1 MB") {
+    char format[] = "/var/tmp/slab_repo.XXXXXX";
+    directory = createTempDirectory(format);
+    config = std::make_shared<minifi::Configure>();
+    config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, directory);
+    config->set(minifi::Configure::nifi_content_repository_slab_max_size, max_slab_size);
+    // reclaim() is called explicitly by the tests
+    config->set(minifi::Configure::nifi_content_repository_slab_reclaim_period, "1 hour");
+    repository = std::make_shared<core::repository::SlabFileSystemRepository>();
+    REQUIRE(repository->initialize(config));
+  }
+
+  void restart() {
+    repository->stop();
+    repository = std::make_shared<core::repository::SlabFileSystemRepository>();
+    REQUIRE(repository->initialize(config));
+  }
+
+  size_t countSlabs() const {
+    size_t count = 0;
+    utils::file::FileUtils::list_dir(directory, [&](const std::string&, const std::string& filename) {
+      if (utils::StringUtils::endsWith(filename, core::repository::SlabFileSystemRepository::SLAB_FILE_EXTENSION)) {
+        ++count;
+      }
+      return true;
+    }, logging::LoggerFactory<core::repository::SlabFileSystemRepository>::getLogger(), false);
+    return count;
+  }
+
+  std::string directory;
+  std::shared_ptr<minifi::Configure> config;
+  std::shared_ptr<core::repository::SlabFileSystemRepository> repository;
+};
+
+void write(const std::shared_ptr<core::ContentSession>& session, const std::shared_ptr<minifi::ResourceClaim>& claim, const std::string& data,
+    core::ContentSession::WriteMode mode = core::ContentSession::WriteMode::OVERWRITE) {
+  const auto stream = session->write(claim, mode);
+  REQUIRE(stream->write(reinterpret_cast<const uint8_t*>(data.data()), gsl::narrow<int>(data.size())) == gsl::narrow<int>(data.size()));
+}
+
+std::string read(core::ContentRepository& repository, const minifi::ResourceClaim& claim, uint64_t offset, uint64_t size) {
+  minifi::io::StreamSlice stream(repository.read(claim), offset, size);
+  std::vector<uint8_t> buffer(gsl::narrow<size_t>(size));
+  REQUIRE(stream.read(buffer.data(), gsl::narrow<int>(size)) == gsl::narrow<int>(size));
+  return std::string(buffer.begin(), buffer.end());
+}
+
+}  // namespace
+
+TEST_CASE("SlabFileSystemRepository packs the claims of a session into a slab", "[slab]") {
+  SlabRepositoryController controller;
+  auto session = controller.repository->createSession();
+
+  const auto claim1 = session->create();
+  write(session, claim1, "first");
+  const auto claim2 = session->create();
+  write(session, claim2, "second");
+  const auto claim3 = session->create();
+  write(session, claim3, "third");
+
+  REQUIRE(claim1->getContentFullPath() == claim2->getContentFullPath());
+  REQUIRE(claim2->getContentFullPath() == claim3->getContentFullPath());
+  REQUIRE(0 == session->getWriteOffset(claim1));
+  REQUIRE(5 == session->getWriteOffset(claim2));
+  REQUIRE(11 == session->getWriteOffset(claim3));
+
+  session->commit();
+  REQUIRE(1 == controller.countSlabs());
+  REQUIRE("first" == read(*controller.repository, *claim1, 0, 5));
+  REQUIRE("second" == read(*controller.repository, *claim2, 5, 6));
+  REQUIRE("third" == read(*controller.repository, *claim3, 11, 5));
+
+  SECTION("the next session continues the slab") {
+    auto next_session = controller.repository->createSession();
+    const auto claim4 = next_session->create();
+    write(next_session, claim4, "fourth");
+    REQUIRE(claim4->getContentFullPath() == claim1->getContentFullPath());
+    REQUIRE(16 == next_session->getWriteOffset(claim4));
+    next_session->commit();
+    REQUIRE("fourth" == read(*controller.repository, *claim4, 16, 6));
+  }
+}
+
+TEST_CASE("SlabFileSystemRepository moves a region to the end of the slab when appending to it", "[slab]") {
+  SlabRepositoryController controller;
+  auto session = controller.repository->createSession();
+
+  const auto claim1 = session->create();
+  write(session, claim1, "begin");
+  REQUIRE(session->canAppend(claim1));
+  const auto claim2 = session->create();
+  write(session, claim2, "other");
+  REQUIRE_FALSE(session->canAppend(claim1));
+  REQUIRE(session->canAppend(claim2));
+
+  write(session, claim1, "-end", core::ContentSession::WriteMode::APPEND);
+  REQUIRE(10 == session->getWriteOffset(claim1));
+  session->commit();
+
+  REQUIRE("begin-end" == read(*controller.repository, *claim1, 10, 9));
+  REQUIRE("other" == read(*controller.repository, *claim2, 5, 5));
+}
+
+TEST_CASE("SlabFileSystemRepository deletes slabs that are no longer referenced", "[slab]") {
+  SlabRepositoryController controller("10 B");
+  auto session = controller.repository->createSession();
+  auto claim1 = session->create();
+  write(session, claim1, "0123456789");
+  auto claim2 = session->create();
+  write(session, claim2, "abc");
+  REQUIRE(claim1->getContentFullPath() != claim2->getContentFullPath());
+  session->commit();
+  REQUIRE(2 == controller.countSlabs());
+
+  controller.repository->reclaim();
+  REQUIRE(2 == controller.countSlabs());
+
+  SECTION("sealed slab") {
+    claim1.reset();
+    controller.repository->reclaim();
+    REQUIRE(1 == controller.countSlabs());
+  }
+  SECTION("slab waiting to be reused") {
+    claim2.reset();
+    controller.repository->reclaim();
+    REQUIRE(1 == controller.countSlabs());
+  }
+  SECTION("rolled back content") {
+    auto rolled_back = controller.repository->createSession();
+    write(rolled_back, rolled_back->create(), "garbage");
+    rolled_back->rollback();
+    claim1.reset();
+    claim2.reset();
+    controller.repository->reclaim();
+    REQUIRE(0 == controller.countSlabs());
+  }
+}
+
+TEST_CASE("SlabFileSystemRepository deletes the slabs of the previous run that no restored FlowFile refers to", "[slab]") {
+  SlabRepositoryController controller("10 B");
+  std::string referenced_path;
+  {
+    auto session = controller.repository->createSession();
+    auto claim1 = session->create();
+    write(session, claim1, "0123456789");
+    auto claim2 = session->create();
+    write(session, claim2, "abc");
+    session->commit();
+    referenced_path = claim1->getContentFullPath();
+  }
+  REQUIRE(2 == controller.countSlabs());
+
+  controller.restart();
+  // the FlowFile restored from the FlowFile repository refers to the first slab
+  const auto restored_claim = std::make_shared<minifi::ResourceClaim>(referenced_path, controller.repository);
+  controller.repository->reclaim();
+  REQUIRE(2 == controller.countSlabs());
+
+  controller.repository->clearOrphans();
+  controller.repository->reclaim();
+  REQUIRE(1 == controller.countSlabs());
+  REQUIRE("0123456789" == read(*controller.repository, *restored_claim, 0, 10));
+}
+
+namespace {
+
+template<typename ContentRepositoryClass>
+std::chrono::milliseconds writeAndRemoveSmallFlowFiles(size_t flow_file_count, size_t batch_size, size_t flow_file_size) {
+  TestController controller;
+  char format[] = "/var/tmp/content_benchmark.XXXXXX";
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, controller.createTempDirectory(format));
+  auto repository = std::make_shared<ContentRepositoryClass>();
+  REQUIRE(repository->initialize(config));
+
+  const std::string content(flow_file_size, 'x');
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t written = 0; written < flow_file_count; written += batch_size) {
+    std::vector<std::shared_ptr<minifi::ResourceClaim>> claims;
+    auto session = repository->createSession();
+    for (size_t i = 0; i < batch_size; ++i) {
+      claims.push_back(session->create());
+      write(session, claims.back(), content);
+    }
+    session->commit();
+    // the claims are released here, as if the flow files were transferred out of the agent
+  }
+  repository->stop();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+TEST_CASE("Small FlowFile throughput of the FileSystemRepository and the SlabFileSystemRepository", "[.][benchmark]") {
+  const size_t flow_file_count = 100000;
+  const size_t batch_size = 100;
+  const size_t flow_file_size = 256;
+  const auto file_system = writeAndRemoveSmallFlowFiles<core::repository::FileSystemRepository>(flow_file_count, batch_size, flow_file_size);
+  const auto slab = writeAndRemoveSmallFlowFiles<core::repository::SlabFileSystemRepository>(flow_file_count, batch_size, flow_file_size);
+  WARN(flow_file_count << " flow files of " << flow_file_size << " bytes in sessions of " << batch_size << "\n"
+      << "FileSystemRepository:     " << file_system.count() << " ms\n"
+      << "SlabFileSystemRepository: " << slab.count() << " ms");
+}
@@ -94,3 +94,28 @@ TEST_CASE("ThreadPoolTest2", "[TPT2]") {
   fut.wait();
   REQUIRE(20 == fut.get());
 }
+
+TEST_CASE("ThreadPool can be resized while running", "[TPT3]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(2);
+  pool.start();
+  REQUIRE(2 == pool.getWorkerCount());
+
+  pool.setMaxConcurrentTasks(5);
+  REQUIRE(5 == pool.getWorkerCount());
+
+  std::function<int()> f_ex = counterFunction;
+  std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new WorkerNumberExecutions(20));
+  utils::Worker<int> functor(f_ex, "id", std::move(after_execute));
+  std::future<int> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+
+  // the task keeps running while the pool is resized
+  pool.setMaxConcurrentTasks(1);
+  REQUIRE(1 == pool.getWorkerCount());
+  pool.setMaxConcurrentTasks(3);
+  REQUIRE(3 == pool.getWorkerCount());
+  fut.wait();
+  REQUIRE(20 == fut.get());
+  REQUIRE(pool.isRunning());
+}
@@ -0,0 +1,109 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "utils/TimerWheel.h"
+
+using std::chrono::milliseconds;
+
+namespace {
+
+std::vector<int> advanceTo(utils::TimerWheel<int>& wheel, std::chrono::steady_clock::time_point now) {
+  std::vector<int> expired;
+  wheel.advance(now, [&](int&& item) { expired.push_back(item); });
+  return expired;
+}
+
+}  // namespace
+
+TEST_CASE("TimerWheel expires items at their deadline", "[TimerWheel]") {
+  const auto origin = std::chrono::steady_clock::now();
+  utils::TimerWheel<int> wheel(origin);
+  const std::vector<int> delays{0, 1, 5, 63, 64, 65, 100, 4095, 4096, 5000, 262143, 262144, 300000};
+  for (int delay : delays) {
+    wheel.schedule(origin + milliseconds(delay), delay);
+  }
+  REQUIRE(wheel.size() == delays.size());
+
+  std::vector<int> expired;
+  for (int now = 0; now <= 300000; ++now) {
+    for (int item : advanceTo(wheel, origin + milliseconds(now))) {
+      REQUIRE(item == now);
+      expired.push_back(item);
+    }
+  }
+  REQUIRE(expired == delays);
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimerWheel keeps items beyond its span", "[TimerWheel]") {
+  const auto origin = std::chrono::steady_clock::now();
+  utils::TimerWheel<int> wheel(origin);
+  const int six_hours = 6 * 60 * 60 * 1000;
+  wheel.schedule(origin + milliseconds(six_hours), 1);
+
+  REQUIRE(advanceTo(wheel, origin + milliseconds(six_hours - 1)).empty());
+  REQUIRE(advanceTo(wheel, origin + milliseconds(six_hours)) == std::vector<int>{1});
+}
+
+TEST_CASE("TimerWheel reports when it has to be advanced next", "[TimerWheel]") {
+  const auto origin = std::chrono::steady_clock::now();
+  utils::TimerWheel<int> wheel(origin);
+  REQUIRE(wheel.nextExpiration() == std::chrono::steady_clock::time_point::max());
+
+  wheel.schedule(origin + milliseconds(10), 1);
+  REQUIRE(wheel.nextExpiration() == origin + milliseconds(10));
+
+  // items on the higher levels have to be moved down first
+  wheel.schedule(origin + milliseconds(5000), 2);
+  REQUIRE(advanceTo(wheel, origin + milliseconds(10)) == std::vector<int>{1});
+  REQUIRE(wheel.nextExpiration() <= origin + milliseconds(5000));
+  REQUIRE(advanceTo(wheel, wheel.nextExpiration() - milliseconds(1)).empty());
+
+  REQUIRE(advanceTo(wheel, origin + milliseconds(5000)) == std::vector<int>{2});
+  REQUIRE(wheel.nextExpiration() == std::chrono::steady_clock::time_point::max());
+}
+
+TEST_CASE("TimerWheel expires overdue items on the next advance", "[TimerWheel]") {
+  const auto origin = std::chrono::steady_clock::now();
+  utils::TimerWheel<int> wheel(origin);
+  REQUIRE(advanceTo(wheel, origin + milliseconds(100)).empty());
+  wheel.schedule(origin + milliseconds(50), 1);
+  REQUIRE(wheel.nextExpiration() <= origin + milliseconds(100));
+  REQUIRE(advanceTo(wheel, origin + milliseconds(100)) == std::vector<int>{1});
+}
+
+TEST_CASE("TimerWheel can be drained before the deadlines", "[TimerWheel]") {
+  const auto origin = std::chrono::steady_clock::now();
+  utils::TimerWheel<int> wheel(origin);
+  const std::vector<int> delays{0, 10, 5000, 300000};
+  for (int delay : delays) {
+    wheel.schedule(origin + milliseconds(delay), delay);
+  }
+
+  std::vector<int> drained;
+  wheel.drain([&](int&& item) { drained.push_back(item); });
+  std::sort(drained.begin(), drained.end());
+  REQUIRE(drained == delays);
+  REQUIRE(wheel.empty());
+  REQUIRE(wheel.nextExpiration() == std::chrono::steady_clock::time_point::max());
+  REQUIRE(advanceTo(wheel, origin + milliseconds(300000)).empty());
+}
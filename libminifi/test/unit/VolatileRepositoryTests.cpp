@@ -0,0 +1,242 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/repository/VolatileFlowFileRepository.h"
+#include "properties/Configure.h"
+
+namespace {
+
+std::shared_ptr<core::repository::VolatileFlowFileRepository> createRepository(uint32_t max_count) {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(std::string(minifi::Configure::nifi_volatile_repository_options) + "volatile.max.count", std::to_string(max_count));
+  auto repository = std::make_shared<core::repository::VolatileFlowFileRepository>("volatile");
+  REQUIRE(repository->initialize(configuration));
+  return repository;
+}
+
+bool put(core::repository::VolatileFlowFileRepository& repository, const std::string& key, const std::string& value) {
+  return repository.Put(key, reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+std::string get(core::repository::VolatileFlowFileRepository& repository, const std::string& key) {
+  std::string value;
+  return repository.Get(key, value) ? value : "<missing>";
+}
+
+}  // namespace
+
+TEST_CASE("VolatileRepository gets and deletes the values by key", "[VolatileRepository]") {
+  auto repository = createRepository(10);
+  REQUIRE(put(*repository, "a", "value a"));
+  REQUIRE(put(*repository, "b", "value b"));
+  REQUIRE(put(*repository, "c", "value c"));
+
+  REQUIRE(get(*repository, "b") == "value b");
+  REQUIRE(get(*repository, "b") == "<missing>");
+  REQUIRE(repository->Delete("a"));
+  REQUIRE_FALSE(repository->Delete("a"));
+  REQUIRE_FALSE(repository->Delete("d"));
+  REQUIRE(get(*repository, "c") == "value c");
+  REQUIRE(repository->getRepoSize() == 0);
+}
+
+TEST_CASE("VolatileRepository replaces the previous value of a key", "[VolatileRepository]") {
+  auto repository = createRepository(2);
+  REQUIRE(put(*repository, "a", "first"));
+  REQUIRE(put(*repository, "a", "second"));
+  REQUIRE(put(*repository, "b", "value b"));
+  REQUIRE(repository->getRepoSize() == std::string("second").size() + std::string("value b").size());
+
+  REQUIRE(get(*repository, "a") == "second");
+  REQUIRE(get(*repository, "a") == "<missing>");
+  REQUIRE(get(*repository, "b") == "value b");
+}
+
+TEST_CASE("VolatileRepository only evicts values when every slot is taken", "[VolatileRepository]") {
+  auto repository = createRepository(3);
+  REQUIRE(put(*repository, "a", "value a"));
+  REQUIRE(put(*repository, "b", "value b"));
+  REQUIRE(put(*repository, "c", "value c"));
+  REQUIRE(repository->Delete("b"));
+  REQUIRE(put(*repository, "d", "value d"));
+
+  SECTION("a free slot is reused") {
+    REQUIRE(get(*repository, "a") == "value a");
+    REQUIRE(get(*repository, "c") == "value c");
+    REQUIRE(get(*repository, "d") == "value d");
+  }
+
+  SECTION("the oldest slot is evicted once full") {
+    REQUIRE(put(*repository, "e", "value e"));
+    REQUIRE(get(*repository, "a") == "<missing>");
+    REQUIRE(get(*repository, "c") == "value c");
+    REQUIRE(get(*repository, "d") == "value d");
+    REQUIRE(get(*repository, "e") == "value e");
+  }
+}
+
+TEST_CASE("VolatileRepository holds more keys than a 16 bit index", "[VolatileRepository]") {
+  const uint32_t count = 70000;
+  auto repository = createRepository(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    REQUIRE(put(*repository, std::to_string(i), "value"));
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    REQUIRE(repository->Delete(std::to_string(i)));
+  }
+}
+
+TEST_CASE("VolatileRepository can be used from several threads", "[VolatileRepository]") {
+  const int thread_count = 8;
+  const int keys_per_thread = 100;
+
+  SECTION("Without eviction") {
+    auto repository = createRepository(thread_count * keys_per_thread);
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t] {
+        for (int round = 0; round < 50; ++round) {
+          for (int i = 0; i < keys_per_thread; ++i) {
+            const std::string key = std::to_string(t) + "-" + std::to_string(i);
+            if (!put(*repository, key, key + "/" + std::to_string(round))) {
+              ++failures;
+            }
+          }
+          for (int i = 0; i < keys_per_thread; ++i) {
+            const std::string key = std::to_string(t) + "-" + std::to_string(i);
+            const bool taken = i % 2 == 0 ? get(*repository, key) == key + "/" + std::to_string(round) : repository->Delete(key);
+            if (!taken) {
+              ++failures;
+            }
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(failures == 0);
+    REQUIRE(repository->getRepoSize() == 0);
+  }
+
+  SECTION("With eviction") {
+    auto repository = createRepository(thread_count * keys_per_thread / 4);
+    std::vector<std::thread> threads;
+    std::atomic<int> wrong_values{0};
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t] {
+        for (int round = 0; round < 50; ++round) {
+          for (int i = 0; i < keys_per_thread; ++i) {
+            const std::string key = std::to_string(t) + "-" + std::to_string(i);
+            put(*repository, key, key + "/" + std::to_string(round));
+          }
+          for (int i = 0; i < keys_per_thread; ++i) {
+            const std::string key = std::to_string(t) + "-" + std::to_string(i);
+            const std::string value = get(*repository, key);
+            // the value may have been evicted, but it is never mixed up with another one
+            if (value != "<missing>" && value != key + "/" + std::to_string(round)) {
+              ++wrong_values;
+            }
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(wrong_values == 0);
+    // every slot is still usable
+    for (int i = 0; i < thread_count * keys_per_thread / 4; ++i) {
+      REQUIRE(put(*repository, "final-" + std::to_string(i), "value"));
+    }
+    for (int i = 0; i < thread_count * keys_per_thread / 4; ++i) {
+      REQUIRE(get(*repository, "final-" + std::to_string(i)) == "value");
+    }
+  }
+}
+
+TEST_CASE("VolatileRepository Put, Get and Delete throughput", "[.][benchmark]") {
+  const uint32_t count = 100000;
+  auto repository = createRepository(count);
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    keys.push_back(utils::IdGenerator::getIdGenerator()->generate().to_string());
+  }
+  const std::string value(200, 'x');
+
+  const auto put_start = std::chrono::steady_clock::now();
+  for (const auto& key : keys) {
+    put(*repository, key, value);
+  }
+  const auto get_start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < count; i += 2) {
+    std::string retrieved;
+    REQUIRE(repository->Get(keys[i], retrieved));
+  }
+  const auto delete_start = std::chrono::steady_clock::now();
+  for (uint32_t i = 1; i < count; i += 2) {
+    REQUIRE(repository->Delete(keys[i]));
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const auto millis = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+  };
+  WARN(count << " puts: " << millis(get_start - put_start) << " ms, " << count / 2 << " gets: " << millis(delete_start - get_start)
+      << " ms, " << count / 2 << " deletes: " << millis(end - delete_start) << " ms");
+}
+
+TEST_CASE("VolatileRepository Put and Get throughput from several threads", "[.][benchmark]") {
+  const uint32_t count = 100000;
+  const uint32_t thread_count = 8;
+  auto repository = createRepository(count);
+  const std::string value(200, 'x');
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<std::string> keys;
+      for (uint32_t i = 0; i < count / thread_count; ++i) {
+        keys.push_back(utils::IdGenerator::getIdGenerator()->generate().to_string());
+      }
+      for (int round = 0; round < 10; ++round) {
+        for (const auto& key : keys) {
+          put(*repository, key, value);
+        }
+        for (const auto& key : keys) {
+          std::string retrieved;
+          repository->Get(key, retrieved);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  WARN(thread_count << " threads, " << 10 * count << " puts and gets: " << elapsed.count() << " ms");
+}
@@ -0,0 +1,148 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../TestBase.h"
+#include "utils/IntegrationTestUtils.h"
+#include "utils/ThreadPool.h"
+#include "utils/WorkStealingThreadPool.h"
+
+namespace {
+
+std::unique_ptr<utils::ThreadPool<utils::TaskRescheduleInfo>> createPool(bool work_stealing) {
+  if (work_stealing) {
+    return utils::make_unique<utils::WorkStealingThreadPool<utils::TaskRescheduleInfo>>(2);
+  }
+  return utils::make_unique<utils::ThreadPool<utils::TaskRescheduleInfo>>(2);
+}
+
+// runs until stopped, waiting for work after every run
+utils::Worker<utils::TaskRescheduleInfo> createWaitingWorker(std::atomic<int>& runs, const std::string& id, std::chrono::milliseconds max_wait) {
+  std::function<utils::TaskRescheduleInfo()> task = [&runs, max_wait] {
+    ++runs;
+    return utils::TaskRescheduleInfo::RetryOnWork(max_wait);
+  };
+  return utils::Worker<utils::TaskRescheduleInfo>(task, id, utils::make_unique<utils::ComplexMonitor>());
+}
+
+void testNotificationWakesUpWaitingTask(bool work_stealing) {
+  auto pool = createPool(work_stealing);
+  pool->start();
+
+  std::atomic<int> runs{0};
+  std::future<utils::TaskRescheduleInfo> future;
+  pool->execute(createWaitingWorker(runs, "waiting", std::chrono::seconds(30)), future);
+  const auto ran_once = [&runs] { return runs == 1; };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), ran_once));
+
+  // without a notification the task is not run again
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(runs == 1);
+
+  for (int expected_runs = 2; expected_runs <= 5; ++expected_runs) {
+    pool->notifyWork("waiting");
+    const auto ran_again = [&runs, expected_runs] { return runs >= expected_runs; };
+    REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), ran_again));
+  }
+
+  // notifications for other tasks are ignored
+  const int runs_before = runs;
+  pool->notifyWork("other");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(runs == runs_before);
+
+  pool->stopTasks("waiting");
+  pool->shutdown();
+}
+
+void testWaitingTaskRunsAfterMaxWait(bool work_stealing) {
+  auto pool = createPool(work_stealing);
+  pool->start();
+
+  std::atomic<int> runs{0};
+  std::future<utils::TaskRescheduleInfo> future;
+  const auto start = std::chrono::steady_clock::now();
+  pool->execute(createWaitingWorker(runs, "waiting", std::chrono::milliseconds(100)), future);
+  const auto ran_three_times = [&runs] { return runs >= 3; };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), ran_three_times));
+  REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(200));
+
+  pool->stopTasks("waiting");
+  pool->shutdown();
+}
+
+void testEarlyNotificationIsNotLost(bool work_stealing) {
+  auto pool = createPool(work_stealing);
+  pool->start();
+
+  // the notification arrives while the task is running, before it starts waiting
+  std::atomic<int> runs{0};
+  std::promise<void> notified;
+  auto notified_future = notified.get_future().share();
+  std::function<utils::TaskRescheduleInfo()> task = [&runs, notified_future] {
+    if (++runs == 1) {
+      notified_future.wait();
+    }
+    return utils::TaskRescheduleInfo::RetryOnWork(std::chrono::seconds(30));
+  };
+  std::future<utils::TaskRescheduleInfo> future;
+  pool->execute(utils::Worker<utils::TaskRescheduleInfo>(task, "waiting", utils::make_unique<utils::ComplexMonitor>()), future);
+  const auto ran_once = [&runs] { return runs == 1; };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), ran_once));
+  pool->notifyWork("waiting");
+  notified.set_value();
+
+  const auto ran_twice = [&runs] { return runs == 2; };
+  REQUIRE(utils::verifyEventHappenedInPollTime(std::chrono::seconds(5), ran_twice));
+
+  pool->stopTasks("waiting");
+  pool->shutdown();
+}
+
+}  // namespace
+
+TEST_CASE("Tasks waiting for work are run when they are notified", "[WaitForWork]") {
+  SECTION("ThreadPool") {
+    testNotificationWakesUpWaitingTask(false);
+  }
+  SECTION("WorkStealingThreadPool") {
+    testNotificationWakesUpWaitingTask(true);
+  }
+}
+
+TEST_CASE("Tasks waiting for work are run when their maximum wait time passes", "[WaitForWork]") {
+  SECTION("ThreadPool") {
+    testWaitingTaskRunsAfterMaxWait(false);
+  }
+  SECTION("WorkStealingThreadPool") {
+    testWaitingTaskRunsAfterMaxWait(true);
+  }
+}
+
+TEST_CASE("Notifications sent before a task starts waiting are not lost", "[WaitForWork]") {
+  SECTION("ThreadPool") {
+    testEarlyNotificationIsNotLost(false);
+  }
+  SECTION("WorkStealingThreadPool") {
+    testEarlyNotificationIsNotLost(true);
+  }
+}
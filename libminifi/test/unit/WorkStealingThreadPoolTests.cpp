@@ -0,0 +1,309 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../TestBase.h"
+#include "utils/IntegrationTestUtils.h"
+#include "utils/ThreadPool.h"
+#include "utils/WorkStealingThreadPool.h"
+
+namespace {
+
+class RunCount : public utils::AfterExecute<int> {
+ public:
+  RunCount(int runs, std::chrono::milliseconds wait_time)
+      : remaining_runs_(runs),
+        wait_time_(wait_time) {
+  }
+
+  bool isFinished(const int& /*result*/) override {
+    return --remaining_runs_ <= 0;
+  }
+  bool isCancelled(const int& /*result*/) override {
+    return false;
+  }
+  std::chrono::milliseconds wait_time() override {
+    return wait_time_;
+  }
+
+ private:
+  int remaining_runs_;
+  std::chrono::milliseconds wait_time_;
+};
+
+utils::Worker<int> createWorker(std::function<int()> task, const std::string& id, int runs, std::chrono::milliseconds wait_time = std::chrono::milliseconds(0)) {
+  return utils::Worker<int>(std::move(task), id, utils::make_unique<RunCount>(runs, wait_time));
+}
+
+}  // namespace
+
+TEST_CASE("WorkStealingThreadPool runs the submitted tasks", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(4);
+  pool.start();
+
+  std::atomic<int> counter{0};
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    std::future<int> future;
+    pool.execute(createWorker([&counter] { return ++counter; }, "id" + std::to_string(i % 7), 20), future);
+    futures.push_back(std::move(future));
+  }
+  for (auto& future : futures) {
+    REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  }
+  REQUIRE(counter == 2000);
+}
+
+TEST_CASE("WorkStealingThreadPool reschedules tasks after their wait time", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(2);
+  pool.start();
+
+  std::vector<std::chrono::steady_clock::time_point> run_times;
+  const auto submitted = std::chrono::steady_clock::now();
+  std::future<int> future;
+  pool.execute(createWorker([&run_times] {
+    run_times.push_back(std::chrono::steady_clock::now());
+    return 0;
+  }, "id", 5, std::chrono::milliseconds(20)), future);
+  REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+  REQUIRE(run_times.size() == 5);
+  // runs are scheduled at a fixed rate, counted from the creation of the task
+  for (size_t i = 0; i < run_times.size(); ++i) {
+    REQUIRE(run_times[i] - submitted >= i * std::chrono::milliseconds(20));
+  }
+}
+
+TEST_CASE("WorkStealingThreadPool stops the tasks of an identifier", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(2);
+  pool.start();
+
+  std::atomic<int> counter{0};
+  std::future<int> future;
+  pool.execute(createWorker([&counter] { return ++counter; }, "stopped", 1000000, std::chrono::milliseconds(1)), future);
+  REQUIRE(pool.isTaskRunning("stopped"));
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  const auto task_has_run = [&counter] { return counter > 0; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), task_has_run));
+
+  pool.stopTasks("stopped");
+  REQUIRE_FALSE(pool.isTaskRunning("stopped"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const int runs_after_stop = counter;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(counter == runs_after_stop);
+
+  // a new task with the same identifier does not revive the stopped one
+  std::future<int> new_future;
+  pool.execute(createWorker([] { return 0; }, "stopped", 1), new_future);
+  REQUIRE(new_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(counter == runs_after_stop);
+}
+
+TEST_CASE("WorkStealingThreadPool does not run tasks while paused", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(2);
+  pool.start();
+  pool.pause();
+
+  std::future<int> future;
+  pool.execute(createWorker([] { return 0; }, "id", 1), future);
+  REQUIRE(future.wait_for(std::chrono::milliseconds(200)) == std::future_status::timeout);
+
+  pool.resume();
+  REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+}
+
+TEST_CASE("WorkStealingThreadPool can be restarted with a different number of threads", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(2);
+  pool.start();
+  pool.setMaxConcurrentTasks(5);
+  REQUIRE(pool.isRunning());
+
+  std::future<int> future;
+  pool.execute(createWorker([] { return 0; }, "id", 1), future);
+  REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+  pool.shutdown();
+  REQUIRE_FALSE(pool.isRunning());
+}
+
+TEST_CASE("WorkStealingThreadPool can be resized while running", "[WorkStealingThreadPool]") {
+  utils::WorkStealingThreadPool<int> pool(4);
+  pool.start();
+  REQUIRE(pool.getWorkerCount() == 4);
+
+  std::atomic<int> runs{0};
+  std::vector<std::future<int>> futures(8);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    pool.execute(createWorker([&runs] { return ++runs; }, "id" + std::to_string(i), 5, std::chrono::milliseconds(20)), futures[i]);
+  }
+
+  // the retiring workers hand their tasks over to the remaining one
+  pool.setMaxConcurrentTasks(1);
+  REQUIRE(pool.getWorkerCount() == 1);
+
+  SECTION("Growing again right away") {
+    pool.setMaxConcurrentTasks(3);
+    REQUIRE(pool.getWorkerCount() == 3);
+  }
+  SECTION("Growing again after the retired workers have left") {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    pool.setMaxConcurrentTasks(6);
+    REQUIRE(pool.getWorkerCount() == 6);
+  }
+
+  for (auto& future : futures) {
+    REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  }
+  REQUIRE(runs == 40);
+  pool.shutdown();
+}
+
+TEST_CASE("WorkStealingThreadPool runs the timers of a worker stuck in a long task", "[WorkStealingThreadPool]") {
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  utils::WorkStealingThreadPool<int> pool(1);
+  pool.start();
+
+  // with a single worker, the periodic task waits in the timer wheel of that worker
+  std::atomic<int> periodic_runs{0};
+  std::future<int> periodic_future;
+  pool.execute(createWorker([&periodic_runs] { return ++periodic_runs; }, "periodic", 1000000, std::chrono::milliseconds(20)), periodic_future);
+  const auto periodic_has_run = [&periodic_runs] { return periodic_runs > 0; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), periodic_has_run));
+
+  std::atomic<bool> blocking{false};
+  std::atomic<bool> released{false};
+  std::future<int> blocking_future;
+  pool.execute(createWorker([&blocking, &released] {
+    blocking = true;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (!released && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+  }, "blocking", 1), blocking_future);
+  const auto is_blocking = [&blocking] { return blocking.load(); };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), is_blocking));
+
+  // the new worker takes over the timers that the blocked one cannot expire
+  pool.setMaxConcurrentTasks(2);
+  const int runs_while_blocked = periodic_runs;
+  const auto periodic_keeps_running = [&] { return periodic_runs >= runs_while_blocked + 5; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), periodic_keeps_running));
+  REQUIRE(blocking_future.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+
+  released = true;
+  REQUIRE(blocking_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  pool.shutdown();
+}
+
+namespace {
+
+void testAdaptiveThreadCount(utils::ThreadPool<int>& pool) {
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  pool.enableAdaptiveThreadCount(1, 4);
+  pool.start();
+  REQUIRE(pool.getWorkerCount() == 1);
+
+  // tasks waiting on I/O: they keep the workers busy without using the CPU
+  std::vector<std::future<int>> futures(8);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    pool.execute(createWorker([] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return 0;
+    }, "id" + std::to_string(i), 200), futures[i]);
+  }
+  const auto has_grown = [&pool] { return pool.getWorkerCount() == 4; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(10), has_grown));
+
+  for (auto& future : futures) {
+    REQUIRE(future.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+  }
+  const auto has_shrunk = [&pool] { return pool.getWorkerCount() == 1; };
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(20), has_shrunk));
+  pool.shutdown();
+}
+
+}  // namespace
+
+TEST_CASE("Thread pools adapt their number of threads to the load", "[WorkStealingThreadPool]") {
+  SECTION("ThreadPool") {
+    utils::ThreadPool<int> pool(1);
+    testAdaptiveThreadCount(pool);
+  }
+  SECTION("WorkStealingThreadPool") {
+    utils::WorkStealingThreadPool<int> pool(1);
+    testAdaptiveThreadCount(pool);
+  }
+}
+
+namespace {
+
+template<typename Pool>
+void benchmarkThreadPool(const std::string& name, Pool& pool) {
+  pool.start();
+  const int task_count = 200000;
+  std::atomic<int> done{0};
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < task_count; ++i) {
+    std::future<int> future;
+    pool.execute(utils::Worker<int>([&done] { return ++done; }, "throughput"), future);
+  }
+  while (done < task_count) {
+    std::this_thread::yield();
+  }
+  const auto throughput_time = std::chrono::steady_clock::now() - start;
+
+  std::vector<int64_t> latencies;
+  for (int i = 0; i < 2000; ++i) {
+    std::atomic<int64_t> latency{0};
+    const auto submitted = std::chrono::steady_clock::now();
+    std::future<int> future;
+    pool.execute(utils::Worker<int>([&latency, submitted] {
+      latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - submitted).count();
+      return 0;
+    }, "latency"), future);
+    future.wait();
+    latencies.push_back(latency);
+    // let the workers go idle between the samples
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  std::sort(latencies.begin(), latencies.end());
+  WARN(name << ": " << task_count << " tasks in " << std::chrono::duration_cast<std::chrono::milliseconds>(throughput_time).count()
+      << " ms, dispatch latency p50 " << latencies[latencies.size() / 2] << " us, p99 " << latencies[latencies.size() * 99 / 100] << " us");
+  pool.shutdown();
+}
+
+}  // namespace
+
+TEST_CASE("ThreadPool dispatch benchmark", "[.][benchmark]") {
+  for (int threads : {4, 16, 32}) {
+    utils::ThreadPool<int> pool(threads);
+    benchmarkThreadPool("ThreadPool with " + std::to_string(threads) + " threads", pool);
+    utils::WorkStealingThreadPool<int> work_stealing_pool(threads);
+    benchmarkThreadPool("WorkStealingThreadPool with " + std::to_string(threads) + " threads", work_stealing_pool);
+  }
+}
@@ -0,0 +1,221 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef __linux__
+
+#include <sys/resource.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../TestBase.h"
+#include "io/BufferStream.h"
+#include "io/CRCStream.h"
+#include "io/PosixFileStream.h"
+#include "io/ServerSocket.h"
+#include "io/StreamPipe.h"
+#include "io/StreamSlice.h"
+#include "utils/file/FileUtils.h"
+#include "utils/gsl.h"
+
+namespace {
+
+/**
+ * Buffer that reads the file regions written to it, to observe what a socket would send.
+ */
+class FileRegionBufferStream : public minifi::io::BufferStream {
+ public:
+  using BufferStream::write;
+
+  bool canWriteFileRegion() const override {
+    return true;
+  }
+
+  int64_t writeFileRegion(const minifi::io::FileRegion& region) override {
+    std::vector<uint8_t> buffer(gsl::narrow<size_t>(region.size));
+    if (pread(region.fd, buffer.data(), buffer.size(), gsl::narrow<off_t>(region.offset)) != gsl::narrow<ssize_t>(buffer.size())) {
+      return -1;
+    }
+    ++file_regions_written;
+    return write(buffer.data(), gsl::narrow<int>(buffer.size()));
+  }
+
+  size_t file_regions_written = 0;
+};
+
+std::string createFile(TestController& controller, const std::string& content) {
+  char format[] = "/tmp/zero_copy.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "content");
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+  return path;
+}
+
+std::string toString(const minifi::io::BufferStream& stream) {
+  return std::string(reinterpret_cast<const char*>(stream.getBuffer()), stream.size());
+}
+
+}  // namespace
+
+TEST_CASE("File streams transfer their content as file regions", "[zerocopy]") {
+  TestController controller;
+  const auto path = createFile(controller, "header|content|trailer");
+  auto file = std::make_shared<minifi::io::PosixFileStream>(path, 0);
+
+  SECTION("whole file") {
+    auto output = std::make_shared<FileRegionBufferStream>();
+    REQUIRE(22 == minifi::internal::pipe(file, output));
+    REQUIRE(1 == output->file_regions_written);
+    REQUIRE("header|content|trailer" == toString(*output));
+  }
+  SECTION("slice") {
+    minifi::io::StreamSlice slice(file, 7, 7);
+    FileRegionBufferStream output;
+    const auto transferred = slice.transferTo(output, 3);
+    REQUIRE(transferred);
+    REQUIRE(3 == *transferred);
+    REQUIRE(4 == *slice.transferTo(output, 100));
+    REQUIRE(0 == *slice.transferTo(output, 100));
+    REQUIRE("content" == toString(output));
+  }
+  SECTION("outputs without file region support are written by copying") {
+    minifi::io::BufferStream output;
+    REQUIRE_FALSE(file->transferTo(output, 100));
+    auto buffer = std::make_shared<minifi::io::BufferStream>();
+    REQUIRE(22 == minifi::internal::pipe(file, buffer));
+    REQUIRE("header|content|trailer" == toString(*buffer));
+  }
+}
+
+TEST_CASE("CRCStream checksums the file regions written through it", "[zerocopy]") {
+  TestController controller;
+  const std::string content(3 * getpagesize() + 17, 'x');
+  const auto path = createFile(controller, "unaligned" + content);
+
+  FileRegionBufferStream output;
+  minifi::io::CRCStream<minifi::io::BaseStream> crc_stream(gsl::make_not_null<minifi::io::BaseStream*>(&output));
+  REQUIRE(crc_stream.canWriteFileRegion());
+  minifi::io::StreamSlice slice(std::make_shared<minifi::io::PosixFileStream>(path, 0), 9, content.size());
+  REQUIRE(gsl::narrow<int64_t>(content.size()) == *slice.transferTo(crc_stream, content.size()));
+
+  REQUIRE(content == toString(output));
+  REQUIRE(crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(content.data()), gsl::narrow<uInt>(content.size())) == crc_stream.getCRC());
+}
+
+TEST_CASE("Socket sends file regions with sendfile", "[zerocopy]") {
+  TestController controller;
+  const std::string content(100000, 'z');
+  const auto path = createFile(controller, content);
+
+  auto socket_context = std::make_shared<minifi::io::SocketContext>(std::make_shared<minifi::Configure>());
+  minifi::io::ServerSocket server(socket_context, minifi::io::Socket::getMyHostName(), 9185, 1);
+  REQUIRE(-1 != server.initialize());
+  auto client = std::make_shared<minifi::io::Socket>(socket_context, minifi::io::Socket::getMyHostName(), 9185);
+  REQUIRE(-1 != client->initialize());
+  REQUIRE(client->canWriteFileRegion());
+
+  std::vector<uint8_t> received;
+  int read = 0;
+  std::thread reader([&] {
+    read = server.read(received, gsl::narrow<int>(content.size()));
+  });
+  REQUIRE(gsl::narrow<int64_t>(content.size()) == minifi::internal::pipe(std::make_shared<minifi::io::PosixFileStream>(path, 0), client));
+  reader.join();
+  REQUIRE(gsl::narrow<int>(content.size()) == read);
+  REQUIRE(content == std::string(received.begin(), received.end()));
+}
+
+namespace {
+
+std::chrono::microseconds threadCpuTime() {
+  rusage usage{};
+  getrusage(RUSAGE_THREAD, &usage);
+  return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/**
+ * Output that hides the file region support of the socket, to measure the copying path.
+ */
+class CopyingOutputStream : public minifi::io::OutputStream {
+ public:
+  explicit CopyingOutputStream(std::shared_ptr<minifi::io::Socket> socket) : socket_(std::move(socket)) {}
+
+  using OutputStream::write;
+
+  int write(const uint8_t *value, int len) override {
+    return socket_->write(value, len);
+  }
+
+ private:
+  std::shared_ptr<minifi::io::Socket> socket_;
+};
+
+std::chrono::microseconds sendFileCpuTime(const std::string& path, uint64_t size, bool zero_copy, uint16_t port) {
+  auto socket_context = std::make_shared<minifi::io::SocketContext>(std::make_shared<minifi::Configure>());
+  minifi::io::ServerSocket server(socket_context, minifi::io::Socket::getMyHostName(), port, 1);
+  REQUIRE(-1 != server.initialize());
+  auto client = std::make_shared<minifi::io::Socket>(socket_context, minifi::io::Socket::getMyHostName(), port);
+  REQUIRE(-1 != client->initialize());
+
+  std::thread reader([&] {
+    std::vector<uint8_t> buffer(1024 * 1024);
+    uint64_t received = 0;
+    while (received < size) {
+      const int ret = server.read(buffer.data(), gsl::narrow<int>((std::min)(size - received, static_cast<uint64_t>(buffer.size()))), false);
+      if (ret <= 0) {
+        break;
+      }
+      received += ret;
+    }
+  });
+  const auto start = threadCpuTime();
+  auto input = std::make_shared<minifi::io::PosixFileStream>(path, 0);
+  const int64_t sent = zero_copy ? minifi::internal::pipe(input, client) : minifi::internal::pipe(input, std::make_shared<CopyingOutputStream>(client));
+  const auto cpu_time = threadCpuTime() - start;
+  reader.join();
+  REQUIRE(gsl::narrow<int64_t>(size) == sent);
+  return std::chrono::duration_cast<std::chrono::microseconds>(cpu_time);
+}
+
+}  // namespace
+
+TEST_CASE("Sender CPU time of sending content over a socket with and without zero-copy", "[.][benchmark]") {
+  TestController controller;
+  char format[] = "/var/tmp/zero_copy_benchmark.XXXXXX";
+  const auto path = utils::file::FileUtils::concat_path(controller.createTempDirectory(format), "content");
+  const uint64_t size = 1024 * 1024 * 1024;
+  {
+    std::ofstream file(path, std::ios::binary);
+    const std::string chunk(1024 * 1024, 'x');
+    for (uint64_t written = 0; written < size; written += chunk.size()) {
+      file << chunk;
+    }
+  }
+  const auto copy = sendFileCpuTime(path, size, false, 9186);
+  const auto zero_copy = sendFileCpuTime(path, size, true, 9187);
+  WARN("CPU time of sending 1 GB over loopback\n"
+      << "read/write: " << copy.count() / 1000 << " ms\n"
+      << "sendfile:   " << zero_copy.count() / 1000 << " ms");
+}
+
+#endif  // __linux__